@@ -26,6 +26,9 @@ class Settings(BaseSettings):
 
     # C Engine
     engine_path: str = "./engine/scheduler"
+    engine_pool_size: int = 2  # Warm --serve processes, 0 for one per request
+    engine_wire_format: str = "binary"  # "binary" or "json" (readable, for debugging)
+    engine_library: bool = True  # Solve in-process through libaesa.so when it loads
 
     # File uploads
     upload_dir: str = "./uploads"
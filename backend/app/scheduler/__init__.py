@@ -1,12 +1,15 @@
 """Scheduler module for AESA."""
 
 from app.scheduler.bridge import (
+    BatchRequest,
     CSchedulerBridge,
+    EngineOptions,
     SchedulerError,
     SchedulerErrorCode,
     TaskInput,
     TimeSlotInput,
     TimeSlotOutput,
+    TimeSlotRun,
     ScheduleResult,
     get_scheduler_bridge,
 )
@@ -64,12 +67,15 @@ from app.scheduler.analytics import (
 
 __all__ = [
     # Bridge
+    "BatchRequest",
     "CSchedulerBridge",
+    "EngineOptions",
     "SchedulerError",
     "SchedulerErrorCode",
     "TaskInput",
     "TimeSlotInput",
     "TimeSlotOutput",
+    "TimeSlotRun",
     "ScheduleResult",
     "get_scheduler_bridge",
     # Gaps
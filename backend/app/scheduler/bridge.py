@@ -1,5 +1,5 @@
 """
-Bridge to C optimization engine via subprocess.
+Bridge to C optimization engine, in-process or via subprocess.
 
 This module provides the interface between the Python backend and the
 C-based constraint satisfaction scheduler engine.
@@ -8,18 +8,72 @@ Requirements: 3.1 (Bridge interface from design)
 """
 
 import asyncio
+import ctypes
 import json
 import logging
-from dataclasses import dataclass, field
+import os
+import struct
+import tempfile
+import threading
+import weakref
+from dataclasses import dataclass, field, replace
 from enum import Enum
 from pathlib import Path
-from typing import Optional
+from typing import Callable, Optional
 
 from app.core.config import get_settings
 
 logger = logging.getLogger(__name__)
 
 
+# Binary wire format, laid out in engine/src/wire.h
+WIRE_VERSION = 1
+_WIRE_PREFIX = struct.Struct("<4sHHI")
+_WIRE_REQUEST_HEADER = struct.Struct("<4sHHIIIIqqqQIIBBBBI48sIBBBB")
+_WIRE_TASK_RECORD = struct.Struct("<iiiiIHBBB3x")
+_WIRE_FIXED_RECORD = struct.Struct("<ii")
+_WIRE_PREVIOUS_RECORD = struct.Struct("<ii")
+_WIRE_RESPONSE_HEADER = struct.Struct("<4sHHIIIIIHHBxH")
+_WIRE_SLOT_RECORD = struct.Struct("<iBBxx")
+_WIRE_RUN_RECORD = struct.Struct("<iHHB3x")
+_WIRE_OBJECTIVE_TAIL = struct.Struct("<qq")
+_WIRE_TEMPLATE_LENGTH = struct.Struct("<H")
+
+# Request flags
+_WIRE_FORWARD_CHECKING = 0x01
+_WIRE_BACKJUMPING = 0x02
+_WIRE_ENERGY_CURVE = 0x04
+_WIRE_SEED = 0x08
+_WIRE_LOCAL_SEARCH = 0x10
+_WIRE_PRIORITY_WEIGHTS = 0x20
+_WIRE_TEMPLATE = 0x40
+_WIRE_REGISTER_TEMPLATE = 0x80
+
+# Response flags
+_WIRE_SUCCESS = 0x01
+_WIRE_BUDGET_EXHAUSTED = 0x02
+_WIRE_RUNS = 0x04
+_WIRE_INCREMENTAL = 0x08
+_WIRE_REPAIRED = 0x10
+_WIRE_CACHE_HIT = 0x20
+_WIRE_OBJECTIVE = 0x40
+
+# Enum codes, in the order of the engine's TaskType and SolverEngine
+_WIRE_TASK_TYPES = {
+    name: code
+    for code, name in enumerate(
+        (
+            "university", "study", "revision", "practice", "assignment",
+            "lab_work", "deep_work", "break", "free_time", "sleep",
+            "wake_routine", "breakfast", "lunch", "dinner",
+        )
+    )
+}
+_WIRE_ENGINES = ("backtrack", "greedy", "auto")
+_WIRE_OBJECTIVES = ("feasible", "maximize_energy_fit")
+_WIRE_INVALID_CODE = 0xFF  # Rejected by the engine like an unknown JSON name
+
+
 class SchedulerErrorCode(str, Enum):
     """Error codes from the C scheduler engine."""
 
@@ -106,6 +160,148 @@ class TimeSlotInput:
         }
 
 
+@dataclass
+class EngineOptions:
+    """Optional per-request solver settings for the C scheduler."""
+
+    energy_curve: Optional[list[int]] = None  # 48 levels (1-10), one per slot of day
+    max_nodes: Optional[int] = None  # Search node budget
+    max_time_us: Optional[int] = None  # Search wall-clock budget in microseconds
+    forward_checking: bool = False  # Prune empty domains, most-constrained first
+    backjumping: bool = False  # Conflict-directed backjumping
+    max_nogoods: int = 0  # Learned conflict table size (needs backjumping)
+    engine: str = "backtrack"  # "backtrack", "greedy" or "auto"
+    local_search_moves: Optional[int] = None  # Greedy engine local search moves
+    seed: Optional[int] = None  # Greedy engine local search seed
+    tie_break_seed: Optional[int] = None  # Rotates equal-score candidate slots
+    threads: Optional[int] = None  # Portfolio worker threads (engine reads AESA_THREADS if unset)
+    search_threads: Optional[int] = None  # Threads splitting one backtracking search
+    objective: str = "feasible"  # "feasible" or "maximize_energy_fit" (branch and bound)
+    weight_by_priority: bool = False  # Objective weighs each task's score by its priority
+    slot_minutes: int = 30  # Slot length: 15, 30 or 60 minutes
+    start_slot_of_day: int = 0  # Slot of the first day the horizon starts at
+    output_format: str = "compact"  # "pretty", "compact" or "runs" (occupied runs only)
+
+    def to_dict(self) -> dict:
+        """Convert to dictionary of top-level input fields, omitting defaults."""
+        data: dict = {}
+        if self.energy_curve is not None:
+            data["energy_curve"] = list(self.energy_curve)
+        if self.max_nodes is not None:
+            data["max_nodes"] = self.max_nodes
+        if self.max_time_us is not None:
+            data["max_time_us"] = self.max_time_us
+        if self.forward_checking:
+            data["forward_checking"] = True
+        if self.backjumping:
+            data["backjumping"] = True
+        if self.max_nogoods:
+            data["max_nogoods"] = self.max_nogoods
+        if self.engine != "backtrack":
+            data["engine"] = self.engine
+        if self.local_search_moves is not None:
+            data["local_search_moves"] = self.local_search_moves
+        if self.seed is not None:
+            data["seed"] = self.seed
+        if self.tie_break_seed is not None:
+            data["tie_break_seed"] = self.tie_break_seed
+        if self.threads is not None:
+            data["threads"] = self.threads
+        if self.search_threads is not None:
+            data["search_threads"] = self.search_threads
+        if self.objective != "feasible":
+            data["objective"] = self.objective
+        if self.weight_by_priority:
+            data["weight_by_priority"] = True
+        if self.slot_minutes != 30:
+            data["slot_minutes"] = self.slot_minutes
+        if self.start_slot_of_day:
+            data["start_slot_of_day"] = self.start_slot_of_day
+        if self.output_format != "pretty":
+            data["output_format"] = self.output_format
+        return data
+
+
+@dataclass
+class FixedSlotTemplate:
+    """
+    Fixed slots shared by many requests, such as one section's timetable.
+
+    Requests name the template with ``fixed_template`` and must use its
+    horizon; their own fixed slots are applied on top of it.
+    """
+
+    name: str  # 1 to 63 bytes of UTF-8
+    fixed_slots: list[TimeSlotInput]
+    num_days: int = 7
+    slot_minutes: int = 30
+    start_slot_of_day: int = 0
+
+    def to_dict(self) -> dict:
+        """Convert to the engine's JSON registration request."""
+        data: dict = {
+            "register_template": self.name,
+            "fixed_slots": [s.to_dict() for s in self.fixed_slots],
+            "num_days": self.num_days,
+        }
+        return data | EngineOptions(
+            slot_minutes=self.slot_minutes,
+            start_slot_of_day=self.start_slot_of_day,
+            output_format="runs",
+        ).to_dict()
+
+
+@dataclass
+class ScheduleVariant:
+    """
+    One what-if edit of a base request, for ``optimize_variants``.
+
+    A task with the ID of a base task replaces it; other tasks are added.
+    """
+
+    remove_tasks: list[int] = field(default_factory=list)  # IDs of base tasks to leave out
+    tasks: list[TaskInput] = field(default_factory=list)
+    fixed_slots: list[TimeSlotInput] = field(default_factory=list)  # Applied on top of the base's
+    remove_fixed_slots: list[int] = field(default_factory=list)  # Base fixed slot indices to free
+
+    def to_dict(self) -> dict:
+        """Convert to the engine's variant object, omitting empty edits."""
+        data: dict = {}
+        if self.remove_tasks:
+            data["remove_tasks"] = list(self.remove_tasks)
+        if self.tasks:
+            data["tasks"] = [t.to_dict() for t in self.tasks]
+        if self.fixed_slots:
+            data["fixed_slots"] = [s.to_dict() for s in self.fixed_slots]
+        if self.remove_fixed_slots:
+            data["remove_fixed_slots"] = list(self.remove_fixed_slots)
+        return data
+
+
+@dataclass
+class BatchRequest:
+    """One independent schedule request of a batch run."""
+
+    request_id: str
+    tasks: list[TaskInput]
+    fixed_slots: list[TimeSlotInput] = field(default_factory=list)
+    num_days: int = 7
+    options: Optional[EngineOptions] = None
+    fixed_template: Optional[str] = None  # Name of a registered FixedSlotTemplate
+
+
+@dataclass
+class TaskPlacement:
+    """Start slot a task had in an earlier schedule."""
+
+    task_id: int
+    start_slot: int
+
+    def to_dict(self) -> dict:
+        """Convert to dictionary for JSON serialization."""
+        return {"task_id": self.task_id, "start_slot": self.start_slot}
+
+
 @dataclass
 class TimeSlotOutput:
     """Time slot output from the C scheduler."""
@@ -126,6 +322,26 @@ class TimeSlotOutput:
         )
 
 
+@dataclass
+class TimeSlotRun:
+    """Consecutive slots sharing a task, from the "runs" output format."""
+
+    task_id: int
+    start_slot: int
+    length: int
+    is_fixed: bool
+
+    @classmethod
+    def from_dict(cls, data: dict) -> "TimeSlotRun":
+        """Create from dictionary."""
+        return cls(
+            task_id=data.get("task_id", -1),
+            start_slot=data.get("start_slot", 0),
+            length=data.get("length", 0),
+            is_fixed=data.get("is_fixed", False),
+        )
+
+
 @dataclass
 class ScheduleResult:
     """Result from the C scheduler optimization."""
@@ -134,6 +350,17 @@ class ScheduleResult:
     error_message: str = ""
     num_slots: int = 0
     slots: list[TimeSlotOutput] = field(default_factory=list)
+    budget_exhausted: bool = False
+    unplaced_tasks: list[int] = field(default_factory=list)
+    engine: str = "backtrack"  # Engine that produced the result
+    strategy: str = ""  # Strategy that produced the result (portfolio winner)
+    runs: list[TimeSlotRun] = field(default_factory=list)  # Set instead of slots by "runs" output
+    moved_tasks: Optional[int] = None  # Set for incremental requests
+    repaired: bool = False  # Incremental result kept every still-valid placement
+    cache_hit: bool = False  # Answered from the engine's result cache
+    objective_value: Optional[int] = None  # Total energy score, set for requests with an objective
+    objective_bound: Optional[int] = None  # Proven upper bound; equals objective_value when optimal
+    stats: Optional[dict] = None  # Search counters and phase timings, from engines built with STATS=1
 
     @classmethod
     def from_dict(cls, data: dict) -> "ScheduleResult":
@@ -144,14 +371,49 @@ class ScheduleResult:
             error_message=data.get("error_message", ""),
             num_slots=data.get("num_slots", 0),
             slots=slots,
+            budget_exhausted=data.get("budget_exhausted", False),
+            unplaced_tasks=list(data.get("unplaced_tasks", [])),
+            engine=data.get("engine", "backtrack"),
+            strategy=data.get("strategy", ""),
+            runs=[TimeSlotRun.from_dict(r) for r in data.get("runs", [])],
+            moved_tasks=data.get("moved_tasks"),
+            repaired=data.get("repaired", False),
+            cache_hit=data.get("cache_hit", False),
+            objective_value=data.get("objective_value"),
+            objective_bound=data.get("objective_bound"),
+            stats=data.get("stats"),
         )
 
+    def placements(self) -> list[TaskPlacement]:
+        """Start slot of every scheduled task, to pass as previous placements."""
+        if self.runs:
+            return [
+                TaskPlacement(r.task_id, r.start_slot)
+                for r in self.runs
+                if not r.is_fixed and r.task_id >= 0
+            ]
+        starts: dict[int, int] = {}
+        for s in self.slots:
+            if not s.is_fixed and s.task_id >= 0:
+                starts.setdefault(s.task_id, s.slot_index)
+        return [TaskPlacement(task_id, start) for task_id, start in starts.items()]
+
     def to_dict(self) -> dict:
         """Convert to dictionary."""
         return {
             "success": self.success,
             "error_message": self.error_message,
             "num_slots": self.num_slots,
+            "budget_exhausted": self.budget_exhausted,
+            "unplaced_tasks": list(self.unplaced_tasks),
+            "engine": self.engine,
+            "strategy": self.strategy,
+            "moved_tasks": self.moved_tasks,
+            "repaired": self.repaired,
+            "cache_hit": self.cache_hit,
+            "objective_value": self.objective_value,
+            "objective_bound": self.objective_bound,
+            "stats": self.stats,
             "slots": [
                 {
                     "slot_index": s.slot_index,
@@ -161,12 +423,534 @@ class ScheduleResult:
                 }
                 for s in self.slots
             ],
+            "runs": [
+                {
+                    "task_id": r.task_id,
+                    "start_slot": r.start_slot,
+                    "length": r.length,
+                    "is_fixed": r.is_fixed,
+                }
+                for r in self.runs
+            ],
         }
 
 
+def _wire_u8(value: int, low: int) -> int:
+    """Fit a header byte; values outside [low, 0xFF) become _WIRE_INVALID_CODE."""
+    return value if low <= value < _WIRE_INVALID_CODE else _WIRE_INVALID_CODE
+
+
+def pack_wire_request(
+    tasks: list[TaskInput],
+    fixed_slots: list[TimeSlotInput],
+    options: Optional[EngineOptions] = None,
+    request_id: int = 0,
+    previous: Optional[list[TaskPlacement]] = None,
+    num_days: int = 7,
+    fixed_template: Optional[str] = None,
+    register_template: bool = False,
+) -> bytes:
+    """
+    Pack a request in the engine's binary wire format.
+
+    Args:
+        tasks: List of tasks to schedule
+        fixed_slots: List of fixed time slots
+        options: Optional solver settings
+        request_id: Number the engine echoes in its response
+        previous: Placements of an earlier schedule to keep where still valid
+        num_days: Number of days to optimize
+        fixed_template: Name of a template the engine applies before
+                        fixed_slots
+        register_template: Register fixed_slots as template fixed_template
+                           instead of solving
+
+    Returns:
+        Request message
+    """
+    options = options or EngineOptions()
+    previous = previous or []
+
+    names = [t.name.encode()[:0xFFFF] for t in tasks]
+    strings_size = sum(len(n) for n in names)
+    tasks_offset = _WIRE_REQUEST_HEADER.size
+    fixed_offset = tasks_offset + len(tasks) * _WIRE_TASK_RECORD.size
+    previous_offset = fixed_offset + len(fixed_slots) * _WIRE_FIXED_RECORD.size
+    strings_offset = previous_offset + len(previous) * _WIRE_PREVIOUS_RECORD.size
+    template_offset = strings_offset + strings_size
+    template = fixed_template.encode()[:0xFFFF] if fixed_template is not None else b""
+    total_size = template_offset
+    if fixed_template is not None:
+        total_size += _WIRE_TEMPLATE_LENGTH.size + len(template)
+
+    flags = 0
+    if fixed_template is not None:
+        flags |= _WIRE_TEMPLATE
+        if register_template:
+            flags |= _WIRE_REGISTER_TEMPLATE
+    if options.forward_checking:
+        flags |= _WIRE_FORWARD_CHECKING
+    if options.backjumping:
+        flags |= _WIRE_BACKJUMPING
+    energy_curve = b""
+    if options.energy_curve is not None:
+        flags |= _WIRE_ENERGY_CURVE
+        # Invalid curves are sent as zero levels so the engine rejects them
+        if len(options.energy_curve) == 48:
+            energy_curve = bytes(v if 0 < v < 256 else 0 for v in options.energy_curve)
+    if options.seed is not None:
+        flags |= _WIRE_SEED
+    if options.local_search_moves is not None:
+        flags |= _WIRE_LOCAL_SEARCH
+    if options.weight_by_priority:
+        flags |= _WIRE_PRIORITY_WEIGHTS
+    engine = (
+        _WIRE_ENGINES.index(options.engine)
+        if options.engine in _WIRE_ENGINES
+        else _WIRE_INVALID_CODE
+    )
+    objective = (
+        _WIRE_OBJECTIVES.index(options.objective)
+        if options.objective in _WIRE_OBJECTIVES
+        else _WIRE_INVALID_CODE
+    )
+
+    buffer = bytearray(total_size)
+    _WIRE_REQUEST_HEADER.pack_into(
+        buffer,
+        0,
+        b"AESQ",
+        WIRE_VERSION,
+        flags,
+        total_size,
+        len(tasks),
+        len(fixed_slots),
+        strings_size,
+        options.max_nodes or 0,
+        options.max_time_us or 0,
+        options.local_search_moves or 0,
+        options.seed or 0,
+        options.tie_break_seed or 0,
+        options.max_nogoods,
+        engine,
+        min(options.threads or 0, 0xFF),
+        min(options.search_threads or 0, 0xFF),
+        1 if options.output_format == "runs" else 0,
+        request_id,
+        energy_curve,
+        len(previous),
+        # Out-of-range horizon fields are sent as 0xFF so the engine rejects them
+        _wire_u8(num_days, low=1),
+        _wire_u8(options.slot_minutes, low=1),
+        _wire_u8(options.start_slot_of_day, low=0),
+        objective,
+    )
+
+    view = memoryview(buffer)
+    name_offset = 0
+    for i, (task, name) in enumerate(zip(tasks, names)):
+        _WIRE_TASK_RECORD.pack_into(
+            view,
+            tasks_offset + i * _WIRE_TASK_RECORD.size,
+            task.id,
+            task.duration_slots,
+            task.priority,
+            task.deadline_slot,
+            name_offset,
+            len(name),
+            _WIRE_TASK_TYPES.get(task.type, _WIRE_TASK_TYPES["study"]),
+            task.preferred_energy & 0xFF,
+            task.is_fixed,
+        )
+        view[strings_offset + name_offset : strings_offset + name_offset + len(name)] = name
+        name_offset += len(name)
+    for i, slot in enumerate(fixed_slots):
+        _WIRE_FIXED_RECORD.pack_into(
+            view, fixed_offset + i * _WIRE_FIXED_RECORD.size, slot.slot_index, slot.task_id
+        )
+    for i, placement in enumerate(previous):
+        _WIRE_PREVIOUS_RECORD.pack_into(
+            view,
+            previous_offset + i * _WIRE_PREVIOUS_RECORD.size,
+            placement.task_id,
+            placement.start_slot,
+        )
+    if fixed_template is not None:
+        _WIRE_TEMPLATE_LENGTH.pack_into(view, template_offset, len(template))
+        view[template_offset + _WIRE_TEMPLATE_LENGTH.size : total_size] = template
+    return bytes(buffer)
+
+
+def wire_message_size(prefix: bytes) -> int:
+    """Read total_size from the first 12 bytes of a wire message."""
+    return _WIRE_PREFIX.unpack_from(prefix)[3]
+
+
+def unpack_wire_response(data: bytes) -> ScheduleResult:
+    """
+    Unpack a response in the engine's binary wire format.
+
+    Args:
+        data: Response message
+
+    Returns:
+        Parsed ScheduleResult
+
+    Raises:
+        ValueError: If data is not a complete response
+    """
+    view = memoryview(data)
+    (
+        magic,
+        version,
+        flags,
+        total_size,
+        _request_id,
+        num_slots,
+        num_items,
+        num_unplaced,
+        error_length,
+        strategy_length,
+        engine,
+        moved_tasks,
+    ) = _WIRE_RESPONSE_HEADER.unpack_from(view)
+    if magic != b"AESR" or version != WIRE_VERSION or total_size != len(data):
+        raise ValueError("not a complete engine response")
+
+    offset = _WIRE_RESPONSE_HEADER.size
+    unplaced = list(struct.unpack_from(f"<{num_unplaced}i", view, offset))
+    offset += 4 * num_unplaced
+
+    slots: list[TimeSlotOutput] = []
+    runs: list[TimeSlotRun] = []
+    if flags & _WIRE_RUNS:
+        end = offset + num_items * _WIRE_RUN_RECORD.size
+        runs = [
+            TimeSlotRun(task_id, start, length, bool(is_fixed))
+            for task_id, start, length, is_fixed in _WIRE_RUN_RECORD.iter_unpack(
+                view[offset:end]
+            )
+        ]
+    else:
+        end = offset + num_items * _WIRE_SLOT_RECORD.size
+        slots = [
+            TimeSlotOutput(index, task_id, energy, bool(is_fixed))
+            for index, (task_id, energy, is_fixed) in enumerate(
+                _WIRE_SLOT_RECORD.iter_unpack(view[offset:end])
+            )
+        ]
+    offset = end
+
+    error_message = bytes(view[offset : offset + error_length]).decode(errors="replace")
+    offset += error_length
+    strategy = bytes(view[offset : offset + strategy_length]).decode(errors="replace")
+    offset += strategy_length
+    objective_value: Optional[int] = None
+    objective_bound: Optional[int] = None
+    if flags & _WIRE_OBJECTIVE:
+        objective_value, objective_bound = _WIRE_OBJECTIVE_TAIL.unpack_from(view, offset)
+    return ScheduleResult(
+        success=bool(flags & _WIRE_SUCCESS),
+        error_message=error_message,
+        num_slots=num_slots,
+        slots=slots,
+        budget_exhausted=bool(flags & _WIRE_BUDGET_EXHAUSTED),
+        unplaced_tasks=unplaced,
+        engine=_WIRE_ENGINES[engine] if engine < len(_WIRE_ENGINES) else "backtrack",
+        strategy=strategy,
+        runs=runs,
+        moved_tasks=moved_tasks if flags & _WIRE_INCREMENTAL else None,
+        repaired=bool(flags & _WIRE_REPAIRED),
+        cache_hit=bool(flags & _WIRE_CACHE_HIT),
+        objective_value=objective_value,
+        objective_bound=objective_bound,
+    )
+
+
+@dataclass
+class _EngineCall:
+    """One encoded request, with what a templated request needs elsewhere."""
+
+    payload: bytes
+    # Request with the template's slots inlined, for one-shot processes
+    standalone: Callable[[], bytes]
+    # Key (name, generation) and registration request of the named template
+    setup: Optional[tuple[tuple[str, int], bytes]] = None
+
+
+class EngineProcessPool:
+    """
+    Small pool of warm C engine processes running in ``--serve`` mode.
+
+    Each process answers one request at a time: a request checks an idle
+    process out, writes its input and reads one response, either a line of
+    JSON or, with ``binary``, one self-framing wire message. Processes that
+    time out or exit are discarded and replaced on demand, so at most
+    ``size`` processes are alive. Each process remembers the fixed-slot
+    templates it was sent, so a template reaches a process once.
+    """
+
+    # Response lines hold the whole timeline, well past asyncio's 64 KiB default
+    READ_LIMIT = 4 * 1024 * 1024
+
+    def __init__(self, engine_path: Path, size: int, binary: bool = False):
+        self.engine_path = engine_path
+        self.size = size
+        self.binary = binary
+        self._idle: list[asyncio.subprocess.Process] = []
+        self._slots: Optional[asyncio.Semaphore] = None
+        self._loop: Optional[asyncio.AbstractEventLoop] = None
+        self._templates: weakref.WeakKeyDictionary = weakref.WeakKeyDictionary()
+
+    def _bind_loop(self) -> None:
+        """Start over when called from a new event loop (e.g. asyncio.run)."""
+        loop = asyncio.get_running_loop()
+        if loop is not self._loop:
+            for process in self._idle:
+                self._kill(process)
+            self._idle = []
+            self._slots = asyncio.Semaphore(self.size)
+            self._loop = loop
+
+    async def _spawn(self) -> asyncio.subprocess.Process:
+        args = ["--serve", "--binary"] if self.binary else ["--serve"]
+        return await asyncio.create_subprocess_exec(
+            str(self.engine_path),
+            *args,
+            stdin=asyncio.subprocess.PIPE,
+            stdout=asyncio.subprocess.PIPE,
+            stderr=asyncio.subprocess.DEVNULL,
+            limit=self.READ_LIMIT,
+        )
+
+    @staticmethod
+    def _kill(process: asyncio.subprocess.Process) -> None:
+        if process.returncode is None:
+            try:
+                process.kill()
+            except ProcessLookupError:
+                pass
+
+    @staticmethod
+    async def _read_message(stream: asyncio.StreamReader) -> bytes:
+        """Read one binary wire message."""
+        try:
+            prefix = await stream.readexactly(_WIRE_PREFIX.size)
+            rest = await stream.readexactly(wire_message_size(prefix) - _WIRE_PREFIX.size)
+        except asyncio.IncompleteReadError:
+            raise ConnectionResetError("C engine server exited mid-request")
+        return prefix + rest
+
+    async def _exchange(
+        self, process: asyncio.subprocess.Process, payload: bytes, timeout: float
+    ) -> bytes:
+        """Write one request to a process and read its response."""
+        if self.binary:
+            process.stdin.write(payload)
+            await process.stdin.drain()
+            return await asyncio.wait_for(
+                self._read_message(process.stdout), timeout=timeout
+            )
+        process.stdin.write(payload + b"\n")
+        await process.stdin.drain()
+        response = await asyncio.wait_for(process.stdout.readline(), timeout=timeout)
+        if not response.endswith(b"\n"):
+            raise ConnectionResetError("C engine server exited mid-request")
+        return response
+
+    async def request(
+        self,
+        payload: bytes,
+        timeout: float,
+        setup: Optional[tuple[tuple[str, int], bytes]] = None,
+    ) -> bytes:
+        """
+        Send one request to a warm engine process.
+
+        Args:
+            payload: Encoded engine input (a single line of JSON, or a wire
+                     message in binary mode)
+            timeout: Timeout in seconds
+            setup: Key and registration request of the template payload
+                   names; sent first to processes that have not seen the key
+
+        Returns:
+            Raw response (a JSON line or a wire message)
+
+        Raises:
+            asyncio.TimeoutError: If the engine exceeds the timeout
+            OSError: If the process cannot be started or exits mid-request
+        """
+        self._bind_loop()
+        async with self._slots:
+            process = None
+            while self._idle and process is None:
+                candidate = self._idle.pop()
+                if candidate.returncode is None:
+                    process = candidate
+            if process is None:
+                process = await self._spawn()
+
+            try:
+                if setup is not None:
+                    key, registration = setup
+                    known = self._templates.setdefault(process, set())
+                    if key not in known:
+                        await self._exchange(process, registration, timeout)
+                        known.add(key)
+                response = await self._exchange(process, payload, timeout)
+            except BaseException:
+                # A timed-out process is still busy with the old request
+                self._kill(process)
+                raise
+
+            self._idle.append(process)
+            return response
+
+    async def close(self) -> None:
+        """Stop all idle processes."""
+        idle, self._idle = self._idle, []
+        for process in idle:
+            if process.stdin is not None:
+                process.stdin.close()
+        for process in idle:
+            try:
+                await asyncio.wait_for(process.wait(), timeout=1.0)
+            except asyncio.TimeoutError:
+                self._kill(process)
+
+
+class _AesaCacheStats(ctypes.Structure):
+    """AesaCacheStats of engine/src/aesa.h."""
+
+    _fields_ = [
+        (name, ctypes.c_uint64)
+        for name in ("hits", "misses", "evictions", "entries", "bytes", "max_bytes")
+    ]
+
+
+class EngineLibrary:
+    """
+    In-process C engine through libaesa (API in engine/src/aesa.h).
+
+    Requests and responses are binary wire messages. Solver contexts and
+    their response buffers are reused: each solve checks an idle one out,
+    so concurrent solves on executor threads never share a context. Each
+    context keeps a result cache and fixed-slot templates of its own.
+    ctypes releases the GIL for the duration of the call.
+    """
+
+    API_VERSION = 2
+    STATUS_OK = 0
+
+    def __init__(self, path: Path):
+        """
+        Load the library.
+
+        Raises:
+            OSError: If the library cannot be loaded or has another API version
+        """
+        lib = ctypes.CDLL(str(path))
+        lib.aesa_api_version.restype = ctypes.c_int
+        lib.aesa_api_version.argtypes = []
+        if lib.aesa_api_version() != self.API_VERSION:
+            raise OSError(f"{path} has API version {lib.aesa_api_version()}")
+        lib.aesa_response_capacity.restype = ctypes.c_size_t
+        lib.aesa_response_capacity.argtypes = []
+        lib.aesa_solver_create.restype = ctypes.c_void_p
+        lib.aesa_solver_create.argtypes = []
+        lib.aesa_solver_free.restype = None
+        lib.aesa_solver_free.argtypes = [ctypes.c_void_p]
+        lib.aesa_solver_cache_stats.restype = ctypes.c_int
+        lib.aesa_solver_cache_stats.argtypes = [
+            ctypes.c_void_p,
+            ctypes.POINTER(_AesaCacheStats),
+        ]
+        lib.aesa_solve.restype = ctypes.c_int
+        lib.aesa_solve.argtypes = [
+            ctypes.c_void_p,
+            ctypes.c_char_p,
+            ctypes.c_size_t,
+            ctypes.c_void_p,
+            ctypes.c_size_t,
+            ctypes.POINTER(ctypes.c_size_t),
+        ]
+        self.path = path
+        self._lib = lib
+        self._capacity = lib.aesa_response_capacity()
+        # Solver, response buffer and the template keys sent to the solver
+        self._idle: list[tuple[int, ctypes.Array, set]] = []
+        self._lock = threading.Lock()
+
+    def _call(self, solver: int, buffer: ctypes.Array, payload: bytes) -> bytes:
+        """Solve one request on a checked-out context."""
+        size = ctypes.c_size_t()
+        status = self._lib.aesa_solve(
+            solver, payload, len(payload), buffer, self._capacity, ctypes.byref(size)
+        )
+        if status != self.STATUS_OK:
+            raise OSError(f"aesa_solve failed with status {status}")
+        return ctypes.string_at(buffer, size.value)
+
+    def solve(
+        self, payload: bytes, setup: Optional[tuple[tuple[str, int], bytes]] = None
+    ) -> bytes:
+        """
+        Solve one request on the calling thread.
+
+        Args:
+            payload: Wire request message
+            setup: Key and registration request of the template payload
+                   names; sent first to contexts that have not seen the key
+
+        Returns:
+            Wire response message
+
+        Raises:
+            MemoryError: If a solver context cannot be created
+            OSError: If the library refuses the call
+        """
+        with self._lock:
+            context = self._idle.pop() if self._idle else None
+        if context is None:
+            solver = self._lib.aesa_solver_create()
+            if not solver:
+                raise MemoryError("aesa_solver_create failed")
+            context = (solver, ctypes.create_string_buffer(self._capacity), set())
+
+        solver, buffer, known = context
+        try:
+            if setup is not None and setup[0] not in known:
+                self._call(solver, buffer, setup[1])
+                known.add(setup[0])
+            return self._call(solver, buffer, payload)
+        finally:
+            with self._lock:
+                self._idle.append(context)
+
+    def cache_stats(self) -> dict[str, int]:
+        """Result cache counters, summed over the idle solver contexts."""
+        totals = {name: 0 for name, _ in _AesaCacheStats._fields_}
+        stats = _AesaCacheStats()
+        with self._lock:
+            for solver, _, _ in self._idle:
+                if self._lib.aesa_solver_cache_stats(solver, ctypes.byref(stats)) == 0:
+                    for name in totals:
+                        totals[name] += getattr(stats, name)
+        return totals
+
+    def close(self) -> None:
+        """Free the idle solver contexts."""
+        with self._lock:
+            idle, self._idle = self._idle, []
+        for solver, _, _ in idle:
+            self._lib.aesa_solver_free(solver)
+
+
 class CSchedulerBridge:
     """
-    Bridge to C optimization engine via subprocess.
+    Bridge to C optimization engine, in-process through libaesa or via
+    subprocess.
 
     This class handles communication with the C-based constraint satisfaction
     scheduler engine, including input serialization, output parsing, timeout
@@ -174,18 +958,47 @@ class CSchedulerBridge:
     """
 
     DEFAULT_TIMEOUT = 5.0  # 5 seconds
+    # Share of the timeout granted to the engine's own search budget, so it
+    # returns its best partial schedule before the subprocess is killed.
+    SEARCH_BUDGET_FRACTION = 0.8
 
-    def __init__(self, engine_path: Optional[str] = None):
+    def __init__(
+        self,
+        engine_path: Optional[str] = None,
+        pool_size: Optional[int] = None,
+        wire_format: Optional[str] = None,
+        use_library: Optional[bool] = None,
+        stats_sink: Optional[Callable[[dict], None]] = None,
+    ):
         """
         Initialize the bridge.
 
         Args:
             engine_path: Path to the C engine executable.
                         If None, uses ENGINE_PATH from settings.
+            pool_size: Number of warm ``--serve`` engine processes; 0 runs
+                      a fresh process per request. If None, uses
+                      ENGINE_POOL_SIZE from settings.
+            wire_format: "binary" for the packed wire format, "json" for
+                        readable requests. If None, uses ENGINE_WIRE_FORMAT
+                        from settings.
+            use_library: Solve in-process through libaesa (next to the
+                        engine executable) when it loads; needs the binary
+                        wire format. If None, uses ENGINE_LIBRARY from
+                        settings.
+            stats_sink: Called with the "stats" object of every JSON
+                       response that has one (engines built with
+                       ``make STATS=1``), e.g. to feed a metrics client.
         """
         if engine_path is None:
             settings = get_settings()
             engine_path = settings.engine_path
+        if pool_size is None:
+            pool_size = get_settings().engine_pool_size
+        if wire_format is None:
+            wire_format = get_settings().engine_wire_format
+        if use_library is None:
+            use_library = get_settings().engine_library
 
         self.engine_path = Path(engine_path)
 
@@ -195,6 +1008,28 @@ class CSchedulerBridge:
             if exe_path.exists():
                 self.engine_path = exe_path
 
+        self.binary = wire_format == "binary"
+        self.stats_sink = stats_sink
+        # Registered fixed-slot templates by name, with the generation that
+        # tells engines holding an older version to take the new one
+        self._templates: dict[str, tuple[int, FixedSlotTemplate]] = {}
+        self._template_generation = 0
+        self._library = self._load_library() if use_library and self.binary else None
+        self._pool = (
+            EngineProcessPool(self.engine_path, pool_size, self.binary)
+            if pool_size > 0
+            else None
+        )
+
+    def _load_library(self) -> Optional[EngineLibrary]:
+        """Load libaesa from the engine directory, None if unavailable."""
+        path = self.engine_path.parent / "libaesa.so"
+        try:
+            return EngineLibrary(path)
+        except OSError as e:
+            logger.info(f"C engine library unavailable ({e}), using subprocesses")
+            return None
+
     def _validate_engine(self) -> None:
         """Validate that the engine executable exists."""
         if not self.engine_path.exists():
@@ -204,11 +1039,28 @@ class CSchedulerBridge:
                 suggestion="Ensure the C engine is compiled. Run 'make' in the engine/ directory.",
             )
 
+    def _with_search_budget(
+        self, options: Optional[EngineOptions], timeout: float
+    ) -> EngineOptions:
+        """Default the engine's search budget to a share of the timeout."""
+        options = options or EngineOptions()
+        if options.max_time_us is None:
+            options = replace(
+                options,
+                max_time_us=int(timeout * self.SEARCH_BUDGET_FRACTION * 1_000_000),
+            )
+        return options
+
     def _serialize_input(
         self,
         tasks: list[TaskInput],
         fixed_slots: list[TimeSlotInput],
         num_days: int = 7,
+        options: Optional[EngineOptions] = None,
+        request_id: Optional[str] = None,
+        previous: Optional[list[TaskPlacement]] = None,
+        fixed_template: Optional[str] = None,
+        variants: Optional[list[ScheduleVariant]] = None,
     ) -> str:
         """
         Serialize input data to JSON for the C engine.
@@ -217,15 +1069,31 @@ class CSchedulerBridge:
             tasks: List of tasks to schedule
             fixed_slots: List of fixed time slots
             num_days: Number of days to optimize
+            options: Optional solver settings
+            request_id: Optional ID the engine echoes in its response
+            previous: Optional placements of an earlier schedule to keep
+            fixed_template: Optional name of a template the engine holds
+            variants: Optional what-if edits solved alongside the request
 
         Returns:
-            JSON string for the C engine
+            JSON string for the C engine, on a single line
         """
-        input_data = {
+        input_data: dict = {}
+        if request_id is not None:
+            input_data["request_id"] = request_id
+        input_data |= {
             "tasks": [t.to_dict() for t in tasks],
             "fixed_slots": [s.to_dict() for s in fixed_slots],
             "num_days": num_days,
         }
+        if options is not None:
+            input_data.update(options.to_dict())
+        if previous:
+            input_data["previous"] = [p.to_dict() for p in previous]
+        if fixed_template is not None:
+            input_data["fixed_template"] = fixed_template
+        if variants:
+            input_data["variants"] = [v.to_dict() for v in variants]
         return json.dumps(input_data)
 
     def _parse_output(self, output: str) -> ScheduleResult:
@@ -243,7 +1111,6 @@ class CSchedulerBridge:
         """
         try:
             data = json.loads(output)
-            return ScheduleResult.from_dict(data)
         except json.JSONDecodeError as e:
             raise SchedulerError(
                 code=SchedulerErrorCode.PARSE_ERROR,
@@ -251,6 +1118,117 @@ class CSchedulerBridge:
                 suggestion="Check the C engine for errors.",
                 context={"raw_output": output[:500]},
             )
+        self._record_stats(data)
+        return ScheduleResult.from_dict(data)
+
+    def _record_stats(self, data: dict) -> None:
+        """Log a response's engine stats and hand them to the stats sink."""
+        stats = data.get("stats")
+        if not isinstance(stats, dict):
+            return
+        logger.debug(f"C engine stats: {stats}")
+        if self.stats_sink is not None:
+            try:
+                self.stats_sink(stats)
+            except Exception as e:
+                logger.warning(f"Engine stats sink failed: {e}")
+
+    def _encode_request(
+        self,
+        tasks: list[TaskInput],
+        fixed_slots: list[TimeSlotInput],
+        num_days: int,
+        options: EngineOptions,
+        previous: Optional[list[TaskPlacement]] = None,
+        fixed_template: Optional[str] = None,
+    ) -> bytes:
+        """Encode one request in the bridge's wire format."""
+        if self.binary:
+            return pack_wire_request(
+                tasks,
+                fixed_slots,
+                options,
+                previous=previous,
+                num_days=num_days,
+                fixed_template=fixed_template,
+            )
+        return self._serialize_input(
+            tasks, fixed_slots, num_days, options, previous=previous,
+            fixed_template=fixed_template,
+        ).encode()
+
+    def _encode_registration(self, template: FixedSlotTemplate) -> bytes:
+        """Encode the request registering a template with an engine."""
+        if self.binary:
+            options = EngineOptions(
+                slot_minutes=template.slot_minutes,
+                start_slot_of_day=template.start_slot_of_day,
+                output_format="runs",
+            )
+            return pack_wire_request(
+                [],
+                template.fixed_slots,
+                options,
+                num_days=template.num_days,
+                fixed_template=template.name,
+                register_template=True,
+            )
+        return json.dumps(template.to_dict()).encode()
+
+    def register_template(self, template: FixedSlotTemplate) -> None:
+        """
+        Register fixed slots that requests can name instead of sending them.
+
+        Engines receive the template with the first request naming it.
+        Registering a name again replaces its template.
+
+        Args:
+            template: Template to register
+        """
+        if not 0 < len(template.name.encode()) < 64:
+            raise ValueError(f"Template name must be 1 to 63 bytes: {template.name!r}")
+        self._template_generation += 1
+        self._templates[template.name] = (self._template_generation, template)
+
+    def _template(
+        self, name: str, num_days: int, options: EngineOptions
+    ) -> tuple[int, FixedSlotTemplate]:
+        """Look up a registered template for a request's horizon."""
+        if name not in self._templates:
+            raise SchedulerError(
+                code=SchedulerErrorCode.UNKNOWN,
+                message=f"Unknown fixed-slot template: {name}",
+                suggestion="Register the template with register_template first.",
+            )
+        generation, template = self._templates[name]
+        if (template.num_days, template.slot_minutes, template.start_slot_of_day) != (
+            num_days, options.slot_minutes, options.start_slot_of_day
+        ):
+            raise SchedulerError(
+                code=SchedulerErrorCode.UNKNOWN,
+                message=f"Fixed-slot template {name} was built for another horizon",
+                suggestion="Use the template's num_days, slot_minutes and start_slot_of_day.",
+            )
+        return generation, template
+
+    def _decode_response(self, output: bytes) -> ScheduleResult:
+        """
+        Decode one response in the bridge's wire format.
+
+        Raises:
+            SchedulerError: If decoding fails
+        """
+        if not self.binary:
+            return self._parse_output(output.decode())
+        try:
+            return unpack_wire_response(output)
+        except (struct.error, ValueError) as e:
+            raise SchedulerError(
+                code=SchedulerErrorCode.PARSE_ERROR,
+                message=f"Failed to parse C engine output: {e}",
+                suggestion="Check the C engine for errors.",
+                context={"raw_output": output[:500].hex()},
+            )
 
     def _translate_error(self, result: ScheduleResult) -> SchedulerError:
         """
@@ -269,6 +1247,7 @@ class CSchedulerBridge:
                 code=SchedulerErrorCode.NO_SOLUTION,
                 message="Cannot find a valid schedule placement",
                 suggestion="Try removing some tasks or extending deadlines.",
+                context={"unplaced_tasks": result.unplaced_tasks},
             )
         elif "timeout" in error_msg:
             return SchedulerError(
@@ -289,12 +1268,184 @@ class CSchedulerBridge:
                 suggestion="Try removing some tasks or extending deadlines.",
             )
 
+    def _check_result(self, result: ScheduleResult) -> ScheduleResult:
+        """
+        Accept full and usable partial results, translate the rest.
+
+        Args:
+            result: Parsed engine result
+
+        Returns:
+            The result, if it holds a usable schedule
+
+        Raises:
+            SchedulerError: If the engine reported a failure
+        """
+        # A spent search budget still yields a usable partial schedule
+        if result.budget_exhausted:
+            logger.warning(
+                f"C engine search budget exhausted, "
+                f"{len(result.unplaced_tasks)} task(s) unplaced"
+            )
+            return result
+
+        # The greedy engine does not search, so left-out tasks are
+        # a partial result rather than proof of infeasibility
+        if not result.success and result.engine == "greedy":
+            logger.warning(
+                f"C engine greedy pass left "
+                f"{len(result.unplaced_tasks)} task(s) unplaced"
+            )
+            return result
+
+        # Check for logical errors
+        if not result.success:
+            raise self._translate_error(result)
+
+        logger.debug(
+            f"C engine returned {result.num_slots} slots "
+            f"(strategy {result.strategy}{', cached' if result.cache_hit else ''})"
+        )
+        return result
+
+    async def _run_subprocess(
+        self, payload: bytes, timeout: float, binary: Optional[bool] = None
+    ) -> bytes:
+        """
+        Run one request in a fresh engine process.
+
+        Args:
+            payload: Encoded engine input
+            timeout: Timeout in seconds
+            binary: Wire format of payload, the bridge's if None
+
+        Returns:
+            Raw output of the engine
+
+        Raises:
+            SchedulerError: If the engine exits with an error
+            asyncio.TimeoutError: If the engine exceeds the timeout
+        """
+        if binary is None:
+            binary = self.binary
+
+        # Run the C engine as subprocess
+        args = ["--binary"] if binary else []
+        process = await asyncio.create_subprocess_exec(
+            str(self.engine_path),
+            *args,
+            stdin=asyncio.subprocess.PIPE,
+            stdout=asyncio.subprocess.PIPE,
+            stderr=asyncio.subprocess.PIPE,
+        )
+
+        # Send input and wait for output with timeout
+        stdout, stderr = await asyncio.wait_for(
+            process.communicate(input=payload),
+            timeout=timeout,
+        )
+
+        # Binary failures still answer with a response holding the error
+        if process.returncode != 0 and binary and stdout:
+            logger.error(f"C engine failed with code {process.returncode}")
+            raise self._translate_error(self._decode_response(stdout))
+
+        # Check for process errors
+        if process.returncode != 0:
+            error_output = stderr.decode() if stderr else "Unknown error"
+            logger.error(
+                f"C engine failed with code {process.returncode}: {error_output}"
+            )
+
+            # Try to parse error from stderr
+            try:
+                error_data = json.loads(error_output)
+                result = ScheduleResult.from_dict(error_data)
+                raise self._translate_error(result)
+            except json.JSONDecodeError:
+                raise SchedulerError(
+                    code=SchedulerErrorCode.UNKNOWN,
+                    message=f"C engine failed: {error_output}",
+                    suggestion="Check the C engine logs for details.",
+                )
+
+        return stdout
+
+    async def _run_pooled(self, call: _EngineCall, timeout: float) -> bytes:
+        """
+        Run one request on a warm engine process from the pool.
+
+        Falls back to a fresh process if the pooled one cannot be started
+        or dies mid-request.
+
+        Args:
+            call: Encoded engine input
+            timeout: Timeout in seconds
+
+        Returns:
+            Raw output of the engine
+        """
+        try:
+            return await self._pool.request(call.payload, timeout, call.setup)
+        except OSError as e:
+            logger.warning(f"C engine pool unavailable ({e}), running one-shot")
+            return await self._run_subprocess(call.standalone(), timeout)
+
+    async def _run_library(self, call: _EngineCall, timeout: float) -> bytes:
+        """
+        Run one request in-process on an executor thread.
+
+        The solve cannot be interrupted, so on timeout it finishes in the
+        background; the search budget keeps that short.
+
+        Args:
+            call: Encoded engine input
+            timeout: Timeout in seconds
+
+        Returns:
+            Raw output of the engine
+        """
+        loop = asyncio.get_running_loop()
+        try:
+            return await asyncio.wait_for(
+                loop.run_in_executor(None, self._library.solve, call.payload, call.setup),
+                timeout=timeout,
+            )
+        except OSError as e:
+            logger.warning(f"C engine library call failed ({e}), running out of process")
+            if self._pool is not None:
+                return await self._run_pooled(call, timeout)
+            return await self._run_subprocess(call.standalone(), timeout)
+
+    def cache_stats(self) -> Optional[dict[str, int]]:
+        """
+        Result cache counters of the in-process engine.
+
+        Returns:
+            Hits, misses, evictions, entries, bytes and max_bytes summed over
+            the idle library contexts, or None without the library (warm
+            processes report theirs on stderr when they exit)
+        """
+        if self._library is None:
+            return None
+        return self._library.cache_stats()
+
+    async def close(self) -> None:
+        """Stop the warm engine processes and free library contexts, if any."""
+        if self._pool is not None:
+            await self._pool.close()
+        if self._library is not None:
+            self._library.close()
+
     async def optimize(
         self,
         tasks: list[TaskInput],
         fixed_slots: list[TimeSlotInput],
         num_days: int = 7,
         timeout: Optional[float] = None,
+        options: Optional[EngineOptions] = None,
+        previous: Optional[list[TaskPlacement]] = None,
+        fixed_template: Optional[str] = None,
     ) -> ScheduleResult:
         """
         Call C engine to optimize schedule.
@@ -304,9 +1455,20 @@ class CSchedulerBridge:
             fixed_slots: List of fixed time slots (classes, sleep, etc.)
             num_days: Number of days to optimize
             timeout: Timeout in seconds (default: 5.0)
+            options: Optional solver settings (energy curve, etc.)
+            previous: Placements of the schedule being edited, e.g. from
+                ``ScheduleResult.placements()``. The engine keeps the ones
+                that are still valid and only places the rest, reporting
+                ``moved_tasks`` and ``repaired`` in the result.
+            fixed_template: Name of a template from ``register_template``
+                whose slots apply beneath ``fixed_slots``; the request must
+                use the template's horizon.
 
         Returns:
-            Optimized schedule result
+            Optimized schedule result. If the engine's search budget runs
+            out, the best partial schedule is returned with
+            ``budget_exhausted`` set and the left-out task IDs in
+            ``unplaced_tasks``.
 
         Raises:
             SchedulerError: If optimization fails
@@ -316,64 +1478,143 @@ class CSchedulerBridge:
         if timeout is None:
             timeout = self.DEFAULT_TIMEOUT
 
+        options = self._with_search_budget(options, timeout)
+
         # Serialize input
-        input_json = self._serialize_input(tasks, fixed_slots, num_days)
+        if fixed_template is None:
+            payload = self._encode_request(tasks, fixed_slots, num_days, options, previous)
+            call = _EngineCall(payload, lambda: payload)
+        else:
+            generation, template = self._template(fixed_template, num_days, options)
+            call = _EngineCall(
+                self._encode_request(
+                    tasks, fixed_slots, num_days, options, previous, fixed_template
+                ),
+                lambda: self._encode_request(
+                    tasks, template.fixed_slots + fixed_slots, num_days, options, previous
+                ),
+                ((fixed_template, generation), self._encode_registration(template)),
+            )
 
         logger.debug(
             f"Calling C engine with {len(tasks)} tasks, {len(fixed_slots)} fixed slots"
+            + (f" over template {fixed_template}" if fixed_template else "")
         )
 
         try:
-            # Run the C engine as subprocess
-            process = await asyncio.create_subprocess_exec(
-                str(self.engine_path),
-                stdin=asyncio.subprocess.PIPE,
-                stdout=asyncio.subprocess.PIPE,
-                stderr=asyncio.subprocess.PIPE,
-            )
+            if self._library is not None:
+                output = await self._run_library(call, timeout)
+            elif self._pool is not None:
+                output = await self._run_pooled(call, timeout)
+            else:
+                output = await self._run_subprocess(call.standalone(), timeout)
 
-            # Send input and wait for output with timeout
-            stdout, stderr = await asyncio.wait_for(
-                process.communicate(input=input_json.encode()),
-                timeout=timeout,
+            # Parse output
+            return self._check_result(self._decode_response(output))
+
+        except asyncio.TimeoutError:
+            logger.error(f"C engine timed out after {timeout}s")
+            raise SchedulerError(
+                code=SchedulerErrorCode.TIMEOUT,
+                message=f"C engine exceeded {timeout}s time limit",
+                suggestion="Try reducing the number of tasks or days to optimize.",
+            )
+        except FileNotFoundError:
+            raise SchedulerError(
+                code=SchedulerErrorCode.ENGINE_NOT_FOUND,
+                message=f"C engine not found at: {self.engine_path}",
+                suggestion="Ensure the C engine is compiled. Run 'make' in the engine/ directory.",
             )
 
-            # Check for process errors
-            if process.returncode != 0:
-                error_output = stderr.decode() if stderr else "Unknown error"
-                logger.error(
-                    f"C engine failed with code {process.returncode}: {error_output}"
-                )
+    async def optimize_variants(
+        self,
+        tasks: list[TaskInput],
+        fixed_slots: list[TimeSlotInput],
+        variants: list[ScheduleVariant],
+        num_days: int = 7,
+        timeout: Optional[float] = None,
+        options: Optional[EngineOptions] = None,
+        previous: Optional[list[TaskPlacement]] = None,
+        fixed_template: Optional[str] = None,
+    ) -> tuple[ScheduleResult | SchedulerError, list[ScheduleResult | SchedulerError]]:
+        """
+        Solve a base request and what-if edits of it in one engine call.
 
-                # Try to parse error from stderr
-                try:
-                    error_data = json.loads(error_output)
-                    result = ScheduleResult.from_dict(error_data)
-                    raise self._translate_error(result)
-                except json.JSONDecodeError:
-                    raise SchedulerError(
-                        code=SchedulerErrorCode.UNKNOWN,
-                        message=f"C engine failed: {error_output}",
-                        suggestion="Check the C engine logs for details.",
-                    )
+        The engine parses and applies the base once, then solves each
+        variant in parallel, starting from the base schedule: tasks an
+        edit does not touch keep their place, and ``moved_tasks`` counts
+        the ones that move. A variant whose ``unplaced_tasks`` is empty
+        while the base's is not, for instance, names a culprit.
 
-            # Parse output
-            output = stdout.decode()
-            result = self._parse_output(output)
+        What-if requests are JSON only, so they go to the warm processes
+        in JSON mode and to a one-shot process otherwise.
 
-            # Check for logical errors
-            if not result.success:
-                raise self._translate_error(result)
+        Args:
+            tasks: Tasks of the base request
+            fixed_slots: Fixed slots of the base request
+            variants: Edits of the base, at most 256
+            num_days: Number of days to optimize
+            timeout: Search time of each solve in seconds (default: 5.0);
+                     the call as a whole may take one per variant more
+            options: Optional solver settings, shared by every solve
+            previous: Placements to re-optimize the base from
+            fixed_template: Name of a template from ``register_template``
 
-            logger.debug(f"C engine returned {result.num_slots} slots")
-            return result
+        Returns:
+            The base's result and each variant's, in order. A failed
+            solve is its SchedulerError and does not affect the others.
+
+        Raises:
+            SchedulerError: If the engine rejected the request as a whole
+        """
+        self._validate_engine()
+
+        if timeout is None:
+            timeout = self.DEFAULT_TIMEOUT
+        options = self._with_search_budget(options, timeout)
+        if options.output_format == "pretty":
+            options = replace(options, output_format="compact")
+
+        template = (
+            self._template(fixed_template, num_days, options)[1]
+            if fixed_template is not None
+            else None
+        )
+        payload = self._serialize_input(
+            tasks, fixed_slots, num_days, options, previous=previous,
+            fixed_template=fixed_template, variants=variants,
+        ).encode()
+        standalone = (
+            self._serialize_input(
+                tasks, template.fixed_slots + fixed_slots, num_days, options,
+                previous=previous, variants=variants,
+            ).encode()
+            if template is not None
+            else payload
+        )
+        call_timeout = timeout * (len(variants) + 1)
 
+        logger.debug(f"Calling C engine with {len(tasks)} tasks and {len(variants)} variants")
+
+        try:
+            if self._pool is not None and not self.binary:
+                setup = None
+                if template is not None:
+                    generation = self._templates[fixed_template][0]
+                    setup = ((fixed_template, generation), self._encode_registration(template))
+                try:
+                    output = await self._pool.request(payload, call_timeout, setup)
+                except OSError as e:
+                    logger.warning(f"C engine pool unavailable ({e}), running one-shot")
+                    output = await self._run_subprocess(standalone, call_timeout, binary=False)
+            else:
+                output = await self._run_subprocess(standalone, call_timeout, binary=False)
         except asyncio.TimeoutError:
-            logger.error(f"C engine timed out after {timeout}s")
+            logger.error(f"C engine timed out after {call_timeout}s")
             raise SchedulerError(
                 code=SchedulerErrorCode.TIMEOUT,
-                message=f"C engine exceeded {timeout}s time limit",
-                suggestion="Try reducing the number of tasks or days to optimize.",
+                message=f"C engine exceeded {call_timeout}s time limit",
+                suggestion="Try fewer variants, or reducing the number of tasks.",
             )
         except FileNotFoundError:
             raise SchedulerError(
@@ -382,12 +1623,171 @@ class CSchedulerBridge:
                 suggestion="Ensure the C engine is compiled. Run 'make' in the engine/ directory.",
             )
 
+        try:
+            data = json.loads(output)
+        except json.JSONDecodeError as e:
+            raise SchedulerError(
+                code=SchedulerErrorCode.PARSE_ERROR,
+                message=f"Failed to parse C engine output: {e}",
+                suggestion="Check the C engine for errors.",
+                context={"raw_output": output[:500].decode(errors="replace")},
+            )
+
+        self._record_stats(data)
+
+        # Without variants in the response, the request failed before solving
+        if variants and "variants" not in data:
+            raise self._translate_error(ScheduleResult.from_dict(data))
+
+        def check(document: dict) -> ScheduleResult | SchedulerError:
+            try:
+                return self._check_result(ScheduleResult.from_dict(document))
+            except SchedulerError as e:
+                return e
+
+        return check(data), [check(v) for v in data.get("variants", [])]
+
+    async def optimize_batch(
+        self,
+        requests: list[BatchRequest],
+        timeout: Optional[float] = None,
+        jobs: Optional[int] = None,
+    ) -> dict[str, ScheduleResult | SchedulerError]:
+        """
+        Solve many independent requests with a single engine process.
+
+        The requests are written to a temporary NDJSON file that the engine
+        memory-maps in ``--batch`` mode and solves on a thread pool. Results
+        stream back tagged with their request ID, in completion order. The
+        templates the requests name go to the engine in a ``--templates``
+        file.
+
+        Args:
+            requests: Requests to solve, with unique request IDs
+            timeout: Per-request search time in seconds (default: 5.0);
+                     the batch as a whole is not time-limited
+            jobs: Engine worker threads (default: one per CPU)
+
+        Returns:
+            For each request ID, its result or the SchedulerError it failed
+            with. A failed request does not affect the others.
+
+        Raises:
+            SchedulerError: If the engine could not run the batch at all
+        """
+        self._validate_engine()
+
+        if timeout is None:
+            timeout = self.DEFAULT_TIMEOUT
+
+        names = {r.fixed_template for r in requests if r.fixed_template is not None}
+        unknown = sorted(names - self._templates.keys())
+        if unknown:
+            raise SchedulerError(
+                code=SchedulerErrorCode.UNKNOWN,
+                message=f"Unknown fixed-slot template: {unknown[0]}",
+                suggestion="Register the template with register_template first.",
+            )
+
+        fd, batch_path = tempfile.mkstemp(prefix="aesa-batch-", suffix=".ndjson")
+        templates_path = None
+        try:
+            with os.fdopen(fd, "w") as batch_file:
+                for request in requests:
+                    options = self._with_search_budget(request.options, timeout)
+                    batch_file.write(
+                        self._serialize_input(
+                            request.tasks,
+                            request.fixed_slots,
+                            request.num_days,
+                            options,
+                            request_id=request.request_id,
+                            fixed_template=request.fixed_template,
+                        )
+                    )
+                    batch_file.write("\n")
+
+            args = [str(self.engine_path), "--batch", batch_path]
+            if jobs is not None:
+                args += ["--jobs", str(jobs)]
+            if names:
+                fd, templates_path = tempfile.mkstemp(
+                    prefix="aesa-templates-", suffix=".ndjson"
+                )
+                with os.fdopen(fd, "w") as templates_file:
+                    for name in sorted(names):
+                        templates_file.write(json.dumps(self._templates[name][1].to_dict()))
+                        templates_file.write("\n")
+                args += ["--templates", templates_path]
+
+            logger.debug(f"Calling C engine with a batch of {len(requests)} requests")
+
+            try:
+                process = await asyncio.create_subprocess_exec(
+                    *args,
+                    stdout=asyncio.subprocess.PIPE,
+                    stderr=asyncio.subprocess.PIPE,
+                    limit=EngineProcessPool.READ_LIMIT,
+                )
+            except FileNotFoundError:
+                raise SchedulerError(
+                    code=SchedulerErrorCode.ENGINE_NOT_FOUND,
+                    message=f"C engine not found at: {self.engine_path}",
+                    suggestion="Ensure the C engine is compiled. Run 'make' in the engine/ directory.",
+                )
+
+            results: dict[str, ScheduleResult | SchedulerError] = {}
+            async for line in process.stdout:
+                try:
+                    data = json.loads(line)
+                except json.JSONDecodeError:
+                    logger.error(f"Unparseable C engine batch line: {line[:200]!r}")
+                    continue
+                request_id = str(data.get("request_id"))
+                self._record_stats(data)
+                try:
+                    results[request_id] = self._check_result(
+                        ScheduleResult.from_dict(data)
+                    )
+                except SchedulerError as e:
+                    results[request_id] = e
+
+            stderr = await process.stderr.read()
+            await process.wait()
+        finally:
+            os.unlink(batch_path)
+            if templates_path is not None:
+                os.unlink(templates_path)
+
+        if process.returncode != 0 and not results:
+            raise SchedulerError(
+                code=SchedulerErrorCode.UNKNOWN,
+                message=f"C engine batch failed: {stderr.decode().strip()}",
+                suggestion="Check the C engine logs for details.",
+            )
+
+        # Requests lost to an engine crash fail on their own
+        for request in requests:
+            if request.request_id not in results:
+                results[request.request_id] = SchedulerError(
+                    code=SchedulerErrorCode.UNKNOWN,
+                    message="C engine returned no result for this request",
+                    suggestion="Retry the request on its own.",
+                )
+
+        failed = sum(1 for r in results.values() if isinstance(r, SchedulerError))
+        logger.info(f"C engine batch solved {len(requests)} requests, {failed} failed")
+        return results
+
     def optimize_sync(
         self,
         tasks: list[TaskInput],
         fixed_slots: list[TimeSlotInput],
         num_days: int = 7,
         timeout: Optional[float] = None,
+        options: Optional[EngineOptions] = None,
+        previous: Optional[list[TaskPlacement]] = None,
+        fixed_template: Optional[str] = None,
     ) -> ScheduleResult:
         """
         Synchronous version of optimize for testing.
@@ -397,11 +1797,25 @@ class CSchedulerBridge:
             fixed_slots: List of fixed time slots
             num_days: Number of days to optimize
             timeout: Timeout in seconds
+            options: Optional solver settings
+            previous: Optional placements of an earlier schedule to keep
+            fixed_template: Optional name of a registered template
 
         Returns:
             Optimized schedule result
         """
-        return asyncio.run(self.optimize(tasks, fixed_slots, num_days, timeout))
+
+        async def run() -> ScheduleResult:
+            # Warm processes belong to this call's event loop, stop them with it
+            try:
+                return await self.optimize(
+                    tasks, fixed_slots, num_days, timeout, options, previous,
+                    fixed_template,
+                )
+            finally:
+                await self.close()
+
+        return asyncio.run(run())
 
 
 # Singleton instance
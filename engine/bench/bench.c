@@ -0,0 +1,358 @@
+/**
+ * AESA Core Scheduling Engine - Benchmarks
+ *
+ * Solves seeded workloads the way serve mode does (parse a JSON request
+ * into an arena, solve, serialize compact JSON into a reused buffer, reset
+ * the arena) and times the three phases separately. Workloads cover 10 to
+ * 1000 tasks, sparse and dense fixed slots, and feasible and infeasible
+ * requests. Infeasible ones get one more long task than their longest
+ * free runs hold; unless the capacity pre-check already refutes them,
+ * their search runs into BENCH_MAX_NODES.
+ *
+ * Prints one JSON object per workload on stdout:
+ *
+ *   {"workload":"tasks=200,fixed=dense,feasible","tasks":200,...,
+ *    "parse_us":{"p50":...,"p99":...},"solve_us":{...},"serialize_us":{...},
+ *    "nodes_per_sec":...,"arena_bytes":...,"peak_rss_kb":...}
+ *
+ * nodes_per_sec is the search nodes of all runs over their solve time.
+ * arena_bytes is the request memory of the workload, peak_rss_kb the
+ * process's peak resident set so far (workloads run smallest first).
+ *
+ * Usage: ./scheduler_bench [--runs N] [--seed S]
+ */
+
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+
+#include "../src/scheduler.h"
+#include "../src/arena.h"
+#include "../src/json_output.h"
+#include "../tests/generators.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#define DEFAULT_RUNS 50             /* Timed runs per workload */
+#define DEFAULT_SEED 42
+#define BENCH_MAX_NODES 50000       /* Search budget of every request */
+#define MAX_BLOCK_LEN 4             /* Longest fixed block, in slots */
+#define BLOCKER_ID 100000           /* First task ID of an infeasible workload's long tasks */
+
+static const int SCALES[] = {10, 50, 200, 500, 1000};
+
+/* Horizons tried in order; a workload takes the first with room for twice its demand */
+static const struct { int num_days; int slot_minutes; } HORIZONS[] = {
+    {7, 30}, {14, 30}, {31, 30}, {31, 15}
+};
+
+#define NUM_SCALES ((int)(sizeof(SCALES) / sizeof(SCALES[0])))
+#define NUM_HORIZONS ((int)(sizeof(HORIZONS) / sizeof(HORIZONS[0])))
+
+/* Growable request text */
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} Text;
+
+typedef struct {
+    char name[64];
+    int num_tasks;                  /* Including an infeasible workload's long tasks */
+    int num_fixed;
+    int num_days;
+    int slot_minutes;
+    int num_slots;
+    Text request;
+} Workload;
+
+static void text_append(Text* text, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (text->length + (size_t)needed + 1 > text->capacity) {
+        size_t capacity = text->capacity > 0 ? text->capacity * 2 : 4096;
+        while (capacity < text->length + (size_t)needed + 1) capacity *= 2;
+        char* data = (char*)realloc(text->data, capacity);
+        if (data == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+        text->data = data;
+        text->capacity = capacity;
+    }
+    va_start(args, format);
+    vsnprintf(text->data + text->length, text->capacity - text->length, format, args);
+    va_end(args);
+    text->length += (size_t)needed;
+}
+
+static void append_task(Text* text, int id, TaskType type, int duration, int priority,
+                        int energy, bool first) {
+    text_append(text,
+                "%s{\"id\":%d,\"name\":\"Task %d\",\"type\":\"%s\",\"duration_slots\":%d,"
+                "\"priority\":%d,\"deadline_slot\":-1,\"preferred_energy\":%d}",
+                first ? "" : ",", id, id, task_type_to_string(type), duration, priority,
+                energy);
+}
+
+/**
+ * Generate a workload's request
+ * @param dense True to fix a quarter of the horizon's slots, false for a twentieth
+ * @param feasible False to add long tasks that cannot all be placed
+ */
+static void workload_build(Workload* workload, unsigned int seed, int num_tasks,
+                           bool dense, bool feasible) {
+    double fraction = dense ? 0.25 : 0.05;
+    seed_random(seed + (unsigned int)num_tasks * 4u + (dense ? 2u : 0u) + (feasible ? 1u : 0u));
+
+    int* durations = (int*)malloc(sizeof(int) * (size_t)num_tasks);
+    if (durations == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    int demand = 0;
+    for (int i = 0; i < num_tasks; i++) {
+        durations[i] = random_int(1, 2);
+        demand += durations[i];
+    }
+
+    int h = 0;
+    for (; h < NUM_HORIZONS - 1; h++) {
+        int slots = HORIZONS[h].num_days * (MINUTES_PER_DAY / HORIZONS[h].slot_minutes);
+        if ((double)slots * (1.0 - fraction) >= 2.0 * demand) break;
+    }
+    workload->num_days = HORIZONS[h].num_days;
+    workload->slot_minutes = HORIZONS[h].slot_minutes;
+    workload->num_slots = workload->num_days * (MINUTES_PER_DAY / workload->slot_minutes);
+
+    /* Fixed blocks of one to MAX_BLOCK_LEN slots at random starts */
+    int num_slots = workload->num_slots;
+    bool* fixed = (bool*)calloc((size_t)num_slots, sizeof(bool));
+    if (fixed == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    int num_fixed = 0;
+    while (num_fixed < (int)(num_slots * fraction)) {
+        int start = random_int(0, num_slots - 1);
+        int length = random_int(1, MAX_BLOCK_LEN);
+        for (int s = start; s < start + length && s < num_slots; s++) {
+            if (!fixed[s]) num_fixed++;
+            fixed[s] = true;
+        }
+    }
+    workload->num_fixed = num_fixed;
+
+    Text* text = &workload->request;
+    text->length = 0;
+    text_append(text, "{\"num_days\":%d,\"slot_minutes\":%d,\"max_nodes\":%d,\"tasks\":[",
+                workload->num_days, workload->slot_minutes, BENCH_MAX_NODES);
+    for (int i = 0; i < num_tasks; i++) {
+        TaskType type = random_task_type();
+        int priority = random_int(10, 100);
+        int energy = random_int(0, 3);
+        append_task(text, i + 1, type, durations[i], priority, energy, i == 0);
+    }
+
+    /* One more task as long as the longest free run than there are such
+     * runs; lowest priority, so the search packs everything else first */
+    workload->num_tasks = num_tasks;
+    if (!feasible) {
+        int longest = 0;
+        int count = 0;
+        int run = 0;
+        for (int s = 0; s <= num_slots; s++) {
+            if (s < num_slots && !fixed[s]) {
+                run++;
+                continue;
+            }
+            if (run > longest) {
+                longest = run;
+                count = 0;
+            }
+            if (run == longest) count++;
+            run = 0;
+        }
+        for (int i = 0; i <= count; i++) {
+            append_task(text, BLOCKER_ID + i, TASK_STUDY, longest, 0, 0, false);
+        }
+        workload->num_tasks += count + 1;
+    }
+
+    text_append(text, "],\"fixed_slots\":[");
+    bool first = true;
+    for (int s = 0; s < num_slots; s++) {
+        if (!fixed[s]) continue;
+        text_append(text, "%s{\"slot_index\":%d,\"task_id\":-1}", first ? "" : ",", s);
+        first = false;
+    }
+    text_append(text, "]}");
+
+    snprintf(workload->name, sizeof(workload->name), "tasks=%d,fixed=%s,%s", num_tasks,
+             dense ? "dense" : "sparse", feasible ? "feasible" : "infeasible");
+    free(fixed);
+    free(durations);
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int int64_compare(const void* a, const void* b) {
+    int64_t x = *(const int64_t*)a;
+    int64_t y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Nearest-rank percentile
+ * @param sorted Samples in ascending order
+ * @param percent 1 to 100
+ */
+static double percentile_us(const int64_t* sorted, int count, int percent) {
+    int rank = (count * percent + 99) / 100;
+    if (rank < 1) rank = 1;
+    return (double)sorted[rank - 1] / 1000.0;
+}
+
+static void print_phase(const char* name, int64_t* samples, int count) {
+    qsort(samples, (size_t)count, sizeof(int64_t), int64_compare);
+    printf(",\"%s\":{\"p50\":%.1f,\"p99\":%.1f}", name, percentile_us(samples, count, 50),
+           percentile_us(samples, count, 99));
+}
+
+static long peak_rss_kb(void) {
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : -1;
+}
+
+/**
+ * Time one workload over runs solves, after one untimed warm-up
+ * @return 0 on success, -1 if a request failed to parse or solve
+ */
+static int run_workload(const Workload* workload, int runs, Arena* arena,
+                        char** buffer, size_t* capacity) {
+    int64_t* samples = (int64_t*)malloc(sizeof(int64_t) * 3 * (size_t)runs);
+    if (samples == NULL) return -1;
+    int64_t* parse = samples;
+    int64_t* solve = samples + runs;
+    int64_t* serialize = samples + 2 * runs;
+    int solved = 0;
+    int exhausted = 0;
+    int64_t nodes = 0;
+    int64_t solve_total = 0;
+    size_t output_bytes = 0;
+
+    for (int run = -1; run < runs; run++) {
+        arena_reset(arena);
+        int64_t start = now_ns();
+        Task* tasks = NULL;
+        int num_tasks = 0;
+        TimeSlot* fixed_slots = NULL;
+        int num_fixed = 0;
+        SolverOptions options;
+        if (parse_json_input(workload->request.data, &tasks, &num_tasks, &fixed_slots,
+                             &num_fixed, arena) != 0 ||
+            parse_solver_options(workload->request.data, &options) != 0) {
+            free(samples);
+            return -1;
+        }
+        options.arena = arena;
+        int64_t parsed = now_ns();
+        Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed,
+                                                  &options);
+        int64_t solved_at = now_ns();
+        int length = timeline != NULL
+            ? timeline_write_json(timeline, OUTPUT_COMPACT, buffer, capacity)
+            : -1;
+        int64_t written = now_ns();
+        if (length < 0) {
+            timeline_free(timeline);
+            free(samples);
+            return -1;
+        }
+        if (run >= 0) {
+            parse[run] = parsed - start;
+            solve[run] = solved_at - parsed;
+            serialize[run] = written - solved_at;
+            if (timeline->success) solved++;
+            if (timeline->budget_exhausted) exhausted++;
+            nodes += timeline->nodes;
+            solve_total += solve[run];
+            output_bytes = (size_t)length;
+        }
+        timeline_free(timeline);
+    }
+
+    printf("{\"workload\":\"%s\",\"tasks\":%d,\"fixed_slots\":%d,\"num_slots\":%d,"
+           "\"slot_minutes\":%d,\"runs\":%d,\"solved\":%d,\"budget_exhausted\":%d,"
+           "\"request_bytes\":%zu,\"response_bytes\":%zu",
+           workload->name, workload->num_tasks, workload->num_fixed, workload->num_slots,
+           workload->slot_minutes, runs, solved, exhausted, workload->request.length,
+           output_bytes);
+    print_phase("parse_us", parse, runs);
+    print_phase("solve_us", solve, runs);
+    print_phase("serialize_us", serialize, runs);
+    printf(",\"nodes_per_sec\":%.0f",
+           solve_total > 0 ? (double)nodes * 1e9 / (double)solve_total : 0.0);
+    printf(",\"arena_bytes\":%zu,\"peak_rss_kb\":%ld}\n", arena->capacity, peak_rss_kb());
+    fflush(stdout);
+    free(samples);
+    return 0;
+}
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [--runs N] [--seed S]\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    int runs = DEFAULT_RUNS;
+    unsigned int seed = DEFAULT_SEED;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (runs < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    Arena arena;
+    arena_init(&arena);
+    Workload workload;
+    memset(&workload, 0, sizeof(workload));
+    char* buffer = NULL;
+    size_t capacity = 0;
+    int status = 0;
+
+    for (int s = 0; s < NUM_SCALES && status == 0; s++) {
+        for (int variant = 0; variant < 4 && status == 0; variant++) {
+            bool dense = variant >= 2;
+            bool feasible = variant % 2 == 0;
+            workload_build(&workload, seed, SCALES[s], dense, feasible);
+            arena_destroy(&arena);
+            arena_init(&arena);
+            if (run_workload(&workload, runs, &arena, &buffer, &capacity) != 0) {
+                fprintf(stderr, "Error: Workload %s failed\n", workload.name);
+                status = 1;
+            }
+        }
+    }
+
+    free(workload.request.data);
+    free_json(buffer);
+    arena_destroy(&arena);
+    return status;
+}
@@ -0,0 +1,131 @@
+/**
+ * AESA Core Scheduling Engine - Library API Implementation
+ */
+
+#include "aesa.h"
+#include "scheduler.h"
+#include "cache.h"
+#include "templates.h"
+#include "wire.h"
+#include <stdlib.h>
+
+struct AesaSolver {
+    int default_threads;            /* AESA_THREADS at creation, 0 if unset */
+    ResultCache* cache;             /* NULL if AESA_CACHE_MB is 0 */
+    TemplateRegistry* templates;    /* Fixed-slot templates registered with this context */
+    Arena arena;                    /* Memory of the request being solved */
+};
+
+int aesa_api_version(void) {
+    return AESA_API_VERSION;
+}
+
+size_t aesa_response_capacity(void) {
+    return wire_response_max_size();
+}
+
+AesaSolver* aesa_solver_create(void) {
+    AesaSolver* solver = (AesaSolver*)malloc(sizeof(AesaSolver));
+    if (solver == NULL) return NULL;
+    solver->default_threads = solver_threads_from_environment();
+    solver->cache = NULL;
+    arena_init(&solver->arena);
+    solver->templates = template_registry_create();
+    if (solver->templates == NULL) {
+        free(solver);
+        return NULL;
+    }
+
+    size_t cache_limit = result_cache_limit_from_environment();
+    if (cache_limit > 0) {
+        solver->cache = result_cache_create(cache_limit);
+        if (solver->cache == NULL) {
+            template_registry_free(solver->templates);
+            free(solver);
+            return NULL;
+        }
+    }
+    return solver;
+}
+
+void aesa_solver_free(AesaSolver* solver) {
+    if (solver == NULL) return;
+    result_cache_free(solver->cache);
+    template_registry_free(solver->templates);
+    arena_destroy(&solver->arena);
+    free(solver);
+}
+
+int aesa_solver_cache_stats(const AesaSolver* solver, AesaCacheStats* stats) {
+    if (solver == NULL || stats == NULL) return AESA_ERROR_ARGUMENT;
+
+    ResultCacheStats cache_stats;
+    result_cache_stats(solver->cache, &cache_stats);
+    stats->hits = cache_stats.hits;
+    stats->misses = cache_stats.misses;
+    stats->evictions = cache_stats.evictions;
+    stats->entries = cache_stats.entries;
+    stats->bytes = cache_stats.bytes;
+    stats->max_bytes = cache_stats.max_bytes;
+    return AESA_OK;
+}
+
+int aesa_solve(
+    AesaSolver* solver,
+    const void* request,
+    size_t request_size,
+    void* response,
+    size_t response_capacity,
+    size_t* response_size
+) {
+    if (solver == NULL || request == NULL || response == NULL || response_size == NULL) {
+        return AESA_ERROR_ARGUMENT;
+    }
+
+    Task* tasks = NULL;
+    int num_tasks = 0;
+    TimeSlot* fixed_slots = NULL;
+    int num_fixed = 0;
+    TaskPlacement* previous = NULL;
+    int num_previous = 0;
+    SolverOptions options;
+    WireRequestInfo info = { 0, false, NULL, 0, false };
+    const char* error = NULL;
+    Timeline* timeline = NULL;
+    Arena* arena = &solver->arena;
+
+    if (wire_parse_request((const char*)request, request_size, &tasks, &num_tasks,
+                           &fixed_slots, &num_fixed, &previous, &num_previous, &options,
+                           &info, &error, arena) == 0) {
+        if (options.threads == 0) options.threads = solver->default_threads;
+        options.arena = arena;
+
+        if (info.template_name != NULL && !info.register_template) {
+            options.fixed_template = template_registry_find(
+                solver->templates, info.template_name, info.template_length);
+            if (options.fixed_template == NULL) error = "Unknown fixed_template";
+        }
+
+        if (info.register_template) {
+            timeline = template_registry_register(solver->templates, info.template_name,
+                                                  info.template_length, num_tasks,
+                                                  fixed_slots, num_fixed, &options, &error);
+        } else if (error == NULL) {
+            timeline = result_cache_solve(solver->cache, tasks, num_tasks, fixed_slots,
+                                          &num_fixed, previous, num_previous, &options);
+            if (timeline == NULL) error = "Optimization failed";
+        }
+    }
+
+    int status = AESA_OK;
+    *response_size = wire_response_size(timeline, error, &info);
+    if (*response_size > response_capacity) {
+        status = AESA_ERROR_BUFFER;
+    } else {
+        wire_encode_response(timeline, error, &info, (char*)response);
+    }
+
+    if (timeline != NULL) timeline_free(timeline);
+    arena_reset(arena);
+    return status;
+}
@@ -0,0 +1,102 @@
+/**
+ * AESA Core Scheduling Engine - Library API
+ *
+ * Stable entry points of libaesa for callers that solve in-process
+ * (bridge.py loads it through ctypes). Requests and responses are the
+ * binary messages of wire.h, so callers never depend on the layout of the
+ * engine's structs. C callers built against scheduler.h may also call
+ * optimize_schedule() and optimize_schedule_ex() from the same library.
+ *
+ * A solver context serves one thread at a time; give each thread its own.
+ * Each context keeps its own result cache (see cache.h), so repeated
+ * requests to one context are answered without solving, and its own
+ * request arena (see arena.h), reset after every response, so steady-state
+ * requests do not allocate, and its own fixed-slot templates (see
+ * templates.h): a request with WIRE_REGISTER_TEMPLATE registers one, and
+ * later requests to the same context name it with WIRE_TEMPLATE.
+ */
+
+#ifndef AESA_H
+#define AESA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define AESA_API_VERSION 2
+
+/* Status codes */
+#define AESA_OK 0
+#define AESA_ERROR_ARGUMENT -1      /* NULL context, request or output */
+#define AESA_ERROR_BUFFER -2        /* Response larger than the buffer */
+
+typedef struct AesaSolver AesaSolver;
+
+/* Result cache counters of a solver context */
+typedef struct {
+    uint64_t hits;                  /* Requests answered from the cache */
+    uint64_t misses;                /* Requests solved */
+    uint64_t evictions;             /* Entries dropped to stay within max_bytes */
+    uint64_t entries;               /* Entries held */
+    uint64_t bytes;                 /* Memory held by the entries */
+    uint64_t max_bytes;             /* Memory bound, 0 if caching is disabled */
+} AesaCacheStats;
+
+/**
+ * Version of this API, for callers that load the library at runtime
+ * @return AESA_API_VERSION of the library
+ */
+int aesa_api_version(void);
+
+/**
+ * Response buffer size that fits the response to any request
+ * It grows with the task capacity (AESA_MAX_TASKS, see scheduler.h).
+ * @return Size in bytes
+ */
+size_t aesa_response_capacity(void);
+
+/**
+ * Create a solver context
+ * Reads AESA_THREADS once, as the default for requests without threads,
+ * and AESA_CACHE_MB, the memory bound of the context's result cache
+ * (default 16, 0 disables caching).
+ * @return Context (free with aesa_solver_free), NULL on allocation failure
+ */
+AesaSolver* aesa_solver_create(void);
+
+/**
+ * Free a solver context
+ * @param solver Context to free, may be NULL
+ */
+void aesa_solver_free(AesaSolver* solver);
+
+/**
+ * Read the result cache counters of a solver context
+ * @param solver Solver context
+ * @param stats Output: counters
+ * @return AESA_OK, or AESA_ERROR_ARGUMENT
+ */
+int aesa_solver_cache_stats(const AesaSolver* solver, AesaCacheStats* stats);
+
+/**
+ * Solve one binary request into a caller-owned response buffer
+ * Malformed requests and solver failures are reported in the response,
+ * like in serve mode; the status only says whether a response was written.
+ * @param solver Solver context
+ * @param request Request message
+ * @param request_size Size of request in bytes
+ * @param response Output: response message
+ * @param response_capacity Size of response in bytes
+ * @param response_size Output: response size, or the size needed on
+ *                      AESA_ERROR_BUFFER
+ * @return AESA_OK, or an AESA_ERROR_* status
+ */
+int aesa_solve(
+    AesaSolver* solver,
+    const void* request,
+    size_t request_size,
+    void* response,
+    size_t response_capacity,
+    size_t* response_size
+);
+
+#endif /* AESA_H */
@@ -0,0 +1,112 @@
+/**
+ * AESA Core Scheduling Engine - Request Arena Implementation
+ */
+
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct ArenaBlock {
+    ArenaBlock* next;               /* Older block */
+    size_t size;                    /* Usable bytes after the header */
+};
+
+/* Block header rounded up so the first allocation is aligned */
+#define BLOCK_HEADER_SIZE \
+    ((sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+static unsigned char* block_data(ArenaBlock* block) {
+    return (unsigned char*)block + BLOCK_HEADER_SIZE;
+}
+
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static ArenaBlock* block_create(size_t size, ArenaBlock* next) {
+    ArenaBlock* block = (ArenaBlock*)malloc(BLOCK_HEADER_SIZE + size);
+    if (block != NULL) {
+        block->next = next;
+        block->size = size;
+    }
+    return block;
+}
+
+void arena_init(Arena* arena) {
+    arena->blocks = NULL;
+    arena->used = 0;
+    arena->last = 0;
+    arena->capacity = 0;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    if (arena == NULL) return malloc(size > 0 ? size : 1);
+
+    size_t needed = align_up(size > 0 ? size : 1);
+    if (needed < size) return NULL;
+    if (arena->blocks == NULL || arena->blocks->size - arena->used < needed) {
+        /* Later blocks double, so a large request needs few of them */
+        size_t block_size = arena->capacity > 0 ? arena->capacity : ARENA_INITIAL_SIZE;
+        if (block_size < needed) block_size = needed;
+        ArenaBlock* block = block_create(block_size, arena->blocks);
+        if (block == NULL) return NULL;
+        arena->blocks = block;
+        arena->used = 0;
+        arena->capacity += block_size;
+    }
+
+    arena->last = arena->used;
+    arena->used += needed;
+    return block_data(arena->blocks) + arena->last;
+}
+
+void* arena_realloc(Arena* arena, void* ptr, size_t old_size, size_t new_size) {
+    if (arena == NULL) return realloc(ptr, new_size);
+    if (ptr == NULL) return arena_alloc(arena, new_size);
+
+    /* The newest allocation can grow into the rest of its block */
+    unsigned char* newest = arena->blocks != NULL ? block_data(arena->blocks) + arena->last : NULL;
+    if ((unsigned char*)ptr == newest) {
+        size_t needed = align_up(new_size > 0 ? new_size : 1);
+        if (needed >= new_size && arena->last + needed <= arena->blocks->size) {
+            arena->used = arena->last + needed;
+            return ptr;
+        }
+    }
+
+    void* moved = arena_alloc(arena, new_size);
+    if (moved != NULL) {
+        memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return moved;
+}
+
+void arena_free(Arena* arena, void* ptr) {
+    if (arena == NULL) free(ptr);
+}
+
+void arena_reset(Arena* arena) {
+    if (arena == NULL || arena->blocks == NULL) return;
+
+    if (arena->blocks->next != NULL) {
+        /* Replace the chain by one block holding all of it */
+        size_t capacity = arena->capacity;
+        arena_destroy(arena);
+        arena->blocks = block_create(capacity, NULL);
+        if (arena->blocks != NULL) arena->capacity = capacity;
+    }
+    arena->used = 0;
+    arena->last = 0;
+}
+
+void arena_destroy(Arena* arena) {
+    if (arena == NULL) return;
+
+    ArenaBlock* block = arena->blocks;
+    while (block != NULL) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena_init(arena);
+}
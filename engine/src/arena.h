@@ -0,0 +1,74 @@
+/**
+ * AESA Core Scheduling Engine - Request Arena
+ *
+ * Bump allocator for the memory of one request: parsed input arrays,
+ * solver state and the result Timeline. Serve mode, batch workers and
+ * library solvers keep one arena each and reset it after every response,
+ * so once the arena has grown to the largest request seen, requests are
+ * answered without touching malloc.
+ *
+ * Functions taking an arena treat NULL as "use the heap": arena_alloc(),
+ * arena_realloc() and arena_free() then behave as malloc, realloc and
+ * free, so call sites need no separate heap path.
+ *
+ * An arena serves one thread at a time.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_ALIGNMENT 16                  /* Alignment of every allocation */
+#define ARENA_INITIAL_SIZE (256 * 1024)     /* First block, doubled as needed */
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock* blocks;             /* Newest first; allocations come from the head */
+    size_t used;                    /* Bytes used in the head block */
+    size_t last;                    /* Offset of the newest allocation in the head */
+    size_t capacity;                /* Bytes held by all blocks */
+} Arena;
+
+/**
+ * Initialize an empty arena; its first allocation creates a block
+ */
+void arena_init(Arena* arena);
+
+/**
+ * Allocate size bytes, aligned to ARENA_ALIGNMENT
+ * @param arena Arena, NULL for malloc
+ * @return Memory released by arena_reset(), NULL on allocation failure
+ */
+void* arena_alloc(Arena* arena, size_t size);
+
+/**
+ * Resize an allocation; the newest allocation of the arena grows in place
+ * @param arena Arena, NULL for realloc
+ * @param ptr Allocation to resize, may be NULL
+ * @param old_size Size ptr was allocated with
+ * @param new_size Size needed
+ * @return Resized memory, NULL on allocation failure (ptr stays valid)
+ */
+void* arena_realloc(Arena* arena, void* ptr, size_t old_size, size_t new_size);
+
+/**
+ * Release one allocation: a no-op in an arena, free() without one
+ */
+void arena_free(Arena* arena, void* ptr);
+
+/**
+ * Release every allocation at once. A request that overflowed the first
+ * block leaves one block large enough for all of it, so the next request
+ * of the same size allocates nothing.
+ */
+void arena_reset(Arena* arena);
+
+/**
+ * Free the arena's blocks
+ * @param arena Arena to destroy, may be NULL
+ */
+void arena_destroy(Arena* arena);
+
+#endif /* ARENA_H */
@@ -0,0 +1,394 @@
+/**
+ * AESA Core Scheduling Engine - Result Cache Implementation
+ */
+
+#include "cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Entries are chained per bucket and linked newest to oldest for eviction */
+typedef struct CacheEntry {
+    struct CacheEntry* chain;       /* Next entry in the same bucket */
+    struct CacheEntry* newer;
+    struct CacheEntry* older;
+    uint64_t hash;
+    Timeline* result;
+    size_t bytes;                   /* Memory charged to the cache */
+    size_t key_size;
+    unsigned char key[];            /* Canonical request */
+} CacheEntry;
+
+struct ResultCache {
+    CacheEntry** buckets;
+    size_t num_buckets;             /* Power of two */
+    CacheEntry* newest;
+    CacheEntry* oldest;
+    unsigned char* key;             /* Canonical form of the current request */
+    size_t key_capacity;
+    ResultCacheStats stats;
+};
+
+size_t result_cache_limit_from_environment(void) {
+    const char* env_mb = getenv("AESA_CACHE_MB");
+    if (env_mb == NULL || *env_mb == '\0') return (size_t)RESULT_CACHE_DEFAULT_MB << 20;
+
+    char* end;
+    long mb = strtol(env_mb, &end, 10);
+    if (*end != '\0' || mb < 0) return (size_t)RESULT_CACHE_DEFAULT_MB << 20;
+    if (mb > RESULT_CACHE_MAX_MB) mb = RESULT_CACHE_MAX_MB;
+    return (size_t)mb << 20;
+}
+
+ResultCache* result_cache_create(size_t max_bytes) {
+    ResultCache* cache = (ResultCache*)calloc(1, sizeof(ResultCache));
+    if (cache == NULL) return NULL;
+
+    /* About one bucket per default-horizon entry that fits */
+    size_t entry_bytes = sizeof(Timeline) +
+                         sizeof(TimeSlot) * DEFAULT_NUM_DAYS * SLOTS_PER_DAY;
+    size_t buckets = 16;
+    while (buckets < max_bytes / entry_bytes) buckets *= 2;
+    cache->buckets = (CacheEntry**)calloc(buckets, sizeof(CacheEntry*));
+    if (cache->buckets == NULL) {
+        free(cache);
+        return NULL;
+    }
+    cache->num_buckets = buckets;
+    cache->stats.max_bytes = max_bytes;
+    return cache;
+}
+
+void result_cache_free(ResultCache* cache) {
+    if (cache == NULL) return;
+    CacheEntry* entry = cache->newest;
+    while (entry != NULL) {
+        CacheEntry* older = entry->older;
+        timeline_free(entry->result);
+        free(entry);
+        entry = older;
+    }
+    free(cache->buckets);
+    free(cache->key);
+    free(cache);
+}
+
+void result_cache_stats(const ResultCache* cache, ResultCacheStats* stats) {
+    if (cache == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    *stats = cache->stats;
+}
+
+/* ============================================================
+ * Canonical Form
+ * ============================================================ */
+
+static int compare_int(int a, int b) {
+    return (a > b) - (a < b);
+}
+
+/* Order by ID, then by every other field the solver reads */
+static int task_compare_canonical(const void* a, const void* b) {
+    const Task* x = (const Task*)a;
+    const Task* y = (const Task*)b;
+    int c = compare_int(x->id, y->id);
+    if (c == 0) c = compare_int(x->duration_slots, y->duration_slots);
+    if (c == 0) c = compare_int(x->priority, y->priority);
+    if (c == 0) c = compare_int(x->deadline_slot, y->deadline_slot);
+    if (c == 0) c = compare_int((int)x->type, (int)y->type);
+    if (c == 0) c = compare_int((int)x->preferred_energy, (int)y->preferred_energy);
+    if (c == 0) c = compare_int(x->is_fixed, y->is_fixed);
+    return c;
+}
+
+static int placement_compare_canonical(const void* a, const void* b) {
+    const TaskPlacement* x = (const TaskPlacement*)a;
+    const TaskPlacement* y = (const TaskPlacement*)b;
+    int c = compare_int(x->task_id, y->task_id);
+    return c != 0 ? c : compare_int(x->start_slot, y->start_slot);
+}
+
+/**
+ * Rewrite fixed slots as the solver applies them: out-of-range slots
+ * dropped, the last entry for a slot kept, in slot order
+ * @return New number of fixed slots
+ */
+static int normalize_fixed_slots(TimeSlot* fixed_slots, int num_fixed) {
+    int task_at[MAX_SLOTS];
+    uint64_t seen[SLOT_WORDS] = { 0 };
+    int end = 0;
+
+    for (int i = 0; i < num_fixed; i++) {
+        int idx = fixed_slots[i].slot_index;
+        if (idx < 0 || idx >= MAX_SLOTS) continue;
+        task_at[idx] = fixed_slots[i].task_id;
+        seen[idx / SLOT_WORD_BITS] |= 1ULL << (idx % SLOT_WORD_BITS);
+        if (idx >= end) end = idx + 1;
+    }
+
+    int count = 0;
+    for (int idx = 0; idx < end; idx++) {
+        if (!(seen[idx / SLOT_WORD_BITS] & (1ULL << (idx % SLOT_WORD_BITS)))) continue;
+        timeslot_init(&fixed_slots[count], idx);
+        fixed_slots[count].task_id = task_at[idx];
+        fixed_slots[count].is_fixed = true;
+        count++;
+    }
+    return count;
+}
+
+static unsigned char* put_i32(unsigned char* p, int32_t value) {
+    memcpy(p, &value, sizeof(value));
+    return p + sizeof(value);
+}
+
+static unsigned char* put_i64(unsigned char* p, int64_t value) {
+    memcpy(p, &value, sizeof(value));
+    return p + sizeof(value);
+}
+
+#define KEY_OPTIONS_SIZE (13 * 4 + 4 * 8 + SLOTS_PER_DAY)
+#define KEY_TASK_SIZE (7 * 4)
+#define KEY_PAIR_SIZE (2 * 4)
+
+/**
+ * Write the canonical key of a canonicalized request into cache->key
+ * @return Key size, 0 on allocation failure
+ */
+static size_t build_key(ResultCache* cache, const Task* tasks, int num_tasks,
+                        const TimeSlot* fixed_slots, int num_fixed,
+                        const TaskPlacement* previous, int num_previous,
+                        const SolverOptions* options) {
+    /* Template slots are keyed by content, so re-registering a name with
+     * other slots cannot hit results solved with the old ones */
+    int num_template = 0;
+    const TimeSlot* template_slots = options->fixed_template != NULL
+        ? fixed_template_slots(options->fixed_template, &num_template) : NULL;
+    size_t size = 4 * 4 + KEY_OPTIONS_SIZE + (size_t)num_tasks * KEY_TASK_SIZE +
+                  (size_t)(num_template + num_fixed + num_previous) * KEY_PAIR_SIZE;
+    if (size > cache->key_capacity) {
+        unsigned char* grown = (unsigned char*)realloc(cache->key, size);
+        if (grown == NULL) return 0;
+        cache->key = grown;
+        cache->key_capacity = size;
+    }
+
+    unsigned char* p = cache->key;
+    p = put_i32(p, num_tasks);
+    p = put_i32(p, num_fixed);
+    p = put_i32(p, num_previous);
+    p = put_i32(p, num_template);
+
+    p = put_i32(p, options->forward_checking);
+    p = put_i32(p, options->backjumping);
+    p = put_i32(p, options->max_nogoods);
+    p = put_i32(p, (int32_t)options->engine);
+    p = put_i32(p, (int32_t)options->tie_break_seed);
+    p = put_i32(p, options->threads);
+    p = put_i32(p, options->search_threads);
+    p = put_i32(p, (int32_t)options->objective);
+    p = put_i32(p, options->weight_by_priority);
+    p = put_i32(p, options->has_energy_curve);
+    p = put_i32(p, options->num_days);
+    p = put_i32(p, options->slot_minutes);
+    p = put_i32(p, options->start_slot_of_day);
+    p = put_i64(p, options->max_nodes);
+    p = put_i64(p, options->max_time_us);
+    p = put_i64(p, options->local_search_moves);
+    p = put_i64(p, (int64_t)options->seed);
+    if (options->has_energy_curve) {
+        memcpy(p, options->energy_curve, SLOTS_PER_DAY);
+    } else {
+        memset(p, 0, SLOTS_PER_DAY);
+    }
+    p += SLOTS_PER_DAY;
+
+    for (int i = 0; i < num_tasks; i++) {
+        p = put_i32(p, tasks[i].id);
+        p = put_i32(p, tasks[i].duration_slots);
+        p = put_i32(p, tasks[i].priority);
+        p = put_i32(p, tasks[i].deadline_slot);
+        p = put_i32(p, (int32_t)tasks[i].type);
+        p = put_i32(p, (int32_t)tasks[i].preferred_energy);
+        p = put_i32(p, tasks[i].is_fixed);
+    }
+    for (int i = 0; i < num_template; i++) {
+        p = put_i32(p, template_slots[i].slot_index);
+        p = put_i32(p, template_slots[i].task_id);
+    }
+    for (int i = 0; i < num_fixed; i++) {
+        p = put_i32(p, fixed_slots[i].slot_index);
+        p = put_i32(p, fixed_slots[i].task_id);
+    }
+    for (int i = 0; i < num_previous; i++) {
+        p = put_i32(p, previous[i].task_id);
+        p = put_i32(p, previous[i].start_slot);
+    }
+    return size;
+}
+
+/* Multiply-xorshift over 8-byte words; keys are compared in full on a match */
+static uint64_t hash_key(const unsigned char* key, size_t size) {
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, key + i, sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, key + i, size - i);
+    hash = (hash ^ tail) * 0xC4CEB9FE1A85EC53ULL;
+    return hash ^ (hash >> 29);
+}
+
+/* ============================================================
+ * Entries
+ * ============================================================ */
+
+static void lru_unlink(ResultCache* cache, CacheEntry* entry) {
+    if (entry->newer != NULL) entry->newer->older = entry->older;
+    else cache->newest = entry->older;
+    if (entry->older != NULL) entry->older->newer = entry->newer;
+    else cache->oldest = entry->newer;
+}
+
+static void lru_push_newest(ResultCache* cache, CacheEntry* entry) {
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if (cache->newest != NULL) cache->newest->newer = entry;
+    cache->newest = entry;
+    if (cache->oldest == NULL) cache->oldest = entry;
+}
+
+static CacheEntry* cache_find(ResultCache* cache, uint64_t hash, size_t key_size) {
+    CacheEntry* entry = cache->buckets[hash & (cache->num_buckets - 1)];
+    for (; entry != NULL; entry = entry->chain) {
+        if (entry->hash == hash && entry->key_size == key_size &&
+            memcmp(entry->key, cache->key, key_size) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void cache_evict_oldest(ResultCache* cache) {
+    CacheEntry* entry = cache->oldest;
+    CacheEntry** link = &cache->buckets[entry->hash & (cache->num_buckets - 1)];
+    while (*link != entry) link = &(*link)->chain;
+    *link = entry->chain;
+    lru_unlink(cache, entry);
+
+    cache->stats.bytes -= entry->bytes;
+    cache->stats.entries--;
+    cache->stats.evictions++;
+    timeline_free(entry->result);
+    free(entry);
+}
+
+static void cache_insert(ResultCache* cache, uint64_t hash, size_t key_size,
+                         const Timeline* result) {
+    size_t bytes = sizeof(CacheEntry) + key_size + sizeof(Timeline) +
+                   sizeof(TimeSlot) * (size_t)result->num_slots +
+                   sizeof(uint64_t) * (size_t)result->num_words +
+                   sizeof(int) * (size_t)result->num_unplaced;
+    if (bytes > cache->stats.max_bytes) return;
+
+    CacheEntry* entry = (CacheEntry*)malloc(sizeof(CacheEntry) + key_size);
+    if (entry == NULL) return;
+    entry->result = timeline_clone(result);
+    if (entry->result == NULL) {
+        free(entry);
+        return;
+    }
+    entry->hash = hash;
+    entry->bytes = bytes;
+    entry->key_size = key_size;
+    memcpy(entry->key, cache->key, key_size);
+
+    while (cache->stats.bytes + bytes > cache->stats.max_bytes) {
+        cache_evict_oldest(cache);
+    }
+
+    CacheEntry** bucket = &cache->buckets[hash & (cache->num_buckets - 1)];
+    entry->chain = *bucket;
+    *bucket = entry;
+    lru_push_newest(cache, entry);
+    cache->stats.bytes += bytes;
+    cache->stats.entries++;
+}
+
+/* ============================================================
+ * Solving
+ * ============================================================ */
+
+static Timeline* solve(Task* tasks, int num_tasks, TimeSlot* fixed_slots, int num_fixed,
+                       const TaskPlacement* previous, int num_previous,
+                       const SolverOptions* options) {
+    return previous != NULL
+        ? optimize_schedule_incremental(tasks, num_tasks, fixed_slots, num_fixed,
+                                        previous, num_previous, options)
+        : optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed, options);
+}
+
+Timeline* result_cache_solve(
+    ResultCache* cache,
+    Task* tasks,
+    int num_tasks,
+    TimeSlot* fixed_slots,
+    int* num_fixed,
+    TaskPlacement* previous,
+    int num_previous,
+    const SolverOptions* options
+) {
+    if (cache == NULL) {
+        return solve(tasks, num_tasks, fixed_slots, *num_fixed, previous, num_previous,
+                     options);
+    }
+
+    if (tasks != NULL && num_tasks > 1) {
+        qsort(tasks, (size_t)num_tasks, sizeof(Task), task_compare_canonical);
+    }
+    if (fixed_slots != NULL && *num_fixed > 0) {
+        *num_fixed = normalize_fixed_slots(fixed_slots, *num_fixed);
+    }
+    if (previous != NULL && num_previous > 1) {
+        qsort(previous, (size_t)num_previous, sizeof(TaskPlacement),
+              placement_compare_canonical);
+    }
+
+    size_t key_size = build_key(cache, tasks, num_tasks > 0 ? num_tasks : 0, fixed_slots,
+                                fixed_slots != NULL ? *num_fixed : 0, previous,
+                                previous != NULL ? num_previous : 0, options);
+    if (key_size == 0) {
+        return solve(tasks, num_tasks, fixed_slots, *num_fixed, previous, num_previous,
+                     options);
+    }
+
+    uint64_t hash = hash_key(cache->key, key_size);
+    CacheEntry* entry = cache_find(cache, hash, key_size);
+    if (entry != NULL) {
+        Timeline* copy = timeline_clone_in(options->arena, entry->result);
+        if (copy == NULL) {
+            return solve(tasks, num_tasks, fixed_slots, *num_fixed, previous,
+                         num_previous, options);
+        }
+        lru_unlink(cache, entry);
+        lru_push_newest(cache, entry);
+        cache->stats.hits++;
+        copy->cache_hit = true;
+        copy->nodes = 0;
+        memset(&copy->stats, 0, sizeof(copy->stats));
+        return copy;
+    }
+
+    cache->stats.misses++;
+    Timeline* timeline = solve(tasks, num_tasks, fixed_slots, *num_fixed, previous,
+                               num_previous, options);
+    if (timeline != NULL && !timeline->budget_exhausted) {
+        cache_insert(cache, hash, key_size, timeline);
+    }
+    return timeline;
+}
@@ -0,0 +1,98 @@
+/**
+ * AESA Core Scheduling Engine - Result Cache
+ *
+ * Memory-bounded LRU cache of solve results for serve mode and library
+ * contexts, which see the same request many times (agent tools re-run the
+ * optimizer with identical or reordered inputs). Requests are keyed by a
+ * canonical form: tasks sorted by ID, fixed slots deduplicated (last entry
+ * per slot wins, as in the solver) and sorted, previous placements sorted,
+ * plus every solver option and the slots of the request's fixed-slot
+ * template. Task names and response settings (request_id,
+ * output format) do not change the schedule and are not part of the key.
+ *
+ * A cache serves one thread at a time.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "scheduler.h"
+#include <stddef.h>
+
+#define RESULT_CACHE_DEFAULT_MB 16
+#define RESULT_CACHE_MAX_MB 4096
+
+typedef struct ResultCache ResultCache;
+
+/**
+ * Counters of a result cache
+ */
+typedef struct {
+    uint64_t hits;                  /* Requests answered from the cache */
+    uint64_t misses;                /* Requests solved */
+    uint64_t evictions;             /* Entries dropped to stay within max_bytes */
+    size_t entries;                 /* Entries held */
+    size_t bytes;                   /* Memory held by the entries */
+    size_t max_bytes;               /* Memory bound */
+} ResultCacheStats;
+
+/**
+ * Read the cache size from the AESA_CACHE_MB environment variable
+ * @return Bound in bytes (RESULT_CACHE_DEFAULT_MB if unset or invalid,
+ *         at most RESULT_CACHE_MAX_MB), 0 if caching is disabled
+ */
+size_t result_cache_limit_from_environment(void);
+
+/**
+ * Create an empty cache
+ * @param max_bytes Memory bound for the entries, > 0
+ * @return Cache (free with result_cache_free), NULL on allocation failure
+ */
+ResultCache* result_cache_create(size_t max_bytes);
+
+/**
+ * Free a cache and its entries
+ * @param cache Cache to free, may be NULL
+ */
+void result_cache_free(ResultCache* cache);
+
+/**
+ * Solve a request, answering repeated requests from the cache
+ *
+ * With a cache, tasks, fixed_slots and previous are first canonicalized
+ * in place (so *num_fixed may shrink) and the canonical request is solved,
+ * so a reordered request gets the same schedule whether it hits or not. Hits
+ * return a copy of the stored result, in options->arena, with cache_hit set.
+ * Stored results are heap copies, so resetting the arena leaves them intact.
+ * Results whose search budget ran out are not stored, so a retry searches
+ * again.
+ *
+ * @param cache Result cache, NULL to solve without caching
+ * @param tasks Array of tasks to schedule
+ * @param num_tasks Number of tasks
+ * @param fixed_slots Array of pre-fixed slots
+ * @param num_fixed In/out: number of fixed slots
+ * @param previous Placements of an incremental request, NULL for a full solve
+ * @param num_previous Number of entries in previous
+ * @param options Solver options
+ * @return Timeline (caller must free with timeline_free()), NULL on failure
+ */
+Timeline* result_cache_solve(
+    ResultCache* cache,
+    Task* tasks,
+    int num_tasks,
+    TimeSlot* fixed_slots,
+    int* num_fixed,
+    TaskPlacement* previous,
+    int num_previous,
+    const SolverOptions* options
+);
+
+/**
+ * Read the counters of a cache
+ * @param cache Cache, NULL reads as an empty cache of size 0
+ * @param stats Output: counters
+ */
+void result_cache_stats(const ResultCache* cache, ResultCacheStats* stats);
+
+#endif /* CACHE_H */
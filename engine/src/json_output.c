@@ -10,57 +10,66 @@
 #include <stdio.h>
 #include <ctype.h>
 
-/* Initial buffer size for JSON output */
-#define INITIAL_BUFFER_SIZE 4096
-#define BUFFER_GROW_FACTOR 2
+/* Upper bounds used to presize the output buffer */
+#define JSON_HEADER_MAX 512     /* Top-level keys, punctuation and scalars */
+#define JSON_ITEM_MAX 160       /* One pretty-printed slot or run object */
+#define JSON_INT_MAX 11         /* "-2147483648" */
+#define JSON_INT64_MAX 20       /* "-9223372036854775808" */
+
+static const char* OUTPUT_FORMAT_STRINGS[OUTPUT_FORMAT_COUNT] = {
+    "pretty",
+    "compact",
+    "runs"
+};
+
 
 /* ============================================================
- * JSON String Escaping
+ * Buffer Writers
  * ============================================================ */
 
-/**
- * Escape a string for JSON output
- * Returns newly allocated string, caller must free
+/*
+ * The output is bounded up front (json_size_bound), so the writers below
+ * store straight through a cursor without length checks or reallocation.
  */
-static char* json_escape_string(const char* str) {
-    if (str == NULL) {
-        char* empty = (char*)malloc(3);
-        if (empty) strcpy(empty, "\"\"");
-        return empty;
-    }
-    
-    /* Calculate required size */
-    size_t len = strlen(str);
-    size_t escaped_len = 2; /* For quotes */
-    
-    for (size_t i = 0; i < len; i++) {
-        switch (str[i]) {
-            case '"':
-            case '\\':
-            case '\b':
-            case '\f':
-            case '\n':
-            case '\r':
-            case '\t':
-                escaped_len += 2;
-                break;
-            default:
-                if ((unsigned char)str[i] < 32) {
-                    escaped_len += 6; /* \uXXXX */
-                } else {
-                    escaped_len += 1;
-                }
-        }
-    }
+
+static char* put_text(char* p, const char* text) {
+    while (*text) *p++ = *text++;
+    return p;
+}
+
+static char* put_int64(char* p, int64_t value) {
+    char digits[JSON_INT64_MAX];
+    uint64_t magnitude = value < 0 ? 0u - (uint64_t)value : (uint64_t)value;
+    int n = 0;
     
-    char* result = (char*)malloc(escaped_len + 1);
-    if (result == NULL) return NULL;
+    do {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
     
-    char* p = result;
-    *p++ = '"';
+    if (value < 0) *p++ = '-';
+    while (n > 0) *p++ = digits[--n];
+    return p;
+}
+
+static char* put_int(char* p, int value) {
+    return put_int64(p, value);
+}
+
+static char* put_bool(char* p, bool value) {
+    return put_text(p, value ? "true" : "false");
+}
+
+/**
+ * Write a string as a quoted JSON string, at most 6 bytes per input byte
+ */
+static char* put_escaped(char* p, const char* str) {
+    static const char HEX[] = "0123456789abcdef";
     
-    for (size_t i = 0; i < len; i++) {
-        switch (str[i]) {
+    *p++ = '"';
+    for (; *str; str++) {
+        unsigned char c = (unsigned char)*str;
+        switch (c) {
             case '"':  *p++ = '\\'; *p++ = '"';  break;
             case '\\': *p++ = '\\'; *p++ = '\\'; break;
             case '\b': *p++ = '\\'; *p++ = 'b';  break;
@@ -69,170 +78,303 @@ static char* json_escape_string(const char* str) {
             case '\r': *p++ = '\\'; *p++ = 'r';  break;
             case '\t': *p++ = '\\'; *p++ = 't';  break;
             default:
-                if ((unsigned char)str[i] < 32) {
-                    sprintf(p, "\\u%04x", (unsigned char)str[i]);
-                    p += 6;
+                if (c < 32) {
+                    p = put_text(p, "\\u00");
+                    *p++ = HEX[c >> 4];
+                    *p++ = HEX[c & 0xF];
                 } else {
-                    *p++ = str[i];
+                    *p++ = (char)c;
                 }
         }
     }
-    
     *p++ = '"';
-    *p = '\0';
-    
-    return result;
+    return p;
 }
 
 
 /* ============================================================
- * Dynamic String Buffer
+ * JSON Serialization
  * ============================================================ */
 
+/**
+ * Whitespace used between JSON tokens: pretty output indents one object
+ * per line, line output keeps the whole document on a single line
+ */
 typedef struct {
-    char* data;
-    size_t size;
-    size_t capacity;
-} StringBuffer;
-
-static StringBuffer* buffer_create(void) {
-    StringBuffer* buf = (StringBuffer*)malloc(sizeof(StringBuffer));
-    if (buf == NULL) return NULL;
-    
-    buf->data = (char*)malloc(INITIAL_BUFFER_SIZE);
-    if (buf->data == NULL) {
-        free(buf);
-        return NULL;
-    }
-    
-    buf->data[0] = '\0';
-    buf->size = 0;
-    buf->capacity = INITIAL_BUFFER_SIZE;
-    
-    return buf;
-}
+    const char* newline;
+    const char* indent;         /* Top-level keys */
+    const char* item_indent;    /* Slot and run objects */
+    const char* field_indent;   /* Their fields */
+    const char* key_separator;  /* Between a key and its value */
+    const char* list_separator; /* Between array elements on one line */
+} JsonLayout;
 
-static void buffer_free(StringBuffer* buf) {
-    if (buf != NULL) {
-        if (buf->data != NULL) {
-            free(buf->data);
-        }
-        free(buf);
-    }
-}
+static const JsonLayout PRETTY_LAYOUT = { "\n", "  ", "    ", "      ", ": ", ", " };
+static const JsonLayout LINE_LAYOUT = { "", "", "", "", ":", "," };
 
-static int buffer_append(StringBuffer* buf, const char* str) {
-    if (buf == NULL || str == NULL) return -1;
-    
-    size_t len = strlen(str);
-    size_t required = buf->size + len + 1;
-    
-    /* Grow buffer if needed */
-    if (required > buf->capacity) {
-        size_t new_capacity = buf->capacity * BUFFER_GROW_FACTOR;
-        while (new_capacity < required) {
-            new_capacity *= BUFFER_GROW_FACTOR;
-        }
-        
-        char* new_data = (char*)realloc(buf->data, new_capacity);
-        if (new_data == NULL) return -1;
-        
-        buf->data = new_data;
-        buf->capacity = new_capacity;
+static size_t json_size_bound(const Timeline* timeline) {
+    size_t size = JSON_HEADER_MAX;
+    size += strlen(timeline->strategy);
+    size += 6 * strlen(timeline->error_message);
+    size += (size_t)timeline->num_unplaced * (JSON_INT_MAX + 2);
+    size += (size_t)timeline->num_slots * JSON_ITEM_MAX;
+    if (timeline->num_variants > 0) size += sizeof(",\"variants\":[]");
+    for (int i = 0; i < timeline->num_variants; i++) {
+        size += json_size_bound(timeline->variants[i]) + 1;
     }
-    
-    strcpy(buf->data + buf->size, str);
-    buf->size += len;
-    
-    return 0;
+    return size;
 }
 
-static int buffer_append_int(StringBuffer* buf, int value) {
-    char temp[32];
-    snprintf(temp, sizeof(temp), "%d", value);
-    return buffer_append(buf, temp);
+static char* put_key(char* p, const JsonLayout* layout, const char* indent,
+                     const char* key) {
+    p = put_text(p, indent);
+    *p++ = '"';
+    p = put_text(p, key);
+    *p++ = '"';
+    return put_text(p, layout->key_separator);
 }
 
-static char* buffer_detach(StringBuffer* buf) {
-    if (buf == NULL) return NULL;
-    char* result = buf->data;
-    buf->data = NULL;
-    buffer_free(buf);
-    return result;
+static char* put_separator(char* p, const JsonLayout* layout) {
+    *p++ = ',';
+    return put_text(p, layout->newline);
 }
 
+static char* put_item_start(char* p, const JsonLayout* layout, bool first) {
+    if (!first) {
+        *p++ = ',';
+        p = put_text(p, layout->newline);
+    }
+    p = put_text(p, layout->item_indent);
+    *p++ = '{';
+    return put_text(p, layout->newline);
+}
 
-/* ============================================================
- * JSON Serialization
- * ============================================================ */
+static char* put_item_end(char* p, const JsonLayout* layout) {
+    p = put_text(p, layout->newline);
+    p = put_text(p, layout->item_indent);
+    *p++ = '}';
+    return p;
+}
 
-char* timeline_to_json(Timeline* timeline) {
-    if (timeline == NULL) {
-        return NULL;
+static char* put_slots(char* p, const Timeline* timeline, const JsonLayout* layout) {
+    for (int i = 0; i < timeline->num_slots; i++) {
+        const TimeSlot* slot = &timeline->slots[i];
+        
+        p = put_item_start(p, layout, i == 0);
+        
+        p = put_key(p, layout, layout->field_indent, "slot_index");
+        p = put_int(p, slot->slot_index);
+        p = put_separator(p, layout);
+        
+        p = put_key(p, layout, layout->field_indent, "task_id");
+        p = put_int(p, slot->task_id);
+        p = put_separator(p, layout);
+        
+        p = put_key(p, layout, layout->field_indent, "energy_level");
+        p = put_int(p, slot->energy_level);
+        p = put_separator(p, layout);
+        
+        p = put_key(p, layout, layout->field_indent, "is_fixed");
+        p = put_bool(p, slot->is_fixed);
+        
+        p = put_item_end(p, layout);
     }
+    return p;
+}
+
+/**
+ * Write maximal runs of slots sharing a task and fixedness, leaving out
+ * free slots
+ */
+static char* put_runs(char* p, const Timeline* timeline, const JsonLayout* layout) {
+    bool first = true;
+    int start = 0;
     
-    StringBuffer* buf = buffer_create();
-    if (buf == NULL) return NULL;
+    while (start < timeline->num_slots) {
+        const TimeSlot* head = &timeline->slots[start];
+        int end = start + 1;
+        while (end < timeline->num_slots &&
+               timeline->slots[end].task_id == head->task_id &&
+               timeline->slots[end].is_fixed == head->is_fixed) {
+            end++;
+        }
+        
+        if (head->task_id >= 0 || head->is_fixed) {
+            p = put_item_start(p, layout, first);
+            first = false;
+            
+            p = put_key(p, layout, layout->field_indent, "task_id");
+            p = put_int(p, head->task_id);
+            p = put_separator(p, layout);
+            
+            p = put_key(p, layout, layout->field_indent, "start_slot");
+            p = put_int(p, start);
+            p = put_separator(p, layout);
+            
+            p = put_key(p, layout, layout->field_indent, "length");
+            p = put_int(p, end - start);
+            p = put_separator(p, layout);
+            
+            p = put_key(p, layout, layout->field_indent, "is_fixed");
+            p = put_bool(p, head->is_fixed);
+            
+            p = put_item_end(p, layout);
+        }
+        start = end;
+    }
+    return p;
+}
+
+/**
+ * Write one document, without a trailing newline
+ * @return Pointer past its closing brace
+ */
+static char* put_document(char* p, const Timeline* timeline, OutputFormat format) {
+    const JsonLayout* layout = format == OUTPUT_PRETTY ? &PRETTY_LAYOUT : &LINE_LAYOUT;
     
-    buffer_append(buf, "{\n");
+    *p++ = '{';
+    p = put_text(p, layout->newline);
     
     /* Success field */
-    buffer_append(buf, "  \"success\": ");
-    buffer_append(buf, timeline->success ? "true" : "false");
-    buffer_append(buf, ",\n");
+    p = put_key(p, layout, layout->indent, "success");
+    p = put_bool(p, timeline->success);
+    p = put_separator(p, layout);
     
     /* Error message (if any) */
-    buffer_append(buf, "  \"error_message\": ");
-    char* escaped_error = json_escape_string(timeline->error_message);
-    if (escaped_error) {
-        buffer_append(buf, escaped_error);
-        free(escaped_error);
-    } else {
-        buffer_append(buf, "\"\"");
+    p = put_key(p, layout, layout->indent, "error_message");
+    p = put_escaped(p, timeline->error_message);
+    p = put_separator(p, layout);
+    
+    /* Search budget outcome */
+    p = put_key(p, layout, layout->indent, "budget_exhausted");
+    p = put_bool(p, timeline->budget_exhausted);
+    p = put_separator(p, layout);
+    
+    p = put_key(p, layout, layout->indent, "unplaced_tasks");
+    *p++ = '[';
+    for (int i = 0; i < timeline->num_unplaced; i++) {
+        if (i > 0) p = put_text(p, layout->list_separator);
+        p = put_int(p, timeline->unplaced_task_ids[i]);
+    }
+    *p++ = ']';
+    p = put_separator(p, layout);
+    
+    p = put_key(p, layout, layout->indent, "engine");
+    p = put_escaped(p, solver_engine_to_string(timeline->engine));
+    p = put_separator(p, layout);
+    
+    p = put_key(p, layout, layout->indent, "strategy");
+    p = put_escaped(p, timeline->strategy);
+    p = put_separator(p, layout);
+    
+    /* Branch-and-bound outcome, only for requests with an objective */
+    if (timeline->objective != OBJECTIVE_FEASIBLE) {
+        p = put_key(p, layout, layout->indent, "objective");
+        p = put_escaped(p, solver_objective_to_string(timeline->objective));
+        p = put_separator(p, layout);
+        p = put_key(p, layout, layout->indent, "objective_value");
+        p = put_int64(p, timeline->objective_value);
+        p = put_separator(p, layout);
+        p = put_key(p, layout, layout->indent, "objective_bound");
+        p = put_int64(p, timeline->objective_bound);
+        p = put_separator(p, layout);
+    }
+    
+    /* Incremental outcome, only for requests with "previous" */
+    if (timeline->moved_tasks >= 0) {
+        p = put_key(p, layout, layout->indent, "moved_tasks");
+        p = put_int(p, timeline->moved_tasks);
+        p = put_separator(p, layout);
+        p = put_key(p, layout, layout->indent, "repaired");
+        p = put_bool(p, timeline->repaired);
+        p = put_separator(p, layout);
+    }
+    
+    /* Only answers from a result cache say so */
+    if (timeline->cache_hit) {
+        p = put_key(p, layout, layout->indent, "cache_hit");
+        p = put_bool(p, true);
+        p = put_separator(p, layout);
     }
-    buffer_append(buf, ",\n");
     
     /* Number of slots */
-    buffer_append(buf, "  \"num_slots\": ");
-    buffer_append_int(buf, timeline->num_slots);
-    buffer_append(buf, ",\n");
+    p = put_key(p, layout, layout->indent, "num_slots");
+    p = put_int(p, timeline->num_slots);
+    p = put_separator(p, layout);
     
-    /* Slots array */
-    buffer_append(buf, "  \"slots\": [\n");
+    /* Slot list, or only the occupied runs */
+    p = put_key(p, layout, layout->indent, format == OUTPUT_RUNS ? "runs" : "slots");
+    *p++ = '[';
+    p = put_text(p, layout->newline);
+    char* items = p;
+    p = format == OUTPUT_RUNS ? put_runs(p, timeline, layout) : put_slots(p, timeline, layout);
+    if (p != items) p = put_text(p, layout->newline);
+    p = put_text(p, layout->indent);
+    *p++ = ']';
     
-    for (int i = 0; i < timeline->num_slots; i++) {
-        TimeSlot* slot = &timeline->slots[i];
-        
-        buffer_append(buf, "    {\n");
-        
-        buffer_append(buf, "      \"slot_index\": ");
-        buffer_append_int(buf, slot->slot_index);
-        buffer_append(buf, ",\n");
-        
-        buffer_append(buf, "      \"task_id\": ");
-        buffer_append_int(buf, slot->task_id);
-        buffer_append(buf, ",\n");
-        
-        buffer_append(buf, "      \"energy_level\": ");
-        buffer_append_int(buf, slot->energy_level);
-        buffer_append(buf, ",\n");
-        
-        buffer_append(buf, "      \"is_fixed\": ");
-        buffer_append(buf, slot->is_fixed ? "true" : "false");
-        buffer_append(buf, "\n");
-        
-        buffer_append(buf, "    }");
-        
-        if (i < timeline->num_slots - 1) {
-            buffer_append(buf, ",");
+    /* What-if results, each a document of its own on one line */
+    if (timeline->num_variants > 0) {
+        OutputFormat variant_format = format == OUTPUT_PRETTY ? OUTPUT_COMPACT : format;
+        p = put_separator(p, layout);
+        p = put_key(p, layout, layout->indent, "variants");
+        *p++ = '[';
+        for (int i = 0; i < timeline->num_variants; i++) {
+            if (i > 0) *p++ = ',';
+            p = put_document(p, timeline->variants[i], variant_format);
         }
-        buffer_append(buf, "\n");
+        *p++ = ']';
     }
+    p = put_text(p, layout->newline);
     
-    buffer_append(buf, "  ]\n");
-    buffer_append(buf, "}\n");
+    *p++ = '}';
+    return p;
+}
+
+/**
+ * Write the whole document; buffer must hold json_size_bound() bytes
+ * @return Pointer to the terminating NUL
+ */
+static char* write_timeline(char* p, const Timeline* timeline, OutputFormat format) {
+    p = put_document(p, timeline, format);
+    *p++ = '\n';
+    *p = '\0';
+    return p;
+}
+
+char* timeline_to_json(Timeline* timeline) {
+    char* json = NULL;
+    size_t capacity = 0;
+    if (timeline_write_json(timeline, OUTPUT_PRETTY, &json, &capacity) < 0) {
+        free(json);
+        return NULL;
+    }
+    return json;
+}
+
+int timeline_write_json(const Timeline* timeline, OutputFormat format,
+                        char** buffer, size_t* capacity) {
+    if (timeline == NULL || buffer == NULL || capacity == NULL ||
+        format < 0 || format >= OUTPUT_FORMAT_COUNT) {
+        return -1;
+    }
     
-    return buffer_detach(buf);
+    size_t required = json_size_bound(timeline);
+    if (*buffer == NULL || *capacity < required) {
+        char* grown = (char*)realloc(*buffer, required);
+        if (grown == NULL) return -1;
+        *buffer = grown;
+        *capacity = required;
+    }
+    
+    char* end = write_timeline(*buffer, timeline, format);
+    return (int)(end - *buffer);
+}
+
+const char* output_format_to_string(OutputFormat format) {
+    if (format < 0 || format >= OUTPUT_FORMAT_COUNT) {
+        return "pretty";
+    }
+    return OUTPUT_FORMAT_STRINGS[format];
 }
 
 void free_json(char* json) {
@@ -273,6 +415,22 @@ static const char* parse_int(const char* p, int* value) {
     return p;
 }
 
+/**
+ * Parse a non-negative 64-bit JSON integer
+ * @return Pointer past the number, NULL if not a non-negative integer
+ */
+static const char* parse_int64(const char* p, int64_t* value) {
+    p = skip_whitespace(p);
+    if (*p < '0' || *p > '9') return NULL;
+    *value = 0;
+    while (*p >= '0' && *p <= '9') {
+        if (*value > (INT64_MAX - (*p - '0')) / 10) return NULL;
+        *value = *value * 10 + (*p - '0');
+        p++;
+    }
+    return p;
+}
+
 /**
  * Parse a JSON string (returns allocated string)
  */
@@ -321,20 +479,161 @@ static const char* parse_bool(const char* p, bool* value) {
     return NULL;
 }
 
+/* ============================================================
+ * JSON Tokenizer
+ * ============================================================ */
+
+/*
+ * Input is walked once, in place: readers step through the members of an
+ * object or the elements of an array, and callers dispatch on each key as
+ * it comes. Values a caller does not consume are skipped structurally, so
+ * a key is only ever matched inside the object it belongs to.
+ */
+
+/**
+ * Skip a JSON string
+ * @param p Pointer to the opening quote
+ * @return Pointer past the closing quote, NULL if unterminated
+ */
+static const char* skip_string(const char* p) {
+    for (p++; *p; p++) {
+        if (*p == '\\') {
+            if (*++p == '\0') return NULL;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return NULL;
+}
+
 /**
- * Find a key in JSON object
+ * Skip one JSON value of any type
+ * @param p Pointer to the first character of the value
+ * @return Pointer past the value, NULL if malformed
  */
-static const char* find_key(const char* p, const char* key) {
-    char search[256];
-    snprintf(search, sizeof(search), "\"%s\"", key);
+static const char* skip_value(const char* p) {
+    if (*p == '"') return skip_string(p);
+    
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (*p) {
+            if (*p == '"') {
+                p = skip_string(p);
+                if (p == NULL) return NULL;
+                continue;
+            }
+            if (*p == '{' || *p == '[') {
+                depth++;
+            } else if (*p == '}' || *p == ']') {
+                if (--depth == 0) return p + 1;
+            }
+            p++;
+        }
+        return NULL;
+    }
+    
+    /* Number or literal */
+    const char* start = p;
+    while (isalnum((unsigned char)*p) || *p == '-' || *p == '+' || *p == '.') p++;
+    return p != start ? p : NULL;
+}
+
+typedef struct {
+    const char* cursor;     /* Just past the opening bracket or the previous entry */
+    const char* key;        /* Current member key, without quotes, not terminated */
+    size_t key_length;
+    const char* value;      /* Current value */
+    const char* value_end;  /* Set by a caller that walked the value itself */
+    char close;             /* '}' for objects, ']' for arrays */
+    bool done;
+    bool malformed;
+} JsonReader;
+
+/**
+ * Start reading an object ('{') or array ('[')
+ * @return false (and malformed set) if p holds no such value
+ */
+static bool reader_begin(JsonReader* reader, const char* p, char open) {
+    memset(reader, 0, sizeof(*reader));
+    p = skip_whitespace(p);
+    if (*p != open) {
+        reader->done = true;
+        reader->malformed = true;
+        return false;
+    }
+    reader->cursor = p + 1;
+    reader->close = open == '{' ? '}' : ']';
+    return true;
+}
+
+/**
+ * Advance to the next member or element
+ * @return false at the closing bracket (cursor then points past it) or
+ *         on malformed input
+ */
+static bool reader_next(JsonReader* reader) {
+    if (reader->done) return false;
+    
+    const char* p = reader->cursor;
+    if (reader->value != NULL) {
+        p = reader->value_end != NULL ? reader->value_end : skip_value(reader->value);
+        if (p == NULL) goto malformed;
+        p = skip_whitespace(p);
+        if (*p == ',') {
+            p = skip_whitespace(p + 1);
+        } else if (*p != reader->close) {
+            goto malformed;
+        }
+    } else {
+        p = skip_whitespace(p);
+    }
+    
+    if (*p == reader->close) {
+        /* Also reached after a trailing comma, which is accepted */
+        reader->cursor = p + 1;
+        reader->done = true;
+        return false;
+    }
     
-    const char* found = strstr(p, search);
-    if (found == NULL) return NULL;
+    if (reader->close == '}') {
+        if (*p != '"') goto malformed;
+        const char* key_end = skip_string(p);
+        if (key_end == NULL) goto malformed;
+        reader->key = p + 1;
+        reader->key_length = (size_t)(key_end - p - 2);
+        p = skip_whitespace(key_end);
+        if (*p != ':') goto malformed;
+        p = skip_whitespace(p + 1);
+    }
+    
+    if (*p == '\0') goto malformed;
+    reader->value = p;
+    reader->value_end = NULL;
+    reader->cursor = p;
+    return true;
     
-    found += strlen(search);
-    found = skip_whitespace(found);
-    if (*found == ':') found++;
-    return skip_whitespace(found);
+malformed:
+    reader->done = true;
+    reader->malformed = true;
+    return false;
+}
+
+static bool key_is(const JsonReader* reader, const char* key) {
+    size_t length = strlen(key);
+    return reader->key_length == length && memcmp(reader->key, key, length) == 0;
+}
+
+/**
+ * Find a member of the top-level object
+ * @return Pointer to its value, NULL if absent or malformed
+ */
+static const char* find_member(const char* json_input, const char* key) {
+    JsonReader top;
+    if (!reader_begin(&top, json_input, '{')) return NULL;
+    while (reader_next(&top)) {
+        if (key_is(&top, key)) return top.value;
+    }
+    return NULL;
 }
 
 
@@ -342,35 +641,152 @@ static const char* find_key(const char* p, const char* key) {
  * JSON Input Parsing
  * ============================================================ */
 
+/* First allocation for the task and fixed slot arrays, doubled as they fill */
+#define INITIAL_ARRAY_CAPACITY 16
+
 /**
- * Count array elements in JSON
+ * Make room for one more element in a growing input array
+ * @return 0 on success, -1 if the array is full or allocation fails
  */
-static int count_array_elements(const char* p) {
-    if (*p != '[') return 0;
-    const char* start = p;
-    p++;
+static int reserve_element(Arena* arena, void** array, int count, int* capacity,
+                           int max_count, size_t element_size) {
+    if (count < *capacity) return 0;
+    if (count >= max_count) return -1;
     
-    int count = 0;
-    int depth = 0;
-    bool in_string = false;
+    int grown = *capacity > 0 ? *capacity * 2 : INITIAL_ARRAY_CAPACITY;
+    if (grown > max_count) grown = max_count;
     
-    while (*p) {
-        if (*p == '"' && (p == start || *(p-1) != '\\')) {
-            in_string = !in_string;
-        } else if (!in_string) {
-            if (*p == '{') {
-                if (depth == 0) count++;
-                depth++;
-            } else if (*p == '}') {
-                depth--;
-            } else if (*p == ']' && depth == 0) {
-                break;
+    void* resized = arena_realloc(arena, *array, (size_t)*capacity * element_size,
+                                  (size_t)grown * element_size);
+    if (resized == NULL) return -1;
+    *array = resized;
+    *capacity = grown;
+    return 0;
+}
+
+static void parse_task_fields(JsonReader* fields, Task* task) {
+    while (reader_next(fields)) {
+        const char* val = fields->value;
+        if (key_is(fields, "id")) {
+            parse_int(val, &task->id);
+        } else if (key_is(fields, "name")) {
+            parse_string(val, task->name, MAX_NAME_LEN);
+        } else if (key_is(fields, "type")) {
+            char type_str[64];
+            if (parse_string(val, type_str, sizeof(type_str))) {
+                int type = task_type_from_string(type_str);
+                if (type >= 0) task->type = (TaskType)type;
             }
+        } else if (key_is(fields, "duration_slots")) {
+            parse_int(val, &task->duration_slots);
+        } else if (key_is(fields, "priority")) {
+            parse_int(val, &task->priority);
+        } else if (key_is(fields, "deadline_slot")) {
+            parse_int(val, &task->deadline_slot);
+        } else if (key_is(fields, "is_fixed")) {
+            parse_bool(val, &task->is_fixed);
+        } else if (key_is(fields, "preferred_energy")) {
+            int energy;
+            parse_int(val, &energy);
+            task->preferred_energy = (PreferredEnergy)energy;
         }
-        p++;
     }
+}
+
+/**
+ * Base task a variant's task entry changes
+ * @return Task with the entry's "id", NULL if none
+ */
+static const Task* find_base_task(JsonReader fields, const Task* base, int num_base) {
+    while (reader_next(&fields)) {
+        if (key_is(&fields, "id")) {
+            int id;
+            parse_int(fields.value, &id);
+            for (int i = 0; i < num_base; i++) {
+                if (base[i].id == id) return &base[i];
+            }
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Parse the "tasks" array
+ * @param parent Reader positioned on the member holding the array; its
+ *               value_end is set past the array
+ * @param base Tasks of a what-if base: an entry with the ID of one of
+ *             them starts from its fields, NULL for none
+ */
+static int parse_task_array(JsonReader* parent, Arena* arena, Task** tasks,
+                            int* num_tasks, const Task* base, int num_base) {
+    JsonReader items;
+    if (!reader_begin(&items, parent->value, '[')) return -1;
+    
+    int capacity = 0;
+    while (reader_next(&items)) {
+        JsonReader fields;
+        if (!reader_begin(&fields, items.value, '{')) return -1;
+        if (reserve_element(arena, (void**)tasks, *num_tasks, &capacity,
+                            solver_task_capacity(), sizeof(Task)) != 0) {
+            return -1;
+        }
+        
+        Task* task = &(*tasks)[*num_tasks];
+        const Task* changed = base != NULL ? find_base_task(fields, base, num_base) : NULL;
+        if (changed != NULL) {
+            *task = *changed;
+        } else {
+            task_init(task);
+        }
+        parse_task_fields(&fields, task);
+        if (fields.malformed) return -1;
+        
+        (*num_tasks)++;
+        items.value_end = fields.cursor;
+    }
+    if (items.malformed) return -1;
     
-    return count;
+    parent->value_end = items.cursor;
+    return 0;
+}
+
+/**
+ * Parse the "fixed_slots" array
+ */
+static int parse_fixed_slot_array(JsonReader* parent, Arena* arena,
+                                  TimeSlot** fixed_slots, int* num_fixed) {
+    JsonReader items;
+    if (!reader_begin(&items, parent->value, '[')) return -1;
+    
+    int capacity = 0;
+    while (reader_next(&items)) {
+        JsonReader fields;
+        if (!reader_begin(&fields, items.value, '{')) return -1;
+        if (reserve_element(arena, (void**)fixed_slots, *num_fixed, &capacity, MAX_SLOTS,
+                            sizeof(TimeSlot)) != 0) {
+            return -1;
+        }
+        
+        TimeSlot* slot = &(*fixed_slots)[*num_fixed];
+        timeslot_init(slot, *num_fixed);
+        while (reader_next(&fields)) {
+            if (key_is(&fields, "slot_index")) {
+                parse_int(fields.value, &slot->slot_index);
+            } else if (key_is(&fields, "task_id")) {
+                parse_int(fields.value, &slot->task_id);
+            }
+        }
+        if (fields.malformed) return -1;
+        slot->is_fixed = true;
+        
+        (*num_fixed)++;
+        items.value_end = fields.cursor;
+    }
+    if (items.malformed) return -1;
+    
+    parent->value_end = items.cursor;
+    return 0;
 }
 
 int parse_json_input(
@@ -378,7 +794,8 @@ int parse_json_input(
     Task** tasks,
     int* num_tasks,
     TimeSlot** fixed_slots,
-    int* num_fixed
+    int* num_fixed,
+    Arena* arena
 ) {
     if (json_input == NULL || tasks == NULL || num_tasks == NULL ||
         fixed_slots == NULL || num_fixed == NULL) {
@@ -390,117 +807,368 @@ int parse_json_input(
     *fixed_slots = NULL;
     *num_fixed = 0;
     
-    /* Find tasks array */
-    const char* tasks_start = find_key(json_input, "tasks");
-    if (tasks_start && *tasks_start == '[') {
-        int count = count_array_elements(tasks_start);
-        if (count > 0 && count <= MAX_TASKS) {
-            *tasks = task_array_create(count);
-            if (*tasks == NULL) return -1;
-            *num_tasks = count;
-            
-            /* Parse each task */
-            const char* p = tasks_start + 1;
-            for (int i = 0; i < count; i++) {
-                p = skip_whitespace(p);
-                if (*p != '{') break;
-                
-                /* Find end of this object */
-                const char* obj_start = p;
-                int depth = 1;
-                p++;
-                while (*p && depth > 0) {
-                    if (*p == '{') depth++;
-                    else if (*p == '}') depth--;
-                    p++;
-                }
-                
-                /* Parse task fields */
-                Task* task = &(*tasks)[i];
-                const char* val;
-                
-                if ((val = find_key(obj_start, "id"))) {
-                    parse_int(val, &task->id);
-                }
-                if ((val = find_key(obj_start, "name"))) {
-                    parse_string(val, task->name, MAX_NAME_LEN);
-                }
-                if ((val = find_key(obj_start, "type"))) {
-                    char type_str[64];
-                    parse_string(val, type_str, sizeof(type_str));
-                    int type = task_type_from_string(type_str);
-                    if (type >= 0) task->type = (TaskType)type;
-                }
-                if ((val = find_key(obj_start, "duration_slots"))) {
-                    parse_int(val, &task->duration_slots);
-                }
-                if ((val = find_key(obj_start, "priority"))) {
-                    parse_int(val, &task->priority);
-                }
-                if ((val = find_key(obj_start, "deadline_slot"))) {
-                    parse_int(val, &task->deadline_slot);
-                }
-                if ((val = find_key(obj_start, "is_fixed"))) {
-                    parse_bool(val, &task->is_fixed);
-                }
-                if ((val = find_key(obj_start, "preferred_energy"))) {
-                    int energy;
-                    parse_int(val, &energy);
-                    task->preferred_energy = (PreferredEnergy)energy;
-                }
-                
-                /* Skip comma */
-                p = skip_whitespace(p);
-                if (*p == ',') p++;
+    JsonReader top;
+    bool failed = !reader_begin(&top, json_input, '{');
+    bool seen_tasks = false;
+    bool seen_fixed = false;
+    
+    while (!failed && reader_next(&top)) {
+        if (key_is(&top, "tasks") && !seen_tasks) {
+            seen_tasks = true;
+            failed = parse_task_array(&top, arena, tasks, num_tasks, NULL, 0) != 0;
+        } else if (key_is(&top, "fixed_slots") && !seen_fixed) {
+            seen_fixed = true;
+            failed = parse_fixed_slot_array(&top, arena, fixed_slots, num_fixed) != 0;
+        }
+    }
+    
+    if (failed || top.malformed) {
+        arena_free(arena, *tasks);
+        arena_free(arena, *fixed_slots);
+        *tasks = NULL;
+        *num_tasks = 0;
+        *fixed_slots = NULL;
+        *num_fixed = 0;
+        return -1;
+    }
+    return 0;
+}
+
+int parse_previous_placements(const char* json_input, TaskPlacement** previous,
+                              int* num_previous, Arena* arena) {
+    *previous = NULL;
+    *num_previous = 0;
+    
+    const char* value = find_member(json_input, "previous");
+    if (value == NULL) return 0;
+    
+    JsonReader items;
+    bool failed = !reader_begin(&items, value, '[');
+    int capacity = 0;
+    while (!failed && reader_next(&items)) {
+        JsonReader fields;
+        TaskPlacement placement = { -1, -1 };
+        bool is_fixed = false;
+        if (!reader_begin(&fields, items.value, '{')) {
+            failed = true;
+            break;
+        }
+        while (reader_next(&fields)) {
+            if (key_is(&fields, "task_id")) {
+                parse_int(fields.value, &placement.task_id);
+            } else if (key_is(&fields, "start_slot")) {
+                parse_int(fields.value, &placement.start_slot);
+            } else if (key_is(&fields, "is_fixed")) {
+                parse_bool(fields.value, &is_fixed);
             }
         }
+        items.value_end = fields.cursor;
+        if (fields.malformed) {
+            failed = true;
+        } else if (!is_fixed && placement.task_id >= 0 && placement.start_slot >= 0) {
+            /* Fixed runs of a "runs" response are not task placements */
+            failed = reserve_element(arena, (void**)previous, *num_previous, &capacity,
+                                     MAX_SLOTS, sizeof(TaskPlacement)) != 0;
+            if (!failed) (*previous)[(*num_previous)++] = placement;
+        }
+    }
+    
+    if (failed || items.malformed) {
+        arena_free(arena, *previous);
+        *previous = NULL;
+        *num_previous = 0;
+        return -1;
     }
+    return 0;
+}
+
+/**
+ * Parse an array of integers of any length
+ * @param parent Reader positioned on the member holding the array; its
+ *               value_end is set past the array
+ */
+static int parse_int_list(JsonReader* parent, Arena* arena, int** values, int* count,
+                          int max_count) {
+    JsonReader items;
+    if (!reader_begin(&items, parent->value, '[')) return -1;
     
-    /* Find fixed_slots array */
-    const char* fixed_start = find_key(json_input, "fixed_slots");
-    if (fixed_start && *fixed_start == '[') {
-        int count = count_array_elements(fixed_start);
-        if (count > 0 && count <= MAX_SLOTS) {
-            *fixed_slots = timeslot_array_create(count);
-            if (*fixed_slots == NULL) {
-                task_array_free(*tasks);
-                *tasks = NULL;
-                *num_tasks = 0;
+    int capacity = 0;
+    while (reader_next(&items)) {
+        const char* end = items.value;
+        if (*end == '-') end++;
+        if (!isdigit((unsigned char)*end) ||
+            reserve_element(arena, (void**)values, *count, &capacity, max_count,
+                            sizeof(int)) != 0) {
+            return -1;
+        }
+        items.value_end = parse_int(items.value, &(*values)[(*count)++]);
+    }
+    if (items.malformed) return -1;
+    
+    parent->value_end = items.cursor;
+    return 0;
+}
+
+/**
+ * Parse the members of one variant object; a member given twice keeps
+ * its first value
+ */
+static int parse_variant_fields(JsonReader* fields, const Task* tasks, int num_tasks,
+                                RequestVariant* variant, Arena* arena) {
+    bool seen_removed = false;
+    bool seen_tasks = false;
+    bool seen_fixed = false;
+    bool seen_released = false;
+    while (reader_next(fields)) {
+        int status = 0;
+        if (key_is(fields, "remove_tasks") && !seen_removed) {
+            seen_removed = true;
+            status = parse_int_list(fields, arena, &variant->removed_tasks,
+                                    &variant->num_removed_tasks, solver_task_capacity());
+        } else if (key_is(fields, "tasks") && !seen_tasks) {
+            seen_tasks = true;
+            status = parse_task_array(fields, arena, &variant->tasks, &variant->num_tasks,
+                                      tasks, num_tasks);
+        } else if (key_is(fields, "fixed_slots") && !seen_fixed) {
+            seen_fixed = true;
+            status = parse_fixed_slot_array(fields, arena, &variant->fixed_slots,
+                                            &variant->num_fixed);
+        } else if (key_is(fields, "remove_fixed_slots") && !seen_released) {
+            seen_released = true;
+            status = parse_int_list(fields, arena, &variant->released_slots,
+                                    &variant->num_released_slots, MAX_SLOTS);
+        }
+        if (status != 0) return -1;
+    }
+    return fields->malformed ? -1 : 0;
+}
+
+int parse_request_variants(const char* json_input, const Task* tasks, int num_tasks,
+                           RequestVariant** variants, int* num_variants, Arena* arena) {
+    *variants = NULL;
+    *num_variants = 0;
+    
+    const char* value = find_member(json_input, "variants");
+    if (value == NULL) return 0;
+    
+    JsonReader items;
+    bool failed = !reader_begin(&items, value, '[');
+    int capacity = 0;
+    while (!failed && reader_next(&items)) {
+        JsonReader fields;
+        if (!reader_begin(&fields, items.value, '{') ||
+            reserve_element(arena, (void**)variants, *num_variants, &capacity, MAX_VARIANTS,
+                            sizeof(RequestVariant)) != 0) {
+            failed = true;
+            break;
+        }
+        RequestVariant* variant = &(*variants)[(*num_variants)++];
+        memset(variant, 0, sizeof(*variant));
+        failed = parse_variant_fields(&fields, tasks, num_tasks, variant, arena) != 0;
+        items.value_end = fields.cursor;
+    }
+    
+    if (failed || items.malformed) {
+        request_variants_free(*variants, *num_variants, arena);
+        *variants = NULL;
+        *num_variants = 0;
+        return -1;
+    }
+    return 0;
+}
+
+
+/* ============================================================
+ * Solver Options Parsing
+ * ============================================================ */
+
+/**
+ * Parse a JSON array of integers into dest
+ * @return Number of elements parsed, -1 if malformed or too long
+ */
+static int parse_int_array(const char* p, int* dest, int max_count) {
+    p = skip_whitespace(p);
+    if (*p != '[') return -1;
+    p = skip_whitespace(p + 1);
+    
+    int count = 0;
+    if (*p == ']') return 0;
+    
+    while (*p) {
+        if (count >= max_count) return -1;
+        if (*p != '-' && (*p < '0' || *p > '9')) return -1;
+        p = parse_int(p, &dest[count++]);
+        p = skip_whitespace(p);
+        if (*p == ',') {
+            p = skip_whitespace(p + 1);
+        } else if (*p == ']') {
+            return count;
+        } else {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Apply one top-level member to the solver options
+ * @return 0 if valid (or not an option), -1 on an invalid value
+ */
+static int parse_solver_option(const JsonReader* member, SolverOptions* options) {
+    const char* val = member->value;
+    
+    if (key_is(member, "energy_curve")) {
+        int curve[SLOTS_PER_DAY];
+        if (parse_int_array(val, curve, SLOTS_PER_DAY) != SLOTS_PER_DAY) {
+            return -1;
+        }
+        for (int i = 0; i < SLOTS_PER_DAY; i++) {
+            if (curve[i] < ENERGY_LEVEL_MIN || curve[i] > ENERGY_LEVEL_MAX) {
                 return -1;
             }
-            *num_fixed = count;
-            
-            /* Parse each fixed slot */
-            const char* p = fixed_start + 1;
-            for (int i = 0; i < count; i++) {
-                p = skip_whitespace(p);
-                if (*p != '{') break;
-                
-                const char* obj_start = p;
-                int depth = 1;
-                p++;
-                while (*p && depth > 0) {
-                    if (*p == '{') depth++;
-                    else if (*p == '}') depth--;
-                    p++;
-                }
-                
-                TimeSlot* slot = &(*fixed_slots)[i];
-                const char* val;
-                
-                if ((val = find_key(obj_start, "slot_index"))) {
-                    parse_int(val, &slot->slot_index);
-                }
-                if ((val = find_key(obj_start, "task_id"))) {
-                    parse_int(val, &slot->task_id);
-                }
-                slot->is_fixed = true;
-                
-                p = skip_whitespace(p);
-                if (*p == ',') p++;
-            }
+            options->energy_curve[i] = (uint8_t)curve[i];
+        }
+        options->has_energy_curve = true;
+    }
+    
+    /* Search budget */
+    else if (key_is(member, "max_nodes")) {
+        if (parse_int64(val, &options->max_nodes) == NULL) return -1;
+    } else if (key_is(member, "max_time_us")) {
+        if (parse_int64(val, &options->max_time_us) == NULL) return -1;
+    }
+    
+    /* Search strategy */
+    else if (key_is(member, "forward_checking")) {
+        if (parse_bool(val, &options->forward_checking) == NULL) return -1;
+    } else if (key_is(member, "backjumping")) {
+        if (parse_bool(val, &options->backjumping) == NULL) return -1;
+    } else if (key_is(member, "max_nogoods")) {
+        parse_int(val, &options->max_nogoods);
+        if (options->max_nogoods < 0 || options->max_nogoods > MAX_NOGOODS) return -1;
+    }
+    
+    /* Engine selection */
+    else if (key_is(member, "engine")) {
+        char engine_str[16];
+        if (parse_string(val, engine_str, sizeof(engine_str)) == NULL) return -1;
+        int engine = solver_engine_from_string(engine_str);
+        if (engine < 0) return -1;
+        options->engine = (SolverEngine)engine;
+    } else if (key_is(member, "local_search_moves")) {
+        if (parse_int64(val, &options->local_search_moves) == NULL) return -1;
+    } else if (key_is(member, "seed")) {
+        int64_t seed;
+        if (parse_int64(val, &seed) == NULL) return -1;
+        options->seed = (uint64_t)seed;
+    } else if (key_is(member, "tie_break_seed")) {
+        int64_t seed;
+        if (parse_int64(val, &seed) == NULL || seed > UINT32_MAX) return -1;
+        options->tie_break_seed = (uint32_t)seed;
+    }
+    
+    /* Branch and bound */
+    else if (key_is(member, "objective")) {
+        char objective_str[32];
+        if (parse_string(val, objective_str, sizeof(objective_str)) == NULL) return -1;
+        int objective = solver_objective_from_string(objective_str);
+        if (objective < 0) return -1;
+        options->objective = (SolverObjective)objective;
+    } else if (key_is(member, "weight_by_priority")) {
+        if (parse_bool(val, &options->weight_by_priority) == NULL) return -1;
+    }
+    
+    /* Horizon, checked as a whole once every member is read */
+    else if (key_is(member, "num_days")) {
+        parse_int(val, &options->num_days);
+    } else if (key_is(member, "slot_minutes")) {
+        parse_int(val, &options->slot_minutes);
+    } else if (key_is(member, "start_slot_of_day")) {
+        parse_int(val, &options->start_slot_of_day);
+    }
+    
+    /* Portfolio */
+    else if (key_is(member, "threads")) {
+        parse_int(val, &options->threads);
+        if (options->threads < 0 || options->threads > MAX_PORTFOLIO_THREADS) return -1;
+    } else if (key_is(member, "search_threads")) {
+        parse_int(val, &options->search_threads);
+        if (options->search_threads < 0 || options->search_threads > MAX_PORTFOLIO_THREADS) {
+            return -1;
         }
     }
     
     return 0;
 }
+
+int parse_solver_options(const char* json_input, SolverOptions* options) {
+    if (json_input == NULL || options == NULL) {
+        return -1;
+    }
+    
+    solver_options_init(options);
+    
+    JsonReader top;
+    if (!reader_begin(&top, json_input, '{')) return -1;
+    while (reader_next(&top)) {
+        if (parse_solver_option(&top, options) != 0) return -1;
+    }
+    if (horizon_num_slots(options->num_days, options->slot_minutes,
+                          options->start_slot_of_day) < 0) {
+        return -1;
+    }
+    return top.malformed ? -1 : 0;
+}
+
+int parse_request_id(const char* json_input, char* id, size_t size) {
+    if (json_input == NULL || id == NULL || size == 0) return -1;
+    
+    const char* val = find_member(json_input, "request_id");
+    if (val == NULL) return 0;
+    
+    /* Copy the raw token so the echoed id keeps its JSON type */
+    const char* end = skip_value(val);
+    if (end == NULL) return -1;
+    if (*val != '"') {
+        const char* digit = *val == '-' ? val + 1 : val;
+        if (digit == end) return -1;
+        for (; digit < end; digit++) {
+            if (!isdigit((unsigned char)*digit)) return -1;
+        }
+    }
+    
+    size_t length = (size_t)(end - val);
+    if (length >= size) return -1;
+    memcpy(id, val, length);
+    id[length] = '\0';
+    return (int)length;
+}
+
+int parse_template_name(const char* json_input, const char* key, char* name, size_t size) {
+    if (json_input == NULL || key == NULL || name == NULL || size == 0) return -1;
+    
+    const char* val = find_member(json_input, key);
+    if (val == NULL) return 0;
+    
+    /* A name cut short by the buffer would match another template */
+    const char* end = parse_string(val, name, size);
+    if (end == NULL || end != skip_value(val) || name[0] == '\0') return -1;
+    return (int)strlen(name);
+}
+
+int parse_output_format(const char* json_input, OutputFormat* format) {
+    if (json_input == NULL || format == NULL) return -1;
+    
+    const char* val = find_member(json_input, "output_format");
+    if (val == NULL) return 0;
+    
+    char name[16];
+    if (parse_string(val, name, sizeof(name)) == NULL) return -1;
+    for (int i = 0; i < OUTPUT_FORMAT_COUNT; i++) {
+        if (strcmp(name, OUTPUT_FORMAT_STRINGS[i]) == 0) {
+            *format = (OutputFormat)i;
+            return 0;
+        }
+    }
+    return -1;
+}
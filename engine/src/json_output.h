@@ -10,16 +10,60 @@
 #define JSON_OUTPUT_H
 
 #include "scheduler.h"
+#include "variants.h"
+#include <stddef.h>
 
 /**
- * Serialize a Timeline to JSON string
+ * JSON output formats
+ */
+typedef enum {
+    OUTPUT_PRETTY = 0,      /* Indented, one object per slot */
+    OUTPUT_COMPACT = 1,     /* Same document on a single line */
+    OUTPUT_RUNS = 2,        /* Single line, "runs" of occupied slots instead of "slots" */
+    OUTPUT_FORMAT_COUNT = 3
+} OutputFormat;
+
+/**
+ * Serialize a Timeline to JSON string (pretty format)
  * @param timeline Timeline to serialize
  * @return JSON string, caller must free with free_json()
  */
 char* timeline_to_json(Timeline* timeline);
 
 /**
- * Free JSON string allocated by timeline_to_json
+ * Serialize a Timeline into a caller-owned buffer that is reused across
+ * calls. The buffer is grown once, to an upper bound of the output size,
+ * before writing. The output is newline-terminated.
+ * In OUTPUT_RUNS, "runs" lists {task_id, start_slot, length, is_fixed} for
+ * each maximal stretch of slots sharing a task and fixedness, leaving out
+ * free slots.
+ * @param timeline Timeline to serialize
+ * @param format Output format
+ * @param buffer In/out: buffer from a previous call, or NULL to allocate;
+ *               caller must free with free_json()
+ * @param capacity In/out: allocated size of *buffer
+ * @return Length written (excluding the terminator), -1 on error
+ */
+int timeline_write_json(const Timeline* timeline, OutputFormat format,
+                        char** buffer, size_t* capacity);
+
+/**
+ * Convert OutputFormat to its "output_format" name
+ * @param format Output format
+ * @return Name ("pretty", "compact", "runs")
+ */
+const char* output_format_to_string(OutputFormat format);
+
+/**
+ * Parse the top-level "output_format" key
+ * @param json_input JSON string input
+ * @param format Output: format, left unchanged if the key is absent
+ * @return 0 on success, -1 on an unknown format name
+ */
+int parse_output_format(const char* json_input, OutputFormat* format);
+
+/**
+ * Free JSON string allocated by timeline_to_json or timeline_write_json
  * @param json JSON string to free
  */
 void free_json(char* json);
@@ -27,10 +71,11 @@ void free_json(char* json);
 /**
  * Parse JSON input to create tasks and fixed slots
  * @param json_input JSON string input
- * @param tasks Output: array of tasks (caller must free)
+ * @param tasks Output: array of tasks (caller must arena_free)
  * @param num_tasks Output: number of tasks
- * @param fixed_slots Output: array of fixed slots (caller must free)
+ * @param fixed_slots Output: array of fixed slots (caller must arena_free)
  * @param num_fixed Output: number of fixed slots
+ * @param arena Arena holding the arrays, NULL for the heap
  * @return 0 on success, -1 on error
  */
 int parse_json_input(
@@ -38,7 +83,79 @@ int parse_json_input(
     Task** tasks,
     int* num_tasks,
     TimeSlot** fixed_slots,
-    int* num_fixed
+    int* num_fixed,
+    Arena* arena
 );
 
+/**
+ * Parse the top-level "previous" array of an incremental request: objects
+ * with "task_id" and "start_slot", such as the "runs" of an earlier
+ * response (entries with "is_fixed": true are skipped)
+ * @param json_input JSON string input
+ * @param previous Output: placements (caller must arena_free), NULL if none
+ * @param num_previous Output: number of placements
+ * @param arena Arena holding the placements, NULL for the heap
+ * @return 0 on success (also when absent), -1 if malformed
+ */
+int parse_previous_placements(const char* json_input, TaskPlacement** previous,
+                              int* num_previous, Arena* arena);
+
+/**
+ * Parse the top-level "variants" array of a what-if request (variants.h).
+ * Each object may hold "remove_tasks" (task IDs), "tasks" (task objects;
+ * one with the ID of a base task replaces it, starting from its fields,
+ * so only the changed ones need to be given), "fixed_slots" (slot
+ * objects) and "remove_fixed_slots" (slot indices).
+ * @param json_input JSON string input
+ * @param tasks Base tasks, as parsed by parse_json_input
+ * @param num_tasks Number of base tasks
+ * @param variants Output: variants (caller must request_variants_free),
+ *                 NULL if none
+ * @param num_variants Output: number of variants, at most MAX_VARIANTS
+ * @param arena Arena holding the variants, NULL for the heap
+ * @return 0 on success (also when absent or empty), -1 if malformed
+ */
+int parse_request_variants(const char* json_input, const Task* tasks, int num_tasks,
+                           RequestVariant** variants, int* num_variants, Arena* arena);
+
+/**
+ * Parse top-level solver options from JSON input
+ * Recognized keys: "energy_curve" (SLOTS_PER_DAY levels 1-10),
+ * "max_nodes" and "max_time_us" (search budget, 0 for unlimited),
+ * "forward_checking" and "backjumping" (bool), "max_nogoods",
+ * "engine" ("backtrack", "greedy", "auto"), "local_search_moves", "seed",
+ * "tie_break_seed", "threads" (portfolio workers), "search_threads"
+ * (threads splitting one search), "objective" ("feasible",
+ * "maximize_energy_fit"), "weight_by_priority" (bool), and the horizon: "num_days" (1 to
+ * MAX_DAYS), "slot_minutes" (15, 30 or 60) and "start_slot_of_day".
+ * Missing keys keep the defaults from solver_options_init().
+ * @param json_input JSON string input
+ * @param options Output: solver options
+ * @return 0 on success, -1 on invalid option values
+ */
+int parse_solver_options(const char* json_input, SolverOptions* options);
+
+/**
+ * Extract the "request_id" of a request as its raw JSON token (a string
+ * with its quotes, or an integer) so responses can echo it unchanged
+ * @param json_input JSON string input
+ * @param id Output: NUL-terminated token
+ * @param size Size of id, including the terminator
+ * @return Token length, 0 if the key is absent, -1 if invalid or too long
+ */
+int parse_request_id(const char* json_input, char* id, size_t size);
+
+/**
+ * Parse the name of a fixed-slot template (templates.h), the string value
+ * of "fixed_template" (a request applying it) or "register_template" (a
+ * request registering its fixed slots under the name)
+ * @param json_input JSON string input
+ * @param key Key to read
+ * @param name Output: NUL-terminated name
+ * @param size Size of name, including the terminator
+ * @return Name length, 0 if the key is absent, -1 if not a non-empty
+ *         string that fits
+ */
+int parse_template_name(const char* json_input, const char* key, char* name, size_t size);
+
 #endif /* JSON_OUTPUT_H */
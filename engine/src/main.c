@@ -1,76 +1,1083 @@
 /**
  * AESA Core Scheduling Engine - Main Entry Point
- * 
+ *
  * Reads JSON input from stdin, runs optimization, outputs JSON to stdout.
- * 
- * Usage: ./scheduler < input.json > output.json
+ *
+ * Usage: ./scheduler [--binary] [--templates FILE] < input.json > output.json
+ *        ./scheduler --serve [--socket PATH] [--binary] [--templates FILE]
+ *        ./scheduler --batch FILE [--jobs N] [--templates FILE]
+ *
+ * Serve mode keeps the process alive and answers a stream of requests,
+ * one line of JSON per request, from stdin or from clients connecting to
+ * a Unix domain socket. A request is either one line of JSON or a line
+ * holding its byte length followed by that many bytes of JSON.
+ *
+ * Batch mode memory-maps FILE, one request per line, solves the lines on
+ * N threads and writes one response line per request as each finishes.
+ * Responses carry the request's "request_id" (its line number if absent).
+ *
+ * --binary switches requests and responses of one-shot and serve mode to
+ * the wire format of wire.h; binary messages frame themselves, so serve
+ * mode reads them back to back. Errors come back as responses with
+ * error_length set.
+ *
+ * Fixed-slot templates (templates.h) let requests share fixed slots.
+ * A request with "register_template": NAME (or WIRE_REGISTER_TEMPLATE)
+ * and no tasks registers its fixed_slots and horizon under NAME and is
+ * answered with the template's timeline; later requests with
+ * "fixed_template": NAME (or WIRE_TEMPLATE) start from it and apply their
+ * own fixed_slots on top. --templates FILE registers one such request per
+ * line at startup; batch mode only accepts templates that way, as its
+ * lines are solved concurrently.
+ *
+ * A JSON request with "variants" is a what-if request (variants.h): the
+ * base problem is solved once, then each variant on its own thread, and
+ * the response adds their documents as "variants", in request order.
+ * What-if results are not cached.
+ *
+ * Serve mode answers repeated requests from a result cache (cache.h) and
+ * writes its hit and miss counts to stderr when it stops. Serve mode and
+ * each batch worker parse and solve into one arena (arena.h), reset after
+ * every response.
+ *
+ * Built with AESA_STATS (make STATS=1), every JSON response starts with a
+ * "stats" object: the search counters of its Timeline (SolverStats) and
+ * the time spent parsing, solving and serializing it.
+ *
+ * Environment: AESA_THREADS sets the portfolio thread count for requests
+ * that do not give "threads". AESA_CACHE_MB bounds the serve mode result
+ * cache (default 16, 0 disables it). AESA_MAX_TASKS sets the largest
+ * task count a request may hold (default 20000).
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "scheduler.h"
+#include "cache.h"
 #include "json_output.h"
+#include "templates.h"
+#include "variants.h"
+#include "wire.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 
-#define MAX_INPUT_SIZE (1024 * 1024)  /* 1MB max input */
+#define MAX_INPUT_SIZE (64 * 1024 * 1024)  /* Largest accepted request */
+#define INITIAL_INPUT_SIZE (64 * 1024)     /* First stdin read buffer, doubled as needed */
+#define SOCKET_BACKLOG 8
+#define MAX_REQUEST_ID_LEN 128
+#define MAX_BATCH_JOBS 64
 
-int main(int argc, char* argv[]) {
-    (void)argc;  /* Unused */
-    (void)argv;  /* Unused */
-    
-    /* Read JSON input from stdin */
-    char* input = (char*)malloc(MAX_INPUT_SIZE);
-    if (input == NULL) {
-        fprintf(stderr, "{\"success\": false, \"error_message\": \"Memory allocation failed\"}\n");
-        return 1;
+/* Phase timings of one JSON request, reported with AESA_STATS */
+typedef struct {
+    int64_t start_ns;           /* Parsing started */
+    int64_t parsed_ns;          /* Solving started */
+    int64_t solved_ns;          /* Serializing started */
+    int64_t serialized_ns;      /* Response serialized */
+} RequestClock;
+
+#ifdef AESA_STATS
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#define CLOCK_MARK(clock, field) \
+    ((clock) != NULL ? (void)((clock)->field = monotonic_ns()) : (void)0)
+#else
+#define CLOCK_MARK(clock, field) ((void)(clock))
+#endif
+
+/* Buffers kept across requests in serve and batch modes */
+typedef struct {
+    char* request;
+    size_t request_capacity;
+    char* response;
+    size_t response_capacity;
+    Arena arena;                /* Memory of the request being solved */
+    RequestClock clock;         /* Timings of the request being solved */
+} ServeBuffers;
+
+static void serve_buffers_init(ServeBuffers* buffers) {
+    buffers->request = NULL;
+    buffers->request_capacity = 0;
+    buffers->response = NULL;
+    buffers->response_capacity = 0;
+    arena_init(&buffers->arena);
+    memset(&buffers->clock, 0, sizeof(buffers->clock));
+}
+
+static void serve_buffers_free(ServeBuffers* buffers) {
+    free(buffers->request);
+    free_json(buffers->response);
+    arena_destroy(&buffers->arena);
+}
+
+static void apply_environment(SolverOptions* options) {
+    if (options->threads == 0) {
+        options->threads = solver_threads_from_environment();
     }
-    
-    size_t total_read = 0;
-    size_t bytes_read;
-    
-    while ((bytes_read = fread(input + total_read, 1, MAX_INPUT_SIZE - total_read - 1, stdin)) > 0) {
-        total_read += bytes_read;
-        if (total_read >= MAX_INPUT_SIZE - 1) break;
+}
+
+/**
+ * Solve a parsed request, taking ownership of its arrays
+ * @param previous Placements of an incremental request, NULL for a full solve
+ * @param cache Result cache of serve mode, NULL to always solve
+ * @param arena Arena holding the arrays and receiving the result, NULL for the heap
+ * @param error Output: message when NULL is returned
+ * @return Timeline (caller must free), or NULL on failure
+ */
+static Timeline* solve_parsed(Task* tasks, int num_tasks, TimeSlot* fixed_slots,
+                              int num_fixed, TaskPlacement* previous, int num_previous,
+                              SolverOptions* options, ResultCache* cache, Arena* arena,
+                              const char** error) {
+    apply_environment(options);
+    options->arena = arena;
+
+    /* Run optimization */
+    Timeline* timeline = result_cache_solve(cache, tasks, num_tasks, fixed_slots,
+                                            &num_fixed, previous, num_previous, options);
+
+    /* Cleanup input data */
+    arena_free(arena, tasks);
+    arena_free(arena, fixed_slots);
+    arena_free(arena, previous);
+
+    if (timeline == NULL) {
+        *error = "Optimization failed";
     }
-    input[total_read] = '\0';
-    
-    /* Parse input */
+    return timeline;
+}
+
+/**
+ * Solve a parsed what-if request, taking ownership of its arrays
+ * @param arena Arena holding the arrays and receiving the result, NULL for the heap
+ * @param error Output: message when NULL is returned
+ * @return Timeline with its variants (caller must free), or NULL on failure
+ */
+static Timeline* solve_parsed_variants(Task* tasks, int num_tasks, TimeSlot* fixed_slots,
+                                       int num_fixed, TaskPlacement* previous,
+                                       int num_previous, RequestVariant* variants,
+                                       int num_variants, SolverOptions* options,
+                                       Arena* arena, const char** error) {
+    apply_environment(options);
+    options->arena = arena;
+
+    Timeline* timeline = optimize_variants(tasks, num_tasks, fixed_slots, num_fixed,
+                                           previous, num_previous, variants, num_variants,
+                                           options, 0);
+
+    request_variants_free(variants, num_variants, arena);
+    arena_free(arena, tasks);
+    arena_free(arena, fixed_slots);
+    arena_free(arena, previous);
+
+    if (timeline == NULL) {
+        *error = "Optimization failed";
+    }
+    return timeline;
+}
+
+/**
+ * Parse and solve one request, or register the template it holds
+ * @param input NUL-terminated JSON request
+ * @param format In/out: default output format, replaced by "output_format"
+ * @param cache Result cache of serve mode, NULL to always solve
+ * @param templates Templates named by "fixed_template", may be NULL
+ * @param registrations Registry receiving "register_template" requests,
+ *                      NULL to reject them
+ * @param arena Arena for the request's memory, NULL for the heap
+ * @param clock Output: parse timings with AESA_STATS, may be NULL
+ * @param error Output: message when NULL is returned
+ * @return Timeline (caller must free), or NULL on failure
+ */
+static Timeline* solve_request(const char* input, OutputFormat* format,
+                               ResultCache* cache, const TemplateRegistry* templates,
+                               TemplateRegistry* registrations, Arena* arena,
+                               RequestClock* clock, const char** error) {
+    CLOCK_MARK(clock, start_ns);
     Task* tasks = NULL;
     int num_tasks = 0;
     TimeSlot* fixed_slots = NULL;
     int num_fixed = 0;
-    
-    if (parse_json_input(input, &tasks, &num_tasks, &fixed_slots, &num_fixed) != 0) {
-        fprintf(stderr, "{\"success\": false, \"error_message\": \"Failed to parse input JSON\"}\n");
-        free(input);
+
+    if (parse_json_input(input, &tasks, &num_tasks, &fixed_slots, &num_fixed, arena) != 0) {
+        *error = "Failed to parse input JSON";
+        return NULL;
+    }
+
+    SolverOptions options;
+    if (parse_solver_options(input, &options) != 0) {
+        *error = "Invalid solver options in input JSON";
+        arena_free(arena, tasks);
+        arena_free(arena, fixed_slots);
+        return NULL;
+    }
+
+    if (parse_output_format(input, format) != 0) {
+        *error = "Invalid output_format in input JSON";
+        arena_free(arena, tasks);
+        arena_free(arena, fixed_slots);
+        return NULL;
+    }
+
+    char name[MAX_TEMPLATE_NAME_LEN];
+    char registered[MAX_TEMPLATE_NAME_LEN];
+    int name_length = parse_template_name(input, "fixed_template", name, sizeof(name));
+    int registered_length = parse_template_name(input, "register_template", registered,
+                                                sizeof(registered));
+    if (name_length < 0 || registered_length < 0 ||
+        (name_length > 0 && registered_length > 0)) {
+        *error = "Invalid fixed_template or register_template in input JSON";
+        arena_free(arena, tasks);
+        arena_free(arena, fixed_slots);
+        return NULL;
+    }
+    if (registered_length > 0) {
+        CLOCK_MARK(clock, parsed_ns);
+        options.arena = arena;
+        Timeline* timeline = template_registry_register(
+            registrations, registered, (size_t)registered_length, num_tasks, fixed_slots,
+            num_fixed, &options, error);
+        arena_free(arena, tasks);
+        arena_free(arena, fixed_slots);
+        return timeline;
+    }
+    if (name_length > 0) {
+        options.fixed_template = template_registry_find(templates, name, (size_t)name_length);
+        if (options.fixed_template == NULL) {
+            *error = "Unknown fixed_template";
+            arena_free(arena, tasks);
+            arena_free(arena, fixed_slots);
+            return NULL;
+        }
+    }
+
+    TaskPlacement* previous = NULL;
+    int num_previous = 0;
+    if (parse_previous_placements(input, &previous, &num_previous, arena) != 0) {
+        *error = "Invalid previous placements in input JSON";
+        arena_free(arena, tasks);
+        arena_free(arena, fixed_slots);
+        return NULL;
+    }
+
+    RequestVariant* variants = NULL;
+    int num_variants = 0;
+    if (parse_request_variants(input, tasks, num_tasks, &variants, &num_variants,
+                               arena) != 0) {
+        *error = "Invalid variants in input JSON";
+        arena_free(arena, tasks);
+        arena_free(arena, fixed_slots);
+        arena_free(arena, previous);
+        return NULL;
+    }
+    CLOCK_MARK(clock, parsed_ns);
+    if (num_variants > 0) {
+        return solve_parsed_variants(tasks, num_tasks, fixed_slots, num_fixed, previous,
+                                     num_previous, variants, num_variants, &options, arena,
+                                     error);
+    }
+
+    return solve_parsed(tasks, num_tasks, fixed_slots, num_fixed, previous, num_previous,
+                        &options, cache, arena, error);
+}
+
+/**
+ * Decode and solve one binary request, or register the template it holds
+ * @param info Output: response settings of the request
+ * @param cache Result cache of serve mode, NULL to always solve
+ * @param templates Templates of WIRE_TEMPLATE requests, which also
+ *                  receives WIRE_REGISTER_TEMPLATE requests
+ * @param arena Arena for the request's memory, NULL for the heap
+ * @param error Output: message when NULL is returned
+ * @return Timeline (caller must free), or NULL on failure
+ */
+static Timeline* solve_binary_request(const char* data, size_t size,
+                                      WireRequestInfo* info, ResultCache* cache,
+                                      TemplateRegistry* templates, Arena* arena,
+                                      const char** error) {
+    Task* tasks = NULL;
+    int num_tasks = 0;
+    TimeSlot* fixed_slots = NULL;
+    int num_fixed = 0;
+    TaskPlacement* previous = NULL;
+    int num_previous = 0;
+    SolverOptions options;
+
+    if (wire_parse_request(data, size, &tasks, &num_tasks, &fixed_slots, &num_fixed,
+                           &previous, &num_previous, &options, info, error, arena) != 0) {
+        return NULL;
+    }
+
+    if (info->register_template) {
+        options.arena = arena;
+        Timeline* timeline = template_registry_register(
+            templates, info->template_name, info->template_length, num_tasks, fixed_slots,
+            num_fixed, &options, error);
+        arena_free(arena, tasks);
+        arena_free(arena, fixed_slots);
+        arena_free(arena, previous);
+        return timeline;
+    }
+    if (info->template_name != NULL) {
+        options.fixed_template = template_registry_find(templates, info->template_name,
+                                                        info->template_length);
+        if (options.fixed_template == NULL) {
+            *error = "Unknown fixed_template";
+            arena_free(arena, tasks);
+            arena_free(arena, fixed_slots);
+            arena_free(arena, previous);
+            return NULL;
+        }
+    }
+    return solve_parsed(tasks, num_tasks, fixed_slots, num_fixed, previous, num_previous,
+                        &options, cache, arena, error);
+}
+
+static void write_error(FILE* out, const char* message) {
+    fprintf(out, "{\"success\": false, \"error_message\": \"%s\"}\n", message);
+}
+
+#ifdef AESA_STATS
+/**
+ * Write the "stats" member of a response, with its trailing comma
+ * @param pretty True to lay it out as a member of pretty output
+ */
+static void write_stats(FILE* out, const Timeline* timeline, const RequestClock* clock,
+                        bool pretty) {
+    const SolverStats* stats = &timeline->stats;
+    fprintf(out, pretty ? "\n  \"stats\": {" : "\"stats\":{");
+    fprintf(out,
+            "\"nodes\":%lld,\"backtracks\":%lld,\"candidates\":%lld,\"pruned\":%lld,"
+            "\"max_depth\":%d,\"parse_us\":%.1f,\"solve_us\":%.1f,\"serialize_us\":%.1f},",
+            (long long)stats->nodes, (long long)stats->backtracks,
+            (long long)stats->candidates, (long long)stats->pruned, stats->max_depth,
+            (double)(clock->parsed_ns - clock->start_ns) / 1000.0,
+            (double)(clock->solved_ns - clock->parsed_ns) / 1000.0,
+            (double)(clock->serialized_ns - clock->solved_ns) / 1000.0);
+}
+#endif
+
+/**
+ * Write one response line, tagged with the request id unless it is empty
+ * @param timeline Solved request, or NULL to report error
+ * @return true if the response reports a complete schedule
+ */
+static bool write_response(FILE* out, const char* id, Timeline* timeline,
+                           OutputFormat format, const char* error,
+                           ServeBuffers* buffers) {
+    int written = -1;
+    if (timeline != NULL) {
+        /* Responses are framed by newlines, so pretty output is not an option */
+        if (format == OUTPUT_PRETTY) format = OUTPUT_COMPACT;
+        CLOCK_MARK(&buffers->clock, solved_ns);
+        written = timeline_write_json(timeline, format, &buffers->response,
+                                      &buffers->response_capacity);
+        CLOCK_MARK(&buffers->clock, serialized_ns);
+        if (written < 0) error = "JSON serialization failed";
+    }
+
+    if (written < 0) {
+        fprintf(out, "{");
+        if (id[0] != '\0') fprintf(out, "\"request_id\":%s,", id);
+        fprintf(out, "\"success\":false,\"error_message\":\"%s\"}\n", error);
+        return false;
+    }
+
+    /* Splice the id, and the stats, in after the opening brace */
+    fputc('{', out);
+    if (id[0] != '\0') fprintf(out, "\"request_id\":%s,", id);
+#ifdef AESA_STATS
+    write_stats(out, timeline, &buffers->clock, false);
+#endif
+    fwrite(buffers->response + 1, 1, (size_t)written - 1, out);
+    return timeline->success;
+}
+
+/**
+ * Write one binary response
+ * @param timeline Solved request, or NULL to report error
+ * @return false if the response could not be encoded
+ */
+static bool write_binary_response(FILE* out, const Timeline* timeline,
+                                  const char* error, const WireRequestInfo* info,
+                                  ServeBuffers* buffers) {
+    int written = wire_write_response(timeline, error, info, &buffers->response,
+                                      &buffers->response_capacity);
+    if (written < 0) {
+        written = wire_write_response(NULL, "Memory allocation failed", info,
+                                      &buffers->response, &buffers->response_capacity);
+    }
+    if (written < 0) return false;
+    fwrite(buffers->response, 1, (size_t)written, out);
+    return true;
+}
+
+/**
+ * Parse the request id, then solve the request
+ * @param fallback_id Id used when the request has none ("" for untagged)
+ * @param id Output: MAX_REQUEST_ID_LEN buffer receiving the id to echo
+ * @param format In/out: default output format, replaced by "output_format"
+ * @param cache Result cache of serve mode, NULL to always solve
+ * @param templates Templates named by "fixed_template", may be NULL
+ * @param registrations Registry receiving "register_template" requests,
+ *                      NULL to reject them
+ * @param arena Arena for the request's memory, NULL for the heap
+ * @param clock Output: parse timings with AESA_STATS, may be NULL
+ * @param error Output: message when NULL is returned
+ * @return Timeline (caller must free), or NULL on failure
+ */
+static Timeline* solve_tagged_request(const char* input, const char* fallback_id,
+                                      char* id, OutputFormat* format,
+                                      ResultCache* cache, const TemplateRegistry* templates,
+                                      TemplateRegistry* registrations, Arena* arena,
+                                      RequestClock* clock, const char** error) {
+    int id_length = parse_request_id(input, id, MAX_REQUEST_ID_LEN);
+    if (id_length <= 0) {
+        strcpy(id, fallback_id);
+    }
+    if (id_length < 0) {
+        *error = "Invalid request_id";
+        return NULL;
+    }
+    return solve_request(input, format, cache, templates, registrations, arena, clock,
+                         error);
+}
+
+/**
+ * Read a whole stream into a NUL-terminated buffer that grows as needed
+ * @param length Output: number of bytes read
+ * @param error Output: message when NULL is returned
+ * @return Buffer (caller must free), or NULL on failure
+ */
+static char* read_stream(FILE* in, size_t* length, const char** error) {
+    size_t capacity = INITIAL_INPUT_SIZE;
+    size_t total_read = 0;
+    char* input = (char*)malloc(capacity);
+    if (input == NULL) {
+        *error = "Memory allocation failed";
+        return NULL;
+    }
+
+    for (;;) {
+        if (total_read + 1 == capacity) {
+            if (capacity >= MAX_INPUT_SIZE) {
+                *error = "Request exceeds maximum input size";
+                free(input);
+                return NULL;
+            }
+            char* grown = (char*)realloc(input, capacity * 2);
+            if (grown == NULL) {
+                *error = "Memory allocation failed";
+                free(input);
+                return NULL;
+            }
+            input = grown;
+            capacity *= 2;
+        }
+
+        size_t bytes_read = fread(input + total_read, 1, capacity - total_read - 1, in);
+        if (bytes_read == 0) break;
+        total_read += bytes_read;
+    }
+    input[total_read] = '\0';
+    *length = total_read;
+    return input;
+}
+
+static int run_binary_once(TemplateRegistry* templates) {
+    ServeBuffers buffers;
+    serve_buffers_init(&buffers);
+    WireRequestInfo info = { 0, false, NULL, 0, false };
+    const char* error = NULL;
+    size_t length = 0;
+
+    char* input = read_stream(stdin, &length, &error);
+    Timeline* timeline = input != NULL
+        ? solve_binary_request(input, length, &info, NULL, templates, NULL, &error)
+        : NULL;
+    free(input);
+
+    bool written = write_binary_response(stdout, timeline, error, &info, &buffers);
+    bool success = timeline != NULL && written;
+    if (timeline != NULL) timeline_free(timeline);
+    serve_buffers_free(&buffers);
+
+    return success ? 0 : 1;
+}
+
+static int run_once(bool binary, TemplateRegistry* templates) {
+    if (binary) return run_binary_once(templates);
+
+    /* Read JSON input from stdin */
+    const char* error = NULL;
+    size_t length = 0;
+    char* input = read_stream(stdin, &length, &error);
+    if (input == NULL) {
+        write_error(stderr, error);
         return 1;
     }
-    
+
+    OutputFormat format = OUTPUT_PRETTY;
+    RequestClock clock;
+    Timeline* timeline = solve_request(input, &format, NULL, templates, templates, NULL,
+                                       &clock, &error);
     free(input);
-    
-    /* Run optimization */
-    Timeline* timeline = optimize_schedule(tasks, num_tasks, fixed_slots, num_fixed);
-    
-    /* Cleanup input data */
-    if (tasks) task_array_free(tasks);
-    if (fixed_slots) timeslot_array_free(fixed_slots);
-    
+
     if (timeline == NULL) {
-        fprintf(stderr, "{\"success\": false, \"error_message\": \"Optimization failed\"}\n");
+        write_error(stderr, error);
         return 1;
     }
-    
+
     /* Output result as JSON */
-    char* json_output = timeline_to_json(timeline);
-    timeline_free(timeline);
-    
-    if (json_output == NULL) {
-        fprintf(stderr, "{\"success\": false, \"error_message\": \"JSON serialization failed\"}\n");
+    char* json_output = NULL;
+    size_t capacity = 0;
+    CLOCK_MARK(&clock, solved_ns);
+    int written = timeline_write_json(timeline, format, &json_output, &capacity);
+    CLOCK_MARK(&clock, serialized_ns);
+
+    if (written < 0) {
+        timeline_free(timeline);
+        free_json(json_output);
+        write_error(stderr, "JSON serialization failed");
         return 1;
     }
-    
-    printf("%s", json_output);
+
+#ifdef AESA_STATS
+    fputc('{', stdout);
+    write_stats(stdout, timeline, &clock, format == OUTPUT_PRETTY);
+    fwrite(json_output + 1, 1, (size_t)written - 1, stdout);
+#else
+    fwrite(json_output, 1, (size_t)written, stdout);
+#endif
+    timeline_free(timeline);
     free_json(json_output);
-    
+
     return 0;
 }
+
+
+/* ============================================================
+ * Serve Mode
+ * ============================================================ */
+
+static bool is_length_prefix(const char* line) {
+    if (*line == '\0') return false;
+    for (const char* p = line; *p; p++) {
+        if (!isdigit((unsigned char)*p)) return false;
+    }
+    return true;
+}
+
+/**
+ * Skip length bytes of input
+ * @return 0 on success, -1 on end of input
+ */
+static int discard_input(FILE* in, size_t length) {
+    char discard[4096];
+    while (length > 0) {
+        size_t chunk = length < sizeof(discard) ? length : sizeof(discard);
+        if (fread(discard, 1, chunk, in) != chunk) return -1;
+        length -= chunk;
+    }
+    return 0;
+}
+
+/**
+ * Read a length-prefixed payload into the request buffer
+ * @return 0 on success, 1 if the payload was too large and was skipped,
+ *         -1 on end of input
+ */
+static int read_payload(FILE* in, ServeBuffers* buffers, size_t length) {
+    if (length >= MAX_INPUT_SIZE) {
+        return discard_input(in, length) == 0 ? 1 : -1;
+    }
+
+    if (length + 1 > buffers->request_capacity) {
+        char* grown = (char*)realloc(buffers->request, length + 1);
+        if (grown == NULL) return -1;
+        buffers->request = grown;
+        buffers->request_capacity = length + 1;
+    }
+
+    if (fread(buffers->request, 1, length, in) != length) return -1;
+    buffers->request[length] = '\0';
+    return 0;
+}
+
+/**
+ * Answer requests from in until end of input, one response line each
+ * @return 0 at end of input, -1 if the response stream failed
+ */
+static int serve_stream(FILE* in, FILE* out, ServeBuffers* buffers,
+                        ResultCache* cache, TemplateRegistry* templates) {
+    for (;;) {
+        ssize_t length = getline(&buffers->request, &buffers->request_capacity, in);
+        if (length < 0) return 0;
+
+        while (length > 0 && isspace((unsigned char)buffers->request[length - 1])) {
+            buffers->request[--length] = '\0';
+        }
+        if (length == 0) continue;
+
+        bool too_large = length >= MAX_INPUT_SIZE;
+        if (is_length_prefix(buffers->request)) {
+            size_t payload = (size_t)strtoull(buffers->request, NULL, 10);
+            int status = read_payload(in, buffers, payload);
+            if (status < 0) return 0;
+            too_large = status > 0;
+        }
+
+        char id[MAX_REQUEST_ID_LEN] = "";
+        OutputFormat format = OUTPUT_COMPACT;
+        const char* error = "Request exceeds maximum input size";
+        Timeline* timeline = too_large
+            ? NULL
+            : solve_tagged_request(buffers->request, "", id, &format, cache, templates,
+                                   templates, &buffers->arena, &buffers->clock, &error);
+        write_response(out, id, timeline, format, error, buffers);
+        if (timeline != NULL) timeline_free(timeline);
+        arena_reset(&buffers->arena);
+
+        if (fflush(out) != 0) return -1;
+    }
+}
+
+/**
+ * Answer binary requests from in until end of input, one response each
+ * @return 0 at end of input, -1 if the response stream failed or a
+ *         malformed prefix left the stream without framing
+ */
+static int serve_binary_stream(FILE* in, FILE* out, ServeBuffers* buffers,
+                               ResultCache* cache, TemplateRegistry* templates) {
+    for (;;) {
+        char prefix[WIRE_PREFIX_SIZE];
+        if (fread(prefix, 1, WIRE_PREFIX_SIZE, in) != WIRE_PREFIX_SIZE) return 0;
+
+        WireRequestInfo info = { 0, false, NULL, 0, false };
+        size_t size = wire_request_size(prefix);
+        if (size < WIRE_REQUEST_HEADER_SIZE) {
+            /* Without a valid prefix the next message cannot be found */
+            write_binary_response(out, NULL, "Malformed binary request header", &info,
+                                  buffers);
+            fflush(out);
+            return -1;
+        }
+
+        Timeline* timeline = NULL;
+        const char* error = "Request exceeds maximum input size";
+        if (size >= MAX_INPUT_SIZE) {
+            if (discard_input(in, size - WIRE_PREFIX_SIZE) != 0) return 0;
+        } else {
+            if (size > buffers->request_capacity) {
+                char* grown = (char*)realloc(buffers->request, size);
+                if (grown == NULL) return -1;
+                buffers->request = grown;
+                buffers->request_capacity = size;
+            }
+            memcpy(buffers->request, prefix, WIRE_PREFIX_SIZE);
+            size_t rest = size - WIRE_PREFIX_SIZE;
+            if (fread(buffers->request + WIRE_PREFIX_SIZE, 1, rest, in) != rest) return 0;
+            timeline = solve_binary_request(buffers->request, size, &info, cache,
+                                            templates, &buffers->arena, &error);
+        }
+
+        write_binary_response(out, timeline, error, &info, buffers);
+        if (timeline != NULL) timeline_free(timeline);
+        arena_reset(&buffers->arena);
+
+        if (fflush(out) != 0) return -1;
+    }
+}
+
+static int serve_connection(FILE* in, FILE* out, bool binary, ServeBuffers* buffers,
+                            ResultCache* cache, TemplateRegistry* templates) {
+    return binary ? serve_binary_stream(in, out, buffers, cache, templates)
+                  : serve_stream(in, out, buffers, cache, templates);
+}
+
+/**
+ * Accept clients on a Unix domain socket, one connection at a time
+ * @return Exit status; only returns if the socket cannot be served
+ */
+static int serve_socket(const char* path, bool binary, ServeBuffers* buffers,
+                        ResultCache* cache, TemplateRegistry* templates) {
+    struct sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        write_error(stderr, "Socket path too long");
+        return 1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        write_error(stderr, "Failed to create socket");
+        return 1;
+    }
+
+    unlink(path);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(listener, SOCKET_BACKLOG) != 0) {
+        write_error(stderr, "Failed to listen on socket");
+        close(listener);
+        return 1;
+    }
+
+    /* A client hanging up mid-response must not take the server down */
+    signal(SIGPIPE, SIG_IGN);
+
+    for (;;) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+
+        int client_out = dup(client);
+        FILE* in = fdopen(client, "r");
+        FILE* out = client_out >= 0 ? fdopen(client_out, "w") : NULL;
+        if (in != NULL && out != NULL) {
+            serve_connection(in, out, binary, buffers, cache, templates);
+        }
+
+        if (in != NULL) fclose(in); else close(client);
+        if (out != NULL) fclose(out); else if (client_out >= 0) close(client_out);
+    }
+
+    write_error(stderr, "Failed to accept connection");
+    close(listener);
+    unlink(path);
+    return 1;
+}
+
+static int serve(const char* socket_path, bool binary, TemplateRegistry* templates) {
+    ServeBuffers buffers;
+    serve_buffers_init(&buffers);
+
+    /* Without memory for a cache, every request is solved */
+    size_t cache_limit = result_cache_limit_from_environment();
+    ResultCache* cache = cache_limit > 0 ? result_cache_create(cache_limit) : NULL;
+
+    int status = socket_path != NULL
+        ? serve_socket(socket_path, binary, &buffers, cache, templates)
+        : (serve_connection(stdin, stdout, binary, &buffers, cache, templates) == 0 ? 0 : 1);
+
+    if (cache != NULL) {
+        ResultCacheStats stats;
+        result_cache_stats(cache, &stats);
+        fprintf(stderr, "serve: %llu cache hits, %llu misses, %llu evictions, "
+                "%zu entries (%zu of %zu bytes)\n",
+                (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+                (unsigned long long)stats.evictions, stats.entries, stats.bytes,
+                stats.max_bytes);
+        result_cache_free(cache);
+    }
+
+    serve_buffers_free(&buffers);
+    return status;
+}
+
+
+/* ============================================================
+ * Batch Mode
+ * ============================================================ */
+
+typedef struct {
+    const char* data;           /* Memory-mapped request file */
+    size_t size;
+    size_t cursor;              /* Start of the next unclaimed line */
+    long next_line;             /* 1-based number of that line */
+    pthread_mutex_t input_lock;
+    pthread_mutex_t output_lock;
+    const TemplateRegistry* templates; /* Loaded before the workers start, read-only */
+    long requests;
+    long unsuccessful;
+} Batch;
+
+/**
+ * Claim the next non-blank line of the batch
+ * @return false once every line has been claimed
+ */
+static bool batch_next_line(Batch* batch, const char** line, size_t* length,
+                            long* number) {
+    bool found = false;
+    pthread_mutex_lock(&batch->input_lock);
+    while (!found && batch->cursor < batch->size) {
+        const char* start = batch->data + batch->cursor;
+        size_t remaining = batch->size - batch->cursor;
+        const char* newline = (const char*)memchr(start, '\n', remaining);
+        size_t line_length = newline != NULL ? (size_t)(newline - start) : remaining;
+
+        batch->cursor += line_length + (newline != NULL ? 1 : 0);
+        *number = batch->next_line++;
+
+        while (line_length > 0 && isspace((unsigned char)start[line_length - 1])) {
+            line_length--;
+        }
+        if (line_length > 0) {
+            *line = start;
+            *length = line_length;
+            found = true;
+        }
+    }
+    pthread_mutex_unlock(&batch->input_lock);
+    return found;
+}
+
+static void* batch_worker_main(void* arg) {
+    Batch* batch = (Batch*)arg;
+    ServeBuffers buffers;
+    serve_buffers_init(&buffers);
+    const char* line;
+    size_t length;
+    long number;
+
+    while (batch_next_line(batch, &line, &length, &number)) {
+        char fallback_id[32];
+        snprintf(fallback_id, sizeof(fallback_id), "%ld", number);
+
+        /* The parser needs a terminated string, the mapping has none */
+        bool copied = true;
+        if (length + 1 > buffers.request_capacity) {
+            char* grown = (char*)realloc(buffers.request, length + 1);
+            if (grown != NULL) {
+                buffers.request = grown;
+                buffers.request_capacity = length + 1;
+            } else {
+                copied = false;
+            }
+        }
+        if (copied) {
+            memcpy(buffers.request, line, length);
+            buffers.request[length] = '\0';
+        }
+
+        /* Solve outside the output lock, then write the whole line at once */
+        char id[MAX_REQUEST_ID_LEN];
+        OutputFormat format = OUTPUT_COMPACT;
+        const char* error = "Memory allocation failed";
+        Timeline* timeline = NULL;
+        if (copied) {
+            timeline = solve_tagged_request(buffers.request, fallback_id, id, &format,
+                                            NULL, batch->templates, NULL, &buffers.arena,
+                                            &buffers.clock, &error);
+        } else {
+            strcpy(id, fallback_id);
+        }
+
+        FILE* out = stdout;
+        pthread_mutex_lock(&batch->output_lock);
+        bool success = write_response(out, id, timeline, format, error, &buffers);
+        fflush(out);
+        batch->requests++;
+        if (!success) batch->unsuccessful++;
+        pthread_mutex_unlock(&batch->output_lock);
+
+        if (timeline != NULL) timeline_free(timeline);
+        arena_reset(&buffers.arena);
+    }
+
+    serve_buffers_free(&buffers);
+    return NULL;
+}
+
+static int default_jobs(void) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 1) return 1;
+    return online > MAX_BATCH_JOBS ? MAX_BATCH_JOBS : (int)online;
+}
+
+static int run_batch(const char* path, int jobs, const TemplateRegistry* templates) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        write_error(stderr, "Failed to open batch file");
+        return 1;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        write_error(stderr, "Batch file must be a regular file");
+        close(fd);
+        return 1;
+    }
+
+    Batch batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.size = (size_t)info.st_size;
+    batch.next_line = 1;
+    batch.templates = templates;
+
+    void* mapping = NULL;
+    if (batch.size > 0) {
+        mapping = mmap(NULL, batch.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            write_error(stderr, "Failed to map batch file");
+            close(fd);
+            return 1;
+        }
+        posix_madvise(mapping, batch.size, POSIX_MADV_SEQUENTIAL);
+        batch.data = (const char*)mapping;
+    }
+    close(fd);
+
+    pthread_mutex_init(&batch.input_lock, NULL);
+    pthread_mutex_init(&batch.output_lock, NULL);
+
+    pthread_t threads[MAX_BATCH_JOBS];
+    int started = 0;
+    for (int i = 0; i < jobs; i++) {
+        if (pthread_create(&threads[started], NULL, batch_worker_main, &batch) == 0) {
+            started++;
+        }
+    }
+    if (started == 0) {
+        batch_worker_main(&batch);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&batch.input_lock);
+    pthread_mutex_destroy(&batch.output_lock);
+    if (mapping != NULL) munmap(mapping, batch.size);
+
+    fprintf(stderr, "batch: %ld requests, %ld unsuccessful\n",
+            batch.requests, batch.unsuccessful);
+    return 0;
+}
+
+
+/* ============================================================
+ * Template Files
+ * ============================================================ */
+
+/**
+ * Register the templates of a --templates file: one JSON request with
+ * "register_template" per line, as a serve mode client would send them
+ * @return 0 on success, -1 after reporting the failing line on stderr
+ */
+static int load_templates(const char* path, TemplateRegistry* templates) {
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+        write_error(stderr, "Failed to open templates file");
+        return -1;
+    }
+
+    ServeBuffers buffers;
+    serve_buffers_init(&buffers);
+    int status = 0;
+    long number = 0;
+    for (;;) {
+        ssize_t length = getline(&buffers.request, &buffers.request_capacity, in);
+        if (length < 0) break;
+        number++;
+
+        while (length > 0 && isspace((unsigned char)buffers.request[length - 1])) {
+            buffers.request[--length] = '\0';
+        }
+        if (length == 0) continue;
+
+        char name[MAX_TEMPLATE_NAME_LEN];
+        OutputFormat format = OUTPUT_COMPACT;
+        const char* error = "Line is not a template registration";
+        Timeline* timeline = NULL;
+        if (parse_template_name(buffers.request, "register_template", name, sizeof(name)) > 0) {
+            timeline = solve_request(buffers.request, &format, NULL, templates, templates,
+                                     &buffers.arena, NULL, &error);
+        }
+        arena_reset(&buffers.arena);
+
+        if (timeline == NULL) {
+            char message[MAX_ERROR_LEN];
+            snprintf(message, sizeof(message), "Templates file line %ld: %s", number, error);
+            write_error(stderr, message);
+            status = -1;
+            break;
+        }
+    }
+
+    fclose(in);
+    serve_buffers_free(&buffers);
+    return status;
+}
+
+static void print_usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [--binary] [--templates FILE] < input.json\n"
+            "       %s --serve [--socket PATH] [--binary] [--templates FILE]\n"
+            "       %s --batch FILE [--jobs N] [--templates FILE]\n",
+            program, program, program);
+}
+
+int main(int argc, char* argv[]) {
+    bool serve_mode = false;
+    bool binary = false;
+    const char* socket_path = NULL;
+    const char* batch_path = NULL;
+    const char* templates_path = NULL;
+    int jobs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--serve") == 0) {
+            serve_mode = true;
+        } else if (strcmp(argv[i], "--binary") == 0) {
+            binary = true;
+        } else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+            serve_mode = true;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_path = argv[++i];
+        } else if (strcmp(argv[i], "--templates") == 0 && i + 1 < argc) {
+            templates_path = argv[++i];
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+            if (jobs < 1 || jobs > MAX_BATCH_JOBS) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((serve_mode && batch_path != NULL) || (jobs > 0 && batch_path == NULL) ||
+        (binary && batch_path != NULL)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    TemplateRegistry* templates = template_registry_create();
+    if (templates == NULL) {
+        write_error(stderr, "Memory allocation failed");
+        return 1;
+    }
+    if (templates_path != NULL && load_templates(templates_path, templates) != 0) {
+        template_registry_free(templates);
+        return 1;
+    }
+
+    int status;
+    if (batch_path != NULL) {
+        status = run_batch(batch_path, jobs > 0 ? jobs : default_jobs(), templates);
+    } else {
+        status = serve_mode ? serve(socket_path, binary, templates) : run_once(binary, templates);
+    }
+    template_registry_free(templates);
+    return status;
+}
@@ -6,10 +6,15 @@
  * Requirements: 2.1, 2.2, 2.3, 2.4, 3.1, 3.2, 3.3, 3.4, 4.2
  */
 
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+
 #include "scheduler.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
 
 /* ============================================================
  * Task Type String Mapping
@@ -50,6 +55,53 @@ int task_type_from_string(const char* str) {
     return -1;
 }
 
+static const char* SOLVER_ENGINE_STRINGS[] = {
+    "backtrack",
+    "greedy",
+    "auto"
+};
+
+const char* solver_engine_to_string(SolverEngine engine) {
+    if (engine >= 0 && engine < ENGINE_COUNT) {
+        return SOLVER_ENGINE_STRINGS[engine];
+    }
+    return "unknown";
+}
+
+int solver_engine_from_string(const char* str) {
+    if (str == NULL) return -1;
+    
+    for (int i = 0; i < ENGINE_COUNT; i++) {
+        if (strcmp(str, SOLVER_ENGINE_STRINGS[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static const char* SOLVER_OBJECTIVE_STRINGS[] = {
+    "feasible",
+    "maximize_energy_fit"
+};
+
+const char* solver_objective_to_string(SolverObjective objective) {
+    if (objective >= 0 && objective < OBJECTIVE_COUNT) {
+        return SOLVER_OBJECTIVE_STRINGS[objective];
+    }
+    return "unknown";
+}
+
+int solver_objective_from_string(const char* str) {
+    if (str == NULL) return -1;
+    
+    for (int i = 0; i < OBJECTIVE_COUNT; i++) {
+        if (strcmp(str, SOLVER_OBJECTIVE_STRINGS[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 
 /* ============================================================
  * Memory Management Functions
@@ -70,7 +122,7 @@ void task_free(Task* task) {
 }
 
 Task* task_array_create(int count) {
-    if (count <= 0 || count > MAX_TASKS) {
+    if (count <= 0 || count > solver_task_capacity()) {
         return NULL;
     }
     
@@ -89,16 +141,108 @@ void task_array_free(Task* tasks) {
     }
 }
 
-Timeline* timeline_create(void) {
-    Timeline* timeline = (Timeline*)malloc(sizeof(Timeline));
+int horizon_num_slots(int num_days, int slot_minutes, int start_slot_of_day) {
+    if (slot_minutes != 15 && slot_minutes != 30 && slot_minutes != 60) return -1;
+    int slots_per_day = MINUTES_PER_DAY / slot_minutes;
+    if (num_days < 1 || num_days > MAX_DAYS ||
+        start_slot_of_day < 0 || start_slot_of_day >= slots_per_day) {
+        return -1;
+    }
+    return num_days * slots_per_day - start_slot_of_day;
+}
+
+/**
+ * Allocate a Timeline of num_slots slots: the struct, then the slots,
+ * then the occupancy words, in one block
+ * @param arena Arena to allocate from, NULL for the heap
+ */
+static Timeline* timeline_alloc(Arena* arena, int num_slots) {
+    int num_words = (num_slots + SLOT_WORD_BITS - 1) / SLOT_WORD_BITS;
+    size_t size = sizeof(Timeline) + sizeof(TimeSlot) * (size_t)num_slots +
+                  sizeof(uint64_t) * (size_t)num_words;
+    Timeline* timeline = (Timeline*)arena_alloc(arena, size);
     if (timeline != NULL) {
-        timeline_init(timeline, 7); /* Default to 7 days */
+        timeline->slots = (TimeSlot*)(timeline + 1);
+        timeline->occupied = (uint64_t*)(timeline->slots + num_slots);
+        timeline->num_slots = num_slots;
+        timeline->num_words = num_words;
+        timeline->unplaced_task_ids = NULL;
+        timeline->arena = arena;
+        timeline->free_index = NULL;
+        timeline->variants = NULL;
+        timeline->num_variants = 0;
     }
     return timeline;
 }
 
-void timeline_free(Timeline* timeline) {
+/**
+ * timeline_create_horizon in an arena
+ */
+static Timeline* timeline_create_in(Arena* arena, int num_days, int slot_minutes,
+                                    int start_slot_of_day) {
+    int num_slots = horizon_num_slots(num_days, slot_minutes, start_slot_of_day);
+    if (num_slots < 0) return NULL;
+    
+    Timeline* timeline = timeline_alloc(arena, num_slots);
     if (timeline != NULL) {
+        timeline->slot_minutes = slot_minutes;
+        timeline->start_slot_of_day = start_slot_of_day;
+        timeline_init(timeline);
+    }
+    return timeline;
+}
+
+Timeline* timeline_create(void) {
+    return timeline_create_horizon(DEFAULT_NUM_DAYS, DEFAULT_SLOT_MINUTES, 0);
+}
+
+Timeline* timeline_create_horizon(int num_days, int slot_minutes, int start_slot_of_day) {
+    return timeline_create_in(NULL, num_days, slot_minutes, start_slot_of_day);
+}
+
+Timeline* timeline_clone(const Timeline* timeline) {
+    return timeline_clone_in(NULL, timeline);
+}
+
+Timeline* timeline_clone_in(Arena* arena, const Timeline* timeline) {
+    if (timeline == NULL) return NULL;
+    
+    Timeline* copy = timeline_alloc(arena, timeline->num_slots);
+    if (copy == NULL) return NULL;
+    TimeSlot* slots = copy->slots;
+    uint64_t* occupied = copy->occupied;
+    *copy = *timeline;
+    copy->slots = slots;
+    copy->occupied = occupied;
+    copy->arena = arena;
+    copy->free_index = NULL;
+    copy->variants = NULL;
+    copy->num_variants = 0;
+    memcpy(slots, timeline->slots, sizeof(TimeSlot) * (size_t)timeline->num_slots);
+    memcpy(occupied, timeline->occupied, sizeof(uint64_t) * (size_t)timeline->num_words);
+    
+    copy->unplaced_task_ids = NULL;
+    if (timeline->num_unplaced > 0 && timeline->unplaced_task_ids != NULL) {
+        size_t size = sizeof(int) * (size_t)timeline->num_unplaced;
+        copy->unplaced_task_ids = (int*)arena_alloc(arena, size);
+        if (copy->unplaced_task_ids == NULL) {
+            arena_free(arena, copy);
+            return NULL;
+        }
+        memcpy(copy->unplaced_task_ids, timeline->unplaced_task_ids, size);
+    }
+    return copy;
+}
+
+void timeline_free(Timeline* timeline) {
+    if (timeline == NULL) return;
+    /* Variants are solved on their own threads, so they live on the heap */
+    for (int i = 0; i < timeline->num_variants; i++) {
+        timeline_free(timeline->variants[i]);
+    }
+    if (timeline->arena == NULL) {
+        free(timeline->variants);
+        free(timeline->unplaced_task_ids);
         free(timeline);
     }
 }
@@ -127,6 +271,8 @@ void timeslot_array_free(TimeSlot* slots) {
  * Initialization Functions
  * ============================================================ */
 
+static int curve_level(const uint8_t* curve, int slot_minutes, int slot_of_day);
+
 void task_init(Task* task) {
     if (task == NULL) return;
     
@@ -149,400 +295,4126 @@ void timeslot_init(TimeSlot* slot, int index) {
     slot->is_fixed = false;
 }
 
-void timeline_init(Timeline* timeline, int num_days) {
+void timeline_init(Timeline* timeline) {
     if (timeline == NULL) return;
     
-    int total_slots = num_days * SLOTS_PER_DAY;
-    if (total_slots > MAX_SLOTS) {
-        total_slots = MAX_SLOTS;
-    }
-    
-    timeline->num_slots = total_slots;
     timeline->success = false;
+    timeline->budget_exhausted = false;
+    timeline->unplaced_task_ids = NULL;
+    timeline->num_unplaced = 0;
+    timeline->engine = ENGINE_BACKTRACK;
+    timeline->strategy[0] = '\0';
     timeline->error_message[0] = '\0';
+    timeline->moved_tasks = -1;
+    timeline->repaired = false;
+    timeline->cache_hit = false;
+    timeline->objective = OBJECTIVE_FEASIBLE;
+    timeline->objective_value = -1;
+    timeline->objective_bound = -1;
+    timeline->nodes = 0;
+    memset(&timeline->stats, 0, sizeof(timeline->stats));
     
-    for (int i = 0; i < total_slots; i++) {
+    int slots_per_day = MINUTES_PER_DAY / timeline->slot_minutes;
+    for (int i = 0; i < timeline->num_slots; i++) {
         timeslot_init(&timeline->slots[i], i);
+        timeline->slots[i].energy_level = curve_level(
+            NULL, timeline->slot_minutes,
+            (timeline->start_slot_of_day + i) % slots_per_day);
     }
+    
+    timeline_rebuild_occupancy(timeline);
 }
 
 
 /* ============================================================
- * Energy Level Functions
- * Requirements: 3.2, 3.3, 3.4
+ * Occupancy Bitmask
+ * 
+ * Bit i of timeline->occupied is set when slot i holds a task, is
+ * fixed, or lies past num_slots. Treating out-of-range slots as
+ * occupied lets run checks skip explicit bounds tests.
  * ============================================================ */
 
 /**
- * Get hour of day from slot index (0-23)
+ * Mask of bits [lo, hi) within a single word (0 <= lo <= hi <= 64)
  */
-static int slot_to_hour(int slot_index) {
-    int slot_in_day = slot_index % SLOTS_PER_DAY;
-    return slot_in_day / 2; /* 2 slots per hour */
+static uint64_t word_mask(int lo, int hi) {
+    uint64_t upper = (hi >= SLOT_WORD_BITS) ? ~UINT64_C(0) : ((UINT64_C(1) << hi) - 1);
+    uint64_t lower = (UINT64_C(1) << lo) - 1;
+    return upper & ~lower;
 }
 
-int get_energy_level(int slot_index) {
-    int hour = slot_to_hour(slot_index);
-    
-    /* Peak energy: 8-10am, 4-6pm -> energy 8-10 */
-    if ((hour >= 8 && hour < 10) || (hour >= 16 && hour < 18)) {
-        return 9;
-    }
-    
-    /* Medium energy: 6-8am, 10am-12pm, 2-4pm, 6-8pm -> energy 5-7 */
-    if ((hour >= 6 && hour < 8) || 
-        (hour >= 10 && hour < 12) ||
-        (hour >= 14 && hour < 16) ||
-        (hour >= 18 && hour < 20)) {
-        return 6;
-    }
-    
-    /* Low energy: after meals (12-2pm), late evening (8pm+), early morning */
-    if ((hour >= 12 && hour < 14) || hour >= 20 || hour < 6) {
-        return 3;
+static void bits_set_range(uint64_t* bits, int start, int length) {
+    int end = start + length;
+    while (start < end) {
+        int word = start / SLOT_WORD_BITS;
+        int lo = start % SLOT_WORD_BITS;
+        int hi = end - word * SLOT_WORD_BITS;
+        if (hi > SLOT_WORD_BITS) hi = SLOT_WORD_BITS;
+        bits[word] |= word_mask(lo, hi);
+        start = word * SLOT_WORD_BITS + hi;
     }
-    
-    /* Default medium */
-    return 5;
 }
 
-bool is_peak_energy_period(int slot_index) {
-    int hour = slot_to_hour(slot_index);
-    return (hour >= 8 && hour < 10) || (hour >= 16 && hour < 18);
+static void bits_clear_range(uint64_t* bits, int start, int length) {
+    int end = start + length;
+    while (start < end) {
+        int word = start / SLOT_WORD_BITS;
+        int lo = start % SLOT_WORD_BITS;
+        int hi = end - word * SLOT_WORD_BITS;
+        if (hi > SLOT_WORD_BITS) hi = SLOT_WORD_BITS;
+        bits[word] &= ~word_mask(lo, hi);
+        start = word * SLOT_WORD_BITS + hi;
+    }
 }
 
-bool is_medium_energy_period(int slot_index) {
-    int hour = slot_to_hour(slot_index);
-    return (hour >= 6 && hour < 8) || 
-           (hour >= 10 && hour < 12) ||
-           (hour >= 14 && hour < 16) ||
-           (hour >= 18 && hour < 20);
+/**
+ * dst = src >> shift across the multi-word bitmask, shifting in zeros
+ * from above so free runs never extend past the end of the mask.
+ */
+static void bits_shift_down(uint64_t* dst, const uint64_t* src, int shift, int num_words) {
+    int word_shift = shift / SLOT_WORD_BITS;
+    int bit_shift = shift % SLOT_WORD_BITS;
+    
+    for (int w = 0; w < num_words; w++) {
+        int a = w + word_shift;
+        int b = a + 1;
+        uint64_t lo = (a < num_words) ? src[a] : 0;
+        uint64_t hi = (b < num_words) ? src[b] : 0;
+        dst[w] = (bit_shift == 0) ? lo :
+                 (lo >> bit_shift) | (hi << (SLOT_WORD_BITS - bit_shift));
+    }
 }
 
-bool is_low_energy_period(int slot_index) {
-    int hour = slot_to_hour(slot_index);
-    return (hour >= 12 && hour < 14) || hour >= 20 || hour < 6;
+void timeline_rebuild_occupancy(Timeline* timeline) {
+    if (timeline == NULL) return;
+    
+    for (int w = 0; w < timeline->num_words; w++) {
+        timeline->occupied[w] = 0;
+    }
+    for (int i = 0; i < timeline->num_slots; i++) {
+        if (timeline->slots[i].task_id != -1 || timeline->slots[i].is_fixed) {
+            bits_set_range(timeline->occupied, i, 1);
+        }
+    }
+    bits_set_range(timeline->occupied, timeline->num_slots,
+                   timeline->num_words * SLOT_WORD_BITS - timeline->num_slots);
 }
 
-/* ============================================================
- * Priority Comparison
- * Requirements: 4.2
- * ============================================================ */
+bool timeline_is_range_free(const Timeline* timeline, int start, int length) {
+    if (timeline == NULL || start < 0 || length <= 0 ||
+        start + length > timeline->num_slots) {
+        return false;
+    }
+    
+    int end = start + length;
+    while (start < end) {
+        int word = start / SLOT_WORD_BITS;
+        int lo = start % SLOT_WORD_BITS;
+        int hi = end - word * SLOT_WORD_BITS;
+        if (hi > SLOT_WORD_BITS) hi = SLOT_WORD_BITS;
+        if (timeline->occupied[word] & word_mask(lo, hi)) {
+            return false;
+        }
+        start = word * SLOT_WORD_BITS + hi;
+    }
+    return true;
+}
 
-int task_compare_priority(const void* a, const void* b) {
-    const Task* task_a = (const Task*)a;
-    const Task* task_b = (const Task*)b;
+int timeline_free_starts(
+    const Timeline* timeline,
+    int length,
+    int limit,
+    uint64_t out[SLOT_WORDS]
+) {
+    if (timeline == NULL) {
+        return 0;
+    }
+    int num_words = timeline->num_words;
+    for (int w = 0; w < num_words; w++) {
+        out[w] = 0;
+    }
+    if (length <= 0) {
+        return 0;
+    }
+    if (limit > timeline->num_slots) {
+        limit = timeline->num_slots;
+    }
+    int last_start = limit - length;
+    if (last_start < 0) {
+        return 0;
+    }
     
-    /* Higher priority first (descending order) */
-    return task_b->priority - task_a->priority;
+    /*
+     * run[s] = 1 iff [s, s + covered) is free. Doubling `covered` with a
+     * shift-and-AND builds runs of any length in O(log length) passes.
+     */
+    uint64_t run[SLOT_WORDS];
+    uint64_t shifted[SLOT_WORDS];
+    for (int w = 0; w < num_words; w++) {
+        run[w] = ~timeline->occupied[w];
+    }
+    
+    int covered = 1;
+    while (covered < length) {
+        int step = (covered * 2 <= length) ? covered : length - covered;
+        bits_shift_down(shifted, run, step, num_words);
+        for (int w = 0; w < num_words; w++) {
+            run[w] &= shifted[w];
+        }
+        covered += step;
+    }
+    
+    /* Keep only starts whose run ends by the limit */
+    int count = 0;
+    for (int w = 0; w < num_words; w++) {
+        int base = w * SLOT_WORD_BITS;
+        if (base > last_start) break;
+        uint64_t bits = run[w];
+        if (last_start - base < SLOT_WORD_BITS - 1) {
+            bits &= word_mask(0, last_start - base + 1);
+        }
+        out[w] = bits;
+        count += __builtin_popcountll(bits);
+    }
+    return count;
 }
 
 
 /* ============================================================
- * Constraint Checking Functions
- * Requirements: 2.1, 2.2, 2.3, 2.4
+ * Free-Interval Index
+ * 
+ * Bottom-up segment tree: node 1 is the root, node i has children 2i
+ * and 2i+1, and leaf num_leaves + s holds slot s. Leaves past num_slots
+ * are taken, like the occupancy bits past num_slots.
  * ============================================================ */
 
 /**
- * Check if a slot is available (not occupied and not fixed)
+ * Free runs of one node's slot range
  */
-static bool is_slot_available(Timeline* timeline, int slot_index) {
-    if (slot_index < 0 || slot_index >= timeline->num_slots) {
-        return false;
-    }
-    return timeline->slots[slot_index].task_id == -1 && 
-           !timeline->slots[slot_index].is_fixed;
+typedef struct {
+    int prefix;                     /* Free run starting at the range's first slot */
+    int suffix;                     /* Free run ending at the range's last slot */
+    int longest;                    /* Longest free run inside the range */
+} FreeRun;
+
+struct FreeIndex {
+    int num_slots;                  /* Slots of the indexed timeline */
+    int num_leaves;                 /* num_slots rounded up to a power of two */
+    FreeRun* nodes;                 /* 2 * num_leaves nodes, node 0 unused */
+    Arena* arena;                   /* Arena holding the index, NULL if on the heap */
+};
+
+static bool slot_is_free(const Timeline* timeline, int slot) {
+    return !((timeline->occupied[slot / SLOT_WORD_BITS] >> (slot % SLOT_WORD_BITS)) & 1);
+}
+
+static void free_index_set_leaf(FreeIndex* index, const Timeline* timeline, int slot) {
+    int run = (slot < index->num_slots && slot_is_free(timeline, slot)) ? 1 : 0;
+    FreeRun* leaf = &index->nodes[index->num_leaves + slot];
+    leaf->prefix = run;
+    leaf->suffix = run;
+    leaf->longest = run;
 }
 
 /**
- * Check if task can be placed at given slot (all constraints)
- * - No overlap with existing tasks
- * - Not in fixed slots
- * - Before deadline if applicable
- * - Enough consecutive slots for duration
+ * Recompute node i, whose range holds len slots, from its children
  */
-static bool can_place_task(Timeline* timeline, Task* task, int start_slot) {
-    /* Check bounds */
-    if (start_slot < 0 || start_slot + task->duration_slots > timeline->num_slots) {
-        return false;
-    }
+static void free_index_pull(FreeIndex* index, int i, int len) {
+    const FreeRun* left = &index->nodes[2 * i];
+    const FreeRun* right = &index->nodes[2 * i + 1];
+    FreeRun* node = &index->nodes[i];
+    int half = len / 2;
     
-    /* Check deadline constraint */
-    if (task->deadline_slot >= 0) {
-        int end_slot = start_slot + task->duration_slots;
-        if (end_slot > task->deadline_slot) {
-            return false;
+    node->prefix = (left->prefix == half) ? half + right->prefix : left->prefix;
+    node->suffix = (right->suffix == half) ? half + left->suffix : right->suffix;
+    node->longest = left->suffix + right->prefix;
+    if (left->longest > node->longest) node->longest = left->longest;
+    if (right->longest > node->longest) node->longest = right->longest;
+}
+
+FreeIndex* free_index_create(Arena* arena, const Timeline* timeline) {
+    if (timeline == NULL) return NULL;
+    
+    int num_leaves = 1;
+    while (num_leaves < timeline->num_slots) num_leaves *= 2;
+    FreeIndex* index = (FreeIndex*)arena_alloc(
+        arena, sizeof(FreeIndex) + sizeof(FreeRun) * 2 * (size_t)num_leaves);
+    if (index == NULL) return NULL;
+    
+    index->num_slots = timeline->num_slots;
+    index->num_leaves = num_leaves;
+    index->nodes = (FreeRun*)(index + 1);
+    index->arena = arena;
+    for (int slot = 0; slot < num_leaves; slot++) {
+        free_index_set_leaf(index, timeline, slot);
+    }
+    for (int first = num_leaves / 2, len = 2; first >= 1; first /= 2, len *= 2) {
+        for (int i = first; i < 2 * first; i++) {
+            free_index_pull(index, i, len);
         }
     }
+    return index;
+}
+
+void free_index_free(FreeIndex* index) {
+    if (index != NULL) {
+        arena_free(index->arena, index);
+    }
+}
+
+void free_index_update(FreeIndex* index, const Timeline* timeline, int start, int length) {
+    if (index == NULL || length <= 0) return;
     
-    /* Check all required slots are available */
-    for (int i = 0; i < task->duration_slots; i++) {
-        if (!is_slot_available(timeline, start_slot + i)) {
-            return false;
+    for (int slot = start; slot < start + length; slot++) {
+        free_index_set_leaf(index, timeline, slot);
+    }
+    /* Only the ancestors of the changed leaves move, one span per level */
+    int lo = index->num_leaves + start;
+    int hi = index->num_leaves + start + length - 1;
+    for (int len = 2; lo > 1; len *= 2) {
+        lo /= 2;
+        hi /= 2;
+        for (int i = lo; i <= hi; i++) {
+            free_index_pull(index, i, len);
         }
     }
-    
-    return true;
 }
 
 /**
- * Place a task in the timeline at given slot
+ * Earliest start s >= from of a free run of length slots within node i,
+ * whose range [lo, lo + len) follows *run free slots (counted from from)
+ * @return Start slot, or -1 with *run set to the free run ending the range
  */
-static void place_task(Timeline* timeline, Task* task, int start_slot) {
-    for (int i = 0; i < task->duration_slots; i++) {
-        timeline->slots[start_slot + i].task_id = task->id;
+static int free_index_descend(const FreeIndex* index, int i, int lo, int len,
+                              int length, int from, int* run) {
+    if (lo + len <= from) {
+        *run = 0;
+        return -1;
+    }
+    
+    const FreeRun* node = &index->nodes[i];
+    if (lo >= from) {
+        if (*run + node->prefix >= length) {
+            return lo - *run;
+        }
+        if (node->longest < length) {
+            *run = (node->prefix == len) ? *run + len : node->suffix;
+            return -1;
+        }
     }
+    
+    int half = len / 2;
+    int start = free_index_descend(index, 2 * i, lo, half, length, from, run);
+    if (start >= 0) return start;
+    return free_index_descend(index, 2 * i + 1, lo + half, half, length, from, run);
 }
 
+int free_index_first_fit(const FreeIndex* index, int length, int from, int limit) {
+    if (index == NULL || length <= 0) return -1;
+    if (from < 0) from = 0;
+    if (limit > index->num_slots) limit = index->num_slots;
+    if (from > limit - length || index->nodes[1].longest < length) return -1;
+    
+    /* The earliest fit also ends earliest, so one check covers the limit */
+    int run = 0;
+    int start = free_index_descend(index, 1, 0, index->num_leaves, length, from, &run);
+    return (start >= 0 && start + length <= limit) ? start : -1;
+}
+
+
+/* ============================================================
+ * Energy Level Functions
+ * Requirements: 3.2, 3.3, 3.4
+ * ============================================================ */
+
 /**
- * Remove a task from the timeline
+ * Default energy curve, one level per half-hour slot of day:
+ * - Peak (9): 8-10am, 4-6pm
+ * - Medium (6): 6-8am, 10am-12pm, 2-4pm, 6-8pm
+ * - Low (3): after lunch (12-2pm), late evening (8pm+), before 6am
  */
-static void remove_task(Timeline* timeline, Task* task, int start_slot) {
-    for (int i = 0; i < task->duration_slots; i++) {
-        timeline->slots[start_slot + i].task_id = -1;
-    }
+static const uint8_t DEFAULT_ENERGY_CURVE[SLOTS_PER_DAY] = {
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,     /* 00:00 - 06:00 */
+    6, 6, 6, 6,                             /* 06:00 - 08:00 */
+    9, 9, 9, 9,                             /* 08:00 - 10:00 */
+    6, 6, 6, 6,                             /* 10:00 - 12:00 */
+    3, 3, 3, 3,                             /* 12:00 - 14:00 */
+    6, 6, 6, 6,                             /* 14:00 - 16:00 */
+    9, 9, 9, 9,                             /* 16:00 - 18:00 */
+    6, 6, 6, 6,                             /* 18:00 - 20:00 */
+    3, 3, 3, 3, 3, 3, 3, 3                  /* 20:00 - 24:00 */
+};
+
+static int slot_of_day(int slot_index) {
+    return slot_index % SLOTS_PER_DAY;
+}
+
+static bool level_is_peak(int level) {
+    return level >= ENERGY_PEAK_THRESHOLD;
+}
+
+static bool level_is_medium(int level) {
+    return level >= ENERGY_MEDIUM_THRESHOLD && level < ENERGY_PEAK_THRESHOLD;
+}
+
+static bool level_is_low(int level) {
+    return level < ENERGY_MEDIUM_THRESHOLD;
+}
+
+int get_energy_level(int slot_index) {
+    return DEFAULT_ENERGY_CURVE[slot_of_day(slot_index)];
+}
+
+bool is_peak_energy_period(int slot_index) {
+    return level_is_peak(get_energy_level(slot_index));
+}
+
+bool is_medium_energy_period(int slot_index) {
+    return level_is_medium(get_energy_level(slot_index));
+}
+
+bool is_low_energy_period(int slot_index) {
+    return level_is_low(get_energy_level(slot_index));
 }
 
 /**
- * Calculate energy match score for placing task at slot
- * Higher score = better match
+ * Score for a task type/preference at a given energy level.
+ * Only used to fill the EnergyTable; the solver never calls it directly.
  */
-static int calculate_energy_score(Task* task, int slot_index) {
+static int score_for_level(TaskType type, PreferredEnergy preference, int level) {
     int score = 0;
     
     /* Study and deep_work prefer peak energy */
-    if (task->type == TASK_STUDY || task->type == TASK_DEEP_WORK) {
-        if (is_peak_energy_period(slot_index)) {
+    if (type == TASK_STUDY || type == TASK_DEEP_WORK) {
+        if (level_is_peak(level)) {
             score += 10;
-        } else if (is_medium_energy_period(slot_index)) {
+        } else if (level_is_medium(level)) {
             score += 5;
         }
     }
     /* Practice and revision accept medium energy */
-    else if (task->type == TASK_PRACTICE || task->type == TASK_REVISION) {
-        if (is_peak_energy_period(slot_index)) {
+    else if (type == TASK_PRACTICE || type == TASK_REVISION) {
+        if (level_is_peak(level)) {
             score += 7;
-        } else if (is_medium_energy_period(slot_index)) {
+        } else if (level_is_medium(level)) {
             score += 8; /* Slightly prefer medium for these */
         }
     }
     /* Breaks and free time prefer low energy */
-    else if (task->type == TASK_BREAK || task->type == TASK_FREE_TIME) {
-        if (is_low_energy_period(slot_index)) {
+    else if (type == TASK_BREAK || type == TASK_FREE_TIME) {
+        if (level_is_low(level)) {
             score += 10;
         }
     }
     
     /* Match preferred energy if specified */
-    if (task->preferred_energy != ENERGY_ANY) {
-        if (task->preferred_energy == ENERGY_PREFER_PEAK && is_peak_energy_period(slot_index)) {
-            score += 5;
-        } else if (task->preferred_energy == ENERGY_PREFER_MEDIUM && is_medium_energy_period(slot_index)) {
-            score += 5;
-        } else if (task->preferred_energy == ENERGY_PREFER_LOW && is_low_energy_period(slot_index)) {
-            score += 5;
-        }
+    if ((preference == ENERGY_PREFER_PEAK && level_is_peak(level)) ||
+        (preference == ENERGY_PREFER_MEDIUM && level_is_medium(level)) ||
+        (preference == ENERGY_PREFER_LOW && level_is_low(level))) {
+        score += 5;
     }
     
     return score;
 }
 
-
-/* ============================================================
- * Backtracking Algorithm
- * Requirements: 2.1, 2.2, 2.3, 2.4
- * ============================================================ */
-
 /**
- * Find best slot for a task based on energy matching
- * Returns -1 if no valid slot found
- * 
- * Note: This function is available for future use in greedy scheduling
- * approaches. Currently the backtracking algorithm handles slot selection
- * internally with energy scoring.
+ * Energy level of a slot of day at a granularity: the rounded mean of the
+ * half-hours of curve the slot covers
+ * @param curve Energy level per half-hour of day, NULL for the default curve
  */
-#ifdef USE_GREEDY_SCHEDULER
-static int find_best_slot(Timeline* timeline, Task* task) {
-    int best_slot = -1;
-    int best_score = -1;
-    
-    for (int slot = 0; slot < timeline->num_slots; slot++) {
-        if (can_place_task(timeline, task, slot)) {
-            int score = calculate_energy_score(task, slot);
-            if (score > best_score) {
-                best_score = score;
-                best_slot = slot;
-            }
-        }
+static int curve_level(const uint8_t* curve, int slot_minutes, int slot_of_day) {
+    if (curve == NULL) {
+        curve = DEFAULT_ENERGY_CURVE;
     }
-    
-    return best_slot;
+    int first = slot_of_day * slot_minutes / 30;
+    int last = ((slot_of_day + 1) * slot_minutes - 1) / 30;
+    int sum = 0;
+    for (int h = first; h <= last; h++) {
+        sum += curve[h];
+    }
+    int count = last - first + 1;
+    return (sum * 2 + count) / (count * 2);
 }
-#endif
 
-/**
- * Recursive backtracking solver
- * @param timeline Current timeline state
- * @param tasks Array of tasks
- * @param num_tasks Total number of tasks
- * @param task_index Current task being placed
- * @param placements Array storing where each task is placed (-1 if not placed)
- * @return true if solution found
- */
-static bool backtrack(
-    Timeline* timeline,
-    Task* tasks,
-    int num_tasks,
-    int task_index,
-    int* placements
-) {
-    /* Base case: all tasks placed */
-    if (task_index >= num_tasks) {
-        return true;
-    }
-    
-    Task* task = &tasks[task_index];
-    
-    /* Skip fixed tasks - they're already placed */
-    if (task->is_fixed) {
-        return backtrack(timeline, tasks, num_tasks, task_index + 1, placements);
-    }
-    
-    /* Try each possible slot, prioritizing by energy score */
-    /* First pass: collect all valid slots with scores */
-    typedef struct {
-        int slot;
-        int score;
-    } SlotScore;
-    
-    SlotScore candidates[MAX_SLOTS];
-    int num_candidates = 0;
+void energy_table_build(EnergyTable* table, const uint8_t* curve) {
+    energy_table_build_ex(table, curve, DEFAULT_SLOT_MINUTES, 0);
+}
+
+void energy_table_build_ex(EnergyTable* table, const uint8_t* curve,
+                           int slot_minutes, int start_slot_of_day) {
+    if (table == NULL) return;
     
-    for (int slot = 0; slot < timeline->num_slots; slot++) {
-        if (can_place_task(timeline, task, slot)) {
-            candidates[num_candidates].slot = slot;
-            candidates[num_candidates].score = calculate_energy_score(task, slot);
-            num_candidates++;
-        }
+    int slots_per_day = MINUTES_PER_DAY / slot_minutes;
+    table->slots_per_day = slots_per_day;
+    table->start_slot_of_day = start_slot_of_day;
+    for (int s = 0; s < slots_per_day; s++) {
+        table->level[s] = (uint8_t)curve_level(curve, slot_minutes, s);
     }
-    
-    /* Sort candidates by score (descending) - simple bubble sort for small arrays */
-    for (int i = 0; i < num_candidates - 1; i++) {
-        for (int j = 0; j < num_candidates - i - 1; j++) {
-            if (candidates[j].score < candidates[j + 1].score) {
-                SlotScore temp = candidates[j];
-                candidates[j] = candidates[j + 1];
-                candidates[j + 1] = temp;
+    for (int type = 0; type < TASK_TYPE_COUNT; type++) {
+        for (int pref = 0; pref < ENERGY_PREFERENCE_COUNT; pref++) {
+            for (int s = 0; s < slots_per_day; s++) {
+                table->score[type][pref][s] = (uint8_t)score_for_level(
+                    (TaskType)type, (PreferredEnergy)pref, table->level[s]);
             }
         }
     }
-    
-    /* Try each candidate slot */
-    for (int i = 0; i < num_candidates; i++) {
-        int slot = candidates[i].slot;
-        
-        /* Place task */
-        place_task(timeline, task, slot);
-        placements[task_index] = slot;
-        
-        /* Recurse */
-        if (backtrack(timeline, tasks, num_tasks, task_index + 1, placements)) {
-            return true;
-        }
-        
-        /* Backtrack */
-        remove_task(timeline, task, slot);
-        placements[task_index] = -1;
-    }
-    
-    return false;
 }
 
+int calculate_energy_score(const EnergyTable* table, const Task* task, int slot_index) {
+    unsigned type = (unsigned)task->type;
+    unsigned pref = (unsigned)task->preferred_energy;
+    if (type >= TASK_TYPE_COUNT) return 0;
+    if (pref >= ENERGY_PREFERENCE_COUNT) pref = ENERGY_ANY;
+    int slot_of_day = (table->start_slot_of_day + slot_index) % table->slots_per_day;
+    return table->score[type][pref][slot_of_day];
+}
 
 /* ============================================================
- * Main Optimization Function
- * Requirements: 2.1, 2.2, 2.3, 2.4, 2.5
+ * Priority Comparison
+ * Requirements: 4.2
  * ============================================================ */
 
-Timeline* optimize_schedule(
-    Task* tasks,
-    int num_tasks,
-    TimeSlot* fixed_slots,
-    int num_fixed
-) {
-    /* Validate inputs */
-    if (num_tasks < 0 || num_tasks > MAX_TASKS) {
-        Timeline* timeline = timeline_create();
-        if (timeline) {
-            timeline->success = false;
+int task_compare_priority(const void* a, const void* b) {
+    const Task* task_a = (const Task*)a;
+    const Task* task_b = (const Task*)b;
+    
+    /* Higher priority first (descending order) */
+    return task_b->priority - task_a->priority;
+}
+
+
+/* ============================================================
+ * Solver Task Records
+ * 
+ * The solver sorts, copies and scans tasks constantly but never reads
+ * their names, so it works on compact records holding only the fields
+ * that shape the schedule (20 bytes instead of sizeof(Task)). Names stay
+ * in the caller's Task array for output and diagnostics.
+ * ============================================================ */
+
+typedef struct {
+    int id;                         /* Task ID, written to the slots */
+    int duration_slots;
+    int priority;
+    int deadline_slot;              /* -1 if none */
+    uint8_t type;                   /* TaskType, TASK_TYPE_COUNT if unknown */
+    uint8_t preferred_energy;       /* PreferredEnergy, out-of-range read as ENERGY_ANY */
+    bool is_fixed;
+} SolverTask;
+
+/**
+ * Copy the hot fields of tasks into solver records
+ * @param arena Arena to allocate from, NULL for the heap
+ * @return Records (release with arena_free()), NULL on allocation failure
+ */
+static SolverTask* solver_tasks_create(Arena* arena, const Task* tasks, int num_tasks) {
+    SolverTask* records =
+        (SolverTask*)arena_alloc(arena, sizeof(SolverTask) * (num_tasks > 0 ? num_tasks : 1));
+    if (records == NULL) return NULL;
+    
+    for (int i = 0; i < num_tasks; i++) {
+        const Task* task = &tasks[i];
+        unsigned type = (unsigned)task->type;
+        unsigned pref = (unsigned)task->preferred_energy;
+        records[i].id = task->id;
+        records[i].duration_slots = task->duration_slots;
+        records[i].priority = task->priority;
+        records[i].deadline_slot = task->deadline_slot;
+        records[i].type = (uint8_t)(type < TASK_TYPE_COUNT ? type : TASK_TYPE_COUNT);
+        records[i].preferred_energy = (uint8_t)(pref < ENERGY_PREFERENCE_COUNT ? pref : ENERGY_ANY);
+        records[i].is_fixed = task->is_fixed;
+    }
+    return records;
+}
+
+/**
+ * task_compare_priority for solver records
+ */
+static int solver_task_compare_priority(const void* a, const void* b) {
+    const SolverTask* task_a = (const SolverTask*)a;
+    const SolverTask* task_b = (const SolverTask*)b;
+    return task_b->priority - task_a->priority;
+}
+
+/**
+ * calculate_energy_score for a solver record, whose type and preference
+ * were range-checked when it was built
+ */
+static int task_energy_score(const EnergyTable* table, const SolverTask* task, int slot_index) {
+    if (task->type >= TASK_TYPE_COUNT) return 0;
+    int slot_of_day = (table->start_slot_of_day + slot_index) % table->slots_per_day;
+    return table->score[task->type][task->preferred_energy][slot_of_day];
+}
+
+
+/* ============================================================
+ * Constraint Checking Functions
+ * Requirements: 2.1, 2.2, 2.3, 2.4
+ * ============================================================ */
+
+/**
+ * Check if task can be placed at given slot (all constraints)
+ * - No overlap with existing tasks
+ * - Not in fixed slots
+ * - Before deadline if applicable
+ * - Enough consecutive slots for duration
+ */
+static bool can_place_task(Timeline* timeline, SolverTask* task, int start_slot) {
+    /* Check deadline constraint */
+    if (task->deadline_slot >= 0) {
+        int end_slot = start_slot + task->duration_slots;
+        if (end_slot > task->deadline_slot) {
+            return false;
+        }
+    }
+    
+    /* Bounds and availability in one bitmask test */
+    return timeline_is_range_free(timeline, start_slot, task->duration_slots);
+}
+
+/**
+ * Exclusive end bound for a task's run: its deadline or the timeline end
+ */
+static int task_slot_limit(const Timeline* timeline, const SolverTask* task) {
+    if (task->deadline_slot >= 0 && task->deadline_slot < timeline->num_slots) {
+        return task->deadline_slot;
+    }
+    return timeline->num_slots;
+}
+
+/**
+ * Place a task in the timeline at given slot.
+ * Only the occupancy bitmask is updated during search; task IDs are
+ * written to the slots once a full assignment is found.
+ */
+static void place_task(Timeline* timeline, SolverTask* task, int start_slot) {
+    bits_set_range(timeline->occupied, start_slot, task->duration_slots);
+    free_index_update(timeline->free_index, timeline, start_slot, task->duration_slots);
+}
+
+/**
+ * Remove a task from the timeline
+ */
+static void remove_task(Timeline* timeline, SolverTask* task, int start_slot) {
+    bits_clear_range(timeline->occupied, start_slot, task->duration_slots);
+    free_index_update(timeline->free_index, timeline, start_slot, task->duration_slots);
+}
+
+/**
+ * Write task IDs into the slots for every recorded placement
+ */
+static void commit_placements(
+    Timeline* timeline,
+    SolverTask* tasks,
+    int num_tasks,
+    const int* placements
+) {
+    for (int t = 0; t < num_tasks; t++) {
+        if (placements[t] < 0) continue;
+        for (int i = 0; i < tasks[t].duration_slots; i++) {
+            timeline->slots[placements[t] + i].task_id = tasks[t].id;
+        }
+    }
+}
+
+/* ============================================================
+ * Backtracking Algorithm
+ * Requirements: 2.1, 2.2, 2.3, 2.4
+ * ============================================================ */
+
+/**
+ * Candidate start slot with its energy score
+ */
+typedef struct {
+    int slot;
+    int score;
+} SlotScore;
+
+/**
+ * Slots of the horizon by energy score, for every task of one type and
+ * preference
+ */
+typedef struct {
+    uint32_t scores;                /* Bit s set if some slot scores s */
+    uint64_t* bits;                 /* One mask per score, num_words each; NULL if unused */
+} ScoreClass;
+
+/* Score classes: one per type (and unknown type) and preference */
+#define SCORE_CLASSES ((TASK_TYPE_COUNT + 1) * ENERGY_PREFERENCE_COUNT)
+
+/**
+ * One level of the explicit search stack. Its sorted candidates are
+ * stacked in the solver's pool right after the parent level's.
+ */
+typedef struct {
+    int first;                      /* Offset of the level's candidates in the pool */
+    int count;                      /* Candidates left to this solver (donations shrink it) */
+    int next;                       /* Next candidate to try */
+} SearchFrame;
+
+/* Candidate lists the pool first holds, in num_slots units; doubled as needed */
+#define POOL_INITIAL_LEVELS 4
+
+/* Nodes expanded between wall-clock budget checks */
+#define BUDGET_CHECK_INTERVAL 256
+
+/* Nodes expanded between checks for idle workers in a parallel search */
+#define SPLIT_CHECK_INTERVAL 64
+
+/* Nogood learning limits */
+#define NOGOOD_MAX_LITERALS 8       /* Larger conflict sets are not recorded */
+#define NOGOOD_BUCKETS 4096         /* Hash buckets over (task, slot) literals */
+
+/**
+ * One (task, start slot) assignment inside a learned nogood
+ */
+typedef struct {
+    int task;                       /* Task index in search order */
+    int slot;                       /* Start slot */
+} NogoodLiteral;
+
+/**
+ * Bounded table of learned nogoods: sets of placements that cannot all
+ * hold in any solution. Every literal is linked into a hash chain so a
+ * candidate only inspects the nogoods that mention it.
+ */
+typedef struct {
+    int capacity;                   /* Maximum nogoods; recording stops when full */
+    int count;                      /* Nogoods recorded */
+    NogoodLiteral* literals;        /* capacity * NOGOOD_MAX_LITERALS entries */
+    uint8_t* sizes;                 /* Literal count per nogood */
+    int* chain_next;                /* Next entry in the same bucket, -1 at end */
+    int bucket[NOGOOD_BUCKETS];     /* First entry per bucket, -1 if empty */
+} NogoodTable;
+
+/**
+ * A task's fit as it was before a placement made branch and bound
+ * recompute it
+ */
+typedef struct {
+    int task;                       /* Task index in search order */
+    int score;                      /* Previous fit_score */
+    int slot;                       /* Previous fit_slot */
+} FitEntry;
+
+/**
+ * Shared state of a portfolio run: set once any worker reaches a
+ * definitive result, telling the others to stop
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    bool done;                      /* A worker found a solution or proved there is none */
+    int winner;                     /* Index of that worker, -1 until done */
+} Portfolio;
+
+/**
+ * Node budget shared by searches that run one after another or side by
+ * side, handed out in chunks so that together they never exceed it
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    int64_t remaining;              /* Nodes not granted to any search yet */
+} NodePool;
+
+/**
+ * Solver state shared by every level of the search
+ */
+typedef struct {
+    Timeline* timeline;             /* Timeline being filled */
+    SolverTask* tasks;              /* Tasks in search order */
+    int num_tasks;                  /* Number of tasks */
+    int* placements;                /* Start slot per task, -1 if not placed */
+    const EnergyTable* energy;      /* Precomputed energy scores */
+    ScoreClass classes[SCORE_CLASSES]; /* Score masks by type and preference */
+    uint64_t* class_bits;           /* Masks of the classes the tasks use */
+    SlotScore* pool;                /* Sorted candidates of the open levels, stacked */
+    int pool_capacity;              /* Entries in pool, at least num_slots */
+    SearchFrame* frames;            /* Search stack, one frame per depth */
+    uint64_t starts[SLOT_WORDS];    /* Feasible starts of the level being opened */
+    
+    /* Search budget */
+    int64_t nodes;                  /* Nodes expanded so far */
+    int64_t max_nodes;              /* Node budget, 0 for unlimited */
+    NodePool* node_pool;            /* Pool max_nodes is drawn from, NULL for a fixed budget */
+    int64_t deadline_us;            /* Monotonic deadline, 0 for unlimited */
+    bool budget_exhausted;          /* Set once either budget runs out */
+    Portfolio* portfolio;           /* Portfolio run to poll for cancellation, NULL if alone */
+    bool cancelled;                 /* Stopped because another worker won */
+    SolverStats stats;              /* Counters of this search (nodes from the budget count) */
+    
+    /* Candidate ordering */
+    uint32_t tie_break_seed;        /* Rotates equal-score candidates, 0 for ascending slots */
+    
+    /* Best partial assignment (anytime result) */
+    int num_placed;                 /* Tasks placed on the current path */
+    int best_num_placed;            /* Most tasks placed on any path */
+    int* best_placements;           /* Placements for that path */
+    
+    /* Variable ordering */
+    int* order;                     /* Fixed order: task index per depth (fixed tasks skipped) */
+    int num_levels;                 /* Number of tasks the search must place */
+    int* level_task;                /* Task index placed at each depth */
+    int* task_depth;                /* Depth at which each task is placed */
+    
+    /* Forward checking */
+    bool forward_checking;          /* Prune wiped-out domains, MRV ordering */
+    int* domain_size;               /* Feasible start count per unplaced task */
+    
+    /* Conflict-directed backjumping */
+    bool backjumping;               /* Jump to the deepest culprit on failure */
+    int conf_words;                 /* Words per depth bitset */
+    uint64_t* conf;                 /* Conflict set per depth */
+    uint64_t* child_conf;           /* Conflict set handed back by a failed child */
+    int* slot_depth;                /* Depth whose task occupies each slot, -1 if none */
+    NogoodTable* nogoods;           /* Learned nogoods, NULL if disabled */
+    
+    /* Symmetry breaking */
+    int* prev_twin;                 /* Previous task identical to each task in search order, -1 if none */
+    
+    /* Branch and bound, with OBJECTIVE_MAXIMIZE_ENERGY_FIT (arrays NULL otherwise) */
+    bool weight_by_priority;        /* Scores count priority times */
+    int* fit_score;                 /* Best score each unplaced task can still reach, -1 if none */
+    int* fit_slot;                  /* A feasible start with that score */
+    FitEntry* trail;                /* Fits overwritten by the current placements, oldest first */
+    int trail_length;               /* Entries in trail */
+    int trail_capacity;             /* Allocated entries */
+    int* trail_mark;                /* Trail length before the placement at each depth */
+    int64_t* node_bound;            /* Bound of the node each open level expands */
+    int64_t placed_value;           /* Weighted score of the current placements */
+    int64_t rest_bound;             /* Weighted fits of the unplaced tasks */
+    int64_t root_bound;             /* rest_bound with nothing placed, -1 if infeasible */
+    int64_t incumbent;              /* Value of the best schedule found, -1 if none */
+    int* incumbent_placements;      /* Its placements */
+    int64_t objective_bound;        /* Proven upper bound on any schedule's value */
+    
+    /* Greedy placement */
+    FreeIndex* free_index;          /* Free runs of the timeline while greedy_schedule runs */
+    
+    /* Work splitting */
+    struct ParallelSearch* parallel; /* Shared work pool, NULL for a sequential search */
+    int worker;                     /* Index of this solver's worker in the pool */
+    int64_t reported_nodes;         /* Nodes already added to the pool's count */
+    int* split_prefix;              /* Scratch placements for donated items */
+    Arena* arena;                   /* Arena holding the solver state, NULL if on the heap */
+} Solver;
+
+static void parallel_poll(Solver* solver, int depth);
+
+/* Search counters; without AESA_STATS they are only type-checked */
+#ifdef AESA_STATS
+#define STAT_ADD(solver, field, n) ((solver)->stats.field += (n))
+#define STAT_DEPTH(solver, depth) \
+    ((depth) > (solver)->stats.max_depth ? (void)((solver)->stats.max_depth = (depth)) : (void)0)
+#else
+#define STAT_ADD(solver, field, n) ((void)sizeof((solver)->stats.field += (n)))
+#define STAT_DEPTH(solver, depth) ((void)sizeof((solver)->stats.max_depth = (depth)))
+#endif
+
+/**
+ * Add the counters of a finished sub-search (every field but nodes,
+ * which the callers total through the budget count)
+ */
+static void stats_merge(SolverStats* into, const SolverStats* from) {
+    into->backtracks += from->backtracks;
+    into->candidates += from->candidates;
+    into->pruned += from->pruned;
+    if (from->max_depth > into->max_depth) into->max_depth = from->max_depth;
+}
+
+/**
+ * Monotonic clock in microseconds
+ */
+static int64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Check whether another portfolio worker has already finished
+ */
+static bool portfolio_done(Portfolio* portfolio) {
+    if (portfolio == NULL) return false;
+    
+    pthread_mutex_lock(&portfolio->lock);
+    bool done = portfolio->done;
+    pthread_mutex_unlock(&portfolio->lock);
+    return done;
+}
+
+/**
+ * Draw up to BUDGET_CHECK_INTERVAL more nodes from solver's pool
+ * @return false if the pool is empty
+ */
+static bool node_pool_draw(Solver* solver) {
+    NodePool* pool = solver->node_pool;
+    
+    pthread_mutex_lock(&pool->lock);
+    int64_t grant = pool->remaining < BUDGET_CHECK_INTERVAL ?
+        pool->remaining : BUDGET_CHECK_INTERVAL;
+    pool->remaining -= grant;
+    pthread_mutex_unlock(&pool->lock);
+    solver->max_nodes += grant;
+    return grant > 0;
+}
+
+/**
+ * Count a node expansion against the budget
+ * @return true if the search must stop
+ */
+static bool budget_spent(Solver* solver) {
+    if (solver->budget_exhausted) {
+        return true;
+    }
+    
+    solver->nodes++;
+    if (solver->max_nodes > 0 && solver->nodes > solver->max_nodes &&
+        (solver->node_pool == NULL || !node_pool_draw(solver))) {
+        solver->budget_exhausted = true;
+    } else if (solver->nodes % BUDGET_CHECK_INTERVAL == 0) {
+        if (solver->deadline_us > 0 && monotonic_us() >= solver->deadline_us) {
+            solver->budget_exhausted = true;
+        } else if (portfolio_done(solver->portfolio)) {
+            solver->budget_exhausted = true;
+            solver->cancelled = true;
+        }
+    }
+    return solver->budget_exhausted;
+}
+
+/**
+ * Remember the current path if it places more tasks than any before
+ */
+static void record_partial(Solver* solver) {
+    if (solver->num_placed > solver->best_num_placed) {
+        solver->best_num_placed = solver->num_placed;
+        memcpy(solver->best_placements, solver->placements,
+               sizeof(int) * solver->num_tasks);
+    }
+}
+
+/* ============================================================
+ * Score Classes
+ * 
+ * A task's energy score depends only on its type, its preference and
+ * the slot, so tasks sharing type and preference score every slot the
+ * same. For each such class a request uses, the solver keeps one slot
+ * bitmask per score. ANDing a task's feasible starts with those masks,
+ * highest score first, yields its candidates 64 slots per operation and
+ * already in order, with no per-slot lookup or sort.
+ * ============================================================ */
+
+static int score_class_index(int type, int preference) {
+    return type * ENERGY_PREFERENCE_COUNT + preference;
+}
+
+static const ScoreClass* task_score_class(const Solver* solver, const SolverTask* task) {
+    return &solver->classes[score_class_index(task->type, task->preferred_energy)];
+}
+
+/**
+ * Mark the classes of tasks in used
+ * @return Number of classes used
+ */
+static int score_classes_used(const SolverTask* tasks, int num_tasks, bool used[SCORE_CLASSES]) {
+    int count = 0;
+    memset(used, 0, sizeof(bool) * SCORE_CLASSES);
+    for (int t = 0; t < num_tasks; t++) {
+        int c = score_class_index(tasks[t].type, tasks[t].preferred_energy);
+        if (!used[c]) count++;
+        used[c] = true;
+    }
+    return count;
+}
+
+/* Words of score masks per class */
+static size_t score_class_words(int num_words) {
+    return (size_t)(MAX_ENERGY_SCORE + 1) * (size_t)num_words;
+}
+
+/**
+ * Fill the score masks of the used classes from solver->class_bits
+ */
+static void score_classes_build(Solver* solver, const bool used[SCORE_CLASSES]) {
+    const Timeline* timeline = solver->timeline;
+    int num_words = timeline->num_words;
+    size_t class_words = score_class_words(num_words);
+    uint64_t* bits = solver->class_bits;
+    
+    for (int c = 0; c < SCORE_CLASSES; c++) {
+        ScoreClass* score_class = &solver->classes[c];
+        score_class->scores = 0;
+        score_class->bits = NULL;
+        if (!used[c]) continue;
+        
+        SolverTask probe;
+        memset(&probe, 0, sizeof(probe));
+        probe.type = (uint8_t)(c / ENERGY_PREFERENCE_COUNT);
+        probe.preferred_energy = (uint8_t)(c % ENERGY_PREFERENCE_COUNT);
+        score_class->bits = bits;
+        bits += class_words;
+        memset(score_class->bits, 0, sizeof(uint64_t) * class_words);
+        for (int slot = 0; slot < timeline->num_slots; slot++) {
+            int score = task_energy_score(solver->energy, &probe, slot);
+            score_class->bits[(size_t)score * num_words + slot / SLOT_WORD_BITS] |=
+                UINT64_C(1) << (slot % SLOT_WORD_BITS);
+            score_class->scores |= UINT32_C(1) << score;
+        }
+    }
+}
+
+/**
+ * Highest score left in a class's score set, taken out of it
+ */
+static int take_highest_score(uint32_t* scores) {
+    int score = 31 - __builtin_clz(*scores);
+    *scores &= ~(UINT32_C(1) << score);
+    return score;
+}
+
+/**
+ * Append the starts in [from, to) that score `score`, in slot order
+ * @return New candidate count
+ */
+static int append_starts(SlotScore* out, int count, const uint64_t* starts,
+                         const uint64_t* mask, int from, int to, int score) {
+    if (from >= to) return count;
+    for (int w = from / SLOT_WORD_BITS; w * SLOT_WORD_BITS < to; w++) {
+        int base = w * SLOT_WORD_BITS;
+        int lo = from > base ? from - base : 0;
+        int hi = to - base < SLOT_WORD_BITS ? to - base : SLOT_WORD_BITS;
+        uint64_t bits = starts[w] & mask[w] & word_mask(lo, hi);
+        while (bits) {
+            out[count].slot = base + __builtin_ctzll(bits);
+            out[count].score = score;
+            count++;
+            bits &= bits - 1;
+        }
+    }
+    return count;
+}
+
+/**
+ * First slot of a task's rotated tie-break order, 0 without a seed
+ */
+static int tie_break_offset(const Solver* solver, const SolverTask* task) {
+    if (solver->tie_break_seed == 0) return 0;
+    
+    uint32_t h = solver->tie_break_seed * UINT32_C(0x9E3779B1) ^
+                 (uint32_t)task->id * UINT32_C(0x85EBCA6B);
+    h ^= h >> 16;
+    return (int)(h % (uint32_t)solver->timeline->num_slots);
+}
+
+/**
+ * Position of a start slot in the order collect_candidates tries a
+ * task's candidates: energy score descending, then rotated slot order
+ */
+static int64_t candidate_rank(const Solver* solver, const SolverTask* task, int slot) {
+    int num_slots = solver->timeline->num_slots;
+    int score = task_energy_score(solver->energy, task, slot);
+    int position = (slot - tie_break_offset(solver, task) + num_slots) % num_slots;
+    return (int64_t)(MAX_ENERGY_SCORE - score) * num_slots + position;
+}
+
+/**
+ * Collect every feasible start slot for a task, ordered by energy score
+ * (descending, ties by ascending slot), one score mask at a time
+ * @param starts Output: bitmask of the feasible start slots
+ * @return Number of candidates written to out
+ */
+static int collect_candidates(
+    Solver* solver,
+    const SolverTask* task,
+    SlotScore* out,
+    uint64_t starts[SLOT_WORDS]
+) {
+    Timeline* timeline = solver->timeline;
+    const ScoreClass* score_class = task_score_class(solver, task);
+    int num_words = timeline->num_words;
+    
+    int num_starts = timeline_free_starts(timeline, task->duration_slots,
+                                          task_slot_limit(timeline, task), starts);
+    
+    if (num_starts == 0) return 0;
+    
+    /* Only the words holding starts are scanned per score */
+    int lo = 0;
+    int hi = num_words;
+    while (starts[lo] == 0) lo++;
+    while (starts[hi - 1] == 0) hi--;
+    lo *= SLOT_WORD_BITS;
+    hi *= SLOT_WORD_BITS;
+    
+    /* With a tie-break seed, equal scores are taken in slot order rotated
+     * to start at a per-task offset instead of at slot 0 */
+    int offset = tie_break_offset(solver, task);
+    if (offset < lo) offset = lo;
+    if (offset > hi) offset = hi;
+    int num_candidates = 0;
+    uint32_t scores = score_class->scores;
+    while (num_candidates < num_starts && scores != 0) {
+        int score = take_highest_score(&scores);
+        const uint64_t* mask = score_class->bits + (size_t)score * num_words;
+        num_candidates = append_starts(out, num_candidates, starts, mask, offset, hi, score);
+        num_candidates = append_starts(out, num_candidates, starts, mask, lo, offset, score);
+    }
+    
+    return num_candidates;
+}
+
+/**
+ * Find best slot for a task based on energy matching
+ * Only free runs long enough for the task are visited: the free-interval
+ * index finds the next one, and within it every start is feasible until
+ * the slot after the window is taken.
+ * Returns -1 if no valid slot found
+ */
+static int find_best_slot(Solver* solver, SolverTask* task) {
+    Timeline* timeline = solver->timeline;
+    int length = task->duration_slots;
+    int limit = task_slot_limit(timeline, task);
+    int best_slot = -1;
+    int best_score = -1;
+    
+    int slot = free_index_first_fit(timeline->free_index, length, 0, limit);
+    while (slot >= 0) {
+        do {
+            int score = task_energy_score(solver->energy, task, slot);
+            if (score > best_score) {
+                best_score = score;
+                best_slot = slot;
+            }
+            slot++;
+        } while (slot + length <= limit && slot_is_free(timeline, slot + length - 1));
+        
+        /* Slot slot + length - 1 is taken (or past the limit) */
+        slot = free_index_first_fit(timeline->free_index, length, slot + length, limit);
+    }
+    
+    return best_slot;
+}
+
+/* ============================================================
+ * Forward Checking with MRV Ordering
+ * ============================================================ */
+
+/**
+ * Count the feasible start slots a task has in the current timeline
+ */
+static int count_domain(const Timeline* timeline, const SolverTask* task) {
+    uint64_t starts[SLOT_WORDS];
+    return timeline_free_starts(timeline, task->duration_slots,
+                                task_slot_limit(timeline, task), starts);
+}
+
+/**
+ * Refresh domain sizes of unplaced tasks after placing or removing a
+ * run starting at start_slot (-1 refreshes every task). Tasks whose
+ * window ends at or before the run keep their cached size.
+ * @return Index of the first task left with no feasible start, -1 if none
+ */
+static int update_domains(Solver* solver, int start_slot) {
+    int wiped_out = -1;
+    
+    for (int t = 0; t < solver->num_tasks; t++) {
+        SolverTask* task = &solver->tasks[t];
+        if (task->is_fixed || solver->placements[t] >= 0) continue;
+        if (task_slot_limit(solver->timeline, task) <= start_slot) continue;
+        
+        solver->domain_size[t] = count_domain(solver->timeline, task);
+        if (solver->domain_size[t] == 0 && wiped_out < 0) {
+            wiped_out = t;
+        }
+    }
+    return wiped_out;
+}
+
+/**
+ * Pick the unplaced task with the fewest feasible starts. Tasks are in
+ * priority order, so the lowest index wins ties.
+ * @return Task index, -1 if every task is placed
+ */
+static int select_mrv_task(Solver* solver) {
+    int best = -1;
+    
+    for (int t = 0; t < solver->num_tasks; t++) {
+        if (solver->tasks[t].is_fixed || solver->placements[t] >= 0) continue;
+        if (best < 0 || solver->domain_size[t] < solver->domain_size[best]) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+
+/* ============================================================
+ * Conflict-Directed Backjumping
+ * 
+ * Each depth keeps a conflict set: the earlier depths whose placements
+ * ruled out one of its start slots, directly or through a deeper
+ * failure. When every candidate fails, the search jumps straight back
+ * to the deepest depth in that set, skipping levels that played no part.
+ * ============================================================ */
+
+static void conf_clear(const Solver* solver, uint64_t* set) {
+    memset(set, 0, sizeof(uint64_t) * solver->conf_words);
+}
+
+static void conf_add(uint64_t* set, int depth) {
+    set[depth / 64] |= UINT64_C(1) << (depth % 64);
+}
+
+static bool conf_has(const uint64_t* set, int depth) {
+    return (set[depth / 64] >> (depth % 64)) & 1;
+}
+
+/**
+ * dst |= src, leaving out `depth` itself
+ */
+static void conf_merge_except(const Solver* solver, uint64_t* dst,
+                              const uint64_t* src, int depth) {
+    for (int w = 0; w < solver->conf_words; w++) {
+        dst[w] |= src[w];
+    }
+    dst[depth / 64] &= ~(UINT64_C(1) << (depth % 64));
+}
+
+/**
+ * Add to conf the culprit of every start slot the task cannot use.
+ * A window that overlaps a fixed slot has no culprit; otherwise the
+ * shallowest depth occupying it is blamed, so jumps reach as far back
+ * as possible.
+ */
+static void explain_blocked(
+    const Solver* solver,
+    const SolverTask* task,
+    const uint64_t starts[SLOT_WORDS],
+    uint64_t* conf
+) {
+    const Timeline* timeline = solver->timeline;
+    int last_start = task_slot_limit(timeline, task) - task->duration_slots;
+    
+    for (int s = 0; s <= last_start; s++) {
+        if ((starts[s / SLOT_WORD_BITS] >> (s % SLOT_WORD_BITS)) & 1) continue;
+        
+        int culprit = -1;
+        for (int i = s; i < s + task->duration_slots; i++) {
+            if (timeline->slots[i].is_fixed) {
+                culprit = -1;
+                break;
+            }
+            int depth = solver->slot_depth[i];
+            if (depth >= 0 && (culprit < 0 || depth < culprit)) {
+                culprit = depth;
+            }
+        }
+        if (culprit >= 0) {
+            conf_add(conf, culprit);
+        }
+    }
+}
+
+static void claim_slots(Solver* solver, const SolverTask* task, int start_slot, int depth) {
+    for (int i = 0; i < task->duration_slots; i++) {
+        solver->slot_depth[start_slot + i] = depth;
+    }
+}
+
+
+/* ============================================================
+ * Nogood Learning
+ * ============================================================ */
+
+static NogoodTable* nogood_table_create(Arena* arena, int capacity) {
+    NogoodTable* table = (NogoodTable*)arena_alloc(arena, sizeof(NogoodTable));
+    if (table == NULL) return NULL;
+    
+    int entries = capacity * NOGOOD_MAX_LITERALS;
+    table->capacity = capacity;
+    table->count = 0;
+    table->literals = (NogoodLiteral*)arena_alloc(arena, sizeof(NogoodLiteral) * entries);
+    table->sizes = (uint8_t*)arena_alloc(arena, sizeof(uint8_t) * capacity);
+    table->chain_next = (int*)arena_alloc(arena, sizeof(int) * entries);
+    if (table->literals == NULL || table->sizes == NULL || table->chain_next == NULL) {
+        arena_free(arena, table->literals);
+        arena_free(arena, table->sizes);
+        arena_free(arena, table->chain_next);
+        arena_free(arena, table);
+        return NULL;
+    }
+    for (int b = 0; b < NOGOOD_BUCKETS; b++) {
+        table->bucket[b] = -1;
+    }
+    return table;
+}
+
+static void nogood_table_free(Arena* arena, NogoodTable* table) {
+    if (table != NULL) {
+        arena_free(arena, table->literals);
+        arena_free(arena, table->sizes);
+        arena_free(arena, table->chain_next);
+        arena_free(arena, table);
+    }
+}
+
+static int nogood_bucket(int task, int slot) {
+    uint32_t key = (uint32_t)task * MAX_SLOTS + (uint32_t)slot;
+    return (int)((key * UINT32_C(2654435761)) >> 20) & (NOGOOD_BUCKETS - 1);
+}
+
+/**
+ * Record the placements of the depths in conf as a nogood
+ */
+static void record_nogood(Solver* solver, const uint64_t* conf) {
+    NogoodTable* table = solver->nogoods;
+    if (table == NULL || table->count >= table->capacity) return;
+    
+    int id = table->count;
+    int size = 0;
+    for (int w = 0; w < solver->conf_words; w++) {
+        uint64_t bits = conf[w];
+        while (bits) {
+            int depth = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (size == NOGOOD_MAX_LITERALS) return;
+            
+            int task = solver->level_task[depth];
+            NogoodLiteral* lit = &table->literals[id * NOGOOD_MAX_LITERALS + size];
+            lit->task = task;
+            lit->slot = solver->placements[task];
+            size++;
+        }
+    }
+    
+    /* An empty set means the problem is infeasible; the search already knows */
+    if (size == 0) return;
+    
+    table->sizes[id] = (uint8_t)size;
+    for (int i = 0; i < size; i++) {
+        int entry = id * NOGOOD_MAX_LITERALS + i;
+        NogoodLiteral* lit = &table->literals[entry];
+        int b = nogood_bucket(lit->task, lit->slot);
+        table->chain_next[entry] = table->bucket[b];
+        table->bucket[b] = entry;
+    }
+    table->count++;
+}
+
+/**
+ * Check whether placing task at slot would complete a learned nogood.
+ * If so, the depths of its other placements are added to conf.
+ */
+static bool nogood_blocks(Solver* solver, int task, int slot, uint64_t* conf) {
+    const NogoodTable* table = solver->nogoods;
+    
+    for (int entry = table->bucket[nogood_bucket(task, slot)];
+         entry >= 0; entry = table->chain_next[entry]) {
+        const NogoodLiteral* hit = &table->literals[entry];
+        if (hit->task != task || hit->slot != slot) continue;
+        
+        int id = entry / NOGOOD_MAX_LITERALS;
+        const NogoodLiteral* lits = &table->literals[id * NOGOOD_MAX_LITERALS];
+        bool violated = true;
+        for (int i = 0; i < table->sizes[id]; i++) {
+            if (lits[i].task != task && solver->placements[lits[i].task] != lits[i].slot) {
+                violated = false;
+                break;
+            }
+        }
+        if (!violated) continue;
+        
+        for (int i = 0; i < table->sizes[id]; i++) {
+            if (lits[i].task != task) {
+                conf_add(conf, solver->task_depth[lits[i].task]);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+
+/* ============================================================
+ * Symmetry Breaking
+ * 
+ * Tasks identical in everything but ID and name are interchangeable:
+ * swapping two of them in a schedule gives another schedule. Each task
+ * is linked to the previous identical task in search order, its twin,
+ * and may only take a start its twin would have tried after its own.
+ * A start the twin tries earlier either failed for the twin already,
+ * or leads to the mirror image of a subtree searched from there, so
+ * the first solution found is unchanged while the k! orderings of k
+ * twins are searched once.
+ * ============================================================ */
+
+/**
+ * Sort entry for grouping identical tasks
+ */
+typedef struct {
+    SolverTask task;
+    int index;                      /* Index in search order */
+} TwinKey;
+
+static int twin_key_compare(const void* a, const void* b) {
+    const TwinKey* ka = (const TwinKey*)a;
+    const TwinKey* kb = (const TwinKey*)b;
+    const SolverTask* ta = &ka->task;
+    const SolverTask* tb = &kb->task;
+    if (ta->duration_slots != tb->duration_slots) return ta->duration_slots < tb->duration_slots ? -1 : 1;
+    if (ta->deadline_slot != tb->deadline_slot) return ta->deadline_slot < tb->deadline_slot ? -1 : 1;
+    if (ta->priority != tb->priority) return ta->priority < tb->priority ? -1 : 1;
+    if (ta->type != tb->type) return ta->type < tb->type ? -1 : 1;
+    if (ta->preferred_energy != tb->preferred_energy) {
+        return ta->preferred_energy < tb->preferred_energy ? -1 : 1;
+    }
+    return (ka->index > kb->index) - (ka->index < kb->index);
+}
+
+static bool tasks_identical(const SolverTask* a, const SolverTask* b) {
+    return a->duration_slots == b->duration_slots && a->deadline_slot == b->deadline_slot &&
+           a->priority == b->priority && a->type == b->type &&
+           a->preferred_energy == b->preferred_energy;
+}
+
+/**
+ * Fill solver->prev_twin. Without memory for the sort, no task gets a
+ * twin and the search runs without symmetry breaking.
+ */
+static void link_twins(Solver* solver) {
+    int count = 0;
+    TwinKey* keys = (TwinKey*)arena_alloc(solver->arena, sizeof(TwinKey) * (solver->num_tasks + 1));
+    if (keys == NULL) return;
+    
+    for (int t = 0; t < solver->num_tasks; t++) {
+        if (solver->tasks[t].is_fixed) continue;
+        keys[count].task = solver->tasks[t];
+        keys[count].index = t;
+        count++;
+    }
+    qsort(keys, count, sizeof(TwinKey), twin_key_compare);
+    for (int k = 1; k < count; k++) {
+        if (tasks_identical(&keys[k - 1].task, &keys[k].task)) {
+            solver->prev_twin[keys[k].index] = keys[k - 1].index;
+        }
+    }
+    arena_free(solver->arena, keys);
+}
+
+/**
+ * Drop the candidates of a task that its placed twin tries no later than
+ * its own start. The twin's depth joins conf, since its placement is
+ * what rules them out.
+ * @return Number of candidates kept, compacted to the front
+ */
+static int break_symmetry(
+    Solver* solver,
+    int task_index,
+    SlotScore* candidates,
+    int count,
+    uint64_t* conf
+) {
+    int twin = solver->prev_twin[task_index];
+    if (twin < 0 || solver->placements[twin] < 0) return count;
+    
+    const SolverTask* twin_task = &solver->tasks[twin];
+    int64_t bound = candidate_rank(solver, twin_task, solver->placements[twin]);
+    int kept = 0;
+    for (int k = 0; k < count; k++) {
+        if (candidate_rank(solver, twin_task, candidates[k].slot) > bound) {
+            candidates[kept++] = candidates[k];
+        }
+    }
+    if (kept < count && conf != NULL) {
+        conf_add(conf, solver->task_depth[twin]);
+    }
+    return kept;
+}
+
+
+/* ============================================================
+ * Capacity Pre-check
+ *
+ * Many infeasible requests are refuted without search. In deadline
+ * order, the tasks due by slot D need at least their total duration of
+ * free slots before D, and every task needs a free run as long as
+ * itself before its limit. One sweep over the slots checks both, at
+ * every limit, in O(n + slots). A violation is a proof, so the search
+ * is skipped and the message names the limit and the tasks involved.
+ * ============================================================ */
+
+/**
+ * Append the IDs of the searched tasks due by limit to a message,
+ * eliding the tail once the message is nearly full
+ */
+static void append_due_tasks(const Solver* solver, int limit, char* message, size_t len) {
+    size_t used = strlen(message);
+    const char* separator = " (tasks ";
+    for (int t = 0; t < solver->num_tasks; t++) {
+        const SolverTask* task = &solver->tasks[t];
+        if (task->is_fixed || task->duration_slots <= 0 ||
+            task_slot_limit(solver->timeline, task) > limit) continue;
+
+        char id[24];
+        int n = snprintf(id, sizeof(id), "%s%d", separator, task->id);
+        /* Keep room for a separator, "...)" and the terminator */
+        if (used + (size_t)n + 13 > len) {
+            snprintf(message + used, len - used, "%s...)", separator);
+            return;
+        }
+        memcpy(message + used, id, (size_t)n + 1);
+        used += (size_t)n;
+        separator = ", ";
+    }
+    snprintf(message + used, len - used, ")");
+}
+
+/**
+ * Check demand against free capacity at every task limit
+ * @return false if the tasks cannot all be placed; the timeline's
+ *         error message then names the cause
+ */
+static bool capacity_check(Solver* solver) {
+    Timeline* timeline = solver->timeline;
+    int num_slots = timeline->num_slots;
+
+    /* Demand and longest duration per limit. Demand saturates at
+     * num_slots + 1, which no supply reaches. */
+    int* due = (int*)arena_alloc(solver->arena, sizeof(int) * 2 * (size_t)(num_slots + 1));
+    if (due == NULL) return true;
+    int* longest_due = due + num_slots + 1;
+    memset(due, 0, sizeof(int) * 2 * (size_t)(num_slots + 1));
+    for (int t = 0; t < solver->num_tasks; t++) {
+        const SolverTask* task = &solver->tasks[t];
+        if (task->is_fixed || task->duration_slots <= 0) continue;
+        int limit = task_slot_limit(timeline, task);
+        int length = task->duration_slots > num_slots ? num_slots + 1 : task->duration_slots;
+        due[limit] += length;
+        if (due[limit] > num_slots + 1) due[limit] = num_slots + 1;
+        if (length > longest_due[limit]) longest_due[limit] = length;
+    }
+
+    int demand = 0;
+    int supply = 0;
+    int run = 0;
+    int longest_run = 0;
+    bool feasible = true;
+    for (int limit = 0; limit <= num_slots && feasible; limit++) {
+        if (limit > 0) {
+            /* Free slots and longest free run before limit */
+            run = slot_is_free(timeline, limit - 1) ? run + 1 : 0;
+            if (run > 0) supply++;
+            if (run > longest_run) longest_run = run;
+        }
+        demand += due[limit];
+        if (demand > num_slots + 1) demand = num_slots + 1;
+
+        if (longest_due[limit] > longest_run) {
+            for (int t = 0; t < solver->num_tasks; t++) {
+                const SolverTask* task = &solver->tasks[t];
+                if (!task->is_fixed && task->duration_slots > longest_run &&
+                    task_slot_limit(timeline, task) == limit) {
+                    snprintf(timeline->error_message, MAX_ERROR_LEN,
+                             "NO_SOLUTION: Task %d needs %d consecutive free slots before "
+                             "slot %d but the longest free run is %d",
+                             task->id, task->duration_slots, limit, longest_run);
+                    break;
+                }
+            }
+            feasible = false;
+        } else if (demand > supply) {
+            int64_t needed = 0;
+            for (int t = 0; t < solver->num_tasks; t++) {
+                const SolverTask* task = &solver->tasks[t];
+                if (!task->is_fixed && task->duration_slots > 0 &&
+                    task_slot_limit(timeline, task) <= limit) {
+                    needed += task->duration_slots;
+                }
+            }
+            snprintf(timeline->error_message, MAX_ERROR_LEN,
+                     "NO_SOLUTION: Tasks due by slot %d need %lld slots but only %d are free",
+                     limit, (long long)needed, supply);
+            append_due_tasks(solver, limit, timeline->error_message, MAX_ERROR_LEN);
+            feasible = false;
+        }
+    }
+
+    arena_free(solver->arena, due);
+    return feasible;
+}
+
+/* ============================================================
+ * Branch and Bound
+ * 
+ * With OBJECTIVE_MAXIMIZE_ENERGY_FIT the search goes on past the first
+ * schedule. A node's bound is the weighted score of its placements plus,
+ * for every unplaced task, its fit: the best weighted score it could
+ * still reach alone, over its feasible starts. Placing tasks only
+ * removes starts, so the bound never underestimates a schedule below
+ * the node, and subtrees whose bound does not beat the incumbent are
+ * skipped. A placement changes only the fits whose start it covers;
+ * those are recomputed and trailed, so undoing it restores them.
+ * ============================================================ */
+
+static int64_t objective_weight(bool weight_by_priority, const SolverTask* task) {
+    if (!weight_by_priority) return 1;
+    return task->priority > 0 ? task->priority : 0;
+}
+
+/**
+ * Objective contribution of a task starting at slot
+ */
+static int64_t placement_value(const EnergyTable* energy, bool weight_by_priority,
+                               const SolverTask* task, int slot) {
+    return objective_weight(weight_by_priority, task) * task_energy_score(energy, task, slot);
+}
+
+/**
+ * Objective value of every placed task in placements
+ */
+static int64_t placements_value(const Solver* solver, const int* placements) {
+    int64_t value = 0;
+    for (int t = 0; t < solver->num_tasks; t++) {
+        if (!solver->tasks[t].is_fixed && placements[t] >= 0) {
+            value += placement_value(solver->energy, solver->weight_by_priority,
+                                     &solver->tasks[t], placements[t]);
+        }
+    }
+    return value;
+}
+
+/**
+ * Highest score among a task's feasible starts
+ * @param slot Output: a start with that score, -1 if none
+ * @return Score, -1 if the task has no feasible start
+ */
+static int best_fit(const Solver* solver, const SolverTask* task, int* slot) {
+    const Timeline* timeline = solver->timeline;
+    const ScoreClass* score_class = task_score_class(solver, task);
+    uint64_t starts[SLOT_WORDS];
+    
+    *slot = -1;
+    if (timeline_free_starts(timeline, task->duration_slots,
+                             task_slot_limit(timeline, task), starts) == 0) {
+        return -1;
+    }
+    uint32_t scores = score_class->scores;
+    while (scores != 0) {
+        int score = take_highest_score(&scores);
+        const uint64_t* mask = score_class->bits + (size_t)score * timeline->num_words;
+        for (int w = 0; w < timeline->num_words; w++) {
+            uint64_t bits = starts[w] & mask[w];
+            if (bits) {
+                *slot = w * SLOT_WORD_BITS + __builtin_ctzll(bits);
+                return score;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * Compute the fit of every unplaced task and the root bound
+ * @return false if some task has no feasible start, so no schedule exists
+ */
+static bool bound_init(Solver* solver) {
+    bool feasible = true;
+    
+    solver->placed_value = 0;
+    solver->rest_bound = 0;
+    solver->trail_length = 0;
+    for (int t = 0; t < solver->num_tasks; t++) {
+        SolverTask* task = &solver->tasks[t];
+        if (task->is_fixed || solver->placements[t] >= 0) continue;
+        
+        solver->fit_score[t] = best_fit(solver, task, &solver->fit_slot[t]);
+        if (solver->fit_score[t] < 0) {
+            feasible = false;
+        } else {
+            solver->rest_bound +=
+                objective_weight(solver->weight_by_priority, task) * solver->fit_score[t];
+        }
+    }
+    solver->root_bound = feasible ? solver->rest_bound : -1;
+    solver->objective_bound = solver->root_bound;
+    return feasible;
+}
+
+/**
+ * Whether a candidate with the given score may still beat the incumbent,
+ * judged by the fits before placing it. Candidates come best score first,
+ * so once one fails, the rest of its level fails too.
+ */
+static bool bound_admits(const Solver* solver, int task_index, int score) {
+    int64_t weight = objective_weight(solver->weight_by_priority, &solver->tasks[task_index]);
+    return solver->placed_value + solver->rest_bound +
+           weight * (score - solver->fit_score[task_index]) > solver->incumbent;
+}
+
+/**
+ * Grow the fit trail to hold at least needed entries
+ * @return false on allocation failure
+ */
+static bool reserve_trail(Solver* solver, int needed) {
+    if (needed <= solver->trail_capacity) return true;
+    
+    int capacity = solver->trail_capacity * 2;
+    if (capacity < needed) capacity = needed;
+    FitEntry* trail = (FitEntry*)arena_realloc(
+        solver->arena, solver->trail, sizeof(FitEntry) * (size_t)solver->trail_capacity,
+        sizeof(FitEntry) * (size_t)capacity);
+    if (trail == NULL) return false;
+    solver->trail = trail;
+    solver->trail_capacity = capacity;
+    return true;
+}
+
+/**
+ * Account for the task just placed at depth: add its score, drop its fit
+ * and recompute the fits its run covers. A fit the trail has no room for
+ * is left as it was, which still bounds the task from above.
+ * @return false if the node cannot beat the incumbent, or a task lost its
+ *         last feasible start
+ */
+static bool bound_place(Solver* solver, int depth, int task_index, int slot) {
+    const SolverTask* task = &solver->tasks[task_index];
+    int end = slot + task->duration_slots;
+    
+    solver->trail_mark[depth] = solver->trail_length;
+    solver->placed_value +=
+        placement_value(solver->energy, solver->weight_by_priority, task, slot);
+    solver->rest_bound -=
+        objective_weight(solver->weight_by_priority, task) * solver->fit_score[task_index];
+    
+    for (int t = 0; t < solver->num_tasks; t++) {
+        const SolverTask* other = &solver->tasks[t];
+        int fit = solver->fit_slot[t];
+        if (other->is_fixed || solver->placements[t] >= 0) continue;
+        if (fit >= end || fit + other->duration_slots <= slot) continue;
+        if (!reserve_trail(solver, solver->trail_length + 1)) continue;
+        
+        FitEntry* entry = &solver->trail[solver->trail_length++];
+        entry->task = t;
+        entry->score = solver->fit_score[t];
+        entry->slot = fit;
+        int score = best_fit(solver, other, &solver->fit_slot[t]);
+        solver->rest_bound += objective_weight(solver->weight_by_priority, other) *
+                              (score - solver->fit_score[t]);
+        solver->fit_score[t] = score;
+        if (score < 0) {
+            return false;
+        }
+    }
+    return solver->placed_value + solver->rest_bound > solver->incumbent;
+}
+
+/**
+ * Undo bound_place for the task at depth, which started at slot
+ */
+static void bound_undo(Solver* solver, int depth, int task_index, int slot) {
+    const SolverTask* task = &solver->tasks[task_index];
+    
+    while (solver->trail_length > solver->trail_mark[depth]) {
+        const FitEntry* entry = &solver->trail[--solver->trail_length];
+        solver->rest_bound +=
+            objective_weight(solver->weight_by_priority, &solver->tasks[entry->task]) *
+            (entry->score - solver->fit_score[entry->task]);
+        solver->fit_score[entry->task] = entry->score;
+        solver->fit_slot[entry->task] = entry->slot;
+    }
+    solver->placed_value -=
+        placement_value(solver->energy, solver->weight_by_priority, task, slot);
+    solver->rest_bound +=
+        objective_weight(solver->weight_by_priority, task) * solver->fit_score[task_index];
+}
+
+/**
+ * Make the current placements the incumbent
+ */
+static void set_incumbent(Solver* solver, int64_t value) {
+    solver->incumbent = value;
+    memcpy(solver->incumbent_placements, solver->placements,
+           sizeof(int) * solver->num_tasks);
+}
+
+/**
+ * Keep the schedule just completed if it beats the incumbent
+ * @return true if it reaches the root bound, so none can be better
+ */
+static bool record_incumbent(Solver* solver) {
+    if (solver->placed_value > solver->incumbent) {
+        set_incumbent(solver, solver->placed_value);
+    }
+    return solver->incumbent >= solver->root_bound;
+}
+
+/**
+ * The search stopped early while opening depth: the best schedule left
+ * unexplored lies below that node or below an untried candidate of an
+ * open level above it, each bounded by the bound of its node
+ */
+static void note_open_bound(Solver* solver, int depth, int root) {
+    int64_t bound = solver->placed_value + solver->rest_bound;
+    for (int d = root; d < depth; d++) {
+        const SearchFrame* frame = &solver->frames[d];
+        if (frame->next < frame->count && solver->node_bound[d] > bound) {
+            bound = solver->node_bound[d];
+        }
+    }
+    solver->objective_bound = bound > solver->incumbent ? bound : solver->incumbent;
+}
+
+
+/* ============================================================
+ * Search
+ * ============================================================ */
+
+/**
+ * Grow the candidate pool to hold at least needed entries
+ * @return false on allocation failure
+ */
+static bool reserve_pool(Solver* solver, int needed) {
+    if (needed <= solver->pool_capacity) return true;
+    
+    int capacity = solver->pool_capacity * 2;
+    if (capacity < needed) capacity = needed;
+    SlotScore* pool = (SlotScore*)arena_realloc(
+        solver->arena, solver->pool, sizeof(SlotScore) * (size_t)solver->pool_capacity,
+        sizeof(SlotScore) * (size_t)capacity);
+    if (pool == NULL) return false;
+    solver->pool = pool;
+    solver->pool_capacity = capacity;
+    return true;
+}
+
+/**
+ * Open the search level at depth: pick its task, then collect its
+ * candidates into the pool above the parent level's
+ * @param root Depth the search started at
+ * @return 1 if the level is open, 0 if every task is placed, -1 if the
+ *         search must stop (budget spent, cancelled, or the pool could
+ *         not grow, which is treated as a spent budget)
+ */
+static int open_level(Solver* solver, int depth, int root) {
+    int task_index;
+    if (solver->forward_checking) {
+        task_index = select_mrv_task(solver);
+    } else {
+        task_index = (depth < solver->num_levels) ? solver->order[depth] : -1;
+    }
+    
+    if (task_index < 0) {
+        return 0;
+    }
+    
+    /* Candidates are tried best energy score first */
+    SearchFrame* frame = &solver->frames[depth];
+    frame->first = (depth > root) ? frame[-1].first + frame[-1].count : 0;
+    frame->count = 0;
+    frame->next = 0;
+    if (budget_spent(solver) ||
+        !reserve_pool(solver, frame->first + solver->timeline->num_slots)) {
+        solver->budget_exhausted = true;
+        if (solver->fit_score != NULL) {
+            note_open_bound(solver, depth, root);
+        }
+        return -1;
+    }
+    
+    SolverTask* task = &solver->tasks[task_index];
+    solver->level_task[depth] = task_index;
+    if (solver->fit_score != NULL) {
+        solver->node_bound[depth] = solver->placed_value + solver->rest_bound;
+    }
+    frame->count = collect_candidates(solver, task, solver->pool + frame->first,
+                                      solver->starts);
+    STAT_ADD(solver, candidates, frame->count);
+    STAT_DEPTH(solver, depth + 1);
+    
+    uint64_t* conf = NULL;
+    if (solver->backjumping) {
+        conf = solver->conf + (size_t)depth * solver->conf_words;
+        conf_clear(solver, conf);
+        explain_blocked(solver, task, solver->starts, conf);
+    }
+    int generated = frame->count;
+    frame->count = break_symmetry(solver, task_index, solver->pool + frame->first,
+                                  frame->count, conf);
+    STAT_ADD(solver, pruned, generated - frame->count);
+    
+    /* The frame is published, so idle workers can take its untried slots */
+    if (solver->parallel != NULL && solver->nodes % SPLIT_CHECK_INTERVAL == 0) {
+        parallel_poll(solver, depth);
+        if (solver->budget_exhausted) {
+            return -1;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Undo the placement at depth after the subtree below it failed
+ * @return true if the level should try its next candidate, false if it
+ *         fails too: the budget ran out, or with backjumping the failure
+ *         did not involve this depth, so the search jumps past it
+ */
+static bool retreat(Solver* solver, int depth) {
+    int task_index = solver->level_task[depth];
+    SolverTask* task = &solver->tasks[task_index];
+    int slot = solver->placements[task_index];
+    
+    remove_task(solver->timeline, task, slot);
+    solver->placements[task_index] = -1;
+    solver->num_placed--;
+    STAT_ADD(solver, backtracks, 1);
+    if (solver->backjumping) {
+        claim_slots(solver, task, slot, -1);
+    }
+    if (solver->fit_score != NULL) {
+        bound_undo(solver, depth, task_index, slot);
+    }
+    if (solver->forward_checking) {
+        update_domains(solver, slot);
+    }
+    
+    if (solver->budget_exhausted) {
+        return false;
+    }
+    
+    if (solver->backjumping) {
+        if (!conf_has(solver->child_conf, depth)) {
+            return false;
+        }
+        conf_merge_except(solver, solver->conf + (size_t)depth * solver->conf_words,
+                          solver->child_conf, depth);
+    }
+    return true;
+}
+
+/**
+ * Backtracking solver over an explicit stack of frames
+ * 
+ * The next task comes from the fixed priority order, or from MRV when
+ * forward checking is on. With backjumping, a failing level leaves its
+ * conflict set in solver->child_conf for the level above. With branch
+ * and bound, a complete schedule becomes the incumbent and the search
+ * goes on below it. Depth is bounded by solver->frames, not by the
+ * thread's stack.
+ * 
+ * @param solver Shared solver state
+ * @param root Number of tasks already placed when the search starts
+ * @return true if solution found (with branch and bound: one reaching the
+ *         root bound); otherwise every placement made by the search has
+ *         been undone
+ */
+static bool backtrack(Solver* solver, int root) {
+    int depth = root;
+    int status = open_level(solver, depth, root);
+    
+    for (;;) {
+        if (status == 0) {
+            /* All tasks placed; branch and bound goes on unless the
+             * schedule reaches the root bound */
+            if (solver->fit_score == NULL || record_incumbent(solver)) {
+                return true;
+            }
+        }
+        
+        if (status > 0) {
+            SearchFrame* frame = &solver->frames[depth];
+            if (frame->next < frame->count) {
+                int task_index = solver->level_task[depth];
+                SolverTask* task = &solver->tasks[task_index];
+                const SlotScore* candidate = &solver->pool[frame->first + frame->next++];
+                int slot = candidate->slot;
+                uint64_t* conf = solver->backjumping ?
+                    solver->conf + (size_t)depth * solver->conf_words : NULL;
+                
+                if (solver->nogoods != NULL && nogood_blocks(solver, task_index, slot, conf)) {
+                    STAT_ADD(solver, pruned, 1);
+                    continue;
+                }
+                if (solver->fit_score != NULL &&
+                    !bound_admits(solver, task_index, candidate->score)) {
+                    STAT_ADD(solver, pruned, frame->count - frame->next + 1);
+                    frame->next = frame->count;
+                    continue;
+                }
+                
+                /* Place task */
+                place_task(solver->timeline, task, slot);
+                solver->placements[task_index] = slot;
+                solver->task_depth[task_index] = depth;
+                solver->num_placed++;
+                record_partial(solver);
+                if (solver->backjumping) {
+                    claim_slots(solver, task, slot, depth);
+                }
+                
+                /* Bound, forward check, then descend */
+                bool consistent = solver->fit_score == NULL ||
+                                  bound_place(solver, depth, task_index, slot);
+                if (consistent && solver->forward_checking) {
+                    int wiped_out = update_domains(solver, slot);
+                    if (wiped_out >= 0) {
+                        consistent = false;
+                        if (solver->backjumping) {
+                            static const uint64_t no_starts[SLOT_WORDS];
+                            conf_clear(solver, solver->child_conf);
+                            explain_blocked(solver, &solver->tasks[wiped_out], no_starts,
+                                            solver->child_conf);
+                        }
+                    }
+                }
+                if (consistent) {
+                    depth++;
+                    status = open_level(solver, depth, root);
+                    continue;
+                }
+                
+                /* A wiped-out domain or a bound that cannot beat the
+                 * incumbent fails like the level below */
+                STAT_ADD(solver, pruned, 1);
+                if (retreat(solver, depth)) {
+                    continue;
+                }
+            } else if (solver->backjumping) {
+                /* Every candidate failed */
+                uint64_t* conf = solver->conf + (size_t)depth * solver->conf_words;
+                record_nogood(solver, conf);
+                memcpy(solver->child_conf, conf, sizeof(uint64_t) * solver->conf_words);
+            }
+        }
+        
+        /* The level at depth failed with nothing placed: pop until a level
+         * can try its next candidate */
+        do {
+            if (depth == root) {
+                return false;
+            }
+            depth--;
+        } while (!retreat(solver, depth));
+        status = 1;
+    }
+}
+
+/* ============================================================
+ * Greedy Engine with Local Search
+ * 
+ * Tasks are placed one at a time, in priority order, at their best
+ * remaining slot. Simulated annealing over shift and swap moves then
+ * raises the total energy score. There is no backtracking, so a task
+ * can be left unplaced even when a full schedule exists.
+ * ============================================================ */
+
+/* Annealing temperature, in energy score units, at the first and last move */
+#define ANNEAL_START_TEMP 2.0
+#define ANNEAL_END_TEMP 0.05
+
+/**
+ * Place every task greedily at find_best_slot
+ * The free-interval index is attached to the timeline only here: local
+ * search and backtracking never query it, so they skip its updates.
+ * @return Number of tasks left unplaced
+ */
+static int greedy_schedule(Solver* solver) {
+    Timeline* timeline = solver->timeline;
+    int num_unplaced = 0;
+    
+    free_index_update(solver->free_index, timeline, 0, timeline->num_slots);
+    timeline->free_index = solver->free_index;
+    
+    for (int t = 0; t < solver->num_tasks; t++) {
+        SolverTask* task = &solver->tasks[t];
+        if (task->is_fixed) continue;
+        
+        int slot = find_best_slot(solver, task);
+        if (slot >= 0) {
+            place_task(timeline, task, slot);
+            solver->placements[t] = slot;
+        } else {
+            num_unplaced++;
+        }
+    }
+    
+    timeline->free_index = NULL;
+    return num_unplaced;
+}
+
+/**
+ * Remove every placement from the timeline occupancy
+ */
+static void clear_placements(Solver* solver) {
+    for (int t = 0; t < solver->num_tasks; t++) {
+        if (solver->placements[t] >= 0) {
+            remove_task(solver->timeline, &solver->tasks[t], solver->placements[t]);
+            solver->placements[t] = -1;
+        }
+    }
+}
+
+static uint64_t xorshift64(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/**
+ * Uniform integer in [0, n)
+ */
+static int random_below(uint64_t* state, int n) {
+    return (int)(xorshift64(state) % (uint64_t)n);
+}
+
+/**
+ * Uniform double in [0, 1)
+ */
+static double random_unit(uint64_t* state) {
+    return (double)(xorshift64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Index of the k-th set bit (0-based) in a slot bitmask
+ */
+static int nth_set_bit(const uint64_t bits[SLOT_WORDS], int k) {
+    for (int w = 0; w < SLOT_WORDS; w++) {
+        int count = __builtin_popcountll(bits[w]);
+        if (k < count) {
+            uint64_t word = bits[w];
+            for (int i = 0; i < k; i++) {
+                word &= word - 1;
+            }
+            return w * SLOT_WORD_BITS + __builtin_ctzll(word);
+        }
+        k -= count;
+    }
+    return -1;
+}
+
+/**
+ * Move one task to a random feasible start, accepted by the annealing rule
+ * @param delta Output: score change of the move
+ * @return true if the move was applied
+ */
+static bool try_shift(Solver* solver, int t, uint64_t* rng, double temperature, int* delta) {
+    Timeline* timeline = solver->timeline;
+    SolverTask* task = &solver->tasks[t];
+    int old_slot = solver->placements[t];
+    
+    /* Its own run is free once lifted, so at least one start exists */
+    remove_task(timeline, task, old_slot);
+    uint64_t starts[SLOT_WORDS];
+    int count = timeline_free_starts(timeline, task->duration_slots,
+                                     task_slot_limit(timeline, task), starts);
+    int new_slot = nth_set_bit(starts, random_below(rng, count));
+    
+    *delta = task_energy_score(solver->energy, task, new_slot) -
+             task_energy_score(solver->energy, task, old_slot);
+    if (new_slot != old_slot &&
+        (*delta >= 0 || random_unit(rng) < exp(*delta / temperature))) {
+        place_task(timeline, task, new_slot);
+        solver->placements[t] = new_slot;
+        return true;
+    }
+    place_task(timeline, task, old_slot);
+    return false;
+}
+
+/**
+ * Exchange the start slots of two tasks if both still fit, accepted by
+ * the annealing rule
+ * @param delta Output: score change of the move
+ * @return true if the move was applied
+ */
+static bool try_swap(Solver* solver, int a, int b, uint64_t* rng, double temperature, int* delta) {
+    Timeline* timeline = solver->timeline;
+    SolverTask* task_a = &solver->tasks[a];
+    SolverTask* task_b = &solver->tasks[b];
+    int slot_a = solver->placements[a];
+    int slot_b = solver->placements[b];
+    
+    if (slot_a == slot_b) return false;
+    
+    remove_task(timeline, task_a, slot_a);
+    remove_task(timeline, task_b, slot_b);
+    
+    bool fits = can_place_task(timeline, task_a, slot_b);
+    if (fits) {
+        place_task(timeline, task_a, slot_b);
+        fits = can_place_task(timeline, task_b, slot_a);
+        remove_task(timeline, task_a, slot_b);
+    }
+    
+    if (fits) {
+        *delta = task_energy_score(solver->energy, task_a, slot_b) +
+                 task_energy_score(solver->energy, task_b, slot_a) -
+                 task_energy_score(solver->energy, task_a, slot_a) -
+                 task_energy_score(solver->energy, task_b, slot_b);
+        if (*delta >= 0 || random_unit(rng) < exp(*delta / temperature)) {
+            place_task(timeline, task_a, slot_b);
+            place_task(timeline, task_b, slot_a);
+            solver->placements[a] = slot_b;
+            solver->placements[b] = slot_a;
+            return true;
+        }
+    }
+    place_task(timeline, task_a, slot_a);
+    place_task(timeline, task_b, slot_b);
+    return false;
+}
+
+/**
+ * Improve the total energy score of the current placements by simulated
+ * annealing. The best assignment seen is restored at the end.
+ * Uses solver->level_task as the list of placed tasks and
+ * solver->best_placements as the best-so-far copy.
+ */
+static void local_search(Solver* solver, int64_t max_moves, uint64_t seed) {
+    int* movable = solver->level_task;
+    int num_movable = 0;
+    int score = 0;
+    
+    for (int t = 0; t < solver->num_tasks; t++) {
+        if (!solver->tasks[t].is_fixed && solver->placements[t] >= 0) {
+            movable[num_movable++] = t;
+            score += task_energy_score(solver->energy, &solver->tasks[t],
+                                            solver->placements[t]);
+        }
+    }
+    memcpy(solver->best_placements, solver->placements, sizeof(int) * solver->num_tasks);
+    if (num_movable == 0 || max_moves <= 0) return;
+    
+    /* xorshift has a fixed point at zero */
+    uint64_t rng = seed ? seed : LOCAL_SEARCH_DEFAULT_SEED;
+    int best_score = score;
+    double cooling = log(ANNEAL_END_TEMP / ANNEAL_START_TEMP) / (double)max_moves;
+    
+    for (int64_t move = 0; move < max_moves; move++) {
+        /* Moves are cheap; only the wall clock bounds them */
+        if (move % BUDGET_CHECK_INTERVAL == 0 &&
+            ((solver->deadline_us > 0 && monotonic_us() >= solver->deadline_us) ||
+             portfolio_done(solver->portfolio))) {
+            break;
+        }
+        
+        double temperature = ANNEAL_START_TEMP * exp(cooling * (double)move);
+        int a = movable[random_below(&rng, num_movable)];
+        int delta = 0;
+        bool applied;
+        if (num_movable > 1 && (xorshift64(&rng) & 1)) {
+            int b = movable[random_below(&rng, num_movable)];
+            applied = (a != b) && try_swap(solver, a, b, &rng, temperature, &delta);
+        } else {
+            applied = try_shift(solver, a, &rng, temperature, &delta);
+        }
+        
+        if (applied) {
+            score += delta;
+            if (score > best_score) {
+                best_score = score;
+                memcpy(solver->best_placements, solver->placements,
+                       sizeof(int) * solver->num_tasks);
+            }
+        }
+    }
+    
+    clear_placements(solver);
+    memcpy(solver->placements, solver->best_placements, sizeof(int) * solver->num_tasks);
+    for (int t = 0; t < solver->num_tasks; t++) {
+        if (solver->placements[t] >= 0) {
+            place_task(solver->timeline, &solver->tasks[t], solver->placements[t]);
+        }
+    }
+}
+
+/**
+ * Turn the best partial assignment into the result timeline.
+ * Tasks left out are tried once more at their best remaining slot,
+ * in search order, before being reported as unplaced.
+ * @return Number of tasks still unplaced
+ */
+static int apply_partial(Solver* solver) {
+    Timeline* timeline = solver->timeline;
+    
+    /* The search unwound every placement; reapply the best path */
+    memcpy(solver->placements, solver->best_placements,
+           sizeof(int) * solver->num_tasks);
+    for (int t = 0; t < solver->num_tasks; t++) {
+        if (solver->placements[t] >= 0) {
+            place_task(timeline, &solver->tasks[t], solver->placements[t]);
+        }
+    }
+    
+    SlotScore* candidates = solver->pool;
+    int num_unplaced = 0;
+    for (int t = 0; t < solver->num_tasks; t++) {
+        SolverTask* task = &solver->tasks[t];
+        if (task->is_fixed || solver->placements[t] >= 0) continue;
+        
+        uint64_t starts[SLOT_WORDS];
+        if (collect_candidates(solver, task, candidates, starts) > 0) {
+            solver->placements[t] = candidates[0].slot;
+            place_task(timeline, task, candidates[0].slot);
+        } else {
+            num_unplaced++;
+        }
+    }
+    
+    commit_placements(timeline, solver->tasks, solver->num_tasks, solver->placements);
+    
+    timeline->num_unplaced = 0;
+    timeline->unplaced_task_ids = (num_unplaced > 0) ?
+        (int*)arena_alloc(timeline->arena, sizeof(int) * num_unplaced) : NULL;
+    if (timeline->unplaced_task_ids != NULL) {
+        for (int t = 0; t < solver->num_tasks; t++) {
+            if (!solver->tasks[t].is_fixed && solver->placements[t] < 0) {
+                timeline->unplaced_task_ids[timeline->num_unplaced++] = solver->tasks[t].id;
+            }
+        }
+    }
+    return num_unplaced;
+}
+
+
+/* ============================================================
+ * Solver Setup
+ * ============================================================ */
+
+/* Per-task int arrays carved out of one allocation */
+#define SOLVER_INT_ARRAYS 8
+
+/* Per-task branch-and-bound arrays: fit score and slot, incumbent, trail marks */
+#define BOUND_INT_ARRAYS 4
+
+
+/* First pool size: a few levels' worth of candidates, at most one per level */
+static int solver_pool_entries(int num_slots, int num_levels) {
+    int levels = num_levels + 1 < POOL_INITIAL_LEVELS ? num_levels + 1 : POOL_INITIAL_LEVELS;
+    return levels * num_slots;
+}
+
+/**
+ * Allocate solver state for sorted tasks on a prepared timeline
+ * @return Solver, or NULL on allocation failure
+ */
+static Solver* solver_create(
+    Timeline* timeline,
+    SolverTask* sorted_tasks,
+    int num_tasks,
+    const EnergyTable* energy,
+    const SolverOptions* options,
+    Portfolio* portfolio
+) {
+    int num_levels = 0;
+    for (int i = 0; i < num_tasks; i++) {
+        if (!sorted_tasks[i].is_fixed) num_levels++;
+    }
+    int conf_words = num_levels / 64 + 1;
+    
+    int num_slots = timeline->num_slots;
+    Arena* arena = options->arena;
+    Solver* solver = (Solver*)arena_alloc(arena, sizeof(Solver));
+    int* buffer = (int*)arena_alloc(arena, sizeof(int) * (num_tasks + 1) * SOLVER_INT_ARRAYS);
+    int* slot_depth = (int*)arena_alloc(arena, sizeof(int) * (size_t)num_slots);
+    bool used_classes[SCORE_CLASSES];
+    int num_classes = score_classes_used(sorted_tasks, num_tasks, used_classes);
+    uint64_t* class_bits = (uint64_t*)arena_alloc(
+        arena, sizeof(uint64_t) * score_class_words(timeline->num_words) * (size_t)num_classes);
+    int pool_capacity = solver_pool_entries(num_slots, num_levels);
+    SlotScore* pool = (SlotScore*)arena_alloc(arena, sizeof(SlotScore) * (size_t)pool_capacity);
+    SearchFrame* frames =
+        (SearchFrame*)arena_alloc(arena, sizeof(SearchFrame) * (size_t)(num_levels + 1));
+    uint64_t* conf = options->backjumping ?
+        (uint64_t*)arena_alloc(arena, sizeof(uint64_t) * conf_words * (num_levels + 2)) : NULL;
+    NogoodTable* nogoods = (options->backjumping && options->max_nogoods > 0) ?
+        nogood_table_create(arena, options->max_nogoods) : NULL;
+    FreeIndex* free_index = options->engine != ENGINE_BACKTRACK ?
+        free_index_create(arena, timeline) : NULL;
+    bool optimizing = options->objective != OBJECTIVE_FEASIBLE;
+    int* fit_buffer = optimizing ?
+        (int*)arena_alloc(arena, sizeof(int) * (num_tasks + 1) * BOUND_INT_ARRAYS) : NULL;
+    int64_t* node_bound = optimizing ?
+        (int64_t*)arena_alloc(arena, sizeof(int64_t) * (size_t)(num_levels + 1)) : NULL;
+    FitEntry* trail = optimizing ?
+        (FitEntry*)arena_alloc(arena, sizeof(FitEntry) * (size_t)(num_tasks + 1)) : NULL;
+    if (solver == NULL || buffer == NULL || slot_depth == NULL || class_bits == NULL ||
+        pool == NULL ||
+        frames == NULL || (options->engine != ENGINE_BACKTRACK && free_index == NULL) ||
+        (options->backjumping && conf == NULL) ||
+        (options->backjumping && options->max_nogoods > 0 && nogoods == NULL) ||
+        (optimizing && (fit_buffer == NULL || node_bound == NULL || trail == NULL))) {
+        arena_free(arena, solver);
+        arena_free(arena, buffer);
+        arena_free(arena, slot_depth);
+        arena_free(arena, class_bits);
+        arena_free(arena, pool);
+        arena_free(arena, frames);
+        arena_free(arena, conf);
+        nogood_table_free(arena, nogoods);
+        free_index_free(free_index);
+        arena_free(arena, fit_buffer);
+        arena_free(arena, node_bound);
+        arena_free(arena, trail);
+        return NULL;
+    }
+    for (int i = 0; i < (num_tasks + 1) * SOLVER_INT_ARRAYS; i++) {
+        buffer[i] = -1;
+    }
+    
+    int stride = num_tasks + 1;
+    solver->timeline = timeline;
+    solver->tasks = sorted_tasks;
+    solver->num_tasks = num_tasks;
+    solver->placements = buffer;
+    solver->energy = energy;
+    solver->class_bits = class_bits;
+    score_classes_build(solver, used_classes);
+    solver->pool = pool;
+    solver->pool_capacity = pool_capacity;
+    solver->frames = frames;
+    for (int i = 0; i <= num_levels; i++) {
+        frames[i].first = 0;
+        frames[i].count = 0;
+        frames[i].next = 0;
+    }
+    solver->nodes = 0;
+    memset(&solver->stats, 0, sizeof(solver->stats));
+    solver->max_nodes = options->max_nodes;
+    solver->node_pool = NULL;
+    solver->deadline_us = (options->max_time_us > 0) ?
+        monotonic_us() + options->max_time_us : 0;
+    solver->budget_exhausted = false;
+    solver->portfolio = portfolio;
+    solver->cancelled = false;
+    solver->tie_break_seed = options->tie_break_seed;
+    solver->num_placed = 0;
+    solver->best_num_placed = 0;
+    solver->best_placements = buffer + stride;
+    solver->domain_size = buffer + stride * 2;
+    solver->order = buffer + stride * 3;
+    solver->level_task = buffer + stride * 4;
+    solver->task_depth = buffer + stride * 5;
+    solver->split_prefix = buffer + stride * 6;
+    solver->prev_twin = buffer + stride * 7;
+    solver->num_levels = 0;
+    for (int i = 0; i < num_tasks; i++) {
+        /* Fixed tasks are already placed and never searched */
+        if (!sorted_tasks[i].is_fixed) {
+            solver->order[solver->num_levels++] = i;
+        }
+    }
+    solver->forward_checking = options->forward_checking;
+    solver->backjumping = options->backjumping;
+    solver->conf_words = conf_words;
+    solver->conf = conf;
+    solver->child_conf = conf ? conf + (size_t)conf_words * (num_levels + 1) : NULL;
+    solver->slot_depth = slot_depth;
+    for (int i = 0; i < num_slots; i++) {
+        solver->slot_depth[i] = -1;
+    }
+    solver->nogoods = nogoods;
+    solver->weight_by_priority = options->weight_by_priority;
+    solver->fit_score = fit_buffer;
+    solver->fit_slot = fit_buffer ? fit_buffer + stride : NULL;
+    solver->incumbent_placements = fit_buffer ? fit_buffer + stride * 2 : NULL;
+    solver->trail_mark = fit_buffer ? fit_buffer + stride * 3 : NULL;
+    solver->trail = trail;
+    solver->trail_length = 0;
+    solver->trail_capacity = trail ? num_tasks + 1 : 0;
+    solver->node_bound = node_bound;
+    solver->placed_value = 0;
+    solver->rest_bound = 0;
+    solver->root_bound = -1;
+    solver->incumbent = -1;
+    solver->objective_bound = -1;
+    solver->free_index = free_index;
+    solver->parallel = NULL;
+    solver->worker = 0;
+    solver->reported_nodes = 0;
+    solver->arena = arena;
+    link_twins(solver);
+    return solver;
+}
+
+static void solver_free(Solver* solver) {
+    if (solver != NULL) {
+        Arena* arena = solver->arena;
+        free_index_free(solver->free_index);
+        arena_free(arena, solver->trail);
+        arena_free(arena, solver->node_bound);
+        arena_free(arena, solver->fit_score);
+        nogood_table_free(arena, solver->nogoods);
+        arena_free(arena, solver->conf);
+        arena_free(arena, solver->frames);
+        arena_free(arena, solver->pool);
+        arena_free(arena, solver->placements);
+        arena_free(arena, solver->class_bits);
+        arena_free(arena, solver->slot_depth);
+        arena_free(arena, solver);
+    }
+}
+
+
+/* ============================================================
+ * Work-Splitting Parallel Search
+ * 
+ * Threads share one backtracking search. A work item is a partial
+ * assignment: the placements of the first `depth` tasks. Each worker
+ * keeps a deque of items, popping its newest and stealing the oldest
+ * (largest) items of other workers when its own runs dry. A busy worker
+ * that sees idle ones gives away the untried slots of its shallowest
+ * open level, one item per slot. The search is exhausted once every
+ * worker is idle with no items left.
+ * 
+ * Conflict sets and nogoods are local to one path, so backjumping and
+ * learning are off in this mode. Forward checking stays on if asked.
+ * ============================================================ */
+
+/**
+ * A subtree to search: placements of the tasks above depth
+ */
+typedef struct {
+    int depth;                      /* Tasks already placed */
+    int placements[];               /* Start slot per task, -1 if not placed */
+} WorkItem;
+
+/**
+ * Items owned by one worker: bottom (newest) at count-1, top (oldest) at head
+ */
+typedef struct {
+    WorkItem** items;
+    int head;
+    int count;
+    int capacity;
+} WorkDeque;
+
+typedef struct ParallelSearch {
+    pthread_mutex_t lock;           /* Guards every field below */
+    pthread_cond_t work_ready;      /* Signalled on new items or when done */
+    int num_workers;
+    int running;                    /* Workers whose thread started */
+    WorkDeque* deques;              /* One per worker */
+    int pending;                    /* Items in all deques */
+    int idle;                       /* Workers waiting for items */
+    bool done;                      /* Solution found, budget spent or tree exhausted */
+    
+    /* Shared budget */
+    int64_t nodes;                  /* Nodes expanded by all workers */
+    SolverStats stats;              /* Counters of the workers that finished */
+    int64_t max_nodes;              /* Node budget, 0 for unlimited */
+    bool budget_exhausted;
+    
+    /* Results */
+    bool found;
+    int* solution;                  /* Placements of the solution found */
+    int best_num_placed;            /* Deepest partial assignment of any worker */
+    int* best_placements;
+    
+    /* Prepared input shared read-only */
+    const Timeline* base;
+    SolverTask* tasks;
+    int num_tasks;
+    const EnergyTable* energy;
+    const SolverOptions* options;
+} ParallelSearch;
+
+/**
+ * One parallel search worker thread
+ */
+typedef struct {
+    ParallelSearch* search;
+    int index;
+    Timeline* timeline;             /* Private copy of the prepared timeline */
+    Solver* solver;
+} SearchWorker;
+
+static WorkItem* work_item_create(int num_tasks, const int* placements, int depth) {
+    WorkItem* item = (WorkItem*)malloc(sizeof(WorkItem) + sizeof(int) * num_tasks);
+    if (item != NULL) {
+        item->depth = depth;
+        memcpy(item->placements, placements, sizeof(int) * num_tasks);
+    }
+    return item;
+}
+
+/**
+ * Append an item to a worker's deque (lock held)
+ * @return false on allocation failure
+ */
+static bool deque_push(ParallelSearch* ps, int worker, WorkItem* item) {
+    WorkDeque* dq = &ps->deques[worker];
+    if (dq->head + dq->count == dq->capacity) {
+        if (dq->head > 0) {
+            memmove(dq->items, dq->items + dq->head, sizeof(WorkItem*) * dq->count);
+            dq->head = 0;
+        } else {
+            int capacity = dq->capacity ? dq->capacity * 2 : 16;
+            WorkItem** items = (WorkItem**)realloc(dq->items, sizeof(WorkItem*) * capacity);
+            if (items == NULL) return false;
+            dq->items = items;
+            dq->capacity = capacity;
+        }
+    }
+    dq->items[dq->head + dq->count++] = item;
+    ps->pending++;
+    return true;
+}
+
+/**
+ * Pop the newest own item, or steal the oldest item of another worker
+ * (lock held)
+ */
+static WorkItem* deque_take(ParallelSearch* ps, int worker) {
+    WorkDeque* own = &ps->deques[worker];
+    if (own->count > 0) {
+        ps->pending--;
+        return own->items[own->head + --own->count];
+    }
+    for (int k = 1; k < ps->num_workers; k++) {
+        WorkDeque* victim = &ps->deques[(worker + k) % ps->num_workers];
+        if (victim->count > 0) {
+            victim->count--;
+            ps->pending--;
+            return victim->items[victim->head++];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Mark the search done and wake idle workers (lock held)
+ */
+static void parallel_finish(ParallelSearch* ps) {
+    ps->done = true;
+    pthread_cond_broadcast(&ps->work_ready);
+}
+
+/**
+ * Block until an item is available
+ * @return The item, or NULL once the search is done
+ */
+static WorkItem* acquire_work(ParallelSearch* ps, int worker) {
+    pthread_mutex_lock(&ps->lock);
+    WorkItem* item = NULL;
+    while (!ps->done && (item = deque_take(ps, worker)) == NULL) {
+        if (ps->idle + 1 >= ps->running && ps->pending == 0) {
+            /* Nobody else is searching, so nobody can add work: tree exhausted */
+            parallel_finish(ps);
+            break;
+        }
+        ps->idle++;
+        pthread_cond_wait(&ps->work_ready, &ps->lock);
+        ps->idle--;
+    }
+    pthread_mutex_unlock(&ps->lock);
+    return item;
+}
+
+/**
+ * Give the untried slots of the shallowest open level above depth to the
+ * pool, one item per slot (lock held)
+ */
+static void donate_work(Solver* solver, int depth) {
+    ParallelSearch* ps = solver->parallel;
+    
+    for (int d = 0; d < depth; d++) {
+        SearchFrame* frame = &solver->frames[d];
+        if (frame->next >= frame->count) {
+            continue;
+        }
+        
+        /* The path down to d stays; deeper placements are not part of it */
+        int* prefix = solver->split_prefix;
+        memcpy(prefix, solver->placements, sizeof(int) * solver->num_tasks);
+        for (int j = d; j < depth; j++) {
+            prefix[solver->level_task[j]] = -1;
+        }
+        
+        int task_index = solver->level_task[d];
+        int given = frame->count;
+        for (int i = frame->count - 1; i >= frame->next; i--) {
+            prefix[task_index] = solver->pool[frame->first + i].slot;
+            WorkItem* item = work_item_create(solver->num_tasks, prefix, d + 1);
+            if (item == NULL || !deque_push(ps, solver->worker, item)) {
+                free(item);
+                break;
+            }
+            given = i;
+        }
+        frame->count = given;
+        pthread_cond_broadcast(&ps->work_ready);
+        return;
+    }
+}
+
+/**
+ * Periodic check-in with the pool: report nodes, stop if the search is
+ * done or over budget, and split work if another worker is idle
+ */
+static void parallel_poll(Solver* solver, int depth) {
+    ParallelSearch* ps = solver->parallel;
+    
+    pthread_mutex_lock(&ps->lock);
+    ps->nodes += solver->nodes - solver->reported_nodes;
+    solver->reported_nodes = solver->nodes;
+    if (!ps->done && ps->max_nodes > 0 && ps->nodes > ps->max_nodes) {
+        ps->budget_exhausted = true;
+        parallel_finish(ps);
+    }
+    if (ps->done) {
+        solver->budget_exhausted = true;
+        solver->cancelled = true;
+    } else if (ps->idle > 0 && ps->pending == 0) {
+        donate_work(solver, depth);
+    }
+    pthread_mutex_unlock(&ps->lock);
+}
+
+/**
+ * Search one work item from a fresh copy of the prepared timeline
+ * @return true if a solution was found
+ */
+static bool search_work_item(Solver* solver, const WorkItem* item) {
+    ParallelSearch* ps = solver->parallel;
+    Timeline* timeline = solver->timeline;
+    
+    memcpy(timeline->occupied, ps->base->occupied, sizeof(uint64_t) * timeline->num_words);
+    memcpy(solver->placements, item->placements, sizeof(int) * solver->num_tasks);
+    for (int t = 0; t < solver->num_tasks; t++) {
+        if (solver->placements[t] >= 0) {
+            place_task(timeline, &solver->tasks[t], solver->placements[t]);
+        }
+    }
+    /* Levels above the item's depth are not on this worker's stack */
+    for (int d = 0; d <= solver->num_levels; d++) {
+        solver->frames[d].count = 0;
+        solver->frames[d].next = 0;
+    }
+    solver->num_placed = item->depth;
+    record_partial(solver);
+    
+    if (solver->forward_checking && update_domains(solver, -1) >= 0) {
+        return false;
+    }
+    return backtrack(solver, item->depth);
+}
+
+static void* search_worker_main(void* arg) {
+    SearchWorker* worker = (SearchWorker*)arg;
+    ParallelSearch* ps = worker->search;
+    Solver* solver = worker->solver;
+    
+    WorkItem* item;
+    while ((item = acquire_work(ps, worker->index)) != NULL) {
+        bool found = search_work_item(solver, item);
+        free(item);
+        
+        pthread_mutex_lock(&ps->lock);
+        if (found && !ps->found) {
+            ps->found = true;
+            memcpy(ps->solution, solver->placements, sizeof(int) * solver->num_tasks);
+        }
+        if (found || (solver->budget_exhausted && !solver->cancelled)) {
+            /* The wall-clock budget is per worker; running out ends the search */
+            ps->budget_exhausted = ps->budget_exhausted || !found;
+            parallel_finish(ps);
+        }
+        pthread_mutex_unlock(&ps->lock);
+        if (solver->budget_exhausted) break;
+    }
+    
+    pthread_mutex_lock(&ps->lock);
+    ps->nodes += solver->nodes - solver->reported_nodes;
+    stats_merge(&ps->stats, &solver->stats);
+    if (solver->best_num_placed > ps->best_num_placed) {
+        ps->best_num_placed = solver->best_num_placed;
+        memcpy(ps->best_placements, solver->best_placements, sizeof(int) * solver->num_tasks);
+    }
+    pthread_mutex_unlock(&ps->lock);
+    return NULL;
+}
+
+/**
+ * Run the backtracking search of solver on num_workers threads. On return
+ * solver->placements holds the solution if one was found; otherwise
+ * solver->best_placements holds the deepest partial assignment.
+ * @return true if a solution was found
+ */
+static bool parallel_backtrack(Solver* solver, const SolverOptions* options, int num_workers) {
+    int num_tasks = solver->num_tasks;
+    
+    SolverOptions worker_options = *options;
+    worker_options.backjumping = false;
+    worker_options.max_nogoods = 0;
+    worker_options.max_nodes = 0;   /* Counted across workers instead */
+    worker_options.arena = NULL;    /* Workers run on other threads */
+    
+    ParallelSearch ps;
+    pthread_mutex_init(&ps.lock, NULL);
+    pthread_cond_init(&ps.work_ready, NULL);
+    ps.num_workers = num_workers;
+    ps.running = num_workers;
+    ps.pending = 0;
+    ps.idle = 0;
+    ps.done = false;
+    ps.nodes = 0;
+    memset(&ps.stats, 0, sizeof(ps.stats));
+    ps.max_nodes = options->max_nodes;
+    ps.budget_exhausted = false;
+    ps.found = false;
+    ps.best_num_placed = 0;
+    ps.base = solver->timeline;
+    ps.tasks = solver->tasks;
+    ps.num_tasks = num_tasks;
+    ps.energy = solver->energy;
+    ps.options = &worker_options;
+    ps.deques = (WorkDeque*)calloc(num_workers, sizeof(WorkDeque));
+    ps.solution = (int*)malloc(sizeof(int) * num_tasks * 2);
+    ps.best_placements = ps.solution ? ps.solution + num_tasks : NULL;
+    SearchWorker* workers = (SearchWorker*)calloc(num_workers, sizeof(SearchWorker));
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * num_workers);
+    bool* started = (bool*)calloc(num_workers, sizeof(bool));
+    
+    bool ok = ps.deques != NULL && ps.solution != NULL && workers != NULL &&
+              threads != NULL && started != NULL;
+    for (int i = 0; ok && i < num_tasks * 2; i++) {
+        ps.solution[i] = -1;
+    }
+    for (int i = 0; ok && i < num_workers; i++) {
+        SearchWorker* worker = &workers[i];
+        worker->search = &ps;
+        worker->index = i;
+        worker->timeline = timeline_clone(solver->timeline);
+        worker->solver = worker->timeline == NULL ? NULL :
+            solver_create(worker->timeline, solver->tasks, num_tasks,
+                          solver->energy, &worker_options, NULL);
+        if (worker->solver == NULL) {
+            ok = false;
+            break;
+        }
+        worker->solver->deadline_us = solver->deadline_us;
+        worker->solver->parallel = &ps;
+        worker->solver->worker = i;
+    }
+    
+    /* The root item holds no placements */
+    WorkItem* root = ok ? work_item_create(num_tasks, solver->placements, 0) : NULL;
+    if (root != NULL && deque_push(&ps, 0, root)) {
+        int num_started = 0;
+        for (int i = 0; i < num_workers; i++) {
+            started[i] = (pthread_create(&threads[i], NULL, search_worker_main, &workers[i]) == 0);
+            if (started[i]) num_started++;
+        }
+        
+        /* Items queued for a worker that failed to start are stolen by the
+         * others; with no thread at all, search on the calling thread */
+        if (num_started == 0) {
+            ps.running = 1;
+            search_worker_main(&workers[0]);
+        } else if (num_started < num_workers) {
+            pthread_mutex_lock(&ps.lock);
+            ps.running = num_started;
+            if (ps.idle >= ps.running && ps.pending == 0) {
+                parallel_finish(&ps);
+            }
+            pthread_cond_broadcast(&ps.work_ready);
+            pthread_mutex_unlock(&ps.lock);
+        }
+        for (int i = 0; i < num_workers; i++) {
+            if (started[i]) pthread_join(threads[i], NULL);
+        }
+    } else {
+        free(root);
+        ok = false;
+    }
+    
+    if (ok) {
+        solver->nodes = ps.nodes;
+        stats_merge(&solver->stats, &ps.stats);
+        solver->budget_exhausted = ps.budget_exhausted && !ps.found;
+        if (ps.found) {
+            memcpy(solver->placements, ps.solution, sizeof(int) * num_tasks);
+        } else {
+            solver->best_num_placed = ps.best_num_placed;
+            memcpy(solver->best_placements, ps.best_placements, sizeof(int) * num_tasks);
+        }
+    } else {
+        /* Fall back to a sequential search */
+        solver->budget_exhausted = false;
+    }
+    bool found = ok && ps.found;
+    bool fallback = !ok;
+    
+    for (int i = 0; ps.deques != NULL && i < num_workers; i++) {
+        WorkDeque* dq = &ps.deques[i];
+        for (int k = 0; k < dq->count; k++) {
+            free(dq->items[dq->head + k]);
+        }
+        free(dq->items);
+    }
+    for (int i = 0; workers != NULL && i < num_workers; i++) {
+        solver_free(workers[i].solver);
+        timeline_free(workers[i].timeline);
+    }
+    free(ps.deques);
+    free(ps.solution);
+    free(workers);
+    free(threads);
+    free(started);
+    pthread_cond_destroy(&ps.work_ready);
+    pthread_mutex_destroy(&ps.lock);
+    
+    if (fallback) {
+        return (!solver->forward_checking || update_domains(solver, -1) < 0) &&
+               backtrack(solver, 0);
+    }
+    return found;
+}
+
+
+/* ============================================================
+ * Component Decomposition
+ * 
+ * Fixed slots cut the timeline into free runs, and a task can only go
+ * into the runs that hold it before its deadline. Tasks that share no
+ * run, directly or through other tasks, never interact, so each
+ * connected group of tasks and runs is searched on its own and a
+ * failure in one group no longer backtracks through the placements of
+ * another. With a fixed task order the first schedule found is the one
+ * the whole search would find. With search_threads the components are
+ * searched in parallel. Every component gets the full node budget; the
+ * wall-clock budget is shared.
+ * ============================================================ */
+
+static int run_root(int* parent, int run) {
+    while (parent[run] != run) {
+        parent[run] = parent[parent[run]];
+        run = parent[run];
+    }
+    return run;
+}
+
+static void run_union(int* parent, int a, int b) {
+    a = run_root(parent, a);
+    b = run_root(parent, b);
+    if (a != b) parent[b] = a;
+}
+
+/**
+ * Group the searched tasks into components
+ * @param component Output: component per task in search order, -1 for fixed tasks
+ * @return Number of components, 0 if some task fits no free run (or
+ *         memory ran out), leaving it to the whole search to report
+ */
+static int task_components(const Solver* solver, int* component) {
+    const Timeline* timeline = solver->timeline;
+    int num_slots = timeline->num_slots;
+    int stride = num_slots + 1;
+    int* buffer = (int*)arena_alloc(solver->arena, sizeof(int) * 6 * (size_t)stride);
+    if (buffer == NULL) return 0;
+    int* run_start = buffer;                /* Free runs in slot order */
+    int* run_end = buffer + stride;
+    int* parent = buffer + stride * 2;      /* Union-find over runs */
+    int* run_of_slot = buffer + stride * 3; /* Run holding each slot, -1 if taken */
+    int* first_long = buffer + stride * 4;  /* First run of each length or more, -1 if none */
+    int* widest = buffer + stride * 5;      /* Largest limit of the tasks of each duration */
+    
+    int num_runs = 0;
+    for (int slot = 0; slot < num_slots; slot++) {
+        run_of_slot[slot] = -1;
+        if (!slot_is_free(timeline, slot)) continue;
+        if (slot == 0 || run_of_slot[slot - 1] < 0) {
+            run_start[num_runs] = slot;
+            parent[num_runs] = num_runs;
+            num_runs++;
+        }
+        run_of_slot[slot] = num_runs - 1;
+        run_end[num_runs - 1] = slot + 1;
+    }
+    for (int length = 0; length <= num_slots; length++) {
+        first_long[length] = -1;
+        widest[length] = 0;
+    }
+    for (int r = num_runs - 1; r >= 0; r--) {
+        for (int length = 1; length <= run_end[r] - run_start[r]; length++) {
+            first_long[length] = r;
+        }
+    }
+    
+    /* A task's runs are those of its length ending by its limit, plus
+     * the run its limit cuts if the task still fits in it. For one
+     * length the runs ending by a smaller limit are a subset, so
+     * joining them for the largest limit joins them for every task. */
+    int count = 0;
+    for (int t = 0; t < solver->num_tasks && count >= 0; t++) {
+        const SolverTask* task = &solver->tasks[t];
+        component[t] = -1;
+        if (task->is_fixed) continue;
+        int length = task->duration_slots;
+        int limit = task_slot_limit(timeline, task);
+        if (length <= 0 || length > limit) {
+            count = -1;
+            break;
+        }
+        if (limit > widest[length]) widest[length] = limit;
+        
+        int cut = run_of_slot[limit - 1];
+        bool fits_cut = cut >= 0 && run_end[cut] > limit && limit - run_start[cut] >= length;
+        int first = first_long[length];
+        if (first >= 0 && run_end[first] <= limit) {
+            component[t] = first;
+            if (fits_cut) run_union(parent, first, cut);
+        } else if (fits_cut) {
+            component[t] = cut;
+        } else {
+            count = -1;
+        }
+    }
+    for (int length = 1; length <= num_slots && count >= 0; length++) {
+        int first = -1;
+        for (int r = 0; widest[length] > 0 && r < num_runs && run_end[r] <= widest[length]; r++) {
+            if (run_end[r] - run_start[r] < length) continue;
+            if (first < 0) {
+                first = r;
+            } else {
+                run_union(parent, first, r);
+            }
+        }
+    }
+    
+    /* Number the components by their first task */
+    int* label = first_long;
+    for (int r = 0; r < num_runs; r++) {
+        label[r] = -1;
+    }
+    for (int t = 0; t < solver->num_tasks && count >= 0; t++) {
+        if (component[t] < 0) continue;
+        int root = run_root(parent, component[t]);
+        if (label[root] < 0) label[root] = count++;
+        component[t] = label[root];
+    }
+    
+    arena_free(solver->arena, buffer);
+    return count > 0 ? count : 0;
+}
+
+/**
+ * Shared state of a decomposed search
+ */
+typedef struct {
+    Solver* solver;                 /* Solver of the whole request */
+    const SolverOptions* options;   /* Options of each component's search */
+    int num_components;
+    const int* members;             /* Task indices grouped by component, in search order */
+    const int* offsets;             /* First member of each component, num_components + 1 */
+    pthread_mutex_t lock;
+    int next;                       /* Next component to search */
+    NodePool budget;                /* What is left of the request's max_nodes */
+    int64_t nodes;                  /* Nodes expanded by finished components */
+    SolverStats stats;              /* Counters of finished components */
+    bool found;                     /* Every finished component was solved */
+    bool budget_exhausted;          /* Some component ran out of budget */
+    bool cancelled;                 /* Some component stopped for the portfolio */
+    bool failed;                    /* Memory ran out */
+} ComponentSearch;
+
+/**
+ * Search one component on timeline and record its placements in the
+ * request solver's best_placements. The timeline is left as it was.
+ */
+static void search_component(ComponentSearch* cs, Timeline* timeline, Arena* arena, int c) {
+    Solver* solver = cs->solver;
+    const int* members = cs->members + cs->offsets[c];
+    int count = cs->offsets[c + 1] - cs->offsets[c];
+    
+    SolverTask* tasks = (SolverTask*)arena_alloc(arena, sizeof(SolverTask) * (size_t)count);
+    for (int k = 0; tasks != NULL && k < count; k++) {
+        tasks[k] = solver->tasks[members[k]];
+    }
+    Solver* sub = tasks == NULL ? NULL :
+        solver_create(timeline, tasks, count, solver->energy, cs->options, solver->portfolio);
+    if (sub == NULL) {
+        arena_free(arena, tasks);
+        pthread_mutex_lock(&cs->lock);
+        cs->failed = true;
+        pthread_mutex_unlock(&cs->lock);
+        return;
+    }
+    sub->deadline_us = solver->deadline_us;
+    if (cs->options->max_nodes > 0) {
+        /* Components draw on one request budget rather than each getting it */
+        sub->node_pool = &cs->budget;
+        sub->max_nodes = 0;
+        sub->budget_exhausted = !node_pool_draw(sub);
+    }
+    
+    bool found = !sub->budget_exhausted &&
+                 (!sub->forward_checking || update_domains(sub, -1) < 0) &&
+                 backtrack(sub, 0);
+    const int* result = found ? sub->placements : sub->best_placements;
+    for (int k = 0; k < count; k++) {
+        solver->best_placements[members[k]] = result[k];
+        if (found) remove_task(timeline, &tasks[k], result[k]);
+    }
+    
+    /* The expansion that found the pool empty was never searched */
+    int64_t nodes = sub->nodes;
+    if (sub->node_pool != NULL) {
+        if (nodes > sub->max_nodes) nodes = sub->max_nodes;
+        pthread_mutex_lock(&cs->budget.lock);
+        cs->budget.remaining += sub->max_nodes - nodes;
+        pthread_mutex_unlock(&cs->budget.lock);
+    }
+    
+    pthread_mutex_lock(&cs->lock);
+    cs->nodes += nodes;
+    stats_merge(&cs->stats, &sub->stats);
+    cs->found = cs->found && found;
+    cs->budget_exhausted = cs->budget_exhausted || sub->budget_exhausted;
+    cs->cancelled = cs->cancelled || sub->cancelled;
+    pthread_mutex_unlock(&cs->lock);
+    solver_free(sub);
+    arena_free(arena, tasks);
+}
+
+/**
+ * Worker of a parallel decomposed search: takes components until none
+ * is left, on its own copy of the timeline
+ */
+static void* component_worker_main(void* arg) {
+    ComponentSearch* cs = (ComponentSearch*)arg;
+    Timeline* timeline = timeline_clone(cs->solver->timeline);
+    
+    for (;;) {
+        pthread_mutex_lock(&cs->lock);
+        int c = cs->next++;
+        if (timeline == NULL) cs->failed = true;
+        pthread_mutex_unlock(&cs->lock);
+        if (c >= cs->num_components || timeline == NULL) break;
+        search_component(cs, timeline, NULL, c);
+    }
+    timeline_free(timeline);
+    return NULL;
+}
+
+/**
+ * Search every component of the request on its own. On return
+ * solver->placements holds the schedule if all were solved; otherwise
+ * solver->best_placements holds each component's deepest assignment.
+ * @param found Output: true if every component was solved
+ * @return false if the tasks form a single component or memory ran
+ *         out, leaving the search to the caller
+ */
+static bool solve_components(Solver* solver, const SolverOptions* options, bool* found) {
+    int num_tasks = solver->num_tasks;
+    Arena* arena = solver->arena;
+    if (solver->num_levels < 2) return false;
+    
+    int* buffer = (int*)arena_alloc(arena, sizeof(int) * (size_t)(num_tasks * 3 + 2));
+    if (buffer == NULL) return false;
+    int* component = buffer;
+    int* members = buffer + num_tasks;
+    int* offsets = buffer + num_tasks * 2;
+    int num_components = task_components(solver, component);
+    if (num_components < 2) {
+        arena_free(arena, buffer);
+        return false;
+    }
+    
+    /* Stable counting sort keeps each component in search order */
+    for (int c = 0; c <= num_components; c++) {
+        offsets[c] = 0;
+    }
+    for (int t = 0; t < num_tasks; t++) {
+        if (component[t] >= 0) offsets[component[t] + 1]++;
+    }
+    for (int c = 0; c < num_components; c++) {
+        offsets[c + 1] += offsets[c];
+    }
+    for (int t = 0; t < num_tasks; t++) {
+        if (component[t] >= 0) members[offsets[component[t]]++] = t;
+    }
+    for (int c = num_components; c > 0; c--) {
+        offsets[c] = offsets[c - 1];
+    }
+    offsets[0] = 0;
+    
+    SolverOptions component_options = *options;
+    component_options.threads = 0;
+    component_options.search_threads = 0;
+    component_options.arena = arena;
+    
+    ComponentSearch cs;
+    cs.solver = solver;
+    cs.options = &component_options;
+    cs.num_components = num_components;
+    cs.members = members;
+    cs.offsets = offsets;
+    pthread_mutex_init(&cs.lock, NULL);
+    cs.next = 0;
+    pthread_mutex_init(&cs.budget.lock, NULL);
+    cs.budget.remaining = options->max_nodes;
+    cs.nodes = 0;
+    memset(&cs.stats, 0, sizeof(cs.stats));
+    cs.found = true;
+    cs.budget_exhausted = false;
+    cs.cancelled = false;
+    cs.failed = false;
+    
+    int num_workers = options->search_threads < num_components ?
+        options->search_threads : num_components;
+    if (num_workers > MAX_PORTFOLIO_THREADS) num_workers = MAX_PORTFOLIO_THREADS;
+    pthread_t threads[MAX_PORTFOLIO_THREADS];
+    int num_started = 0;
+    if (num_workers > 1) {
+        component_options.arena = NULL;     /* Workers run on other threads */
+        for (int i = 0; i < num_workers; i++) {
+            if (pthread_create(&threads[num_started], NULL, component_worker_main, &cs) == 0) {
+                num_started++;
+            }
+        }
+        for (int i = 0; i < num_started; i++) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    if (num_started == 0) {
+        component_options.arena = arena;
+        for (int c = 0; c < num_components && !cs.failed; c++) {
+            search_component(&cs, solver->timeline, arena, c);
+        }
+    }
+    pthread_mutex_destroy(&cs.budget.lock);
+    pthread_mutex_destroy(&cs.lock);
+    arena_free(arena, buffer);
+    
+    if (cs.failed) {
+        for (int t = 0; t < num_tasks; t++) {
+            solver->best_placements[t] = -1;
+        }
+        return false;
+    }
+    
+    solver->nodes = cs.nodes;
+    stats_merge(&solver->stats, &cs.stats);
+    solver->budget_exhausted = cs.budget_exhausted;
+    solver->cancelled = cs.cancelled;
+    *found = cs.found;
+    if (cs.found) {
+        /* Leave the schedule placed, as a whole search does */
+        memcpy(solver->placements, solver->best_placements, sizeof(int) * num_tasks);
+        for (int t = 0; t < num_tasks; t++) {
+            if (solver->placements[t] >= 0) {
+                place_task(solver->timeline, &solver->tasks[t], solver->placements[t]);
+            }
+        }
+    }
+    return true;
+}
+
+
+/* ============================================================
+ * Single Strategy Solve
+ * ============================================================ */
+
+/**
+ * Name a strategy after its engine and search flags,
+ * e.g. "backtrack+fc+cbj", "backtrack+cbj/ties=3" or "auto+fc+bnb"
+ */
+static void describe_strategy(const SolverOptions* options, char* name, size_t len) {
+    int n = snprintf(name, len, "%s", solver_engine_to_string(options->engine));
+    if (options->engine != ENGINE_GREEDY) {
+        if (options->forward_checking && n < (int)len) {
+            n += snprintf(name + n, len - n, "+fc");
+        }
+        if (options->backjumping && n < (int)len) {
+            n += snprintf(name + n, len - n, "+cbj");
+        }
+        if (options->backjumping && options->max_nogoods > 0 && n < (int)len) {
+            n += snprintf(name + n, len - n, "+nogoods");
+        }
+        if (options->objective != OBJECTIVE_FEASIBLE && n < (int)len) {
+            n += snprintf(name + n, len - n, "+bnb");
+        }
+        if (options->tie_break_seed != 0 && n < (int)len) {
+            n += snprintf(name + n, len - n, "/ties=%u", (unsigned)options->tie_break_seed);
+        }
+        if (options->search_threads > 1 && n < (int)len) {
+            snprintf(name + n, len - n, "/split=%d", options->search_threads);
+        }
+    }
+}
+
+/**
+ * Branch-and-bound search on a timeline with nothing placed, after
+ * bound_init. The incumbent may already hold the greedy schedule.
+ * @return true if a schedule was found; the best one is then placed
+ */
+static bool branch_and_bound(Solver* solver) {
+    if (solver->root_bound < 0) {
+        return false;
+    }
+    if (solver->incumbent < solver->root_bound &&
+        (!solver->forward_checking || update_domains(solver, -1) < 0) &&
+        backtrack(solver, 0)) {
+        /* Stopped at a schedule reaching the root bound */
+        solver->objective_bound = solver->incumbent;
+        return true;
+    }
+    if (!solver->budget_exhausted) {
+        solver->objective_bound = solver->incumbent;
+    }
+    if (solver->incumbent < 0) {
+        return false;
+    }
+    
+    /* The search unwound every placement; reapply the incumbent */
+    memcpy(solver->placements, solver->incumbent_placements, sizeof(int) * solver->num_tasks);
+    for (int t = 0; t < solver->num_tasks; t++) {
+        if (solver->placements[t] >= 0) {
+            place_task(solver->timeline, &solver->tasks[t], solver->placements[t]);
+        }
+    }
+    return true;
+}
+
+/**
+ * Solve sorted tasks into a timeline that already holds the fixed slots
+ * and energy levels. Fills in the result fields of the timeline.
+ * @param portfolio Portfolio run to poll for cancellation, NULL if alone
+ * @param cancelled Output: true if stopped because the portfolio finished
+ */
+static void solve_prepared(
+    Timeline* timeline,
+    SolverTask* sorted_tasks,
+    int num_tasks,
+    const EnergyTable* energy,
+    const SolverOptions* options,
+    Portfolio* portfolio,
+    bool* cancelled
+) {
+    describe_strategy(options, timeline->strategy, MAX_STRATEGY_LEN);
+    *cancelled = false;
+    
+    /* Initialize solver state */
+    Solver* solver = solver_create(timeline, sorted_tasks, num_tasks, energy, options, portfolio);
+    if (solver == NULL) {
+        timeline->success = false;
+        snprintf(timeline->error_message, MAX_ERROR_LEN, 
+                 "Memory allocation failed");
+        return;
+    }
+    int* placements = solver->placements;
+    bool optimizing = solver->fit_score != NULL;
+    if (optimizing) {
+        bound_init(solver);
+    }
+    
+    /* Capacity refutes some infeasible requests before any search */
+    bool refuted = options->engine != ENGINE_GREEDY && !capacity_check(solver);
+    bool found = false;
+    bool searched = false;
+    if (!refuted && options->engine != ENGINE_BACKTRACK) {
+        timeline->engine = ENGINE_GREEDY;
+        found = (greedy_schedule(solver) == 0);
+        if (found || options->engine == ENGINE_GREEDY) {
+            local_search(solver, options->local_search_moves, options->seed);
+        }
+        if (!found) {
+            /* best_placements holds the greedy result for apply_partial */
+            clear_placements(solver);
+        }
+    }
+    if (found && optimizing && options->engine == ENGINE_AUTO) {
+        /* The greedy schedule is the incumbent the search has to beat */
+        set_incumbent(solver, placements_value(solver, placements));
+        clear_placements(solver);
+        found = false;
+    }
+    if (!found && options->engine != ENGINE_GREEDY) {
+        /* Run backtracking algorithm; with forward checking an empty
+         * initial domain means no search is needed */
+        timeline->engine = ENGINE_BACKTRACK;
+        searched = true;
+        for (int i = 0; i < num_tasks; i++) {
+            solver->best_placements[i] = -1;
+        }
+        if (refuted) {
+            found = false;
+        } else if (optimizing) {
+            found = branch_and_bound(solver);
+        } else if (solve_components(solver, options, &found)) {
+            /* Each independent group of tasks was searched on its own */
+        } else if (options->search_threads > 1) {
+            found = parallel_backtrack(solver, options, options->search_threads);
+        } else {
+            found = (!options->forward_checking || update_domains(solver, -1) < 0) &&
+                    backtrack(solver, 0);
+        }
+    }
+    
+    if (found) {
+        commit_placements(timeline, sorted_tasks, num_tasks, placements);
+        timeline->success = true;
+    } else if (!searched) {
+        int num_unplaced = apply_partial(solver);
+        timeline->success = (num_unplaced == 0);
+        if (num_unplaced > 0) {
+            snprintf(timeline->error_message, MAX_ERROR_LEN,
+                     "GREEDY_INCOMPLETE: Greedy placement left %d task(s) unplaced",
+                     num_unplaced);
+        }
+    } else if (apply_partial(solver) == 0) {
+        /* Budget ran out, but the greedy top-up completed the schedule */
+        timeline->success = true;
+        timeline->budget_exhausted = true;
+    } else {
+        timeline->success = false;
+        timeline->budget_exhausted = solver->budget_exhausted;
+        if (solver->budget_exhausted) {
+            snprintf(timeline->error_message, MAX_ERROR_LEN,
+                     "BUDGET_EXHAUSTED: Search budget ran out with %d task(s) unplaced",
+                     timeline->num_unplaced);
+        } else if (!refuted) {
             snprintf(timeline->error_message, MAX_ERROR_LEN, 
-                     "Invalid number of tasks: %d", num_tasks);
+                     "NO_SOLUTION: Cannot find valid placement for all tasks");
         }
-        return timeline;
     }
     
-    /* Create timeline (default 7 days) */
-    Timeline* timeline = timeline_create();
+    if (optimizing) {
+        timeline->objective_value = timeline->success ? placements_value(solver, placements) : -1;
+        timeline->objective_bound = solver->objective_bound > timeline->objective_value ?
+            solver->objective_bound : timeline->objective_value;
+    }
+    
+    timeline->nodes = solver->nodes;
+#ifdef AESA_STATS
+    timeline->stats = solver->stats;
+    timeline->stats.nodes = solver->nodes;
+#endif
+    
+    /* Cleanup */
+    *cancelled = solver->cancelled;
+    solver_free(solver);
+}
+
+
+/* ============================================================
+ * Portfolio Solver
+ * 
+ * Several threads solve the same input with different strategies, each
+ * on its own Timeline copy. The first worker to find a complete schedule
+ * or prove there is none marks the portfolio done; the rest notice at
+ * their next budget check and stop.
+ * ============================================================ */
+
+/**
+ * One portfolio worker: a strategy and the timeline it fills
+ */
+typedef struct {
+    Portfolio* portfolio;
+    int index;                      /* Position in the portfolio */
+    Timeline* timeline;             /* Private copy of the prepared timeline */
+    SolverTask* tasks;              /* Sorted tasks, shared read-only */
+    int num_tasks;
+    const EnergyTable* energy;      /* Shared read-only */
+    SolverOptions options;          /* This worker's strategy */
+    bool cancelled;                 /* Stopped early by another worker */
+} PortfolioWorker;
+
+/**
+ * Derive strategy i of the portfolio from the request options. Strategy 0
+ * is the request as given; the others vary ordering, pruning, candidate
+ * tie-breaking and the engine, keeping the budget and energy curve.
+ */
+static void portfolio_strategy(const SolverOptions* base, int index, SolverOptions* out) {
+    *out = *base;
+    out->threads = 1;
+    out->search_threads = 0;
+    
+    switch (index) {
+        case 0:
+            break;
+        case 1:
+            out->engine = ENGINE_BACKTRACK;
+            out->forward_checking = true;
+            out->backjumping = true;
+            if (out->max_nogoods == 0) out->max_nogoods = PORTFOLIO_NOGOODS;
+            break;
+        case 2:
+            out->engine = ENGINE_GREEDY;
+            break;
+        default:
+            /* Odd and even indexes alternate the variable ordering */
+            out->engine = ENGINE_BACKTRACK;
+            out->forward_checking = (index % 2 == 0);
+            out->backjumping = true;
+            out->tie_break_seed = (uint32_t)(index - 2);
+            break;
+    }
+}
+
+/**
+ * A result ends the portfolio if it is a full schedule or if a search
+ * proved that none exists
+ */
+static bool result_is_definitive(const Timeline* timeline) {
+    if (timeline->success) return true;
+    return timeline->engine == ENGINE_BACKTRACK && !timeline->budget_exhausted &&
+           strncmp(timeline->error_message, "NO_SOLUTION", 11) == 0;
+}
+
+static void* portfolio_worker_main(void* arg) {
+    PortfolioWorker* worker = (PortfolioWorker*)arg;
+    
+    solve_prepared(worker->timeline, worker->tasks, worker->num_tasks,
+                   worker->energy, &worker->options, worker->portfolio,
+                   &worker->cancelled);
+    
+    if (!worker->cancelled && result_is_definitive(worker->timeline)) {
+        pthread_mutex_lock(&worker->portfolio->lock);
+        if (!worker->portfolio->done) {
+            worker->portfolio->done = true;
+            worker->portfolio->winner = worker->index;
+        }
+        pthread_mutex_unlock(&worker->portfolio->lock);
+    }
+    return NULL;
+}
+
+/**
+ * Run the portfolio and move the chosen result into timeline. Without a
+ * definitive result, the one with the fewest unplaced tasks is kept.
+ * @return false if the workers could not be allocated
+ */
+static bool solve_portfolio(
+    Timeline* timeline,
+    SolverTask* sorted_tasks,
+    int num_tasks,
+    const EnergyTable* energy,
+    const SolverOptions* options
+) {
+    int num_workers = options->threads;
+    if (num_workers > MAX_PORTFOLIO_THREADS) num_workers = MAX_PORTFOLIO_THREADS;
+    
+    PortfolioWorker* workers = (PortfolioWorker*)calloc(num_workers, sizeof(PortfolioWorker));
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * num_workers);
+    bool* started = (bool*)calloc(num_workers, sizeof(bool));
+    if (workers == NULL || threads == NULL || started == NULL) {
+        free(workers);
+        free(threads);
+        free(started);
+        return false;
+    }
+    
+    Portfolio portfolio;
+    pthread_mutex_init(&portfolio.lock, NULL);
+    portfolio.done = false;
+    portfolio.winner = -1;
+    
+    bool ok = true;
+    for (int i = 0; i < num_workers && ok; i++) {
+        PortfolioWorker* worker = &workers[i];
+        worker->portfolio = &portfolio;
+        worker->index = i;
+        worker->tasks = sorted_tasks;
+        worker->num_tasks = num_tasks;
+        worker->energy = energy;
+        portfolio_strategy(options, i, &worker->options);
+        worker->options.arena = NULL;   /* Workers run on other threads */
+        worker->timeline = timeline_clone(timeline);
+        if (worker->timeline == NULL) {
+            ok = false;
+            break;
+        }
+        
+        /* A worker whose thread cannot start runs inline instead */
+        started[i] = (pthread_create(&threads[i], NULL, portfolio_worker_main, worker) == 0);
+        if (!started[i]) {
+            portfolio_worker_main(worker);
+        }
+    }
+    
+    /* Without a full set of workers, stop the ones already running */
+    if (!ok) {
+        pthread_mutex_lock(&portfolio.lock);
+        portfolio.done = true;
+        pthread_mutex_unlock(&portfolio.lock);
+    }
+    for (int i = 0; i < num_workers; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    
+    if (ok) {
+        int chosen = portfolio.winner;
+        for (int i = 0; chosen < 0 && i < num_workers; i++) {
+            if (workers[i].cancelled) continue;
+            if (chosen < 0 || workers[i].timeline->num_unplaced <
+                              workers[chosen].timeline->num_unplaced) {
+                chosen = i;
+            }
+        }
+        if (chosen < 0) chosen = 0;
+        
+        /* Take over the winner's timeline, including its unplaced list,
+         * which an arena timeline copies instead of adopting */
+        Timeline* winner = workers[chosen].timeline;
+        TimeSlot* slots = timeline->slots;
+        uint64_t* occupied = timeline->occupied;
+        Arena* arena = timeline->arena;
+        memcpy(slots, winner->slots, sizeof(TimeSlot) * (size_t)winner->num_slots);
+        memcpy(occupied, winner->occupied, sizeof(uint64_t) * (size_t)winner->num_words);
+        *timeline = *winner;
+        timeline->slots = slots;
+        timeline->occupied = occupied;
+        timeline->arena = arena;
+        if (arena == NULL) {
+            winner->unplaced_task_ids = NULL;
+        } else if (winner->unplaced_task_ids != NULL) {
+            size_t size = sizeof(int) * (size_t)winner->num_unplaced;
+            timeline->unplaced_task_ids = (int*)arena_alloc(arena, size);
+            if (timeline->unplaced_task_ids != NULL) {
+                memcpy(timeline->unplaced_task_ids, winner->unplaced_task_ids, size);
+            } else {
+                timeline->num_unplaced = 0;
+            }
+        }
+    }
+    
+    for (int i = 0; i < num_workers; i++) {
+        timeline_free(workers[i].timeline);
+    }
+    pthread_mutex_destroy(&portfolio.lock);
+    free(workers);
+    free(threads);
+    free(started);
+    return ok;
+}
+
+
+/* ============================================================
+ * Main Optimization Function
+ * Requirements: 2.1, 2.2, 2.3, 2.4, 2.5
+ * ============================================================ */
+
+void solver_options_init(SolverOptions* options) {
+    if (options == NULL) return;
+    
+    options->has_energy_curve = false;
+    for (int s = 0; s < SLOTS_PER_DAY; s++) {
+        options->energy_curve[s] = DEFAULT_ENERGY_CURVE[s];
+    }
+    options->max_nodes = 0;
+    options->max_time_us = 0;
+    options->forward_checking = false;
+    options->backjumping = false;
+    options->max_nogoods = 0;
+    options->engine = ENGINE_BACKTRACK;
+    options->local_search_moves = LOCAL_SEARCH_DEFAULT_MOVES;
+    options->seed = LOCAL_SEARCH_DEFAULT_SEED;
+    options->tie_break_seed = 0;
+    options->threads = 0;
+    options->search_threads = 0;
+    options->objective = OBJECTIVE_FEASIBLE;
+    options->weight_by_priority = false;
+    options->num_days = DEFAULT_NUM_DAYS;
+    options->slot_minutes = DEFAULT_SLOT_MINUTES;
+    options->start_slot_of_day = 0;
+    options->fixed_template = NULL;
+    options->arena = NULL;
+}
+
+int solver_threads_from_environment(void) {
+    const char* env_threads = getenv("AESA_THREADS");
+    if (env_threads == NULL) return 0;
+
+    int threads = atoi(env_threads);
+    if (threads > MAX_PORTFOLIO_THREADS) threads = MAX_PORTFOLIO_THREADS;
+    return threads > 0 ? threads : 0;
+}
+
+static int task_capacity = DEFAULT_MAX_TASKS;
+static pthread_once_t task_capacity_once = PTHREAD_ONCE_INIT;
+
+static void read_task_capacity(void) {
+    const char* env_tasks = getenv("AESA_MAX_TASKS");
+    if (env_tasks == NULL || *env_tasks == '\0') return;
+    
+    char* end;
+    long capacity = strtol(env_tasks, &end, 10);
+    if (*end == '\0' && capacity >= 1 && capacity <= MAX_TASK_CAPACITY) {
+        task_capacity = (int)capacity;
+    }
+}
+
+int solver_task_capacity(void) {
+    pthread_once(&task_capacity_once, read_task_capacity);
+    return task_capacity;
+}
+
+Timeline* optimize_schedule(
+    Task* tasks,
+    int num_tasks,
+    TimeSlot* fixed_slots,
+    int num_fixed
+) {
+    return optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed, NULL);
+}
+
+
+/* ============================================================
+ * Fixed-Slot Templates
+ * 
+ * Students of one section share a timetable, so their requests repeat
+ * the same fixed slots. A template applies them once to a prototype
+ * Timeline; each solve copies the prototype's slots and occupancy words
+ * (two memcpy calls) instead of applying the slots one by one, then
+ * applies the request's own fixed slots on top.
+ * ============================================================ */
+
+struct FixedTemplate {
+    Timeline* prototype;            /* Template slots applied, default energy levels */
+    TimeSlot* slots;                /* The applied slots, in slot order */
+    int num_fixed;                  /* Entries in slots */
+};
+
+/**
+ * Mark fixed slots in a timeline; out-of-range slots are dropped and a
+ * later entry for a slot overrides an earlier one
+ */
+static void apply_fixed_slots(Timeline* timeline, const TimeSlot* fixed_slots, int num_fixed) {
+    if (fixed_slots == NULL) return;
+    for (int i = 0; i < num_fixed; i++) {
+        int idx = fixed_slots[i].slot_index;
+        if (idx >= 0 && idx < timeline->num_slots) {
+            timeline->slots[idx].task_id = fixed_slots[i].task_id;
+            timeline->slots[idx].is_fixed = true;
+            bits_set_range(timeline->occupied, idx, 1);
+        }
+    }
+}
+
+FixedTemplate* fixed_template_create(const TimeSlot* fixed_slots, int num_fixed,
+                                     const SolverOptions* options) {
+    SolverOptions defaults;
+    if (options == NULL) {
+        solver_options_init(&defaults);
+        options = &defaults;
+    }
+    
+    FixedTemplate* tmpl = (FixedTemplate*)calloc(1, sizeof(FixedTemplate));
+    if (tmpl == NULL) return NULL;
+    tmpl->prototype = timeline_create_in(NULL, options->num_days, options->slot_minutes,
+                                         options->start_slot_of_day);
+    if (tmpl->prototype == NULL) {
+        free(tmpl);
+        return NULL;
+    }
+    Timeline* prototype = tmpl->prototype;
+    apply_fixed_slots(prototype, fixed_slots, num_fixed);
+    
+    for (int i = 0; i < prototype->num_slots; i++) {
+        if (prototype->slots[i].is_fixed) tmpl->num_fixed++;
+    }
+    tmpl->slots = (TimeSlot*)malloc(sizeof(TimeSlot) * (size_t)(tmpl->num_fixed + 1));
+    if (tmpl->slots == NULL) {
+        fixed_template_free(tmpl);
+        return NULL;
+    }
+    int count = 0;
+    for (int i = 0; i < prototype->num_slots; i++) {
+        if (prototype->slots[i].is_fixed) tmpl->slots[count++] = prototype->slots[i];
+    }
+    return tmpl;
+}
+
+void fixed_template_free(FixedTemplate* tmpl) {
+    if (tmpl == NULL) return;
+    timeline_free(tmpl->prototype);
+    free(tmpl->slots);
+    free(tmpl);
+}
+
+const TimeSlot* fixed_template_slots(const FixedTemplate* tmpl, int* num_fixed) {
+    *num_fixed = tmpl->num_fixed;
+    return tmpl->slots;
+}
+
+bool fixed_template_fits(const FixedTemplate* tmpl, const SolverOptions* options) {
+    const Timeline* prototype = tmpl->prototype;
+    return prototype->slot_minutes == options->slot_minutes &&
+           prototype->start_slot_of_day == options->start_slot_of_day &&
+           prototype->num_slots == horizon_num_slots(options->num_days, options->slot_minutes,
+                                                     options->start_slot_of_day);
+}
+
+Timeline* fixed_template_timeline(const FixedTemplate* tmpl, Arena* arena) {
+    Timeline* timeline = timeline_clone_in(arena, tmpl->prototype);
+    if (timeline != NULL) {
+        timeline->success = true;
+    }
+    return timeline;
+}
+
+/**
+ * Create the timeline of a request: energy levels and fixed slots
+ * @param energy Output: energy scores for the request's curve
+ * @return Timeline, NULL on allocation failure
+ */
+static Timeline* prepare_timeline(
+    TimeSlot* fixed_slots,
+    int num_fixed,
+    const SolverOptions* options,
+    EnergyTable* energy
+) {
+    /* Create timeline sized to the request's horizon, or copy the template
+     * built for it (callers check fixed_template_fits) */
+    Timeline* timeline = options->fixed_template != NULL
+        ? timeline_clone_in(options->arena, options->fixed_template->prototype)
+        : timeline_create_in(options->arena, options->num_days,
+                             options->slot_minutes, options->start_slot_of_day);
     if (timeline == NULL) {
         return NULL;
     }
+    describe_strategy(options, timeline->strategy, MAX_STRATEGY_LEN);
     
-    /* Apply fixed slots first */
-    if (fixed_slots != NULL && num_fixed > 0) {
-        for (int i = 0; i < num_fixed; i++) {
-            int idx = fixed_slots[i].slot_index;
-            if (idx >= 0 && idx < timeline->num_slots) {
-                timeline->slots[idx].task_id = fixed_slots[i].task_id;
-                timeline->slots[idx].is_fixed = true;
-            }
+    /* Build energy scores once per solve; the curve also sets slot levels */
+    energy_table_build_ex(energy, options->has_energy_curve ? options->energy_curve : NULL,
+                          options->slot_minutes, options->start_slot_of_day);
+    if (options->has_energy_curve) {
+        for (int i = 0; i < timeline->num_slots; i++) {
+            timeline->slots[i].energy_level =
+                energy->level[(energy->start_slot_of_day + i) % energy->slots_per_day];
         }
     }
     
+    /* Apply fixed slots first */
+    apply_fixed_slots(timeline, fixed_slots, num_fixed);
+    return timeline;
+}
+
+/**
+ * Sort a copy of tasks by priority and solve it into a prepared timeline
+ */
+static void solve_tasks(
+    Timeline* timeline,
+    const SolverTask* tasks,
+    int num_tasks,
+    const EnergyTable* energy,
+    const SolverOptions* options
+) {
     /* Handle empty task list */
+    timeline->objective = options->objective;
     if (tasks == NULL || num_tasks == 0) {
         timeline->success = true;
-        return timeline;
+        if (options->objective != OBJECTIVE_FEASIBLE) {
+            timeline->objective_value = 0;
+            timeline->objective_bound = 0;
+        }
+        return;
+    }
+    
+    /* Conflict sets and nogoods explain infeasibility, not bound
+     * failures, and a proven bound needs one search: branch and bound
+     * runs without them, alone */
+    SolverOptions optimizing;
+    if (options->objective != OBJECTIVE_FEASIBLE) {
+        optimizing = *options;
+        optimizing.backjumping = false;
+        optimizing.max_nogoods = 0;
+        optimizing.threads = 0;
+        optimizing.search_threads = 0;
+        options = &optimizing;
     }
     
     /* Create working copy of tasks for sorting */
-    Task* sorted_tasks = task_array_create(num_tasks);
+    SolverTask* sorted_tasks =
+        (SolverTask*)arena_alloc(options->arena, sizeof(SolverTask) * num_tasks);
     if (sorted_tasks == NULL) {
         timeline->success = false;
         snprintf(timeline->error_message, MAX_ERROR_LEN, 
                  "Memory allocation failed");
-        return timeline;
+        return;
     }
-    memcpy(sorted_tasks, tasks, sizeof(Task) * num_tasks);
+    memcpy(sorted_tasks, tasks, sizeof(SolverTask) * num_tasks);
     
     /* Sort tasks by priority (highest first) */
-    qsort(sorted_tasks, num_tasks, sizeof(Task), task_compare_priority);
+    qsort(sorted_tasks, num_tasks, sizeof(SolverTask), solver_task_compare_priority);
+    
+    if (options->threads > 1) {
+        if (!solve_portfolio(timeline, sorted_tasks, num_tasks, energy, options)) {
+            timeline->success = false;
+            snprintf(timeline->error_message, MAX_ERROR_LEN, 
+                     "Memory allocation failed");
+        }
+    } else {
+        bool cancelled;
+        solve_prepared(timeline, sorted_tasks, num_tasks, energy, options, NULL, &cancelled);
+    }
     
-    /* Initialize placements array */
-    int* placements = (int*)malloc(sizeof(int) * num_tasks);
-    if (placements == NULL) {
-        task_array_free(sorted_tasks);
+    arena_free(options->arena, sorted_tasks);
+}
+
+static Timeline* invalid_task_count(int num_tasks) {
+    Timeline* timeline = timeline_create();
+    if (timeline) {
         timeline->success = false;
         snprintf(timeline->error_message, MAX_ERROR_LEN, 
-                 "Memory allocation failed");
-        return timeline;
+                 "Invalid number of tasks: %d", num_tasks);
     }
-    for (int i = 0; i < num_tasks; i++) {
-        placements[i] = -1;
+    return timeline;
+}
+
+static Timeline* invalid_horizon(const SolverOptions* options) {
+    Timeline* timeline = timeline_create();
+    if (timeline) {
+        timeline->success = false;
+        snprintf(timeline->error_message, MAX_ERROR_LEN, 
+                 "Invalid horizon: %d day(s) of %d-minute slots from slot %d",
+                 options->num_days, options->slot_minutes, options->start_slot_of_day);
+    }
+    return timeline;
+}
+
+static Timeline* invalid_template(const SolverOptions* options) {
+    Timeline* timeline = timeline_create();
+    if (timeline) {
+        timeline->success = false;
+        snprintf(timeline->error_message, MAX_ERROR_LEN, 
+                 "Invalid fixed_template: built for another horizon than "
+                 "%d day(s) of %d-minute slots from slot %d",
+                 options->num_days, options->slot_minutes, options->start_slot_of_day);
+    }
+    return timeline;
+}
+
+Timeline* optimize_schedule_ex(
+    Task* tasks,
+    int num_tasks,
+    TimeSlot* fixed_slots,
+    int num_fixed,
+    const SolverOptions* options
+) {
+    SolverOptions defaults;
+    if (options == NULL) {
+        solver_options_init(&defaults);
+        options = &defaults;
     }
     
-    /* Run backtracking algorithm */
-    bool found = backtrack(timeline, sorted_tasks, num_tasks, 0, placements);
+    /* Validate inputs */
+    if (num_tasks < 0 || num_tasks > solver_task_capacity()) {
+        return invalid_task_count(num_tasks);
+    }
+    if (horizon_num_slots(options->num_days, options->slot_minutes,
+                          options->start_slot_of_day) < 0) {
+        return invalid_horizon(options);
+    }
+    if (options->fixed_template != NULL &&
+        !fixed_template_fits(options->fixed_template, options)) {
+        return invalid_template(options);
+    }
     
-    if (found) {
-        timeline->success = true;
-    } else {
+    EnergyTable energy;
+    Timeline* timeline = prepare_timeline(fixed_slots, num_fixed, options, &energy);
+    if (timeline == NULL) {
+        return NULL;
+    }
+    
+    SolverTask* records = NULL;
+    if (tasks != NULL && num_tasks > 0) {
+        records = solver_tasks_create(options->arena, tasks, num_tasks);
+        if (records == NULL) {
+            timeline->success = false;
+            snprintf(timeline->error_message, MAX_ERROR_LEN, 
+                     "Memory allocation failed");
+            return timeline;
+        }
+    }
+    
+    solve_tasks(timeline, records, num_tasks, &energy, options);
+    arena_free(options->arena, records);
+    return timeline;
+}
+
+
+/* ============================================================
+ * Incremental Re-optimization
+ * 
+ * Previous placements that still fit are pinned: they occupy the
+ * timeline like fixed slots while the remaining tasks are solved, so
+ * a single edit usually searches a handful of tasks.
+ * ============================================================ */
+
+static int placement_compare(const void* a, const void* b) {
+    const TaskPlacement* pa = (const TaskPlacement*)a;
+    const TaskPlacement* pb = (const TaskPlacement*)b;
+    if (pa->task_id != pb->task_id) {
+        return (pa->task_id > pb->task_id) - (pa->task_id < pb->task_id);
+    }
+    return (pa->start_slot > pb->start_slot) - (pa->start_slot < pb->start_slot);
+}
+
+/**
+ * Previous start of a task in placements sorted by placement_compare
+ * @return Earliest start recorded for task_id, -1 if none
+ */
+static int previous_start(const TaskPlacement* sorted, int count, int task_id) {
+    int lo = 0;
+    int hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (sorted[mid].task_id < task_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < count && sorted[lo].task_id == task_id) ? sorted[lo].start_slot : -1;
+}
+
+/**
+ * Whether a task's run in timeline starts at slot start
+ */
+static bool starts_at(const Timeline* timeline, int task_id, int start) {
+    if (start < 0 || start >= timeline->num_slots) return false;
+    return timeline->slots[start].task_id == task_id &&
+           (start == 0 || timeline->slots[start - 1].task_id != task_id);
+}
+
+Timeline* optimize_schedule_incremental(
+    Task* tasks,
+    int num_tasks,
+    TimeSlot* fixed_slots,
+    int num_fixed,
+    const TaskPlacement* previous,
+    int num_previous,
+    const SolverOptions* options
+) {
+    SolverOptions defaults;
+    if (options == NULL) {
+        solver_options_init(&defaults);
+        options = &defaults;
+    }
+    if (num_tasks < 0 || num_tasks > solver_task_capacity()) {
+        return invalid_task_count(num_tasks);
+    }
+    if (horizon_num_slots(options->num_days, options->slot_minutes,
+                          options->start_slot_of_day) < 0) {
+        return invalid_horizon(options);
+    }
+    if (options->fixed_template != NULL &&
+        !fixed_template_fits(options->fixed_template, options)) {
+        return invalid_template(options);
+    }
+    if (tasks == NULL) num_tasks = 0;
+    if (previous == NULL || num_previous < 0) num_previous = 0;
+    int64_t started_us = monotonic_us();
+    
+    EnergyTable energy;
+    Timeline* timeline = prepare_timeline(fixed_slots, num_fixed, options, &energy);
+    if (timeline == NULL) {
+        return NULL;
+    }
+    
+    /* Pinning runs in priority order, so a higher-priority task keeps its
+     * place when two previous placements now overlap */
+    Arena* arena = options->arena;
+    SolverTask* sorted_tasks = num_tasks > 0 ? solver_tasks_create(arena, tasks, num_tasks) : NULL;
+    SolverTask* displaced = num_tasks > 0 ?
+        (SolverTask*)arena_alloc(arena, sizeof(SolverTask) * num_tasks) : NULL;
+    TaskPlacement* sorted_previous = num_previous > 0 ?
+        (TaskPlacement*)arena_alloc(arena, sizeof(TaskPlacement) * num_previous) : NULL;
+    /* Previous and pinned start of each sorted task, -1 for none */
+    int* starts = (int*)arena_alloc(arena, sizeof(int) * (num_tasks + 1) * 2);
+    int* pinned = starts != NULL ? starts + num_tasks + 1 : NULL;
+    if ((num_tasks > 0 && (sorted_tasks == NULL || displaced == NULL)) ||
+        (num_previous > 0 && sorted_previous == NULL) || starts == NULL) {
+        arena_free(arena, sorted_tasks);
+        arena_free(arena, displaced);
+        arena_free(arena, sorted_previous);
+        arena_free(arena, starts);
         timeline->success = false;
         snprintf(timeline->error_message, MAX_ERROR_LEN, 
-                 "NO_SOLUTION: Cannot find valid placement for all tasks");
+                 "Memory allocation failed");
+        return timeline;
+    }
+    if (num_tasks > 0) {
+        qsort(sorted_tasks, num_tasks, sizeof(SolverTask), solver_task_compare_priority);
+    }
+    if (num_previous > 0) {
+        memcpy(sorted_previous, previous, sizeof(TaskPlacement) * num_previous);
+        qsort(sorted_previous, num_previous, sizeof(TaskPlacement), placement_compare);
     }
     
-    /* Cleanup */
-    free(placements);
-    task_array_free(sorted_tasks);
+    int num_pinned = 0;
+    int num_displaced = 0;
+    for (int t = 0; t < num_tasks; t++) {
+        SolverTask* task = &sorted_tasks[t];
+        starts[t] = task->is_fixed ? -1 :
+                    previous_start(sorted_previous, num_previous, task->id);
+        pinned[t] = -1;
+        if (starts[t] >= 0 && task->duration_slots > 0 &&
+            can_place_task(timeline, task, starts[t])) {
+            place_task(timeline, task, starts[t]);
+            pinned[t] = starts[t];
+            num_pinned++;
+        } else {
+            displaced[num_displaced++] = *task;
+        }
+    }
+    
+    /* Repair: solve only the displaced tasks around the pinned ones */
+    solve_tasks(timeline, displaced, num_displaced, &energy, options);
+    for (int t = 0; t < num_tasks; t++) {
+        if (pinned[t] < 0) continue;
+        for (int i = 0; i < sorted_tasks[t].duration_slots; i++) {
+            timeline->slots[pinned[t] + i].task_id = sorted_tasks[t].id;
+        }
+        /* The repair's objective counted only the displaced tasks */
+        if (timeline->objective_value >= 0) {
+            int64_t value = placement_value(&energy, options->weight_by_priority,
+                                            &sorted_tasks[t], pinned[t]);
+            timeline->objective_value += value;
+            timeline->objective_bound += value;
+        }
+    }
+    timeline->repaired = timeline->success;
+    
+    /* Widen to the whole schedule with what is left of the time budget */
+    if (!timeline->success && num_pinned > 0) {
+        SolverOptions wider = *options;
+        bool has_time = true;
+        if (options->max_time_us > 0) {
+            wider.max_time_us = options->max_time_us - (monotonic_us() - started_us);
+            has_time = wider.max_time_us > 0;
+        }
+        Timeline* full = has_time ?
+            prepare_timeline(fixed_slots, num_fixed, &wider, &energy) : NULL;
+        if (full != NULL) {
+            solve_tasks(full, sorted_tasks, num_tasks, &energy, &wider);
+            if (full->success || full->num_unplaced < timeline->num_unplaced) {
+                timeline_free(timeline);
+                timeline = full;
+            } else {
+                timeline_free(full);
+            }
+        }
+    }
+    
+    timeline->moved_tasks = 0;
+    for (int t = 0; t < num_tasks; t++) {
+        if (starts[t] >= 0 && !starts_at(timeline, sorted_tasks[t].id, starts[t])) {
+            timeline->moved_tasks++;
+        }
+    }
     
+    arena_free(arena, sorted_tasks);
+    arena_free(arena, displaced);
+    arena_free(arena, sorted_previous);
+    arena_free(arena, starts);
     return timeline;
 }
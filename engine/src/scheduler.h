@@ -10,21 +10,51 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
+#include "arena.h"
 #include <stdint.h>
 #include <stdbool.h>
 
 /* Constants */
-#define MAX_TASKS 500
-#define MAX_SLOTS 336          /* 7 days * 48 half-hour slots */
+#define DEFAULT_MAX_TASKS 20000 /* Task capacity unless AESA_MAX_TASKS sets it */
+#define MAX_TASK_CAPACITY 1048576 /* Largest AESA_MAX_TASKS accepted */
+#define MAX_DAYS 31
+#define MAX_SLOTS_PER_DAY 96   /* 15-minute slots */
+#define MAX_SLOTS (MAX_DAYS * MAX_SLOTS_PER_DAY) /* Longest horizon at the finest granularity */
 #define MAX_NAME_LEN 128
 #define MAX_ERROR_LEN 256
-#define SLOTS_PER_DAY 48       /* 24 hours * 2 slots per hour */
+#define MAX_NOGOODS 1048576    /* Upper bound on the learned nogood table */
+#define MAX_STRATEGY_LEN 64
+#define MAX_PORTFOLIO_THREADS 16
+#define PORTFOLIO_NOGOODS 4096 /* Nogood table for portfolio workers that learn */
+#define SLOTS_PER_DAY 48       /* 24 hours * 2 half-hour slots: default granularity and energy curve */
+
+/* Horizon defaults and slot granularity */
+#define DEFAULT_NUM_DAYS 7
+#define DEFAULT_SLOT_MINUTES 30
+#define MINUTES_PER_DAY 1440
+
+/* Occupancy bitmask sizing: one bit per slot, packed into 64-bit words */
+#define SLOT_WORD_BITS 64
+#define SLOT_WORDS ((MAX_SLOTS + SLOT_WORD_BITS - 1) / SLOT_WORD_BITS)
 
 /* Energy level thresholds */
 #define ENERGY_LOW 1
 #define ENERGY_MEDIUM 2
 #define ENERGY_PEAK 3
 
+/* Energy curve levels (1-10) and the period each level falls into */
+#define ENERGY_LEVEL_MIN 1
+#define ENERGY_LEVEL_MAX 10
+#define ENERGY_PEAK_THRESHOLD 8     /* Levels 8-10 are peak periods */
+#define ENERGY_MEDIUM_THRESHOLD 5   /* Levels 5-7 are medium, 1-4 low */
+
+/* Upper bound on calculate_energy_score (type bonus + preference bonus) */
+#define MAX_ENERGY_SCORE 15
+
+/* Local search defaults */
+#define LOCAL_SEARCH_DEFAULT_MOVES 4096
+#define LOCAL_SEARCH_DEFAULT_SEED 0x9E3779B97F4A7C15ULL
+
 /* Priority levels */
 #define PRIORITY_FREE_TIME 10
 #define PRIORITY_REGULAR_STUDY 50
@@ -64,19 +94,41 @@ typedef enum {
     ENERGY_ANY = 0,
     ENERGY_PREFER_LOW = 1,
     ENERGY_PREFER_MEDIUM = 2,
-    ENERGY_PREFER_PEAK = 3
+    ENERGY_PREFER_PEAK = 3,
+    ENERGY_PREFERENCE_COUNT = 4
 } PreferredEnergy;
 
+/**
+ * Solver engine selection
+ */
+typedef enum {
+    ENGINE_BACKTRACK = 0,           /* Complete CSP search */
+    ENGINE_GREEDY = 1,              /* Greedy seed + local search, may leave tasks unplaced */
+    ENGINE_AUTO = 2,                /* Greedy, backtracking only if tasks are left unplaced */
+    ENGINE_COUNT = 3
+} SolverEngine;
+
+/**
+ * What the backtracking search looks for
+ */
+typedef enum {
+    OBJECTIVE_FEASIBLE = 0,         /* First complete schedule */
+    OBJECTIVE_MAXIMIZE_ENERGY_FIT = 1, /* Highest total energy score, by branch and bound */
+    OBJECTIVE_COUNT = 2
+} SolverObjective;
+
 
 /**
  * Task structure - represents a schedulable unit of work
+ * The solver copies the fields it needs into compact internal records,
+ * so the name is only read by callers and output.
  * Requirements: 2.1
  */
 typedef struct {
     int id;                         /* Unique task identifier */
     char name[MAX_NAME_LEN];        /* Task name/title */
     TaskType type;                  /* Type of task */
-    int duration_slots;             /* Duration in 30-min slots */
+    int duration_slots;             /* Duration in slots */
     int priority;                   /* Priority 0-100 */
     int deadline_slot;              /* Deadline slot index, -1 if none */
     bool is_fixed;                  /* True if immutable (class, sleep) */
@@ -84,7 +136,7 @@ typedef struct {
 } Task;
 
 /**
- * TimeSlot structure - represents a 30-minute scheduling unit
+ * TimeSlot structure - represents one slot of the timeline
  * Requirements: 2.1
  */
 typedef struct {
@@ -94,17 +146,107 @@ typedef struct {
     bool is_fixed;                  /* True if slot is fixed/immutable */
 } TimeSlot;
 
+/**
+ * TaskPlacement structure - where a task started in a previous schedule
+ */
+typedef struct {
+    int task_id;                    /* Task ID */
+    int start_slot;                 /* First slot of the task's run */
+} TaskPlacement;
+
+/* Free-interval index over a Timeline's slots (see free_index_create) */
+typedef struct FreeIndex FreeIndex;
+
+/* Fixed slots shared by many requests (see fixed_template_create) */
+typedef struct FixedTemplate FixedTemplate;
+
+/**
+ * SolverStats structure - what the backtracking search did for a result.
+ * Counted only in builds with AESA_STATS defined (make STATS=1); zero
+ * otherwise, so the counting costs nothing in regular builds.
+ */
+typedef struct {
+    int64_t nodes;                  /* Search levels opened, across threads and components */
+    int64_t backtracks;             /* Placements undone */
+    int64_t candidates;             /* Candidate start slots generated */
+    int64_t pruned;                 /* Candidates skipped or rejected without descending */
+    int max_depth;                  /* Deepest level opened, 1 for the first task's */
+} SolverStats;
+
 /**
  * Timeline structure - represents the complete schedule
+ * The slots and occupancy words are sized to the horizon and allocated
+ * with the Timeline; copy a Timeline with timeline_clone(), not by value.
+ * A Timeline solved with SolverOptions.arena lives in that arena:
+ * timeline_free() leaves it alone and arena_reset() releases it.
  * Requirements: 2.1
  */
-typedef struct {
-    TimeSlot slots[MAX_SLOTS];      /* Array of time slots */
-    int num_slots;                  /* Number of active slots */
+typedef struct Timeline {
+    TimeSlot* slots;                /* num_slots time slots */
+    uint64_t* occupied;             /* num_words words; bit set if slot is taken, fixed or past num_slots */
+    int num_slots;                  /* Number of slots in the horizon */
+    int num_words;                  /* Words in occupied */
+    int slot_minutes;               /* Slot length: 15, 30 or 60 minutes */
+    int start_slot_of_day;          /* Slot of day that slot 0 falls on */
     bool success;                   /* True if valid schedule found */
+    bool budget_exhausted;          /* True if the search budget ran out */
+    int* unplaced_task_ids;         /* IDs of tasks left out of a partial schedule */
+    int num_unplaced;               /* Number of entries in unplaced_task_ids */
+    SolverEngine engine;            /* Engine that produced the result */
+    char strategy[MAX_STRATEGY_LEN]; /* Strategy that produced the result */
     char error_message[MAX_ERROR_LEN]; /* Error message if failed */
+    int moved_tasks;                /* Tasks placed away from their previous start, -1 if not incremental */
+    bool repaired;                  /* Incremental result kept every still-valid placement */
+    bool cache_hit;                 /* Answered from a result cache (cache.h) */
+    SolverObjective objective;      /* Objective the result was solved for */
+    int64_t objective_value;        /* Total energy score of the schedule, -1 if none or not optimizing */
+    int64_t objective_bound;        /* Proven upper bound on any schedule's total, -1 if unknown */
+    int64_t nodes;                  /* Search nodes expanded, 0 on a cache hit */
+    SolverStats stats;              /* Search counters, zero without AESA_STATS or on a cache hit */
+    Arena* arena;                   /* Arena holding the Timeline, NULL if on the heap */
+    FreeIndex* free_index;          /* Kept in step with occupied during greedy placement, else NULL */
+    struct Timeline** variants;     /* Results of a what-if request's variants (variants.h), else NULL */
+    int num_variants;               /* Number of entries in variants */
 } Timeline;
 
+/**
+ * EnergyTable structure - precomputed energy match scores
+ * score[type][preference][slot_of_day] replaces per-candidate period
+ * classification in the solver's inner loop (5.4 KB, stays in L1).
+ */
+typedef struct {
+    int slots_per_day;              /* Slots per day at the table's granularity */
+    int start_slot_of_day;          /* Slot of day that timeline slot 0 falls on */
+    uint8_t level[MAX_SLOTS_PER_DAY]; /* Energy level 1-10 per slot of day */
+    uint8_t score[TASK_TYPE_COUNT][ENERGY_PREFERENCE_COUNT][MAX_SLOTS_PER_DAY];
+} EnergyTable;
+
+/**
+ * SolverOptions structure - per-request tuning for optimize_schedule_ex
+ */
+typedef struct {
+    bool has_energy_curve;          /* True if energy_curve overrides the default */
+    uint8_t energy_curve[SLOTS_PER_DAY]; /* Per-user energy level 1-10 per half-hour of day */
+    int64_t max_nodes;              /* Search node budget, 0 for unlimited */
+    int64_t max_time_us;            /* Wall-clock budget in microseconds, 0 for unlimited */
+    bool forward_checking;          /* Prune on empty domains, pick most-constrained task next */
+    bool backjumping;               /* Conflict-directed backjumping */
+    int max_nogoods;                /* Learned nogood table size (needs backjumping), 0 to disable */
+    SolverEngine engine;            /* Which engine solves the request */
+    int64_t local_search_moves;     /* Local search move budget for the greedy engine */
+    uint64_t seed;                  /* Local search random seed */
+    uint32_t tie_break_seed;        /* Rotates equal-score candidates, 0 for ascending slots */
+    int threads;                    /* Portfolio worker threads, 0 or 1 to solve alone */
+    int search_threads;             /* Threads splitting one backtracking search, 0 or 1 for none */
+    SolverObjective objective;      /* Feasibility or branch-and-bound optimization */
+    bool weight_by_priority;        /* Objective weighs each task's score by its priority */
+    int num_days;                   /* Days in the horizon, 1 to MAX_DAYS */
+    int slot_minutes;               /* Slot length: 15, 30 or 60 minutes */
+    int start_slot_of_day;          /* Slot of the first day the horizon starts at */
+    const FixedTemplate* fixed_template; /* Fixed slots applied before the request's own, NULL for none */
+    Arena* arena;                   /* Memory for the solve and its result, NULL for the heap */
+} SolverOptions;
+
 /**
  * ScheduleInput structure - input for optimization
  */
@@ -146,13 +288,47 @@ Task* task_array_create(int count);
 void task_array_free(Task* tasks);
 
 /**
- * Allocate a new Timeline
+ * Allocate a new Timeline over the default horizon (DEFAULT_NUM_DAYS of
+ * DEFAULT_SLOT_MINUTES slots)
  * @return Pointer to allocated Timeline, NULL on failure
  */
 Timeline* timeline_create(void);
 
 /**
- * Free a Timeline
+ * Allocate a new Timeline sized to a horizon
+ * @param num_days Days in the horizon, 1 to MAX_DAYS
+ * @param slot_minutes Slot length: 15, 30 or 60
+ * @param start_slot_of_day Slot of the first day the horizon starts at, so
+ *                          the first day has only its remaining slots
+ * @return Pointer to allocated Timeline, NULL on failure or invalid horizon
+ */
+Timeline* timeline_create_horizon(int num_days, int slot_minutes, int start_slot_of_day);
+
+/**
+ * Allocate a deep copy of a Timeline, including its unplaced task IDs
+ * but not its variants
+ * @param timeline Timeline to copy
+ * @return Pointer to allocated Timeline, NULL on failure
+ */
+Timeline* timeline_clone(const Timeline* timeline);
+
+/**
+ * Copy a Timeline into an arena
+ * @param arena Arena holding the copy, NULL for the heap (as timeline_clone)
+ * @param timeline Timeline to copy
+ * @return Copy, NULL on failure
+ */
+Timeline* timeline_clone_in(Arena* arena, const Timeline* timeline);
+
+/**
+ * Number of slots in a horizon
+ * @return Slot count (1 to MAX_SLOTS), -1 if the horizon is invalid
+ */
+int horizon_num_slots(int num_days, int slot_minutes, int start_slot_of_day);
+
+/**
+ * Free a Timeline; a no-op for one held by an arena, whose variants are
+ * still freed
  * @param timeline Pointer to Timeline to free
  */
 void timeline_free(Timeline* timeline);
@@ -189,11 +365,160 @@ void task_init(Task* task);
 void timeslot_init(TimeSlot* slot, int index);
 
 /**
- * Initialize a Timeline with default values
+ * Initialize SolverOptions with defaults (built-in energy curve)
+ * @param options Pointer to SolverOptions to initialize
+ */
+void solver_options_init(SolverOptions* options);
+
+/**
+ * Read the portfolio thread count from the AESA_THREADS environment variable
+ * @return Threads (at most MAX_PORTFOLIO_THREADS), 0 if unset or invalid
+ */
+int solver_threads_from_environment(void);
+
+/**
+ * Largest task count a request may hold, for parsers and solvers alike:
+ * the AESA_MAX_TASKS environment variable (1 to MAX_TASK_CAPACITY), read
+ * once per process, or DEFAULT_MAX_TASKS if unset or invalid
+ * @return Task capacity
+ */
+int solver_task_capacity(void);
+
+/**
+ * Reset a Timeline's slots and result fields to default values over the
+ * horizon it was allocated with
+ * Does not release a previous unplaced_task_ids array.
  * @param timeline Pointer to Timeline to initialize
- * @param num_days Number of days (determines num_slots)
  */
-void timeline_init(Timeline* timeline, int num_days);
+void timeline_init(Timeline* timeline);
+
+/* ============================================================
+ * Occupancy Index Functions
+ * ============================================================ */
+
+/**
+ * Rebuild the occupancy bitmask from the slots array.
+ * Call after modifying timeline->slots directly.
+ * @param timeline Pointer to Timeline
+ */
+void timeline_rebuild_occupancy(Timeline* timeline);
+
+/**
+ * Check whether a run of slots is entirely free
+ * @param timeline Pointer to Timeline
+ * @param start First slot of the run
+ * @param length Number of slots in the run
+ * @return true if every slot in [start, start + length) is free
+ */
+bool timeline_is_range_free(const Timeline* timeline, int start, int length);
+
+/**
+ * Compute the set of feasible start slots for a run of given length
+ * Bit s of out is set if [s, s + length) is free and s + length <= limit.
+ * @param timeline Pointer to Timeline
+ * @param length Run length in slots (>= 1)
+ * @param limit Exclusive end bound for the run (deadline or num_slots)
+ * @param out Output bitmask; its first timeline->num_words words are written
+ * @return Number of feasible start slots
+ */
+int timeline_free_starts(
+    const Timeline* timeline,
+    int length,
+    int limit,
+    uint64_t out[SLOT_WORDS]
+);
+
+/* ============================================================
+ * Free-Interval Index Functions
+ * 
+ * A segment tree over the slots of a Timeline that stores, per node,
+ * the free run at each end of its range and the longest free run inside
+ * it. The greedy engine attaches one to its Timeline while it places
+ * tasks; placements then update it in O(length + log n) and best-slot
+ * searches jump between free runs that fit instead of scanning every
+ * start slot.
+ * ============================================================ */
+
+/**
+ * Build a free-interval index from a Timeline's occupancy bitmask
+ * @param arena Arena holding the index, NULL for the heap
+ * @param timeline Timeline to index
+ * @return Index, NULL on allocation failure
+ */
+FreeIndex* free_index_create(Arena* arena, const Timeline* timeline);
+
+/**
+ * Free an index made by free_index_create
+ * @param index Index to free, may be NULL
+ */
+void free_index_free(FreeIndex* index);
+
+/**
+ * Re-read a run of slots from the occupancy bitmask after it changed
+ * @param index Index of timeline
+ * @param timeline Timeline whose occupied bits changed
+ * @param start First changed slot
+ * @param length Number of changed slots
+ */
+void free_index_update(FreeIndex* index, const Timeline* timeline, int start, int length);
+
+/**
+ * Find the earliest free run of a given length inside a window
+ * @param index Index to search
+ * @param length Run length in slots (>= 1)
+ * @param from First start slot to consider
+ * @param limit Exclusive end bound for the run (deadline or num_slots)
+ * @return Start s >= from with [s, s + length) free and s + length <= limit,
+ *         -1 if there is none; O(log n)
+ */
+int free_index_first_fit(const FreeIndex* index, int length, int from, int limit);
+
+/* ============================================================
+ * Fixed-Slot Templates
+ * ============================================================ */
+
+/**
+ * Build a template from fixed slots shared by many requests, such as the
+ * timetable of a university section. The slots are applied once to a
+ * prototype Timeline; a request naming the template in
+ * SolverOptions.fixed_template starts from a copy of the prototype and
+ * applies only its own fixed slots on top (last entry per slot wins).
+ * A template is immutable and may be shared by concurrent solves.
+ * @param fixed_slots Slots of the template; out-of-range slots are dropped
+ * @param num_fixed Number of fixed slots
+ * @param options Horizon of the template (num_days, slot_minutes,
+ *                start_slot_of_day), NULL for the default horizon
+ * @return Template (free with fixed_template_free), NULL if the horizon is
+ *         invalid or on allocation failure
+ */
+FixedTemplate* fixed_template_create(const TimeSlot* fixed_slots, int num_fixed,
+                                     const SolverOptions* options);
+
+/**
+ * Free a template
+ * @param tmpl Template to free, may be NULL
+ */
+void fixed_template_free(FixedTemplate* tmpl);
+
+/**
+ * Fixed slots of a template, deduplicated and in slot order
+ * @param num_fixed Output: number of slots
+ */
+const TimeSlot* fixed_template_slots(const FixedTemplate* tmpl, int* num_fixed);
+
+/**
+ * Whether a request's horizon is the one the template was built for;
+ * solves with any other horizon fail with an error
+ */
+bool fixed_template_fits(const FixedTemplate* tmpl, const SolverOptions* options);
+
+/**
+ * Copy of the template's prototype Timeline, reported as a successful
+ * schedule with no tasks
+ * @param arena Arena holding the copy, NULL for the heap
+ * @return Timeline, NULL on allocation failure
+ */
+Timeline* fixed_template_timeline(const FixedTemplate* tmpl, Arena* arena);
 
 /* ============================================================
  * Core Scheduling Functions (implemented in scheduler.c)
@@ -216,6 +541,107 @@ Timeline* optimize_schedule(
     int num_fixed
 );
 
+/**
+ * Optimization with per-request options
+ * 
+ * When no complete schedule is found (budget exhausted or no solution),
+ * the returned Timeline holds the deepest partial assignment reached,
+ * topped up greedily, with success = false and the left-out tasks in
+ * unplaced_task_ids. The backtracking and auto engines first compare
+ * demand to free capacity at every deadline; a request failing that is
+ * answered with NO_SOLUTION without searching. Tasks that can never
+ * share a free run are searched as separate components, drawing on one
+ * max_nodes budget between them.
+ * 
+ * With options->fixed_template set, the template's slots are applied
+ * first and fixed_slots on top of them.
+ * 
+ * With OBJECTIVE_MAXIMIZE_ENERGY_FIT the search does not stop at the
+ * first schedule: it keeps the best one found (objective_value) and
+ * prunes subtrees whose admissible bound cannot beat it. objective_bound
+ * equals objective_value once the search proves optimality; when a
+ * budget runs out it is the best bound left among the unexplored
+ * subtrees. Backjumping, nogoods and both thread counts are ignored in
+ * this mode.
+ * 
+ * @param tasks Array of tasks to schedule
+ * @param num_tasks Number of tasks
+ * @param fixed_slots Array of pre-fixed slots
+ * @param num_fixed Number of fixed slots
+ * @param options Solver options, NULL for defaults
+ * @return Optimized Timeline, caller must free with timeline_free()
+ */
+Timeline* optimize_schedule_ex(
+    Task* tasks,
+    int num_tasks,
+    TimeSlot* fixed_slots,
+    int num_fixed,
+    const SolverOptions* options
+);
+
+/**
+ * Incremental re-optimization after an edit to a previous schedule
+ * 
+ * tasks and fixed_slots describe the schedule after the edit. Tasks whose
+ * previous placement still fits (same task ID, within its deadline, clear
+ * of fixed slots and of higher-priority pinned tasks) keep it; only added,
+ * changed and displaced tasks are solved, around the pinned ones. If that
+ * repair leaves tasks unplaced, the whole schedule is solved again with the
+ * remaining time budget, and the more complete result is returned.
+ * Sets moved_tasks and repaired on the returned Timeline.
+ * 
+ * @param tasks Array of tasks to schedule
+ * @param num_tasks Number of tasks
+ * @param fixed_slots Array of pre-fixed slots
+ * @param num_fixed Number of fixed slots
+ * @param previous Start slots from the previous schedule; unknown task IDs
+ *                 are ignored, the first entry of a repeated ID is used
+ * @param num_previous Number of entries in previous
+ * @param options Solver options, NULL for defaults
+ * @return Optimized Timeline, caller must free with timeline_free()
+ */
+Timeline* optimize_schedule_incremental(
+    Task* tasks,
+    int num_tasks,
+    TimeSlot* fixed_slots,
+    int num_fixed,
+    const TaskPlacement* previous,
+    int num_previous,
+    const SolverOptions* options
+);
+
+/* ============================================================
+ * Energy Score Table
+ * ============================================================ */
+
+/**
+ * Build the energy score table for an energy curve
+ * @param table Pointer to EnergyTable to fill
+ * @param curve Energy level (1-10) per slot of day, NULL for the default curve
+ */
+void energy_table_build(EnergyTable* table, const uint8_t* curve);
+
+/**
+ * Build the energy score table for an energy curve on a horizon's slots
+ * A 15-minute slot takes the level of its half-hour, a 60-minute slot the
+ * rounded mean of its two half-hours.
+ * @param table Pointer to EnergyTable to fill
+ * @param curve Energy level (1-10) per half-hour of day, NULL for the default curve
+ * @param slot_minutes Slot length: 15, 30 or 60
+ * @param start_slot_of_day Slot of day that timeline slot 0 falls on
+ */
+void energy_table_build_ex(EnergyTable* table, const uint8_t* curve,
+                           int slot_minutes, int start_slot_of_day);
+
+/**
+ * Look up the energy match score for placing a task at a slot
+ * @param table Energy table built with energy_table_build() or energy_table_build_ex()
+ * @param task Task being placed
+ * @param slot_index Start slot in timeline
+ * @return Score 0..MAX_ENERGY_SCORE, higher is a better match
+ */
+int calculate_energy_score(const EnergyTable* table, const Task* task, int slot_index);
+
 /* ============================================================
  * Utility Functions
  * ============================================================ */
@@ -234,6 +660,34 @@ const char* task_type_to_string(TaskType type);
  */
 int task_type_from_string(const char* str);
 
+/**
+ * Get string name for a SolverEngine
+ * @param engine SolverEngine enum value
+ * @return String representation
+ */
+const char* solver_engine_to_string(SolverEngine engine);
+
+/**
+ * Parse SolverEngine from string
+ * @param str String to parse ("backtrack", "greedy" or "auto")
+ * @return SolverEngine enum value, or -1 if invalid
+ */
+int solver_engine_from_string(const char* str);
+
+/**
+ * Get string name for a SolverObjective
+ * @param objective SolverObjective enum value
+ * @return String representation
+ */
+const char* solver_objective_to_string(SolverObjective objective);
+
+/**
+ * Parse SolverObjective from string
+ * @param str String to parse ("feasible" or "maximize_energy_fit")
+ * @return SolverObjective enum value, or -1 if invalid
+ */
+int solver_objective_from_string(const char* str);
+
 /**
  * Get energy level for a given slot index
  * Based on time of day heuristics
@@ -0,0 +1,155 @@
+/**
+ * AESA Core Scheduling Engine - Fixed-Slot Template Registry Implementation
+ */
+
+#include "templates.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_TEMPLATES 16        /* First entry array, doubled as it fills */
+
+typedef struct {
+    char name[MAX_TEMPLATE_NAME_LEN];
+    size_t length;
+    FixedTemplate* tmpl;
+} TemplateEntry;
+
+/* Entries sorted by name, so lookups bisect */
+struct TemplateRegistry {
+    TemplateEntry* entries;
+    size_t count;
+    size_t capacity;
+};
+
+TemplateRegistry* template_registry_create(void) {
+    return (TemplateRegistry*)calloc(1, sizeof(TemplateRegistry));
+}
+
+void template_registry_free(TemplateRegistry* registry) {
+    if (registry == NULL) return;
+    for (size_t i = 0; i < registry->count; i++) {
+        fixed_template_free(registry->entries[i].tmpl);
+    }
+    free(registry->entries);
+    free(registry);
+}
+
+size_t template_registry_count(const TemplateRegistry* registry) {
+    return registry != NULL ? registry->count : 0;
+}
+
+static int compare_name(const TemplateEntry* entry, const char* name, size_t length) {
+    size_t common = entry->length < length ? entry->length : length;
+    int c = memcmp(entry->name, name, common);
+    if (c != 0) return c;
+    return (entry->length > length) - (entry->length < length);
+}
+
+/**
+ * Position of name in the sorted entries
+ * @param found Output: whether the entry at the position has the name
+ * @return Index of the entry, or where it would be inserted
+ */
+static size_t find_position(const TemplateRegistry* registry, const char* name,
+                            size_t length, bool* found) {
+    size_t lo = 0;
+    size_t hi = registry->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (compare_name(&registry->entries[mid], name, length) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = lo < registry->count &&
+             compare_name(&registry->entries[lo], name, length) == 0;
+    return lo;
+}
+
+const FixedTemplate* template_registry_find(const TemplateRegistry* registry,
+                                            const char* name, size_t length) {
+    if (registry == NULL || name == NULL) return NULL;
+    bool found;
+    size_t index = find_position(registry, name, length, &found);
+    return found ? registry->entries[index].tmpl : NULL;
+}
+
+/**
+ * Insert or replace the template of a name, taking ownership of tmpl
+ * @return Error message, NULL on success (tmpl is freed on failure)
+ */
+static const char* registry_put(TemplateRegistry* registry, const char* name,
+                                size_t length, FixedTemplate* tmpl) {
+    bool found;
+    size_t index = find_position(registry, name, length, &found);
+    if (found) {
+        fixed_template_free(registry->entries[index].tmpl);
+        registry->entries[index].tmpl = tmpl;
+        return NULL;
+    }
+
+    if (registry->count == MAX_TEMPLATES) {
+        fixed_template_free(tmpl);
+        return "Too many templates";
+    }
+    if (registry->count == registry->capacity) {
+        size_t capacity = registry->capacity > 0 ? registry->capacity * 2 : INITIAL_TEMPLATES;
+        TemplateEntry* grown = (TemplateEntry*)realloc(registry->entries,
+                                                       sizeof(TemplateEntry) * capacity);
+        if (grown == NULL) {
+            fixed_template_free(tmpl);
+            return "Memory allocation failed";
+        }
+        registry->entries = grown;
+        registry->capacity = capacity;
+    }
+
+    TemplateEntry* entry = &registry->entries[index];
+    memmove(entry + 1, entry, sizeof(TemplateEntry) * (registry->count - index));
+    memcpy(entry->name, name, length);
+    entry->name[length] = '\0';
+    entry->length = length;
+    entry->tmpl = tmpl;
+    registry->count++;
+    return NULL;
+}
+
+Timeline* template_registry_register(
+    TemplateRegistry* registry,
+    const char* name,
+    size_t length,
+    int num_tasks,
+    const TimeSlot* fixed_slots,
+    int num_fixed,
+    const SolverOptions* options,
+    const char** error
+) {
+    if (registry == NULL) {
+        *error = "Templates cannot be registered in this mode";
+        return NULL;
+    }
+    if (name == NULL || length == 0 || length >= MAX_TEMPLATE_NAME_LEN) {
+        *error = "Invalid template name";
+        return NULL;
+    }
+    if (num_tasks > 0) {
+        *error = "A template registration holds no tasks";
+        return NULL;
+    }
+
+    FixedTemplate* tmpl = fixed_template_create(fixed_slots, num_fixed, options);
+    if (tmpl == NULL) {
+        *error = "Memory allocation failed";
+        return NULL;
+    }
+    const char* failure = registry_put(registry, name, length, tmpl);
+    if (failure != NULL) {
+        *error = failure;
+        return NULL;
+    }
+
+    Timeline* timeline = fixed_template_timeline(tmpl, options->arena);
+    if (timeline == NULL) *error = "Memory allocation failed";
+    return timeline;
+}
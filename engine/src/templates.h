@@ -0,0 +1,82 @@
+/**
+ * AESA Core Scheduling Engine - Fixed-Slot Template Registry
+ *
+ * Named fixed-slot templates (FixedTemplate, scheduler.h) of serve mode,
+ * batch mode and library contexts. Students of one section share a
+ * timetable, so it is registered once under a name and later requests
+ * name it ("fixed_template" in JSON, the template section of wire.h)
+ * instead of resending its fixed slots; their own fixed slots are applied
+ * on top. Registering a name again replaces its template. Cached results
+ * are keyed by the template's slots, not its name, so a replaced
+ * template never answers from results of the old one.
+ *
+ * Registration needs exclusive access; lookups may run concurrently once
+ * registration has stopped (batch mode loads its templates before the
+ * workers start).
+ */
+
+#ifndef TEMPLATES_H
+#define TEMPLATES_H
+
+#include "scheduler.h"
+#include <stddef.h>
+
+#define MAX_TEMPLATE_NAME_LEN 64    /* Longest name, including the terminator */
+#define MAX_TEMPLATES 65536         /* Names a registry holds */
+
+typedef struct TemplateRegistry TemplateRegistry;
+
+/**
+ * Create an empty registry
+ * @return Registry (free with template_registry_free), NULL on allocation failure
+ */
+TemplateRegistry* template_registry_create(void);
+
+/**
+ * Free a registry and its templates
+ * @param registry Registry to free, may be NULL
+ */
+void template_registry_free(TemplateRegistry* registry);
+
+/**
+ * Number of templates in a registry
+ * @param registry Registry, NULL reads as empty
+ */
+size_t template_registry_count(const TemplateRegistry* registry);
+
+/**
+ * Find a template by name; O(log n)
+ * @param registry Registry, NULL reads as empty
+ * @param name Name bytes, not necessarily NUL-terminated
+ * @param length Length of name
+ * @return Template, NULL if the name is not registered
+ */
+const FixedTemplate* template_registry_find(const TemplateRegistry* registry,
+                                            const char* name, size_t length);
+
+/**
+ * Build a template from a parsed registration request and register it
+ * @param registry Registry, NULL where registration is not allowed (batch
+ *                 workers), which fails with an error
+ * @param name Name bytes, 1 to MAX_TEMPLATE_NAME_LEN - 1 of them
+ * @param length Length of name
+ * @param num_tasks Tasks of the request; a registration must have none
+ * @param fixed_slots Slots of the template
+ * @param num_fixed Number of fixed slots
+ * @param options Request options, giving the template's horizon
+ * @param error Output: message when NULL is returned
+ * @return Copy of the template's prototype Timeline in options->arena, as
+ *         the response to the registration, NULL on failure
+ */
+Timeline* template_registry_register(
+    TemplateRegistry* registry,
+    const char* name,
+    size_t length,
+    int num_tasks,
+    const TimeSlot* fixed_slots,
+    int num_fixed,
+    const SolverOptions* options,
+    const char** error
+);
+
+#endif /* TEMPLATES_H */
@@ -0,0 +1,290 @@
+/**
+ * AESA Core Scheduling Engine - What-If Variants Implementation
+ */
+
+#define _POSIX_C_SOURCE 200809L    /* sysconf */
+
+#include "variants.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+void request_variants_free(RequestVariant* variants, int num_variants, Arena* arena) {
+    if (variants == NULL) return;
+    for (int i = 0; i < num_variants; i++) {
+        arena_free(arena, variants[i].removed_tasks);
+        arena_free(arena, variants[i].tasks);
+        arena_free(arena, variants[i].fixed_slots);
+        arena_free(arena, variants[i].released_slots);
+    }
+    arena_free(arena, variants);
+}
+
+/* Shared by the threads solving one request's variants */
+typedef struct {
+    const Task* tasks;              /* Base tasks */
+    int num_tasks;
+    const FixedTemplate* base;      /* Base fixed slots, the template of every variant */
+    const TaskPlacement* placements; /* Base schedule, the warm start of every variant */
+    int num_placements;
+    const RequestVariant* variants;
+    int num_variants;
+    SolverOptions options;          /* Base options on the heap, over the base template */
+    Timeline** results;             /* One per variant, in request order */
+    int next;                       /* First variant no thread has claimed */
+    pthread_mutex_t lock;
+} VariantJob;
+
+static int int_compare(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static bool sorted_contains(const int* sorted, int count, int value) {
+    return count > 0 && bsearch(&value, sorted, (size_t)count, sizeof(int), int_compare) != NULL;
+}
+
+/**
+ * Sorted copy of two integer lists
+ * @return Array (caller must free), NULL on allocation failure
+ */
+static int* sorted_union(const int* a, int num_a, const int* b, int num_b) {
+    int* sorted = (int*)malloc(sizeof(int) * (size_t)(num_a + num_b + 1));
+    if (sorted == NULL) return NULL;
+    if (num_a > 0) memcpy(sorted, a, sizeof(int) * (size_t)num_a);
+    if (num_b > 0) memcpy(sorted + num_a, b, sizeof(int) * (size_t)num_b);
+    qsort(sorted, (size_t)(num_a + num_b), sizeof(int), int_compare);
+    return sorted;
+}
+
+static Timeline* variant_error(const SolverOptions* options, const char* message) {
+    Timeline* timeline = timeline_create_horizon(options->num_days, options->slot_minutes,
+                                                 options->start_slot_of_day);
+    if (timeline != NULL) {
+        timeline->success = false;
+        snprintf(timeline->error_message, MAX_ERROR_LEN, "%s", message);
+    }
+    return timeline;
+}
+
+/**
+ * Apply a variant to the base problem and solve it
+ * @return Timeline on the heap, NULL only if not even an error fits in memory
+ */
+static Timeline* solve_variant(const VariantJob* job, const RequestVariant* variant) {
+    /* Base tasks the variant removes or replaces are left out */
+    int* ids = (int*)malloc(sizeof(int) * (size_t)(variant->num_tasks + 1));
+    Task* tasks = (Task*)malloc(sizeof(Task) * (size_t)(job->num_tasks + variant->num_tasks + 1));
+    int* excluded = NULL;
+    if (ids != NULL) {
+        for (int i = 0; i < variant->num_tasks; i++) ids[i] = variant->tasks[i].id;
+        excluded = sorted_union(variant->removed_tasks, variant->num_removed_tasks,
+                                ids, variant->num_tasks);
+    }
+    free(ids);
+    if (tasks == NULL || excluded == NULL) {
+        free(tasks);
+        free(excluded);
+        return variant_error(&job->options, "Memory allocation failed");
+    }
+
+    int num_excluded = variant->num_removed_tasks + variant->num_tasks;
+    int num_tasks = 0;
+    for (int i = 0; i < job->num_tasks; i++) {
+        if (!sorted_contains(excluded, num_excluded, job->tasks[i].id)) {
+            tasks[num_tasks++] = job->tasks[i];
+        }
+    }
+    if (variant->num_tasks > 0) {
+        memcpy(tasks + num_tasks, variant->tasks, sizeof(Task) * (size_t)variant->num_tasks);
+        num_tasks += variant->num_tasks;
+    }
+    free(excluded);
+
+    /* Released slots have to leave the template, so such a variant
+     * applies the rest of the base's fixed slots itself */
+    SolverOptions options = job->options;
+    TimeSlot* fixed_slots = variant->fixed_slots;
+    int num_fixed = variant->num_fixed;
+    TimeSlot* kept = NULL;
+    if (variant->num_released_slots > 0) {
+        int num_base = 0;
+        const TimeSlot* base = fixed_template_slots(job->base, &num_base);
+        int* released = sorted_union(variant->released_slots, variant->num_released_slots,
+                                     NULL, 0);
+        kept = (TimeSlot*)malloc(sizeof(TimeSlot) * (size_t)(num_base + num_fixed + 1));
+        if (released == NULL || kept == NULL) {
+            free(released);
+            free(kept);
+            free(tasks);
+            return variant_error(&job->options, "Memory allocation failed");
+        }
+        int count = 0;
+        for (int i = 0; i < num_base; i++) {
+            if (!sorted_contains(released, variant->num_released_slots, base[i].slot_index)) {
+                kept[count++] = base[i];
+            }
+        }
+        if (num_fixed > 0) {
+            memcpy(kept + count, fixed_slots, sizeof(TimeSlot) * (size_t)num_fixed);
+        }
+        free(released);
+        fixed_slots = kept;
+        num_fixed += count;
+        options.fixed_template = NULL;
+    }
+
+    Timeline* timeline = job->num_placements > 0
+        ? optimize_schedule_incremental(tasks, num_tasks, fixed_slots, num_fixed,
+                                        job->placements, job->num_placements, &options)
+        : optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed, &options);
+    free(kept);
+    free(tasks);
+    return timeline != NULL ? timeline : variant_error(&job->options, "Optimization failed");
+}
+
+static void* variant_worker(void* arg) {
+    VariantJob* job = (VariantJob*)arg;
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        int index = job->next < job->num_variants ? job->next++ : -1;
+        pthread_mutex_unlock(&job->lock);
+        if (index < 0) return NULL;
+        job->results[index] = solve_variant(job, &job->variants[index]);
+    }
+}
+
+/**
+ * Start slot of every task a schedule placed, in slot order
+ * @param placements Output: room for timeline->num_slots entries
+ * @return Number of placements
+ */
+static int schedule_placements(const Timeline* timeline, TaskPlacement* placements) {
+    int count = 0;
+    for (int i = 0; i < timeline->num_slots; i++) {
+        const TimeSlot* slot = &timeline->slots[i];
+        if (slot->is_fixed || slot->task_id < 0) continue;
+        const TimeSlot* before = i > 0 ? &timeline->slots[i - 1] : NULL;
+        if (before != NULL && !before->is_fixed && before->task_id == slot->task_id) continue;
+        placements[count].task_id = slot->task_id;
+        placements[count].start_slot = i;
+        count++;
+    }
+    return count;
+}
+
+static int variant_thread_count(int threads, int num_variants) {
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)(online < MAX_VARIANT_THREADS ? online : MAX_VARIANT_THREADS) : 1;
+    }
+    if (threads > MAX_VARIANT_THREADS) threads = MAX_VARIANT_THREADS;
+    return threads < num_variants ? threads : num_variants;
+}
+
+Timeline* optimize_variants(
+    Task* tasks,
+    int num_tasks,
+    TimeSlot* fixed_slots,
+    int num_fixed,
+    const TaskPlacement* previous,
+    int num_previous,
+    const RequestVariant* variants,
+    int num_variants,
+    const SolverOptions* options,
+    int threads
+) {
+    SolverOptions defaults;
+    if (options == NULL) {
+        solver_options_init(&defaults);
+        options = &defaults;
+    }
+    if (variants == NULL || num_variants < 1 || num_variants > MAX_VARIANTS) return NULL;
+
+    /* A request the solver refuses gets its error, without variants */
+    if (horizon_num_slots(options->num_days, options->slot_minutes,
+                          options->start_slot_of_day) < 0 ||
+        (options->fixed_template != NULL &&
+         !fixed_template_fits(options->fixed_template, options))) {
+        return optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed, options);
+    }
+
+    /* The base's fixed slots, over the template it names, are applied once */
+    int num_inherited = 0;
+    const TimeSlot* inherited = options->fixed_template != NULL
+        ? fixed_template_slots(options->fixed_template, &num_inherited)
+        : NULL;
+    if (fixed_slots == NULL) num_fixed = 0;
+    TimeSlot* base_slots = (TimeSlot*)malloc(sizeof(TimeSlot) *
+                                             (size_t)(num_inherited + num_fixed + 1));
+    if (base_slots == NULL) return NULL;
+    if (num_inherited > 0) memcpy(base_slots, inherited, sizeof(TimeSlot) * (size_t)num_inherited);
+    if (num_fixed > 0) memcpy(base_slots + num_inherited, fixed_slots, sizeof(TimeSlot) * (size_t)num_fixed);
+    FixedTemplate* base = fixed_template_create(base_slots, num_inherited + num_fixed, options);
+    free(base_slots);
+    if (base == NULL) return NULL;
+
+    SolverOptions base_options = *options;
+    base_options.fixed_template = base;
+    Timeline* timeline = previous != NULL && num_previous > 0
+        ? optimize_schedule_incremental(tasks, num_tasks, NULL, 0, previous, num_previous,
+                                        &base_options)
+        : optimize_schedule_ex(tasks, num_tasks, NULL, 0, &base_options);
+    Timeline** results = timeline != NULL
+        ? (Timeline**)arena_alloc(timeline->arena, sizeof(Timeline*) * (size_t)num_variants)
+        : NULL;
+    TaskPlacement* placements = timeline != NULL
+        ? (TaskPlacement*)malloc(sizeof(TaskPlacement) * (size_t)timeline->num_slots)
+        : NULL;
+    if (results == NULL || placements == NULL) {
+        if (timeline != NULL) arena_free(timeline->arena, results);
+        free(placements);
+        timeline_free(timeline);
+        fixed_template_free(base);
+        return NULL;
+    }
+    memset(results, 0, sizeof(Timeline*) * (size_t)num_variants);
+
+    VariantJob job;
+    job.tasks = tasks;
+    job.num_tasks = tasks != NULL && num_tasks > 0 ? num_tasks : 0;
+    job.base = base;
+    job.placements = placements;
+    job.num_placements = schedule_placements(timeline, placements);
+    job.variants = variants;
+    job.num_variants = num_variants;
+    job.options = base_options;
+    job.options.arena = NULL;
+    job.results = results;
+    job.next = 0;
+    pthread_mutex_init(&job.lock, NULL);
+
+    /* The calling thread solves variants as well */
+    pthread_t workers[MAX_VARIANT_THREADS];
+    int started = 0;
+    int wanted = variant_thread_count(threads, num_variants);
+    while (started + 1 < wanted &&
+           pthread_create(&workers[started], NULL, variant_worker, &job) == 0) {
+        started++;
+    }
+    variant_worker(&job);
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    pthread_mutex_destroy(&job.lock);
+    free(placements);
+    fixed_template_free(base);
+
+    timeline->variants = results;
+    timeline->num_variants = num_variants;
+    for (int i = 0; i < num_variants; i++) {
+        if (results[i] == NULL) {
+            timeline_free(timeline);
+            return NULL;
+        }
+    }
+    return timeline;
+}
@@ -0,0 +1,81 @@
+/**
+ * AESA Core Scheduling Engine - What-If Variants
+ *
+ * A what-if request carries one base problem and up to MAX_VARIANTS small
+ * edits of it ("variants" in JSON): tasks removed, tasks added or changed,
+ * fixed slots added or released. The base's fixed slots are applied once,
+ * into a FixedTemplate (scheduler.h) every variant starts from, and the
+ * base is solved once. Each variant is then solved incrementally from
+ * the base schedule, so tasks its edit does not touch keep their place
+ * and moved_tasks counts the ones that do move. Variants are solved in
+ * parallel and returned in request order, in the base Timeline's
+ * variants array; a variant that fails does not affect the others.
+ */
+
+#ifndef VARIANTS_H
+#define VARIANTS_H
+
+#include "scheduler.h"
+
+#define MAX_VARIANTS 256            /* Variants a request holds */
+#define MAX_VARIANT_THREADS 16      /* Threads solving one request's variants */
+
+/**
+ * One edit of the base problem
+ */
+typedef struct {
+    int* removed_tasks;             /* IDs of base tasks left out */
+    int num_removed_tasks;
+    Task* tasks;                    /* Tasks added, or replacing the base task with their ID */
+    int num_tasks;
+    TimeSlot* fixed_slots;          /* Fixed slots applied on top of the base's */
+    int num_fixed;
+    int* released_slots;            /* Slot indices of base fixed slots made free */
+    int num_released_slots;
+} RequestVariant;
+
+/**
+ * Free the arrays of parsed variants, then the variant array
+ * @param variants Variants, may be NULL
+ * @param num_variants Number of variants
+ * @param arena Arena holding them, NULL for the heap
+ */
+void request_variants_free(RequestVariant* variants, int num_variants, Arena* arena);
+
+/**
+ * Solve a base request and each of its variants
+ *
+ * The base is solved into options->arena, incrementally if previous is
+ * given; options->fixed_template applies beneath fixed_slots as usual.
+ * Every variant is solved on the heap with the same options, from the
+ * base schedule's placements, or from scratch if the base placed
+ * nothing. Search budgets apply to each solve.
+ *
+ * @param tasks Base tasks
+ * @param num_tasks Number of base tasks
+ * @param fixed_slots Base fixed slots
+ * @param num_fixed Number of base fixed slots
+ * @param previous Placements to re-optimize the base from, NULL for none
+ * @param num_previous Number of entries in previous
+ * @param variants Edits of the base, 1 to MAX_VARIANTS of them
+ * @param num_variants Number of variants
+ * @param options Solver options of the base and the variants
+ * @param threads Threads solving variants, 0 for one per CPU (at most
+ *                MAX_VARIANT_THREADS, and never more than variants)
+ * @return Base Timeline with variants set (caller must timeline_free),
+ *         NULL on allocation failure
+ */
+Timeline* optimize_variants(
+    Task* tasks,
+    int num_tasks,
+    TimeSlot* fixed_slots,
+    int num_fixed,
+    const TaskPlacement* previous,
+    int num_previous,
+    const RequestVariant* variants,
+    int num_variants,
+    const SolverOptions* options,
+    int threads
+);
+
+#endif /* VARIANTS_H */
@@ -0,0 +1,439 @@
+/**
+ * AESA Core Scheduling Engine - Binary Wire Format Implementation
+ */
+
+#include "wire.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================
+ * Little-Endian Field Access
+ * ============================================================ */
+
+static uint16_t get_u16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const unsigned char* p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+static int32_t get_i32(const unsigned char* p) {
+    return (int32_t)get_u32(p);
+}
+
+static int64_t get_i64(const unsigned char* p) {
+    return (int64_t)get_u64(p);
+}
+
+static void put_u16(unsigned char* p, uint16_t value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+}
+
+static void put_u32(unsigned char* p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static void put_i32(unsigned char* p, int32_t value) {
+    put_u32(p, (uint32_t)value);
+}
+
+static void put_i64(unsigned char* p, int64_t value) {
+    put_u32(p, (uint32_t)(uint64_t)value);
+    put_u32(p + 4, (uint32_t)((uint64_t)value >> 32));
+}
+
+
+/* ============================================================
+ * Requests
+ * ============================================================ */
+
+uint32_t wire_request_size(const char* prefix) {
+    const unsigned char* p = (const unsigned char*)prefix;
+    if (memcmp(p, WIRE_REQUEST_MAGIC, 4) != 0 || get_u16(p + 4) != WIRE_VERSION) {
+        return 0;
+    }
+    return get_u32(p + 8);
+}
+
+static int decode_options(const unsigned char* header, SolverOptions* options) {
+    uint16_t flags = get_u16(header + 6);
+
+    solver_options_init(options);
+    options->forward_checking = (flags & WIRE_FORWARD_CHECKING) != 0;
+    options->backjumping = (flags & WIRE_BACKJUMPING) != 0;
+
+    options->max_nodes = get_i64(header + 24);
+    options->max_time_us = get_i64(header + 32);
+    if (options->max_nodes < 0 || options->max_time_us < 0) return -1;
+
+    if (flags & WIRE_LOCAL_SEARCH) {
+        options->local_search_moves = get_i64(header + 40);
+        if (options->local_search_moves < 0) return -1;
+    }
+    if (flags & WIRE_SEED) {
+        options->seed = get_u64(header + 48);
+    }
+    options->tie_break_seed = get_u32(header + 56);
+
+    uint32_t max_nogoods = get_u32(header + 60);
+    if (max_nogoods > MAX_NOGOODS) return -1;
+    options->max_nogoods = (int)max_nogoods;
+
+    if (header[64] >= ENGINE_COUNT) return -1;
+    options->engine = (SolverEngine)header[64];
+    if (header[65] > MAX_PORTFOLIO_THREADS || header[66] > MAX_PORTFOLIO_THREADS) return -1;
+    options->threads = header[65];
+    options->search_threads = header[66];
+
+    if (flags & WIRE_ENERGY_CURVE) {
+        for (int i = 0; i < SLOTS_PER_DAY; i++) {
+            uint8_t level = header[72 + i];
+            if (level < ENERGY_LEVEL_MIN || level > ENERGY_LEVEL_MAX) return -1;
+            options->energy_curve[i] = level;
+        }
+        options->has_energy_curve = true;
+    }
+
+    /* Zero horizon fields keep the defaults */
+    if (header[124] != 0) options->num_days = header[124];
+    if (header[125] != 0) options->slot_minutes = header[125];
+    options->start_slot_of_day = header[126];
+    if (horizon_num_slots(options->num_days, options->slot_minutes,
+                          options->start_slot_of_day) < 0) {
+        return -1;
+    }
+
+    if (header[127] >= OBJECTIVE_COUNT) return -1;
+    options->objective = (SolverObjective)header[127];
+    options->weight_by_priority = (flags & WIRE_PRIORITY_WEIGHTS) != 0;
+    return 0;
+}
+
+static int decode_task(const unsigned char* record, const unsigned char* strings,
+                       uint32_t strings_size, Task* task) {
+    task_init(task);
+    task->id = get_i32(record);
+    task->duration_slots = get_i32(record + 4);
+    task->priority = get_i32(record + 8);
+    task->deadline_slot = get_i32(record + 12);
+
+    uint32_t name_offset = get_u32(record + 16);
+    uint32_t name_length = get_u16(record + 20);
+    if (name_offset > strings_size || name_length > strings_size - name_offset) return -1;
+    if (name_length > MAX_NAME_LEN - 1) name_length = MAX_NAME_LEN - 1;
+    memcpy(task->name, strings + name_offset, name_length);
+    task->name[name_length] = '\0';
+
+    if (record[22] >= TASK_TYPE_COUNT) return -1;
+    task->type = (TaskType)record[22];
+    /* Out-of-range preferences score as ENERGY_ANY, as they do from JSON */
+    task->preferred_energy = (PreferredEnergy)record[23];
+    task->is_fixed = record[24] != 0;
+    return 0;
+}
+
+int wire_parse_request(
+    const char* data,
+    size_t size,
+    Task** tasks,
+    int* num_tasks,
+    TimeSlot** fixed_slots,
+    int* num_fixed,
+    TaskPlacement** previous,
+    int* num_previous,
+    SolverOptions* options,
+    WireRequestInfo* info,
+    const char** error,
+    Arena* arena
+) {
+    *tasks = NULL;
+    *num_tasks = 0;
+    *fixed_slots = NULL;
+    *num_fixed = 0;
+    *previous = NULL;
+    *num_previous = 0;
+    info->request_id = 0;
+    info->runs = false;
+    info->template_name = NULL;
+    info->template_length = 0;
+    info->register_template = false;
+
+    const unsigned char* header = (const unsigned char*)data;
+    if (size < WIRE_REQUEST_HEADER_SIZE || wire_request_size(data) != size) {
+        *error = "Malformed binary request header";
+        return -1;
+    }
+    info->request_id = get_u32(header + 68);
+    info->runs = header[67] == 1;
+
+    uint32_t task_count = get_u32(header + 12);
+    uint32_t fixed_count = get_u32(header + 16);
+    uint32_t strings_size = get_u32(header + 20);
+    uint32_t previous_count = get_u32(header + 120);
+    size_t records_size = WIRE_REQUEST_HEADER_SIZE + (size_t)task_count * WIRE_TASK_RECORD_SIZE +
+                          (size_t)fixed_count * WIRE_FIXED_RECORD_SIZE +
+                          (size_t)previous_count * WIRE_PREVIOUS_RECORD_SIZE + strings_size;
+    uint16_t flags = get_u16(header + 6);
+    size_t template_size = 0;
+    if ((flags & WIRE_TEMPLATE) && records_size + WIRE_TEMPLATE_LENGTH_SIZE <= size) {
+        template_size = WIRE_TEMPLATE_LENGTH_SIZE +
+                        get_u16((const unsigned char*)data + records_size);
+    }
+    if (task_count > (uint32_t)solver_task_capacity() || fixed_count > MAX_SLOTS || previous_count > MAX_SLOTS ||
+        size != records_size + template_size ||
+        ((flags & WIRE_TEMPLATE) && template_size == 0)) {
+        *error = "Binary request size does not match its counts";
+        return -1;
+    }
+    if ((flags & WIRE_REGISTER_TEMPLATE) && !(flags & WIRE_TEMPLATE)) {
+        *error = "Template registration without a template name";
+        return -1;
+    }
+    if (template_size > 0) {
+        info->template_name = data + records_size + WIRE_TEMPLATE_LENGTH_SIZE;
+        info->template_length = template_size - WIRE_TEMPLATE_LENGTH_SIZE;
+        info->register_template = (flags & WIRE_REGISTER_TEMPLATE) != 0;
+    }
+
+    if (header[67] > 1 || decode_options(header, options) != 0) {
+        *error = "Invalid solver options in binary request";
+        return -1;
+    }
+
+    const unsigned char* records = header + WIRE_REQUEST_HEADER_SIZE;
+    const unsigned char* fixed_records = records + (size_t)task_count * WIRE_TASK_RECORD_SIZE;
+    const unsigned char* previous_records =
+        fixed_records + (size_t)fixed_count * WIRE_FIXED_RECORD_SIZE;
+    const unsigned char* strings =
+        previous_records + (size_t)previous_count * WIRE_PREVIOUS_RECORD_SIZE;
+
+    if (task_count > 0) {
+        *tasks = (Task*)arena_alloc(arena, sizeof(Task) * task_count);
+        if (*tasks == NULL) {
+            *error = "Memory allocation failed";
+            return -1;
+        }
+        for (uint32_t i = 0; i < task_count; i++) {
+            if (decode_task(records + (size_t)i * WIRE_TASK_RECORD_SIZE, strings,
+                            strings_size, &(*tasks)[i]) != 0) {
+                arena_free(arena, *tasks);
+                *tasks = NULL;
+                *error = "Invalid task record in binary request";
+                return -1;
+            }
+        }
+        *num_tasks = (int)task_count;
+    }
+
+    if (fixed_count > 0) {
+        *fixed_slots = (TimeSlot*)arena_alloc(arena, sizeof(TimeSlot) * fixed_count);
+        if (*fixed_slots == NULL) {
+            arena_free(arena, *tasks);
+            *tasks = NULL;
+            *num_tasks = 0;
+            *error = "Memory allocation failed";
+            return -1;
+        }
+        for (uint32_t i = 0; i < fixed_count; i++) {
+            const unsigned char* record = fixed_records + (size_t)i * WIRE_FIXED_RECORD_SIZE;
+            TimeSlot* slot = &(*fixed_slots)[i];
+            timeslot_init(slot, (int)i);
+            slot->slot_index = get_i32(record);
+            slot->task_id = get_i32(record + 4);
+            slot->is_fixed = true;
+        }
+        *num_fixed = (int)fixed_count;
+    }
+
+    if (previous_count > 0) {
+        *previous = (TaskPlacement*)arena_alloc(arena, sizeof(TaskPlacement) * previous_count);
+        if (*previous == NULL) {
+            arena_free(arena, *tasks);
+            arena_free(arena, *fixed_slots);
+            *tasks = NULL;
+            *num_tasks = 0;
+            *fixed_slots = NULL;
+            *num_fixed = 0;
+            *error = "Memory allocation failed";
+            return -1;
+        }
+        for (uint32_t i = 0; i < previous_count; i++) {
+            const unsigned char* record =
+                previous_records + (size_t)i * WIRE_PREVIOUS_RECORD_SIZE;
+            (*previous)[i].task_id = get_i32(record);
+            (*previous)[i].start_slot = get_i32(record + 4);
+        }
+        *num_previous = (int)previous_count;
+    }
+
+    return 0;
+}
+
+
+/* ============================================================
+ * Responses
+ * ============================================================ */
+
+/* Length of the reported error: the timeline's message, else error */
+static size_t response_error_length(const Timeline* timeline, const char* error) {
+    if (timeline != NULL) error = timeline->error_message;
+    if (error == NULL) return 0;
+    size_t length = strlen(error);
+    return length > UINT16_MAX ? UINT16_MAX : length;
+}
+
+static int count_runs(const Timeline* timeline) {
+    int runs = 0;
+    for (int i = 0; i < timeline->num_slots; i++) {
+        const TimeSlot* slot = &timeline->slots[i];
+        bool starts_run = i == 0 ||
+            slot->task_id != timeline->slots[i - 1].task_id ||
+            slot->is_fixed != timeline->slots[i - 1].is_fixed;
+        if (starts_run && (slot->task_id >= 0 || slot->is_fixed)) runs++;
+    }
+    return runs;
+}
+
+/**
+ * Write maximal runs of slots sharing a task and fixedness, leaving out
+ * free slots (same segmentation as the JSON "runs" format)
+ */
+static unsigned char* put_runs(unsigned char* p, const Timeline* timeline) {
+    int start = 0;
+    while (start < timeline->num_slots) {
+        const TimeSlot* head = &timeline->slots[start];
+        int end = start + 1;
+        while (end < timeline->num_slots &&
+               timeline->slots[end].task_id == head->task_id &&
+               timeline->slots[end].is_fixed == head->is_fixed) {
+            end++;
+        }
+
+        if (head->task_id >= 0 || head->is_fixed) {
+            memset(p, 0, WIRE_RUN_RECORD_SIZE);
+            put_i32(p, head->task_id);
+            put_u16(p + 4, (uint16_t)start);
+            put_u16(p + 6, (uint16_t)(end - start));
+            p[8] = head->is_fixed ? 1 : 0;
+            p += WIRE_RUN_RECORD_SIZE;
+        }
+        start = end;
+    }
+    return p;
+}
+
+size_t wire_response_size(const Timeline* timeline, const char* error,
+                          const WireRequestInfo* info) {
+    if (timeline == NULL) {
+        return WIRE_RESPONSE_HEADER_SIZE + response_error_length(NULL, error);
+    }
+    size_t items = info->runs
+        ? (size_t)count_runs(timeline) * WIRE_RUN_RECORD_SIZE
+        : (size_t)timeline->num_slots * WIRE_SLOT_RECORD_SIZE;
+    size_t objective = timeline->objective != OBJECTIVE_FEASIBLE ? WIRE_OBJECTIVE_SIZE : 0;
+    return WIRE_RESPONSE_HEADER_SIZE + (size_t)timeline->num_unplaced * 4 + items +
+           response_error_length(timeline, error) + strlen(timeline->strategy) + objective;
+}
+
+size_t wire_response_max_size(void) {
+    return WIRE_RESPONSE_HEADER_SIZE + (size_t)solver_task_capacity() * 4 +
+           MAX_SLOTS * WIRE_RUN_RECORD_SIZE + MAX_ERROR_LEN + MAX_STRATEGY_LEN +
+           WIRE_OBJECTIVE_SIZE;
+}
+
+size_t wire_encode_response(const Timeline* timeline, const char* error,
+                            const WireRequestInfo* info, char* out) {
+    size_t size = wire_response_size(timeline, error, info);
+    size_t error_length = response_error_length(timeline, error);
+    if (timeline != NULL) error = timeline->error_message;
+
+    bool runs = timeline != NULL && info->runs;
+    int num_unplaced = timeline != NULL ? timeline->num_unplaced : 0;
+    int num_items = timeline == NULL ? 0 : runs ? count_runs(timeline) : timeline->num_slots;
+    size_t strategy_length = timeline != NULL ? strlen(timeline->strategy) : 0;
+
+    unsigned char* header = (unsigned char*)out;
+    memset(header, 0, WIRE_RESPONSE_HEADER_SIZE);
+    memcpy(header, WIRE_RESPONSE_MAGIC, 4);
+    put_u16(header + 4, WIRE_VERSION);
+
+    uint16_t flags = 0;
+    if (timeline != NULL && timeline->success) flags |= WIRE_SUCCESS;
+    if (timeline != NULL && timeline->budget_exhausted) flags |= WIRE_BUDGET_EXHAUSTED;
+    if (runs) flags |= WIRE_RUNS;
+    bool incremental = timeline != NULL && timeline->moved_tasks >= 0;
+    if (incremental) flags |= WIRE_INCREMENTAL;
+    if (incremental && timeline->repaired) flags |= WIRE_REPAIRED;
+    if (timeline != NULL && timeline->cache_hit) flags |= WIRE_CACHE_HIT;
+    bool objective = timeline != NULL && timeline->objective != OBJECTIVE_FEASIBLE;
+    if (objective) flags |= WIRE_OBJECTIVE;
+    put_u16(header + 6, flags);
+
+    put_u32(header + 8, (uint32_t)size);
+    put_u32(header + 12, info->request_id);
+    put_u32(header + 16, timeline != NULL ? (uint32_t)timeline->num_slots : 0);
+    put_u32(header + 20, (uint32_t)num_items);
+    put_u32(header + 24, (uint32_t)num_unplaced);
+    put_u16(header + 28, (uint16_t)error_length);
+    put_u16(header + 30, (uint16_t)strategy_length);
+    header[32] = timeline != NULL ? (unsigned char)timeline->engine : 0;
+    if (incremental) put_u16(header + 34, (uint16_t)timeline->moved_tasks);
+
+    unsigned char* p = header + WIRE_RESPONSE_HEADER_SIZE;
+    for (int i = 0; i < num_unplaced; i++, p += 4) {
+        put_i32(p, timeline->unplaced_task_ids[i]);
+    }
+
+    if (runs) {
+        p = put_runs(p, timeline);
+    } else {
+        for (int i = 0; i < num_items; i++, p += WIRE_SLOT_RECORD_SIZE) {
+            const TimeSlot* slot = &timeline->slots[i];
+            put_i32(p, slot->task_id);
+            p[4] = (unsigned char)slot->energy_level;
+            p[5] = slot->is_fixed ? 1 : 0;
+            p[6] = 0;
+            p[7] = 0;
+        }
+    }
+
+    if (error_length > 0) {
+        memcpy(p, error, error_length);
+        p += error_length;
+    }
+    if (strategy_length > 0) {
+        memcpy(p, timeline->strategy, strategy_length);
+        p += strategy_length;
+    }
+    if (objective) {
+        put_i64(p, timeline->objective_value);
+        put_i64(p + 8, timeline->objective_bound);
+    }
+    return size;
+}
+
+int wire_write_response(
+    const Timeline* timeline,
+    const char* error,
+    const WireRequestInfo* info,
+    char** buffer,
+    size_t* capacity
+) {
+    size_t size = wire_response_size(timeline, error, info);
+    if (*buffer == NULL || *capacity < size) {
+        char* grown = (char*)realloc(*buffer, size);
+        if (grown == NULL) return -1;
+        *buffer = grown;
+        *capacity = size;
+    }
+    return (int)wire_encode_response(timeline, error, info, *buffer);
+}
@@ -0,0 +1,200 @@
+/**
+ * AESA Core Scheduling Engine - Binary Wire Format
+ *
+ * Fixed-layout little-endian request/response messages, an alternative to
+ * JSON for callers that pack records directly (see bridge.py).
+ *
+ * Request:  header (WIRE_REQUEST_HEADER_SIZE bytes)
+ *           task records (num_tasks * WIRE_TASK_RECORD_SIZE)
+ *           fixed slot records (num_fixed * WIRE_FIXED_RECORD_SIZE)
+ *           previous placements (num_previous * WIRE_PREVIOUS_RECORD_SIZE)
+ *           string table (strings_size bytes of task names, UTF-8)
+ *           if WIRE_TEMPLATE: uint16 template_length, template name
+ *           (template_length bytes, see templates.h)
+ *
+ * Response: header (WIRE_RESPONSE_HEADER_SIZE bytes)
+ *           unplaced task ids (num_unplaced * int32)
+ *           slot records (WIRE_SLOT_RECORD_SIZE) or run records
+ *           (WIRE_RUN_RECORD_SIZE), num_items of them
+ *           error message, then strategy (error_length, strategy_length bytes)
+ *           if WIRE_OBJECTIVE: int64 objective_value, int64 objective_bound
+ *
+ * Every message starts with a 4-byte magic, uint16 version, uint16 flags
+ * and uint32 total_size, so a stream of messages frames itself.
+ *
+ * Request header:
+ *     0  char[4]  "AESQ"          64  uint8    engine (SolverEngine)
+ *     4  uint16   version         65  uint8    threads
+ *     6  uint16   flags           66  uint8    search_threads
+ *     8  uint32   total_size      67  uint8    output (0 slots, 1 runs)
+ *    12  uint32   num_tasks       68  uint32   request_id (echoed)
+ *    16  uint32   num_fixed       72  uint8[48] energy_curve
+ *    20  uint32   strings_size   120  uint32   num_previous (incremental if > 0)
+ *                                 124  uint8    num_days (0 for DEFAULT_NUM_DAYS)
+ *                                 125  uint8    slot_minutes (0 for DEFAULT_SLOT_MINUTES)
+ *                                 126  uint8    start_slot_of_day
+ *                                 127  uint8    objective (SolverObjective)
+ *    24  int64    max_nodes
+ *    32  int64    max_time_us
+ *    40  int64    local_search_moves
+ *    48  uint64   seed
+ *    56  uint32   tie_break_seed
+ *    60  uint32   max_nogoods
+ *
+ * Task record:  int32 id, int32 duration_slots, int32 priority,
+ *               int32 deadline_slot, uint32 name_offset, uint16 name_length,
+ *               uint8 type, uint8 preferred_energy, uint8 is_fixed, 3 pad
+ * Fixed record: int32 slot_index, int32 task_id
+ * Previous record: int32 task_id, int32 start_slot
+ *
+ * Response header:
+ *     0  char[4]  "AESR"          24  uint32   num_unplaced
+ *     4  uint16   version         28  uint16   error_length
+ *     6  uint16   flags           30  uint16   strategy_length
+ *     8  uint32   total_size      32  uint8    engine
+ *    12  uint32   request_id      33  1 pad
+ *                                 34  uint16   moved_tasks (if WIRE_INCREMENTAL)
+ *    16  uint32   num_slots
+ *    20  uint32   num_items
+ *
+ * Slot record:  int32 task_id, uint8 energy_level, uint8 is_fixed, 2 pad
+ *               (slot_index is the record's position)
+ * Run record:   int32 task_id, uint16 start_slot, uint16 length,
+ *               uint8 is_fixed, 3 pad
+ */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include "scheduler.h"
+#include <stddef.h>
+
+#define WIRE_VERSION 1
+#define WIRE_REQUEST_MAGIC "AESQ"
+#define WIRE_RESPONSE_MAGIC "AESR"
+
+#define WIRE_PREFIX_SIZE 12             /* Magic, version, flags, total_size */
+#define WIRE_REQUEST_HEADER_SIZE 128
+#define WIRE_RESPONSE_HEADER_SIZE 36
+#define WIRE_TASK_RECORD_SIZE 28
+#define WIRE_FIXED_RECORD_SIZE 8
+#define WIRE_PREVIOUS_RECORD_SIZE 8
+#define WIRE_SLOT_RECORD_SIZE 8
+#define WIRE_RUN_RECORD_SIZE 12
+
+/* Request flags */
+#define WIRE_FORWARD_CHECKING 0x01
+#define WIRE_BACKJUMPING 0x02
+#define WIRE_ENERGY_CURVE 0x04      /* energy_curve replaces the default */
+#define WIRE_SEED 0x08              /* seed replaces the default */
+#define WIRE_LOCAL_SEARCH 0x10      /* local_search_moves replaces the default */
+#define WIRE_PRIORITY_WEIGHTS 0x20  /* Objective weighs scores by priority */
+#define WIRE_TEMPLATE 0x40          /* Apply the named fixed-slot template first */
+#define WIRE_REGISTER_TEMPLATE 0x80 /* Register the fixed slots as the named template
+                                       instead of solving (set with WIRE_TEMPLATE) */
+
+/* Response flags */
+#define WIRE_SUCCESS 0x01
+#define WIRE_BUDGET_EXHAUSTED 0x02
+#define WIRE_RUNS 0x04              /* Items are run records */
+#define WIRE_INCREMENTAL 0x08       /* Request had previous placements */
+#define WIRE_REPAIRED 0x10          /* Every still-valid placement was kept */
+#define WIRE_CACHE_HIT 0x20         /* Answered from a result cache */
+#define WIRE_OBJECTIVE 0x40         /* Objective value and bound follow the strategy */
+
+#define WIRE_OBJECTIVE_SIZE 16      /* Two int64 after the strategy */
+#define WIRE_TEMPLATE_LENGTH_SIZE 2 /* uint16 before the template name */
+
+/**
+ * Per-request settings that SolverOptions does not hold: the shape of the
+ * response and the template section
+ */
+typedef struct {
+    uint32_t request_id;
+    bool runs;
+    const char* template_name;      /* Points into the request, NULL without WIRE_TEMPLATE */
+    size_t template_length;         /* Bytes of template_name */
+    bool register_template;         /* WIRE_REGISTER_TEMPLATE was set */
+} WireRequestInfo;
+
+/**
+ * Read the total size of the message starting with prefix
+ * @param prefix First WIRE_PREFIX_SIZE bytes of a message
+ * @return total_size, 0 if prefix is not a request of this version
+ */
+uint32_t wire_request_size(const char* prefix);
+
+/**
+ * Decode a binary request
+ * @param data Message bytes
+ * @param size Number of bytes in data
+ * @param tasks Output: array of tasks (caller must arena_free)
+ * @param num_tasks Output: number of tasks
+ * @param fixed_slots Output: array of fixed slots (caller must arena_free)
+ * @param num_fixed Output: number of fixed slots
+ * @param previous Output: previous placements (caller must arena_free), NULL if
+ *                 the request is not incremental
+ * @param num_previous Output: number of previous placements
+ * @param options Output: solver options
+ * @param info Output: response settings (set as far as the header is valid)
+ * @param error Output: message when -1 is returned
+ * @param arena Arena holding the arrays, NULL for the heap
+ * @return 0 on success, -1 on a malformed request
+ */
+int wire_parse_request(
+    const char* data,
+    size_t size,
+    Task** tasks,
+    int* num_tasks,
+    TimeSlot** fixed_slots,
+    int* num_fixed,
+    TaskPlacement** previous,
+    int* num_previous,
+    SolverOptions* options,
+    WireRequestInfo* info,
+    const char** error,
+    Arena* arena
+);
+
+/**
+ * Size of the response wire_encode_response writes
+ * @param timeline Result to encode, or NULL to report error
+ * @param error Message reported when timeline is NULL
+ * @param info Response settings from the request
+ * @return Response size in bytes
+ */
+size_t wire_response_size(const Timeline* timeline, const char* error,
+                          const WireRequestInfo* info);
+
+/**
+ * Upper bound on wire_response_size for any request the process accepts
+ * (up to solver_task_capacity() tasks)
+ * @return Size in bytes
+ */
+size_t wire_response_max_size(void);
+
+/**
+ * Encode a response into out, which must hold wire_response_size bytes
+ * @return Response size in bytes
+ */
+size_t wire_encode_response(const Timeline* timeline, const char* error,
+                            const WireRequestInfo* info, char* out);
+
+/**
+ * Encode a response into a caller-owned buffer reused across calls
+ * @param timeline Result to encode, or NULL to report error
+ * @param error Message reported when timeline is NULL
+ * @param info Response settings from the request
+ * @param buffer In/out: buffer from a previous call or NULL; caller frees
+ * @param capacity In/out: allocated size of *buffer
+ * @return Length written, -1 on allocation failure
+ */
+int wire_write_response(
+    const Timeline* timeline,
+    const char* error,
+    const WireRequestInfo* info,
+    char** buffer,
+    size_t* capacity
+);
+
+#endif /* WIRE_H */
@@ -0,0 +1,30 @@
+/**
+ * AESA Core Scheduling Engine - Random Generators
+ *
+ * Seeded generators shared by the property tests (test_scheduler.c) and
+ * the benchmarks (bench/bench.c), so both draw workloads the same way.
+ */
+
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include "../src/scheduler.h"
+#include <stdlib.h>
+
+/* Random number generator for property tests and benchmark workloads */
+static unsigned int rand_seed = 0;
+
+static inline void seed_random(unsigned int seed) {
+    rand_seed = seed;
+    srand(seed);
+}
+
+static inline int random_int(int min, int max) {
+    return min + rand() % (max - min + 1);
+}
+
+static inline TaskType random_task_type(void) {
+    return (TaskType)random_int(0, TASK_TYPE_COUNT - 1);
+}
+
+#endif /* GENERATORS_H */
@@ -6,16 +6,25 @@
  */
 
 #include "../src/scheduler.h"
+#include "../src/cache.h"
 #include "../src/json_output.h"
+#include "../src/wire.h"
+#include "../src/templates.h"
+#include "../src/variants.h"
+#include "../src/aesa.h"
+#include "generators.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <time.h>
+#include <pthread.h>
 #include <assert.h>
 
 /* Test configuration */
 #define NUM_ITERATIONS 100
 #define MAX_TEST_TASKS 50
+#define WEEK_SLOTS (DEFAULT_NUM_DAYS * SLOTS_PER_DAY)
 
 /* Simple test framework */
 static int tests_run = 0;
@@ -44,22 +53,6 @@ static int tests_failed = 0;
 #define ASSERT_TRUE(x) ASSERT(x)
 #define ASSERT_FALSE(x) ASSERT(!(x))
 
-/* Random number generator for property tests */
-static unsigned int rand_seed = 0;
-
-static void seed_random(unsigned int seed) {
-    rand_seed = seed;
-    srand(seed);
-}
-
-static int random_int(int min, int max) {
-    return min + rand() % (max - min + 1);
-}
-
-static TaskType random_task_type(void) {
-    return (TaskType)random_int(0, TASK_TYPE_COUNT - 1);
-}
-
 
 /* ============================================================
  * Unit Tests
@@ -113,6 +106,1935 @@ TEST(test_energy_levels) {
     ASSERT_TRUE(is_low_energy_period(0));    /* midnight */
 }
 
+TEST(test_energy_table_default) {
+    EnergyTable table;
+    energy_table_build(&table, NULL);
+    
+    Task task;
+    task_init(&task);
+    task.type = TASK_STUDY;
+    ASSERT_EQ(calculate_energy_score(&table, &task, 16), 10);        /* 8am, peak */
+    ASSERT_EQ(calculate_energy_score(&table, &task, 12), 5);         /* 6am, medium */
+    ASSERT_EQ(calculate_energy_score(&table, &task, 0), 0);          /* midnight, low */
+    ASSERT_EQ(calculate_energy_score(&table, &task, SLOTS_PER_DAY + 16), 10);
+    
+    task.preferred_energy = ENERGY_PREFER_PEAK;
+    ASSERT_EQ(calculate_energy_score(&table, &task, 34), MAX_ENERGY_SCORE);
+    
+    task.type = TASK_BREAK;
+    task.preferred_energy = ENERGY_PREFER_LOW;
+    ASSERT_EQ(calculate_energy_score(&table, &task, 24), 15);        /* 12pm, low */
+    ASSERT_EQ(calculate_energy_score(&table, &task, 20), 0);
+    
+    for (int slot = 0; slot < SLOTS_PER_DAY; slot++) {
+        ASSERT_EQ(table.level[slot], get_energy_level(slot));
+    }
+}
+
+TEST(test_custom_energy_curve) {
+    SolverOptions options;
+    solver_options_init(&options);
+    ASSERT_FALSE(options.has_energy_curve);
+    
+    /* Night owl: only 22:00-23:00 is peak */
+    options.has_energy_curve = true;
+    for (int slot = 0; slot < SLOTS_PER_DAY; slot++) {
+        options.energy_curve[slot] = (slot == 44 || slot == 45) ? 10 : 2;
+    }
+    
+    Task task;
+    task_init(&task);
+    task.id = 1;
+    task.type = TASK_DEEP_WORK;
+    task.duration_slots = 2;
+    
+    Timeline* timeline = optimize_schedule_ex(&task, 1, NULL, 0, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    ASSERT_EQ(timeline->slots[44].task_id, 1);
+    ASSERT_EQ(timeline->slots[45].task_id, 1);
+    ASSERT_EQ(timeline->slots[44].energy_level, 10);
+    ASSERT_EQ(timeline->slots[0].energy_level, 2);
+    timeline_free(timeline);
+    
+    /* Curve round-trips through the JSON options parser */
+    char json[1024];
+    int len = snprintf(json, sizeof(json), "{\"tasks\": [], \"energy_curve\": [");
+    for (int slot = 0; slot < SLOTS_PER_DAY; slot++) {
+        len += snprintf(json + len, sizeof(json) - len, "%s%d", slot ? ", " : "", slot % 10 + 1);
+    }
+    snprintf(json + len, sizeof(json) - len, "]}");
+    
+    SolverOptions parsed;
+    ASSERT_EQ(parse_solver_options(json, &parsed), 0);
+    ASSERT_TRUE(parsed.has_energy_curve);
+    ASSERT_EQ(parsed.energy_curve[13], 4);
+    
+    /* Wrong length or out-of-range levels are rejected */
+    ASSERT_EQ(parse_solver_options("{\"energy_curve\": [1, 2, 3]}", &parsed), -1);
+}
+
+TEST(test_search_budget_partial_result) {
+    /* 19 two-slot tasks must finish by slot 40, and fixed slots 13 and
+     * 27 leave free runs of 13, 13 and 12: the 38 free slots cover the
+     * demand, but only 18 tasks fit, and proving that exhaustively takes
+     * far more than the node budget allows */
+    int num_tasks = 19;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].duration_slots = 2;
+        tasks[i].priority = 100 - i;
+        tasks[i].deadline_slot = 40;
+    }
+    TimeSlot* fixed_slots = timeslot_array_create(2);
+    ASSERT_NE(fixed_slots, NULL);
+    fixed_slots[0].slot_index = 13;
+    fixed_slots[0].is_fixed = true;
+    fixed_slots[1].slot_index = 27;
+    fixed_slots[1].is_fixed = true;
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.max_nodes = 1000;
+    
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, 2, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_TRUE(timeline->budget_exhausted);
+    ASSERT_EQ(timeline->num_unplaced, 1);
+    ASSERT_EQ(timeline->unplaced_task_ids[0], num_tasks);
+    
+    /* The partial schedule keeps every other task */
+    int filled = 0;
+    for (int i = 0; i < timeline->num_slots; i++) {
+        if (timeline->slots[i].task_id > 0) filled++;
+    }
+    ASSERT_EQ(filled, 36);
+    
+    char* json = timeline_to_json(timeline);
+    ASSERT_NE(json, NULL);
+    ASSERT_NE(strstr(json, "\"budget_exhausted\": true"), NULL);
+    ASSERT_NE(strstr(json, "\"unplaced_tasks\": [19]"), NULL);
+    free_json(json);
+    
+    timeline_free(timeline);
+    timeslot_array_free(fixed_slots);
+    task_array_free(tasks);
+}
+
+TEST(test_parse_input_scoping) {
+    /* The first task has no priority, deadline or type: they must not be
+     * taken from the second task, from nested values or from strings */
+    const char* json =
+        "{\"meta\": {\"tasks\": [{\"id\": 99}]},"
+        " \"tasks\": ["
+        "  {\"id\": 1, \"name\": \"a } \\\" { \\\"priority\\\": 5\", \"extra\": [1, {\"deadline_slot\": 3}]},"
+        "  {\"id\": 2, \"type\": \"deep_work\", \"priority\": 90, \"deadline_slot\": 40,"
+        "   \"max_nodes\": 7}"
+        " ],"
+        " \"fixed_slots\": [{\"slot_index\": 4, \"task_id\": 2}],"
+        " \"max_time_us\": 1000}";
+    
+    Task* tasks = NULL;
+    int num_tasks = 0;
+    TimeSlot* fixed = NULL;
+    int num_fixed = 0;
+    ASSERT_EQ(parse_json_input(json, &tasks, &num_tasks, &fixed, &num_fixed, NULL), 0);
+    ASSERT_EQ(num_tasks, 2);
+    ASSERT_EQ(tasks[0].id, 1);
+    ASSERT_EQ(strcmp(tasks[0].name, "a } \" { \"priority\": 5"), 0);
+    ASSERT_EQ(tasks[0].priority, PRIORITY_REGULAR_STUDY);
+    ASSERT_EQ(tasks[0].deadline_slot, -1);
+    ASSERT_EQ(tasks[0].type, TASK_STUDY);
+    ASSERT_EQ(tasks[1].type, TASK_DEEP_WORK);
+    ASSERT_EQ(tasks[1].priority, 90);
+    ASSERT_EQ(num_fixed, 1);
+    ASSERT_EQ(fixed[0].slot_index, 4);
+    ASSERT_TRUE(fixed[0].is_fixed);
+    task_array_free(tasks);
+    timeslot_array_free(fixed);
+    
+    /* Options are only read from the top level */
+    SolverOptions options;
+    ASSERT_EQ(parse_solver_options(json, &options), 0);
+    ASSERT_EQ(options.max_nodes, 0);
+    ASSERT_EQ(options.max_time_us, 1000);
+    
+    /* Structural errors are reported instead of read around */
+    ASSERT_EQ(parse_json_input("{\"tasks\": [{\"id\": 1}", &tasks, &num_tasks, &fixed, &num_fixed, NULL), -1);
+    ASSERT_EQ(parse_json_input("{\"tasks\": [1, 2]}", &tasks, &num_tasks, &fixed, &num_fixed, NULL), -1);
+    ASSERT_EQ(parse_json_input("not json", &tasks, &num_tasks, &fixed, &num_fixed, NULL), -1);
+    ASSERT_EQ(tasks, NULL);
+    ASSERT_EQ(num_tasks, 0);
+    
+    /* Arrays grow past their first allocation, up to the task capacity */
+    int max_tasks = solver_task_capacity();
+    size_t size = (size_t)(max_tasks + 1) * 16 + 32;
+    char* many = (char*)malloc(size);
+    ASSERT_NE(many, NULL);
+    for (int count = max_tasks; count <= max_tasks + 1; count++) {
+        int len = snprintf(many, size, "{\"tasks\": [");
+        for (int i = 0; i < count; i++) {
+            len += snprintf(many + len, size - len, "%s{\"id\": %d}", i ? "," : "", i);
+        }
+        snprintf(many + len, size - len, "]}");
+        int status = parse_json_input(many, &tasks, &num_tasks, &fixed, &num_fixed, NULL);
+        if (count == max_tasks) {
+            ASSERT_EQ(status, 0);
+            ASSERT_EQ(num_tasks, max_tasks);
+            ASSERT_EQ(tasks[max_tasks - 1].id, max_tasks - 1);
+            task_array_free(tasks);
+        } else {
+            ASSERT_EQ(status, -1);
+        }
+    }
+    free(many);
+}
+
+TEST(test_json_output_formats) {
+    Timeline* timeline = timeline_create();
+    ASSERT_NE(timeline, NULL);
+    timeline->success = true;
+    timeline->slots[3].task_id = 7;
+    timeline->slots[4].task_id = 7;
+    timeline->slots[10].is_fixed = true;
+    timeline->slots[11].is_fixed = true;
+    timeline->slots[12].is_fixed = true;
+    timeline->slots[12].task_id = 2;
+    
+    /* Compact output is the pretty document on one line */
+    char* line = NULL;
+    size_t capacity = 0;
+    int length = timeline_write_json(timeline, OUTPUT_COMPACT, &line, &capacity);
+    ASSERT_TRUE(length > 0);
+    ASSERT_NE(line, NULL);
+    ASSERT_EQ((size_t)length, strlen(line));
+    ASSERT_EQ(strchr(line, '\n'), line + length - 1);
+    ASSERT_NE(strstr(line, "{\"slot_index\":3,\"task_id\":7,"), NULL);
+    
+    char* pretty = timeline_to_json(timeline);
+    ASSERT_NE(pretty, NULL);
+    size_t stripped = 0;
+    bool in_string = false;
+    for (const char* p = pretty; *p; p++) {
+        if (*p == '"') in_string = !in_string;
+        if (in_string || !isspace((unsigned char)*p)) stripped++;
+    }
+    ASSERT_EQ(stripped + 1, (size_t)length);
+    free_json(pretty);
+    
+    /* Runs cover each task once and each fixed stretch, never free slots */
+    char* first = line;
+    ASSERT_EQ(timeline_write_json(timeline, OUTPUT_RUNS, &line, &capacity), (int)strlen(line));
+    ASSERT_EQ(line, first);
+    ASSERT_EQ(strstr(line, "\"slots\""), NULL);
+    ASSERT_NE(strstr(line, "\"runs\":[{\"task_id\":7,\"start_slot\":3,\"length\":2,"
+                           "\"is_fixed\":false},{\"task_id\":-1,\"start_slot\":10,"
+                           "\"length\":2,\"is_fixed\":true},{\"task_id\":2,"
+                           "\"start_slot\":12,\"length\":1,\"is_fixed\":true}]}"), NULL);
+    
+    OutputFormat format = OUTPUT_PRETTY;
+    ASSERT_EQ(parse_output_format("{\"tasks\": []}", &format), 0);
+    ASSERT_EQ(format, OUTPUT_PRETTY);
+    ASSERT_EQ(parse_output_format("{\"output_format\": \"runs\"}", &format), 0);
+    ASSERT_EQ(format, OUTPUT_RUNS);
+    ASSERT_EQ(parse_output_format("{\"output_format\": \"xml\"}", &format), -1);
+    
+    free_json(line);
+    timeline_free(timeline);
+}
+
+static void put_le(char* p, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (char)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const char* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)(unsigned char)p[i] << (8 * i);
+    }
+    return value;
+}
+
+#define TEST_WIRE_REQUEST_SIZE (WIRE_REQUEST_HEADER_SIZE + 2 * WIRE_TASK_RECORD_SIZE + \
+                                WIRE_FIXED_RECORD_SIZE + 8)
+
+/* Two tasks, one fixed slot, names "Essay" and "Lab" in the string table */
+static size_t pack_wire_request(char* request) {
+    const size_t size = TEST_WIRE_REQUEST_SIZE;
+    memset(request, 0, size);
+    memcpy(request, WIRE_REQUEST_MAGIC, 4);
+    put_le(request + 4, WIRE_VERSION, 2);
+    put_le(request + 6, WIRE_FORWARD_CHECKING, 2);
+    put_le(request + 8, size, 4);
+    put_le(request + 12, 2, 4);
+    put_le(request + 16, 1, 4);
+    put_le(request + 20, 8, 4);
+    put_le(request + 68, 42, 4);
+    
+    char* task = request + WIRE_REQUEST_HEADER_SIZE;
+    put_le(task, 1, 4);
+    put_le(task + 4, 2, 4);
+    put_le(task + 8, 80, 4);
+    put_le(task + 12, (uint32_t)-1, 4);
+    put_le(task + 20, 5, 2);
+    task[22] = TASK_ASSIGNMENT;
+    task += WIRE_TASK_RECORD_SIZE;
+    put_le(task, 2, 4);
+    put_le(task + 4, 1, 4);
+    put_le(task + 8, 50, 4);
+    put_le(task + 12, (uint32_t)-1, 4);
+    put_le(task + 16, 5, 4);
+    put_le(task + 20, 3, 2);
+    task[22] = TASK_LAB_WORK;
+    char* fixed = task + WIRE_TASK_RECORD_SIZE;
+    put_le(fixed, 20, 4);
+    put_le(fixed + 4, (uint32_t)-1, 4);
+    memcpy(fixed + WIRE_FIXED_RECORD_SIZE, "EssayLab", 8);
+    return size;
+}
+
+TEST(test_wire_round_trip) {
+    char request[TEST_WIRE_REQUEST_SIZE];
+    size_t size = pack_wire_request(request);
+    ASSERT_EQ(wire_request_size(request), (uint32_t)size);
+    
+    Task* tasks = NULL;
+    int num_tasks = 0;
+    TimeSlot* fixed_slots = NULL;
+    int num_fixed = 0;
+    TaskPlacement* previous = NULL;
+    int num_previous = 0;
+    SolverOptions options;
+    WireRequestInfo info;
+    const char* error = NULL;
+    ASSERT_EQ(wire_parse_request(request, size, &tasks, &num_tasks, &fixed_slots,
+                                 &num_fixed, &previous, &num_previous, &options, &info,
+                                 &error, NULL), 0);
+    ASSERT_EQ(num_tasks, 2);
+    ASSERT_EQ(num_fixed, 1);
+    ASSERT_EQ(strcmp(tasks[0].name, "Essay"), 0);
+    ASSERT_EQ(strcmp(tasks[1].name, "Lab"), 0);
+    ASSERT_EQ(tasks[1].type, TASK_LAB_WORK);
+    ASSERT_EQ(tasks[0].deadline_slot, -1);
+    ASSERT_TRUE(fixed_slots[0].is_fixed);
+    ASSERT_TRUE(options.forward_checking);
+    ASSERT_EQ(info.request_id, 42u);
+    ASSERT_TRUE(!info.runs);
+    ASSERT_EQ(previous, NULL);
+    
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed,
+                                              &options);
+    task_array_free(tasks);
+    timeslot_array_free(fixed_slots);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    
+    char* response = NULL;
+    size_t capacity = 0;
+    int length = wire_write_response(timeline, NULL, &info, &response, &capacity);
+    ASSERT_EQ((size_t)length, WIRE_RESPONSE_HEADER_SIZE +
+              (size_t)timeline->num_slots * WIRE_SLOT_RECORD_SIZE + strlen(timeline->strategy));
+    ASSERT_EQ(memcmp(response, WIRE_RESPONSE_MAGIC, 4), 0);
+    ASSERT_EQ(get_le(response + 6, 2), (uint64_t)WIRE_SUCCESS);
+    ASSERT_EQ(get_le(response + 8, 4), (uint64_t)length);
+    ASSERT_EQ(get_le(response + 12, 4), 42u);
+    ASSERT_EQ(get_le(response + 16, 4), (uint64_t)timeline->num_slots);
+    for (int i = 0; i < timeline->num_slots; i++) {
+        const char* record = response + WIRE_RESPONSE_HEADER_SIZE + i * WIRE_SLOT_RECORD_SIZE;
+        ASSERT_EQ((int32_t)get_le(record, 4), timeline->slots[i].task_id);
+        ASSERT_EQ((int)record[4], timeline->slots[i].energy_level);
+        ASSERT_EQ(record[5] != 0, timeline->slots[i].is_fixed);
+    }
+    
+    /* Runs carry the same placements, one record per stretch */
+    info.runs = true;
+    length = wire_write_response(timeline, NULL, &info, &response, &capacity);
+    ASSERT_EQ(get_le(response + 6, 2), (uint64_t)(WIRE_SUCCESS | WIRE_RUNS));
+    ASSERT_EQ(get_le(response + 20, 4), 3u);
+    int covered = 0;
+    for (int i = 0; i < 3; i++) {
+        const char* record = response + WIRE_RESPONSE_HEADER_SIZE + i * WIRE_RUN_RECORD_SIZE;
+        int start = (int)get_le(record + 4, 2);
+        int run_length = (int)get_le(record + 6, 2);
+        ASSERT_EQ(timeline->slots[start].task_id, (int32_t)get_le(record, 4));
+        covered += run_length;
+    }
+    ASSERT_EQ(covered, 4);
+    
+    /* Errors report through the header; truncated requests are rejected */
+    length = wire_write_response(NULL, "bad", &info, &response, &capacity);
+    ASSERT_EQ((size_t)length, WIRE_RESPONSE_HEADER_SIZE + 3);
+    ASSERT_EQ(get_le(response + 6, 2), 0u);
+    ASSERT_EQ(memcmp(response + WIRE_RESPONSE_HEADER_SIZE, "bad", 3), 0);
+    ASSERT_EQ(wire_parse_request(request, size - 1, &tasks, &num_tasks, &fixed_slots,
+                                 &num_fixed, &previous, &num_previous, &options, &info,
+                                 &error, NULL), -1);
+    ASSERT_EQ(tasks, NULL);
+    
+    free(response);
+    timeline_free(timeline);
+}
+
+TEST(test_library_api) {
+    ASSERT_EQ(aesa_api_version(), AESA_API_VERSION);
+    AesaSolver* solver = aesa_solver_create();
+    ASSERT_NE(solver, NULL);
+    
+    char request[TEST_WIRE_REQUEST_SIZE];
+    size_t size = pack_wire_request(request);
+    size_t capacity = aesa_response_capacity();
+    char* response = (char*)malloc(capacity);
+    ASSERT_NE(response, NULL);
+    size_t response_size = 0;
+    
+    /* The context is reused: every solve answers the same, repeats from its cache */
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(aesa_solve(solver, request, size, response, capacity, &response_size),
+                  AESA_OK);
+        ASSERT_EQ(memcmp(response, WIRE_RESPONSE_MAGIC, 4), 0);
+        ASSERT_EQ(get_le(response + 6, 2),
+                  (uint64_t)(i == 0 ? WIRE_SUCCESS : WIRE_SUCCESS | WIRE_CACHE_HIT));
+        ASSERT_EQ(get_le(response + 8, 4), (uint64_t)response_size);
+        ASSERT_EQ(get_le(response + 12, 4), 42u);
+    }
+    AesaCacheStats stats;
+    ASSERT_EQ(aesa_solver_cache_stats(solver, &stats), AESA_OK);
+    ASSERT_EQ(stats.hits, 2u);
+    ASSERT_EQ(stats.misses, 1u);
+    ASSERT_EQ(stats.entries, 1u);
+    
+    /* Too small a buffer reports the size needed */
+    size_t needed = response_size;
+    ASSERT_EQ(aesa_solve(solver, request, size, response, 16, &response_size),
+              AESA_ERROR_BUFFER);
+    ASSERT_EQ(response_size, needed);
+    
+    /* Malformed requests are answered, not refused */
+    ASSERT_EQ(aesa_solve(solver, request, size - 1, response, capacity, &response_size),
+              AESA_OK);
+    ASSERT_EQ(get_le(response + 6, 2), 0u);
+    ASSERT_TRUE(get_le(response + 28, 2) > 0);
+    ASSERT_EQ(aesa_solve(NULL, request, size, response, capacity, &response_size),
+              AESA_ERROR_ARGUMENT);
+    
+    free(response);
+    aesa_solver_free(solver);
+}
+
+/* Start slot of a task's run in timeline, -1 if unplaced */
+static int task_start(const Timeline* timeline, int task_id) {
+    for (int i = 0; i < timeline->num_slots; i++) {
+        if (timeline->slots[i].task_id == task_id) return i;
+    }
+    return -1;
+}
+
+TEST(test_incremental_repair) {
+    int num_tasks = 10;
+    Task* tasks = task_array_create(num_tasks + 1);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = i % 2 ? TASK_STUDY : TASK_ASSIGNMENT;
+        tasks[i].duration_slots = 2 + i % 3;
+        tasks[i].priority = 40 + i;
+    }
+    Timeline* first = optimize_schedule(tasks, num_tasks, NULL, 0);
+    ASSERT_NE(first, NULL);
+    ASSERT_TRUE(first->success);
+    ASSERT_EQ(first->moved_tasks, -1);
+    
+    TaskPlacement previous[10];
+    for (int i = 0; i < num_tasks; i++) {
+        previous[i].task_id = tasks[i].id;
+        previous[i].start_slot = task_start(first, tasks[i].id);
+    }
+    
+    /* Adding a task keeps every other task where it was */
+    tasks[num_tasks].id = 99;
+    tasks[num_tasks].duration_slots = 3;
+    tasks[num_tasks].priority = 95;
+    Timeline* added = optimize_schedule_incremental(tasks, num_tasks + 1, NULL, 0,
+                                                    previous, num_tasks, NULL);
+    ASSERT_NE(added, NULL);
+    ASSERT_TRUE(added->success);
+    ASSERT_TRUE(added->repaired);
+    ASSERT_EQ(added->moved_tasks, 0);
+    ASSERT_TRUE(task_start(added, 99) >= 0);
+    for (int i = 0; i < num_tasks; i++) {
+        ASSERT_EQ(task_start(added, tasks[i].id), previous[i].start_slot);
+    }
+    timeline_free(added);
+    
+    /* A fixed slot over one task displaces only that task */
+    TimeSlot* fixed_slots = timeslot_array_create(1);
+    ASSERT_NE(fixed_slots, NULL);
+    fixed_slots[0].slot_index = previous[0].start_slot;
+    fixed_slots[0].is_fixed = true;
+    Timeline* blocked = optimize_schedule_incremental(tasks, num_tasks, fixed_slots, 1,
+                                                      previous, num_tasks, NULL);
+    ASSERT_NE(blocked, NULL);
+    ASSERT_TRUE(blocked->success);
+    ASSERT_TRUE(blocked->repaired);
+    ASSERT_EQ(blocked->moved_tasks, 1);
+    ASSERT_TRUE(task_start(blocked, tasks[0].id) >= 0);
+    for (int i = 1; i < num_tasks; i++) {
+        ASSERT_EQ(task_start(blocked, tasks[i].id), previous[i].start_slot);
+    }
+    timeline_free(blocked);
+    
+    /* A pinned task splitting the only long enough window is moved by the
+     * full solve after the repair fails */
+    Task pair[2];
+    task_init(&pair[0]);
+    task_init(&pair[1]);
+    pair[0].id = 1;
+    pair[0].duration_slots = 1;
+    pair[1].id = 2;
+    pair[1].duration_slots = 300;
+    pair[1].priority = 90;
+    TaskPlacement pinned = { 1, 100 };
+    Timeline* widened = optimize_schedule_incremental(pair, 2, NULL, 0, &pinned, 1, NULL);
+    ASSERT_NE(widened, NULL);
+    ASSERT_TRUE(widened->success);
+    ASSERT_TRUE(!widened->repaired);
+    ASSERT_EQ(widened->moved_tasks, 1);
+    timeline_free(widened);
+    
+    timeslot_array_free(fixed_slots);
+    timeline_free(first);
+    task_array_free(tasks);
+}
+
+/* Reverse tasks[0..n) in place */
+static void reverse_tasks(Task* tasks, int n) {
+    for (int i = 0; i < n / 2; i++) {
+        Task t = tasks[i];
+        tasks[i] = tasks[n - 1 - i];
+        tasks[n - 1 - i] = t;
+    }
+}
+
+TEST(test_result_cache) {
+    int num_tasks = 6;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = TASK_STUDY;
+        tasks[i].duration_slots = 2;
+        tasks[i].priority = 50;      /* Ties: the order decides */
+    }
+    TimeSlot* fixed_slots = timeslot_array_create(3);
+    ASSERT_NE(fixed_slots, NULL);
+    fixed_slots[0].slot_index = 20;
+    fixed_slots[0].task_id = 7;
+    fixed_slots[1].slot_index = 18;
+    fixed_slots[2].slot_index = MAX_SLOTS;  /* Ignored by the solver */
+    SolverOptions options;
+    solver_options_init(&options);
+    
+    ResultCache* cache = result_cache_create(1 << 20);
+    ASSERT_NE(cache, NULL);
+    int num_fixed = 3;
+    Timeline* first = result_cache_solve(cache, tasks, num_tasks, fixed_slots, &num_fixed,
+                                         NULL, 0, &options);
+    ASSERT_NE(first, NULL);
+    ASSERT_TRUE(first->success);
+    ASSERT_TRUE(!first->cache_hit);
+    ASSERT_EQ(num_fixed, 2);
+    ASSERT_EQ(fixed_slots[0].slot_index, 18);
+    
+    /* The same request reordered, with a duplicate fixed slot, is a hit */
+    reverse_tasks(tasks, num_tasks);
+    fixed_slots[0].slot_index = 20;
+    fixed_slots[0].task_id = 7;
+    fixed_slots[1].slot_index = 18;
+    fixed_slots[1].task_id = -1;
+    fixed_slots[2] = fixed_slots[0];
+    num_fixed = 3;
+    Timeline* again = result_cache_solve(cache, tasks, num_tasks, fixed_slots, &num_fixed,
+                                         NULL, 0, &options);
+    ASSERT_NE(again, NULL);
+    ASSERT_TRUE(again->cache_hit);
+    ASSERT_EQ(memcmp(again->slots, first->slots,
+                     sizeof(TimeSlot) * first->num_slots), 0);
+    timeline_free(again);
+    
+    /* Any option is part of the key */
+    options.forward_checking = true;
+    Timeline* other = result_cache_solve(cache, tasks, num_tasks, fixed_slots, &num_fixed,
+                                         NULL, 0, &options);
+    ASSERT_NE(other, NULL);
+    ASSERT_TRUE(!other->cache_hit);
+    timeline_free(other);
+    
+    ResultCacheStats stats;
+    result_cache_stats(cache, &stats);
+    ASSERT_EQ(stats.hits, 1u);
+    ASSERT_EQ(stats.misses, 2u);
+    ASSERT_EQ(stats.entries, 2u);
+    ASSERT_TRUE(stats.bytes <= stats.max_bytes);
+    result_cache_free(cache);
+    
+    /* A cache with room for one result evicts the older one */
+    cache = result_cache_create(sizeof(Timeline) + sizeof(TimeSlot) * WEEK_SLOTS + 4096);
+    ASSERT_NE(cache, NULL);
+    for (int round = 0; round < 3; round++) {
+        options.forward_checking = round % 2 == 1;
+        Timeline* t = result_cache_solve(cache, tasks, num_tasks, fixed_slots, &num_fixed,
+                                         NULL, 0, &options);
+        ASSERT_NE(t, NULL);
+        ASSERT_TRUE(!t->cache_hit);
+        timeline_free(t);
+    }
+    result_cache_stats(cache, &stats);
+    ASSERT_EQ(stats.misses, 3u);
+    ASSERT_EQ(stats.evictions, 2u);
+    ASSERT_EQ(stats.entries, 1u);
+    result_cache_free(cache);
+    
+    /* Without a cache the request is solved as given */
+    reverse_tasks(tasks, num_tasks);
+    Timeline* uncached = result_cache_solve(NULL, tasks, num_tasks, fixed_slots,
+                                            &num_fixed, NULL, 0, &options);
+    ASSERT_NE(uncached, NULL);
+    ASSERT_TRUE(!uncached->cache_hit);
+    ASSERT_EQ(tasks[0].id, num_tasks);
+    timeline_free(uncached);
+    
+    timeline_free(first);
+    timeslot_array_free(fixed_slots);
+    task_array_free(tasks);
+}
+
+TEST(test_fixed_templates) {
+    /* A section timetable: two 2-slot classes a day, plus a dropped slot */
+    int num_classes = 4 * DEFAULT_NUM_DAYS;
+    TimeSlot* classes = timeslot_array_create(num_classes + 1);
+    ASSERT_NE(classes, NULL);
+    for (int d = 0; d < DEFAULT_NUM_DAYS; d++) {
+        for (int i = 0; i < 4; i++) {
+            TimeSlot* slot = &classes[d * 4 + i];
+            slot->slot_index = d * SLOTS_PER_DAY + (i < 2 ? 18 : 24) + i % 2;
+            slot->task_id = 900 + d * 2 + i / 2;
+        }
+    }
+    classes[num_classes].slot_index = MAX_SLOTS;
+    FixedTemplate* tmpl = fixed_template_create(classes, num_classes + 1, NULL);
+    ASSERT_NE(tmpl, NULL);
+    int count = 0;
+    const TimeSlot* slots = fixed_template_slots(tmpl, &count);
+    ASSERT_EQ(count, num_classes);
+    ASSERT_EQ(slots[0].slot_index, 18);
+    
+    int num_tasks = 8;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = i % 2 ? TASK_STUDY : TASK_LAB_WORK;
+        tasks[i].duration_slots = 3;
+        tasks[i].priority = 40 + i;
+    }
+    
+    /* Per-user overrides: an extra fixed slot and a replaced class slot */
+    TimeSlot* combined = timeslot_array_create(num_classes + 2);
+    ASSERT_NE(combined, NULL);
+    memcpy(combined, classes, sizeof(TimeSlot) * num_classes);
+    TimeSlot* overrides = combined + num_classes;
+    overrides[0].slot_index = 40;
+    overrides[0].task_id = 77;
+    overrides[1].slot_index = 18;
+    overrides[1].task_id = 78;
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    Timeline* expected = optimize_schedule_ex(tasks, num_tasks, combined, num_classes + 2,
+                                              &options);
+    options.fixed_template = tmpl;
+    Timeline* from_template = optimize_schedule_ex(tasks, num_tasks, overrides, 2, &options);
+    ASSERT_NE(expected, NULL);
+    ASSERT_NE(from_template, NULL);
+    ASSERT_TRUE(expected->success);
+    ASSERT_TRUE(from_template->success);
+    ASSERT_EQ(from_template->num_slots, expected->num_slots);
+    for (int i = 0; i < expected->num_slots; i++) {
+        ASSERT_EQ(from_template->slots[i].task_id, expected->slots[i].task_id);
+        ASSERT_EQ(from_template->slots[i].is_fixed, expected->slots[i].is_fixed);
+        ASSERT_EQ(from_template->slots[i].energy_level, expected->slots[i].energy_level);
+    }
+    ASSERT_EQ(from_template->slots[18].task_id, 78);
+    timeline_free(from_template);
+    
+    /* Cached results are keyed by the template's slots, not the pointer */
+    FixedTemplate* fewer = fixed_template_create(classes, num_classes - 1, NULL);
+    ASSERT_NE(fewer, NULL);
+    ResultCache* cache = result_cache_create(1 << 20);
+    ASSERT_NE(cache, NULL);
+    int num_overrides = 2;
+    Timeline* cached = result_cache_solve(cache, tasks, num_tasks, overrides, &num_overrides,
+                                          NULL, 0, &options);
+    ASSERT_NE(cached, NULL);
+    ASSERT_TRUE(!cached->cache_hit);
+    timeline_free(cached);
+    options.fixed_template = fewer;
+    cached = result_cache_solve(cache, tasks, num_tasks, overrides, &num_overrides,
+                                NULL, 0, &options);
+    ASSERT_NE(cached, NULL);
+    ASSERT_TRUE(!cached->cache_hit);
+    timeline_free(cached);
+    result_cache_free(cache);
+    fixed_template_free(fewer);
+    
+    /* A template only serves the horizon it was built for */
+    options.fixed_template = tmpl;
+    options.num_days = 1;
+    ASSERT_TRUE(!fixed_template_fits(tmpl, &options));
+    Timeline* refused = optimize_schedule_ex(tasks, num_tasks, NULL, 0, &options);
+    ASSERT_NE(refused, NULL);
+    ASSERT_TRUE(!refused->success);
+    ASSERT_TRUE(strstr(refused->error_message, "fixed_template") != NULL);
+    timeline_free(refused);
+    fixed_template_free(tmpl);
+    
+    /* A registry answers a registration with the prototype and finds it by name */
+    TemplateRegistry* registry = template_registry_create();
+    ASSERT_NE(registry, NULL);
+    solver_options_init(&options);
+    const char* error = NULL;
+    Timeline* prototype = template_registry_register(registry, "sec-a", 5, 0, classes,
+                                                     num_classes, &options, &error);
+    ASSERT_NE(prototype, NULL);
+    ASSERT_TRUE(prototype->success);
+    ASSERT_TRUE(prototype->slots[19].is_fixed);
+    ASSERT_EQ(prototype->slots[19].task_id, 900);
+    ASSERT_TRUE(!prototype->slots[20].is_fixed);
+    timeline_free(prototype);
+    ASSERT_NE(template_registry_find(registry, "sec-a", 5), NULL);
+    ASSERT_EQ(template_registry_find(registry, "sec-", 4), NULL);
+    ASSERT_EQ(template_registry_find(registry, "sec-b", 5), NULL);
+    
+    /* Registering a name again replaces its template */
+    prototype = template_registry_register(registry, "sec-a", 5, 0, NULL, 0, &options, &error);
+    ASSERT_NE(prototype, NULL);
+    timeline_free(prototype);
+    ASSERT_EQ(template_registry_count(registry), 1u);
+    const FixedTemplate* replaced = template_registry_find(registry, "sec-a", 5);
+    ASSERT_NE(replaced, NULL);
+    fixed_template_slots(replaced, &count);
+    ASSERT_EQ(count, 0);
+    
+    /* Registrations carry no tasks and need a registry */
+    ASSERT_EQ(template_registry_register(registry, "sec-b", 5, 1, classes, num_classes,
+                                         &options, &error), NULL);
+    ASSERT_EQ(template_registry_register(NULL, "sec-b", 5, 0, classes, num_classes,
+                                         &options, &error), NULL);
+    ASSERT_EQ(template_registry_count(registry), 1u);
+    template_registry_free(registry);
+    
+    /* Library contexts register over the wire: the fixed slot 30 of "sec",
+     * then the usual request naming it */
+    AesaSolver* solver = aesa_solver_create();
+    ASSERT_NE(solver, NULL);
+    size_t capacity = aesa_response_capacity();
+    char* response = (char*)malloc(capacity);
+    ASSERT_NE(response, NULL);
+    size_t response_size = 0;
+    char message[TEST_WIRE_REQUEST_SIZE + 8];
+    size_t size = WIRE_REQUEST_HEADER_SIZE + WIRE_FIXED_RECORD_SIZE + 2 + 3;
+    memset(message, 0, size);
+    memcpy(message, WIRE_REQUEST_MAGIC, 4);
+    put_le(message + 4, WIRE_VERSION, 2);
+    put_le(message + 6, WIRE_TEMPLATE | WIRE_REGISTER_TEMPLATE, 2);
+    put_le(message + 8, size, 4);
+    put_le(message + 16, 1, 4);
+    put_le(message + WIRE_REQUEST_HEADER_SIZE, 30, 4);
+    put_le(message + WIRE_REQUEST_HEADER_SIZE + 4, 900, 4);
+    put_le(message + size - 5, 3, 2);
+    memcpy(message + size - 3, "sec", 3);
+    ASSERT_EQ(aesa_solve(solver, message, size, response, capacity, &response_size), AESA_OK);
+    ASSERT_EQ(get_le(response + 6, 2), (uint64_t)WIRE_SUCCESS);
+    
+    size = pack_wire_request(message);
+    put_le(message + 6, WIRE_FORWARD_CHECKING | WIRE_TEMPLATE, 2);
+    put_le(message + 8, size + 5, 4);
+    put_le(message + size, 3, 2);
+    memcpy(message + size + 2, "sec", 3);
+    ASSERT_EQ(aesa_solve(solver, message, size + 5, response, capacity, &response_size),
+              AESA_OK);
+    ASSERT_EQ(get_le(response + 6, 2), (uint64_t)WIRE_SUCCESS);
+    const char* record = response + WIRE_RESPONSE_HEADER_SIZE + 30 * WIRE_SLOT_RECORD_SIZE;
+    ASSERT_EQ(get_le(record, 4), 900u);
+    ASSERT_EQ(record[5], 1);
+    
+    /* A name the context has not registered is an error response */
+    memcpy(message + size + 2, "sed", 3);
+    ASSERT_EQ(aesa_solve(solver, message, size + 5, response, capacity, &response_size),
+              AESA_OK);
+    ASSERT_EQ(get_le(response + 6, 2), 0u);
+    free(response);
+    aesa_solver_free(solver);
+    
+    timeline_free(expected);
+    timeslot_array_free(combined);
+    timeslot_array_free(classes);
+    task_array_free(tasks);
+}
+
+TEST(test_request_variants) {
+    const char* input =
+        "{\"tasks\":["
+        "{\"id\":1,\"type\":\"study\",\"duration_slots\":4,\"priority\":90,\"deadline_slot\":40},"
+        "{\"id\":2,\"type\":\"lab_work\",\"duration_slots\":4,\"priority\":50,\"deadline_slot\":40},"
+        "{\"id\":3,\"type\":\"revision\",\"duration_slots\":4,\"priority\":40,\"deadline_slot\":40}],"
+        "\"fixed_slots\":[{\"slot_index\":20,\"task_id\":900},{\"slot_index\":21,\"task_id\":900}],"
+        "\"variants\":["
+        "{\"remove_tasks\":[1]},"
+        "{\"tasks\":[{\"id\":2,\"priority\":99},{\"id\":4,\"duration_slots\":30,\"deadline_slot\":40}]},"
+        "{\"remove_fixed_slots\":[20],\"fixed_slots\":[{\"slot_index\":30,\"task_id\":901}]}]}";
+    Task* tasks = NULL;
+    TimeSlot* fixed_slots = NULL;
+    int num_tasks = 0;
+    int num_fixed = 0;
+    ASSERT_EQ(parse_json_input(input, &tasks, &num_tasks, &fixed_slots, &num_fixed, NULL), 0);
+    RequestVariant* variants = NULL;
+    int num_variants = 0;
+    ASSERT_EQ(parse_request_variants(input, tasks, num_tasks, &variants, &num_variants, NULL), 0);
+    ASSERT_EQ(num_variants, 3);
+    ASSERT_EQ(variants[0].num_removed_tasks, 1);
+    ASSERT_EQ(variants[0].removed_tasks[0], 1);
+    
+    /* A change starts from the base task, a new ID from the defaults */
+    ASSERT_EQ(variants[1].num_tasks, 2);
+    ASSERT_EQ(variants[1].tasks[0].priority, 99);
+    ASSERT_EQ(variants[1].tasks[0].type, TASK_LAB_WORK);
+    ASSERT_EQ(variants[1].tasks[0].duration_slots, 4);
+    ASSERT_EQ(variants[1].tasks[1].duration_slots, 30);
+    ASSERT_EQ(variants[2].num_released_slots, 1);
+    ASSERT_EQ(variants[2].num_fixed, 1);
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.num_days = 1;
+    Timeline* expected = optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed, &options);
+    Timeline* timeline = optimize_variants(tasks, num_tasks, fixed_slots, num_fixed, NULL, 0,
+                                           variants, num_variants, &options, 2);
+    ASSERT_NE(expected, NULL);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_EQ(timeline->num_variants, 3);
+    for (int i = 0; i < expected->num_slots; i++) {
+        ASSERT_EQ(timeline->slots[i].task_id, expected->slots[i].task_id);
+    }
+    
+    /* Dropping a task leaves the rest of the base schedule in place */
+    const Timeline* dropped = timeline->variants[0];
+    ASSERT_TRUE(dropped->success);
+    ASSERT_EQ(dropped->moved_tasks, 0);
+    for (int i = 0; i < expected->num_slots; i++) {
+        int id = expected->slots[i].task_id;
+        ASSERT_EQ(dropped->slots[i].task_id, id == 1 ? -1 : id);
+    }
+    
+    /* A task that cannot fit names itself as the culprit */
+    const Timeline* overloaded = timeline->variants[1];
+    ASSERT_TRUE(!overloaded->success);
+    ASSERT_EQ(overloaded->num_unplaced, 1);
+    ASSERT_EQ(overloaded->unplaced_task_ids[0], 4);
+    
+    /* Released base slots are free, added ones fixed */
+    const Timeline* moved = timeline->variants[2];
+    ASSERT_TRUE(moved->success);
+    ASSERT_TRUE(!moved->slots[20].is_fixed);
+    ASSERT_TRUE(moved->slots[21].is_fixed);
+    ASSERT_EQ(moved->slots[30].task_id, 901);
+    
+    char* json = NULL;
+    size_t capacity = 0;
+    ASSERT_TRUE(timeline_write_json(timeline, OUTPUT_RUNS, &json, &capacity) > 0);
+    const char* list = strstr(json, "\"variants\":[{\"success\":true");
+    ASSERT_NE(list, NULL);
+    ASSERT_NE(strstr(list, "\"unplaced_tasks\":[4]"), NULL);
+    free_json(json);
+    timeline_free(timeline);
+    timeline_free(expected);
+    request_variants_free(variants, num_variants, NULL);
+    
+    /* Malformed variants are refused, an empty list is a plain request */
+    ASSERT_EQ(parse_request_variants("{\"variants\":[{\"remove_tasks\":[\"x\"]}]}", tasks,
+                                     num_tasks, &variants, &num_variants, NULL), -1);
+    ASSERT_EQ(variants, NULL);
+    ASSERT_EQ(parse_request_variants("{\"variants\":[]}", tasks, num_tasks, &variants,
+                                     &num_variants, NULL), 0);
+    ASSERT_EQ(num_variants, 0);
+    free(tasks);
+    free(fixed_slots);
+}
+
+TEST(test_solver_stats) {
+    /* The overloaded request of test_search_budget_partial_result: the
+     * search reaches its last task, backtracks and runs out of budget */
+    int num_tasks = 19;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].duration_slots = 2;
+        tasks[i].priority = 100 - i;
+        tasks[i].deadline_slot = 40;
+    }
+    TimeSlot* fixed_slots = timeslot_array_create(2);
+    ASSERT_NE(fixed_slots, NULL);
+    fixed_slots[0].slot_index = 13;
+    fixed_slots[0].is_fixed = true;
+    fixed_slots[1].slot_index = 27;
+    fixed_slots[1].is_fixed = true;
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.max_nodes = 1000;
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, 2, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->budget_exhausted);
+    ASSERT_EQ(timeline->nodes, 1001);
+    const SolverStats* stats = &timeline->stats;
+#ifdef AESA_STATS
+    ASSERT_EQ(stats->nodes, 1001);
+    ASSERT_TRUE(stats->backtracks > 0);
+    ASSERT_TRUE(stats->candidates >= stats->nodes);
+    ASSERT_EQ(stats->max_depth, num_tasks);
+#else
+    /* Without AESA_STATS nothing is counted */
+    ASSERT_EQ(stats->nodes, 0);
+    ASSERT_EQ(stats->backtracks, 0);
+    ASSERT_EQ(stats->candidates, 0);
+    ASSERT_EQ(stats->pruned, 0);
+    ASSERT_EQ(stats->max_depth, 0);
+#endif
+    
+    timeline_free(timeline);
+    timeslot_array_free(fixed_slots);
+    task_array_free(tasks);
+}
+
+TEST(test_request_arena) {
+    Arena arena;
+    arena_init(&arena);
+    
+    /* The newest allocation grows in place; others move */
+    char* first = (char*)arena_alloc(&arena, 10);
+    ASSERT_NE(first, NULL);
+    ASSERT_EQ((size_t)first % ARENA_ALIGNMENT, 0u);
+    memset(first, 'a', 10);
+    ASSERT_TRUE(arena_realloc(&arena, first, 10, 100) == first);
+    char* second = (char*)arena_alloc(&arena, 10);
+    char* moved = (char*)arena_realloc(&arena, first, 100, 200);
+    ASSERT_TRUE(moved != first && moved != second);
+    ASSERT_EQ(moved[9], 'a');
+    
+    /* Overflowing the first block leaves one block that fits it all */
+    ASSERT_NE(arena_alloc(&arena, ARENA_INITIAL_SIZE * 3), NULL);
+    size_t capacity = arena.capacity;
+    arena_reset(&arena);
+    ASSERT_EQ(arena.capacity, capacity);
+    ASSERT_NE(arena_alloc(&arena, ARENA_INITIAL_SIZE * 3), NULL);
+    ASSERT_EQ(arena.capacity, capacity);
+    arena_destroy(&arena);
+    ASSERT_EQ(arena.capacity, 0u);
+    
+    /* A request parsed and solved in the arena matches the heap solve, and
+     * repeating it reuses the arena without growing it */
+    const char* json =
+        "{\"tasks\": [{\"id\": 1, \"type\": \"study\", \"duration_slots\": 4, \"priority\": 80},"
+        " {\"id\": 2, \"type\": \"chore\", \"duration_slots\": 2, \"deadline_slot\": 40},"
+        " {\"id\": 3, \"type\": \"exercise\", \"duration_slots\": 3}],"
+        " \"fixed_slots\": [{\"slot_index\": 20, \"task_id\": 9}], \"backjumping\": true}";
+    Task* tasks = NULL;
+    TimeSlot* fixed_slots = NULL;
+    int num_tasks = 0;
+    int num_fixed = 0;
+    ASSERT_EQ(parse_json_input(json, &tasks, &num_tasks, &fixed_slots, &num_fixed, NULL), 0);
+    SolverOptions options;
+    ASSERT_EQ(parse_solver_options(json, &options), 0);
+    Timeline* expected = optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed, &options);
+    ASSERT_NE(expected, NULL);
+    ASSERT_TRUE(expected->success);
+    ASSERT_EQ(expected->arena, NULL);
+    task_array_free(tasks);
+    timeslot_array_free(fixed_slots);
+    
+    for (int round = 0; round < 3; round++) {
+        ASSERT_EQ(parse_json_input(json, &tasks, &num_tasks, &fixed_slots, &num_fixed,
+                                   &arena), 0);
+        options.arena = &arena;
+        Timeline* solved = optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed,
+                                                &options);
+        ASSERT_NE(solved, NULL);
+        ASSERT_TRUE(solved->arena == &arena);
+        ASSERT_TRUE(solved->success);
+        ASSERT_EQ(solved->num_slots, expected->num_slots);
+        for (int i = 0; i < expected->num_slots; i++) {
+            ASSERT_EQ(solved->slots[i].task_id, expected->slots[i].task_id);
+        }
+        timeline_free(solved);
+        if (round == 0) capacity = arena.capacity;
+        ASSERT_EQ(arena.capacity, capacity);
+        arena_reset(&arena);
+    }
+    timeline_free(expected);
+    
+    /* A partial portfolio result keeps its unplaced list in the arena.
+     * The fixed slot splits the day into runs of 24 and 23 slots, so
+     * only two of the tasks fit. */
+    Task crowded[3];
+    for (int i = 0; i < 3; i++) {
+        task_init(&crowded[i]);
+        crowded[i].id = i + 1;
+        crowded[i].duration_slots = 15;
+    }
+    TimeSlot divider;
+    timeslot_init(&divider, 24);
+    divider.is_fixed = true;
+    solver_options_init(&options);
+    options.num_days = 1;
+    options.engine = ENGINE_GREEDY;
+    options.threads = 2;
+    options.arena = &arena;
+    Timeline* partial = optimize_schedule_ex(crowded, 3, &divider, 1, &options);
+    ASSERT_NE(partial, NULL);
+    ASSERT_TRUE(!partial->success);
+    ASSERT_EQ(partial->num_unplaced, 1);
+    ASSERT_NE(partial->unplaced_task_ids, NULL);
+    Timeline* copy = timeline_clone(partial);
+    ASSERT_NE(copy, NULL);
+    ASSERT_EQ(copy->arena, NULL);
+    ASSERT_EQ(copy->unplaced_task_ids[0], partial->unplaced_task_ids[0]);
+    timeline_free(partial);
+    arena_destroy(&arena);
+    timeline_free(copy);
+}
+
+TEST(test_forward_checking_mrv) {
+    /* A low-priority task with a single feasible window must not be starved
+     * by higher-priority tasks that grab the same peak slots first */
+    int num_tasks = 11;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks - 1; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = TASK_STUDY;
+        tasks[i].duration_slots = 2;
+        tasks[i].priority = 90;
+    }
+    Task* tight = &tasks[num_tasks - 1];
+    tight->id = num_tasks;
+    tight->duration_slots = 4;
+    tight->priority = 10;
+    tight->deadline_slot = 20;
+    
+    TimeSlot* fixed_slots = timeslot_array_create(16);
+    ASSERT_NE(fixed_slots, NULL);
+    for (int i = 0; i < 16; i++) {
+        fixed_slots[i].slot_index = i;
+        fixed_slots[i].is_fixed = true;
+    }
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.max_nodes = 50;
+    
+    /* Priority order places the tight task last and runs out of budget */
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, 16, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->budget_exhausted);
+    timeline_free(timeline);
+    
+    /* MRV places it first, one node per task */
+    options.forward_checking = true;
+    timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, 16, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    ASSERT_FALSE(timeline->budget_exhausted);
+    for (int i = 16; i < 20; i++) {
+        ASSERT_EQ(timeline->slots[i].task_id, num_tasks);
+    }
+    timeline_free(timeline);
+    
+    /* An empty initial domain is reported without searching */
+    tight->deadline_slot = 19;
+    options.max_nodes = 1;
+    timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, 16, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_FALSE(timeline->budget_exhausted);
+    ASSERT_EQ(timeline->num_unplaced, 1);
+    ASSERT_EQ(timeline->unplaced_task_ids[0], num_tasks);
+    timeline_free(timeline);
+    
+    timeslot_array_free(fixed_slots);
+    task_array_free(tasks);
+}
+
+TEST(test_backjumping_proves_infeasible) {
+    /* Three low-priority tasks compete for the two 3-slot windows before
+     * slot 7 that fixed slot 3 leaves; the free slots cover their demand,
+     * so only search shows they cannot all fit. Chronological
+     * backtracking retries every placement of the earlier tasks;
+     * backjumping sees they played no part and stops at once. */
+    int num_tasks = 10;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = TASK_STUDY;
+        tasks[i].duration_slots = 2;
+        tasks[i].priority = 90;
+    }
+    for (int i = num_tasks - 3; i < num_tasks; i++) {
+        tasks[i].priority = 10;
+        tasks[i].deadline_slot = 7;
+    }
+    TimeSlot divider;
+    timeslot_init(&divider, 3);
+    divider.is_fixed = true;
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.max_nodes = 100000;
+    
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, &divider, 1, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_TRUE(timeline->budget_exhausted);
+    timeline_free(timeline);
+    
+    options.backjumping = true;
+    options.max_nogoods = 64;
+    timeline = optimize_schedule_ex(tasks, num_tasks, &divider, 1, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_FALSE(timeline->budget_exhausted);
+    ASSERT_EQ(strncmp(timeline->error_message, "NO_SOLUTION", 11), 0);
+    timeline_free(timeline);
+    
+    /* Once feasible, the first solution matches chronological search */
+    tasks[num_tasks - 1].deadline_slot = 9;
+    Timeline* expected = optimize_schedule(tasks, num_tasks, &divider, 1);
+    timeline = optimize_schedule_ex(tasks, num_tasks, &divider, 1, &options);
+    ASSERT_NE(expected, NULL);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(expected->success);
+    ASSERT_TRUE(timeline->success);
+    for (int i = 0; i < WEEK_SLOTS; i++) {
+        ASSERT_EQ(timeline->slots[i].task_id, expected->slots[i].task_id);
+    }
+    timeline_free(expected);
+    timeline_free(timeline);
+    
+    task_array_free(tasks);
+}
+
+TEST(test_capacity_precheck) {
+    /* Three 4-slot tasks due by slot 10 need 12 of its 10 slots; the
+     * pre-check says so without a search budget */
+    int num_tasks = 4;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].duration_slots = 4;
+        tasks[i].priority = 90 - i;
+        tasks[i].deadline_slot = (i < 3) ? 10 : -1;
+    }
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.engine = ENGINE_BACKTRACK;
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, NULL, 0, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_FALSE(timeline->budget_exhausted);
+    ASSERT_NE(strstr(timeline->error_message,
+                     "NO_SOLUTION: Tasks due by slot 10 need 12 slots but only 10 are free "
+                     "(tasks 1, 2, 3)"), NULL);
+    /* The partial schedule places what fits */
+    ASSERT_EQ(timeline->num_unplaced, 1);
+    ASSERT_EQ(timeline->unplaced_task_ids[0], 3);
+    timeline_free(timeline);
+    
+    /* Greedy is fast anyway and keeps its own result */
+    options.engine = ENGINE_GREEDY;
+    timeline = optimize_schedule_ex(tasks, num_tasks, NULL, 0, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_EQ(strncmp(timeline->error_message, "GREEDY_INCOMPLETE", 17), 0);
+    timeline_free(timeline);
+    
+    /* Fixed slots every fourth slot leave no 4-slot run before slot 40 */
+    TimeSlot* fixed_slots = timeslot_array_create(10);
+    ASSERT_NE(fixed_slots, NULL);
+    for (int i = 0; i < 10; i++) {
+        fixed_slots[i].slot_index = 4 * i + 3;
+        fixed_slots[i].is_fixed = true;
+    }
+    tasks[0].deadline_slot = 40;
+    options.engine = ENGINE_AUTO;
+    timeline = optimize_schedule_ex(tasks, 1, fixed_slots, 10, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_EQ(strcmp(timeline->error_message,
+                     "NO_SOLUTION: Task 1 needs 4 consecutive free slots before slot 40 "
+                     "but the longest free run is 3"), 0);
+    ASSERT_EQ(timeline->num_unplaced, 1);
+    timeline_free(timeline);
+    
+    /* One slot later the run 40-43 is long enough */
+    tasks[0].deadline_slot = 44;
+    timeline = optimize_schedule_ex(tasks, 1, fixed_slots, 10, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    ASSERT_EQ(timeline->slots[40].task_id, 1);
+    timeline_free(timeline);
+    
+    timeslot_array_free(fixed_slots);
+    task_array_free(tasks);
+}
+
+TEST(test_component_decomposition) {
+    /* Fixed slots 8 and 20 leave runs of 8 and 11 slots before the long
+     * run from slot 21. The three 6-slot tasks due by slot 20 only fit
+     * the first two runs, and the 12-slot tasks only the long one. The
+     * short tasks cannot all fit, which the whole search would retry
+     * for every placement of the long ones. */
+    int num_tasks = 11;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = TASK_STUDY;
+        tasks[i].duration_slots = 12;
+        tasks[i].priority = 90;
+    }
+    for (int i = 8; i < num_tasks; i++) {
+        tasks[i].duration_slots = 6;
+        tasks[i].priority = 10;
+        tasks[i].deadline_slot = 20;
+    }
+    TimeSlot dividers[2];
+    timeslot_init(&dividers[0], 8);
+    dividers[0].is_fixed = true;
+    timeslot_init(&dividers[1], 20);
+    dividers[1].is_fixed = true;
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.max_nodes = 100000;
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, dividers, 2, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_FALSE(timeline->budget_exhausted);
+    ASSERT_EQ(strncmp(timeline->error_message, "NO_SOLUTION", 11), 0);
+    ASSERT_EQ(timeline->num_unplaced, 1);
+    ASSERT_EQ(timeline->unplaced_task_ids[0], num_tasks);
+    
+    /* Threads searching whole components find the same partial schedule */
+    options.search_threads = 4;
+    Timeline* parallel = optimize_schedule_ex(tasks, num_tasks, dividers, 2, &options);
+    ASSERT_NE(parallel, NULL);
+    ASSERT_FALSE(parallel->budget_exhausted);
+    for (int i = 0; i < WEEK_SLOTS; i++) {
+        ASSERT_EQ(parallel->slots[i].task_id, timeline->slots[i].task_id);
+    }
+    timeline_free(parallel);
+    timeline_free(timeline);
+    
+    /* Without the third short task both components are solved */
+    options.search_threads = 0;
+    timeline = optimize_schedule_ex(tasks, num_tasks - 1, dividers, 2, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    for (int t = 0; t < num_tasks - 1; t++) {
+        int start = task_start(timeline, tasks[t].id);
+        ASSERT_TRUE(start >= 0);
+        ASSERT_TRUE((t < 8) == (start >= 21));
+    }
+    timeline_free(timeline);
+    
+    /* max_nodes bounds the components together, sequential or threaded */
+    options.max_nodes = 6;
+    for (int threads = 0; threads <= 4; threads += 4) {
+        options.search_threads = threads;
+        timeline = optimize_schedule_ex(tasks, num_tasks, dividers, 2, &options);
+        ASSERT_NE(timeline, NULL);
+        ASSERT_FALSE(timeline->success);
+        ASSERT_TRUE(timeline->budget_exhausted);
+        ASSERT_TRUE(timeline->nodes <= options.max_nodes);
+        timeline_free(timeline);
+    }
+    
+    task_array_free(tasks);
+}
+
+TEST(test_portfolio_solver) {
+    /* The starving instance from test_forward_checking_mrv: priority
+     * order runs out of nodes, the MRV worker solves it */
+    int num_tasks = 11;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks - 1; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = TASK_STUDY;
+        tasks[i].duration_slots = 2;
+        tasks[i].priority = 90;
+    }
+    tasks[num_tasks - 1].id = num_tasks;
+    tasks[num_tasks - 1].duration_slots = 4;
+    tasks[num_tasks - 1].priority = 10;
+    tasks[num_tasks - 1].deadline_slot = 20;
+    
+    TimeSlot* fixed_slots = timeslot_array_create(16);
+    ASSERT_NE(fixed_slots, NULL);
+    for (int i = 0; i < 16; i++) {
+        fixed_slots[i].slot_index = i;
+        fixed_slots[i].is_fixed = true;
+    }
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.max_nodes = 50;
+    options.threads = 4;
+    
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, 16, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    ASSERT_FALSE(timeline->budget_exhausted);
+    ASSERT_NE(strcmp(timeline->strategy, "backtrack"), 0);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_TRUE(timeline->slots[i].is_fixed);
+    }
+    for (int i = 16; i < 20; i++) {
+        ASSERT_EQ(timeline->slots[i].task_id, num_tasks);
+    }
+    timeline_free(timeline);
+    
+    /* Proof of infeasibility from any worker ends the run */
+    tasks[num_tasks - 1].deadline_slot = 19;
+    options.max_nodes = 0;
+    timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, 16, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_EQ(strncmp(timeline->error_message, "NO_SOLUTION", 11), 0);
+    timeline_free(timeline);
+    
+    timeslot_array_free(fixed_slots);
+    task_array_free(tasks);
+}
+
+TEST(test_parallel_search) {
+    /* Only slots 0-9 and 11-20 are free. Six 3-slot tasks and a 2-slot
+     * task fill those 20 slots exactly, yet each run holds three 3-slot
+     * tasks or two and the 2-slot one, never seven tasks in all. Proving
+     * that visits the whole tree, split across the workers. */
+    int num_tasks = 7;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].duration_slots = (i < 6) ? 3 : 2;
+    }
+    
+    int num_fixed = WEEK_SLOTS - 20;
+    TimeSlot* fixed_slots = timeslot_array_create(num_fixed);
+    ASSERT_NE(fixed_slots, NULL);
+    fixed_slots[0].slot_index = 10;
+    fixed_slots[0].is_fixed = true;
+    for (int i = 1; i < num_fixed; i++) {
+        fixed_slots[i].slot_index = 20 + i;
+        fixed_slots[i].is_fixed = true;
+    }
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.search_threads = 4;
+    
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_FALSE(timeline->budget_exhausted);
+    ASSERT_EQ(strncmp(timeline->error_message, "NO_SOLUTION", 11), 0);
+    ASSERT_EQ(strcmp(timeline->strategy, "backtrack/split=4"), 0);
+    timeline_free(timeline);
+    
+    /* The node budget is shared by all workers */
+    options.max_nodes = 500;
+    timeline = optimize_schedule_ex(tasks, num_tasks, fixed_slots, num_fixed, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->budget_exhausted);
+    timeline_free(timeline);
+    
+    /* Without the extra task every worker's subtree holds a packing */
+    options.max_nodes = 0;
+    options.forward_checking = true;
+    timeline = optimize_schedule_ex(tasks, num_tasks - 1, fixed_slots, num_fixed, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    for (int t = 1; t <= 6; t++) {
+        int first = -1, count = 0;
+        for (int i = 0; i < 21; i++) {
+            if (timeline->slots[i].task_id == t) {
+                if (first < 0) first = i;
+                count++;
+            }
+        }
+        ASSERT_EQ(count, 3);
+        ASSERT_EQ(timeline->slots[first + 2].task_id, t);
+    }
+    timeline_free(timeline);
+    
+    timeslot_array_free(fixed_slots);
+    task_array_free(tasks);
+}
+
+/**
+ * Sum of start-slot energy scores of every task placed in the timeline
+ */
+static int total_energy_score(const Timeline* timeline, const Task* tasks, int num_tasks,
+                              const EnergyTable* energy) {
+    int total = 0;
+    for (int t = 0; t < num_tasks; t++) {
+        for (int i = 0; i < timeline->num_slots; i++) {
+            if (timeline->slots[i].task_id == tasks[t].id) {
+                total += calculate_energy_score(energy, &tasks[t], i);
+                break;
+            }
+        }
+    }
+    return total;
+}
+
+TEST(test_symmetry_breaking) {
+    /* Six identical practice blocks for five 5-slot windows: without
+     * symmetry breaking the search retries all 5! orders of the blocks
+     * that fit before it runs out of windows for the sixth */
+    int num_fixed = 0;
+    TimeSlot fixed[SLOTS_PER_DAY];
+    for (int i = 0; i < SLOTS_PER_DAY; i++) {
+        if (i >= 30 || i % 6 == 5) {
+            timeslot_init(&fixed[num_fixed], i);
+            fixed[num_fixed++].is_fixed = true;
+        }
+    }
+    int num_tasks = 6;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = TASK_PRACTICE;
+        tasks[i].duration_slots = 3;
+        tasks[i].priority = PRIORITY_ASSIGNMENT;
+    }
+    SolverOptions options;
+    solver_options_init(&options);
+    options.num_days = 1;
+    options.max_nodes = 5000;
+    
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, fixed, num_fixed, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_FALSE(timeline->budget_exhausted);
+    ASSERT_EQ(strncmp(timeline->error_message, "NO_SOLUTION", 11), 0);
+    timeline_free(timeline);
+    
+    /* Five blocks take one window each */
+    timeline = optimize_schedule_ex(tasks, num_tasks - 1, fixed, num_fixed, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    for (int w = 0; w < 5; w++) {
+        int used = 0;
+        for (int i = w * 6; i < w * 6 + 5; i++) {
+            if (timeline->slots[i].task_id > 0) used++;
+        }
+        ASSERT_EQ(used, 3);
+    }
+    timeline_free(timeline);
+    task_array_free(tasks);
+}
+
+TEST(test_branch_and_bound) {
+    /* One peak window: the first schedule gives it to the higher
+     * priority study task (10 + 5), the optimum to the deep work task
+     * that prefers peak energy (15 + 5) */
+    Task pair[2];
+    task_init(&pair[0]);
+    pair[0].id = 1;
+    pair[0].type = TASK_STUDY;
+    pair[0].duration_slots = 2;
+    pair[0].priority = 90;
+    task_init(&pair[1]);
+    pair[1].id = 2;
+    pair[1].type = TASK_DEEP_WORK;
+    pair[1].duration_slots = 2;
+    pair[1].priority = 10;
+    pair[1].preferred_energy = ENERGY_PREFER_PEAK;
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    options.num_days = 1;
+    options.has_energy_curve = true;
+    for (int slot = 0; slot < SLOTS_PER_DAY; slot++) {
+        options.energy_curve[slot] = (slot < 2) ? 10 : 5;
+    }
+    
+    Timeline* first = optimize_schedule_ex(pair, 2, NULL, 0, &options);
+    ASSERT_NE(first, NULL);
+    ASSERT_TRUE(first->success);
+    ASSERT_EQ(first->slots[0].task_id, 1);
+    ASSERT_EQ(first->objective_value, -1);
+    timeline_free(first);
+    
+    options.objective = OBJECTIVE_MAXIMIZE_ENERGY_FIT;
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        if (e == ENGINE_GREEDY) continue;
+        options.engine = (SolverEngine)e;
+        Timeline* best = optimize_schedule_ex(pair, 2, NULL, 0, &options);
+        ASSERT_NE(best, NULL);
+        ASSERT_TRUE(best->success);
+        ASSERT_EQ(best->slots[0].task_id, 2);
+        ASSERT_EQ(best->objective_value, 20);
+        ASSERT_EQ(best->objective_bound, 20);
+        timeline_free(best);
+    }
+    
+    /* Weighted by priority the study task's peak score counts most:
+     * 90 * 10 + 10 * 5 beats 90 * 5 + 10 * 15 */
+    options.engine = ENGINE_BACKTRACK;
+    options.weight_by_priority = true;
+    Timeline* weighted = optimize_schedule_ex(pair, 2, NULL, 0, &options);
+    ASSERT_NE(weighted, NULL);
+    ASSERT_TRUE(weighted->success);
+    ASSERT_EQ(weighted->slots[0].task_id, 1);
+    ASSERT_EQ(weighted->objective_value, 950);
+    ASSERT_EQ(weighted->objective_bound, 950);
+    timeline_free(weighted);
+    
+    /* Random tasks: the proven optimum is at least the first schedule's
+     * total, and a budget that runs out on the first dive leaves a gap
+     * that still brackets it */
+    EnergyTable energy;
+    energy_table_build(&energy, NULL);
+    seed_random(23);
+    int num_tasks = 10;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = random_task_type();
+        tasks[i].duration_slots = random_int(1, 4);
+        tasks[i].priority = random_int(0, 100);
+        tasks[i].preferred_energy = (PreferredEnergy)random_int(0, 3);
+    }
+    solver_options_init(&options);
+    options.num_days = 1;
+    first = optimize_schedule_ex(tasks, num_tasks, NULL, 0, &options);
+    options.objective = OBJECTIVE_MAXIMIZE_ENERGY_FIT;
+    options.forward_checking = true;
+    Timeline* best = optimize_schedule_ex(tasks, num_tasks, NULL, 0, &options);
+    options.max_nodes = 5;
+    Timeline* budgeted = optimize_schedule_ex(tasks, num_tasks, NULL, 0, &options);
+    ASSERT_NE(first, NULL);
+    ASSERT_NE(best, NULL);
+    ASSERT_NE(budgeted, NULL);
+    ASSERT_TRUE(best->success);
+    ASSERT_FALSE(best->budget_exhausted);
+    ASSERT_EQ(best->objective_value, total_energy_score(best, tasks, num_tasks, &energy));
+    ASSERT_EQ(best->objective_bound, best->objective_value);
+    ASSERT_TRUE(best->objective_value >= total_energy_score(first, tasks, num_tasks, &energy));
+    ASSERT_TRUE(budgeted->success);
+    ASSERT_TRUE(budgeted->budget_exhausted);
+    ASSERT_TRUE(budgeted->objective_value <= best->objective_value);
+    ASSERT_TRUE(budgeted->objective_bound >= best->objective_value);
+    timeline_free(first);
+    timeline_free(best);
+    timeline_free(budgeted);
+    task_array_free(tasks);
+    
+    ASSERT_EQ(parse_solver_options("{\"objective\": \"maximize_energy_fit\", "
+                                   "\"weight_by_priority\": true}", &options), 0);
+    ASSERT_EQ(options.objective, OBJECTIVE_MAXIMIZE_ENERGY_FIT);
+    ASSERT_TRUE(options.weight_by_priority);
+    ASSERT_EQ(parse_solver_options("{\"objective\": \"fastest\"}", &options), -1);
+}
+
+TEST(test_greedy_engine) {
+    EnergyTable energy;
+    energy_table_build(&energy, NULL);
+    
+    seed_random(7);
+    int num_tasks = 30;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = random_task_type();
+        tasks[i].duration_slots = random_int(1, 4);
+        tasks[i].priority = random_int(0, 100);
+        tasks[i].preferred_energy = (PreferredEnergy)random_int(0, 3);
+    }
+    
+    SolverOptions options;
+    solver_options_init(&options);
+    Timeline* backtracked = optimize_schedule_ex(tasks, num_tasks, NULL, 0, &options);
+    options.engine = ENGINE_GREEDY;
+    Timeline* greedy = optimize_schedule_ex(tasks, num_tasks, NULL, 0, &options);
+    ASSERT_NE(backtracked, NULL);
+    ASSERT_NE(greedy, NULL);
+    ASSERT_TRUE(greedy->success);
+    ASSERT_EQ(greedy->engine, ENGINE_GREEDY);
+    ASSERT_EQ(backtracked->engine, ENGINE_BACKTRACK);
+    
+    /* The greedy seed is the first path backtracking takes; local search
+     * only keeps improvements */
+    ASSERT_TRUE(total_energy_score(greedy, tasks, num_tasks, &energy) >=
+                total_energy_score(backtracked, tasks, num_tasks, &energy));
+    
+    /* Every task keeps one contiguous run of its duration */
+    for (int t = 0; t < num_tasks; t++) {
+        int count = 0;
+        int first = -1, last = -1;
+        for (int i = 0; i < greedy->num_slots; i++) {
+            if (greedy->slots[i].task_id == tasks[t].id) {
+                if (first < 0) first = i;
+                last = i;
+                count++;
+            }
+        }
+        ASSERT_EQ(count, tasks[t].duration_slots);
+        ASSERT_EQ(last - first + 1, count);
+    }
+    timeline_free(backtracked);
+    timeline_free(greedy);
+    task_array_free(tasks);
+    
+    /* A peak-loving task takes the only window a tight task could use */
+    Task pair[2];
+    task_init(&pair[0]);
+    pair[0].id = 1;
+    pair[0].type = TASK_DEEP_WORK;
+    pair[0].duration_slots = 2;
+    pair[0].priority = 90;
+    task_init(&pair[1]);
+    pair[1].id = 2;
+    pair[1].duration_slots = 4;
+    pair[1].priority = 10;
+    pair[1].deadline_slot = 4;
+    
+    options.has_energy_curve = true;
+    for (int slot = 0; slot < SLOTS_PER_DAY; slot++) {
+        options.energy_curve[slot] = (slot < 2) ? 10 : 5;
+    }
+    
+    greedy = optimize_schedule_ex(pair, 2, NULL, 0, &options);
+    ASSERT_NE(greedy, NULL);
+    ASSERT_FALSE(greedy->success);
+    ASSERT_EQ(greedy->num_unplaced, 1);
+    ASSERT_EQ(greedy->unplaced_task_ids[0], 2);
+    ASSERT_EQ(strncmp(greedy->error_message, "GREEDY_INCOMPLETE", 17), 0);
+    timeline_free(greedy);
+    
+    /* Auto falls back to backtracking, which moves the flexible task */
+    options.engine = ENGINE_AUTO;
+    Timeline* timeline = optimize_schedule_ex(pair, 2, NULL, 0, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    ASSERT_EQ(timeline->engine, ENGINE_BACKTRACK);
+    ASSERT_EQ(timeline->slots[0].task_id, 2);
+    timeline_free(timeline);
+    
+    ASSERT_EQ(parse_solver_options("{\"engine\": \"auto\"}", &options), 0);
+    ASSERT_EQ(options.engine, ENGINE_AUTO);
+    ASSERT_EQ(parse_solver_options("{\"engine\": \"fast\"}", &options), -1);
+}
+
+TEST(test_occupancy_free_starts) {
+    Timeline* timeline = timeline_create();
+    ASSERT_NE(timeline, NULL);
+    
+    /* Block slot 70 so it splits the run across the first word boundary */
+    timeline->slots[70].is_fixed = true;
+    timeline_rebuild_occupancy(timeline);
+    
+    ASSERT_TRUE(timeline_is_range_free(timeline, 60, 10));
+    ASSERT_FALSE(timeline_is_range_free(timeline, 60, 11));
+    ASSERT_FALSE(timeline_is_range_free(timeline, WEEK_SLOTS - 2, 3));
+    
+    uint64_t starts[SLOT_WORDS];
+    int count = timeline_free_starts(timeline, 4, 80, starts);
+    
+    /* Starts 0..66 fit before the fixed slot, 71..76 fit before slot 80 */
+    ASSERT_EQ(count, 67 + 6);
+    for (int s = 0; s < WEEK_SLOTS; s++) {
+        bool expected = (s <= 66) || (s >= 71 && s <= 76);
+        bool actual = (starts[s / SLOT_WORD_BITS] >> (s % SLOT_WORD_BITS)) & 1;
+        ASSERT_EQ(actual, expected);
+    }
+    
+    /* Runs never extend past the end of the timeline */
+    count = timeline_free_starts(timeline, 5, WEEK_SLOTS, starts);
+    ASSERT_EQ(count, 66 + (WEEK_SLOTS - 71 - 4));
+    
+    timeline_free(timeline);
+}
+
+/* Earliest free run by scanning every start, as free_index_first_fit answers it */
+static int scan_first_fit(const Timeline* timeline, int length, int from, int limit) {
+    for (int s = from; s + length <= limit; s++) {
+        if (timeline_is_range_free(timeline, s, length)) return s;
+    }
+    return -1;
+}
+
+TEST(test_free_index) {
+    Timeline* timeline = timeline_create_horizon(MAX_DAYS, 15, 0);
+    ASSERT_NE(timeline, NULL);
+    seed_random(21);
+    for (int i = 0; i < timeline->num_slots; i++) {
+        timeline->slots[i].is_fixed = random_int(0, 3) == 0;
+    }
+    timeline_rebuild_occupancy(timeline);
+    FreeIndex* index = free_index_create(NULL, timeline);
+    ASSERT_NE(index, NULL);
+    
+    for (int round = 0; round < 200; round++) {
+        for (int q = 0; q < 20; q++) {
+            int length = random_int(1, 12);
+            int from = random_int(0, timeline->num_slots);
+            int limit = random_int(0, timeline->num_slots + 10);
+            ASSERT_EQ(free_index_first_fit(index, length, from, limit),
+                      scan_first_fit(timeline, length, from,
+                                     limit < timeline->num_slots ? limit : timeline->num_slots));
+        }
+        
+        /* Take or free a random run and update only those slots */
+        int start = random_int(0, timeline->num_slots - 1);
+        int length = random_int(1, 40);
+        if (start + length > timeline->num_slots) length = timeline->num_slots - start;
+        bool taken = random_int(0, 1) == 0;
+        for (int i = start; i < start + length; i++) {
+            timeline->slots[i].is_fixed = taken;
+        }
+        timeline_rebuild_occupancy(timeline);
+        free_index_update(index, timeline, start, length);
+    }
+    
+    /* A fully taken timeline has no fit at all */
+    for (int i = 0; i < timeline->num_slots; i++) {
+        timeline->slots[i].is_fixed = true;
+    }
+    timeline_rebuild_occupancy(timeline);
+    free_index_update(index, timeline, 0, timeline->num_slots);
+    ASSERT_EQ(free_index_first_fit(index, 1, 0, timeline->num_slots), -1);
+    
+    free_index_free(index);
+    timeline_free(timeline);
+}
+
+TEST(test_runtime_horizon) {
+    ASSERT_EQ(horizon_num_slots(DEFAULT_NUM_DAYS, DEFAULT_SLOT_MINUTES, 0), WEEK_SLOTS);
+    ASSERT_EQ(horizon_num_slots(1, 60, 0), 24);
+    ASSERT_EQ(horizon_num_slots(1, 30, 28), 20);
+    ASSERT_EQ(horizon_num_slots(MAX_DAYS, 15, 0), MAX_SLOTS);
+    ASSERT_EQ(horizon_num_slots(0, 30, 0), -1);
+    ASSERT_EQ(horizon_num_slots(MAX_DAYS + 1, 30, 0), -1);
+    ASSERT_EQ(horizon_num_slots(1, 45, 0), -1);
+    ASSERT_EQ(horizon_num_slots(1, 30, SLOTS_PER_DAY), -1);
+    ASSERT_EQ(timeline_create_horizon(1, 20, 0), NULL);
+    
+    /* Hour slots average their two half-hours; quarter slots copy theirs */
+    uint8_t curve[SLOTS_PER_DAY];
+    for (int i = 0; i < SLOTS_PER_DAY; i++) {
+        curve[i] = (i % 2 == 0) ? 2 : 5;
+    }
+    EnergyTable table;
+    energy_table_build_ex(&table, curve, 60, 0);
+    ASSERT_EQ(table.slots_per_day, 24);
+    ASSERT_EQ(table.level[3], 4);
+    energy_table_build_ex(&table, curve, 15, 0);
+    ASSERT_EQ(table.slots_per_day, 96);
+    ASSERT_EQ(table.level[2], 5);
+    ASSERT_EQ(table.level[4], 2);
+    
+    /* Rest of today from 14:00: 20 slots, the 16:00 peak is slot 4 */
+    Task task;
+    task_init(&task);
+    task.id = 1;
+    task.duration_slots = 2;
+    SolverOptions options;
+    solver_options_init(&options);
+    options.num_days = 1;
+    options.start_slot_of_day = 28;
+    Timeline* timeline = optimize_schedule_ex(&task, 1, NULL, 0, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    ASSERT_EQ(timeline->num_slots, 20);
+    ASSERT_EQ(timeline->num_words, 1);
+    ASSERT_EQ(timeline->slots[4].task_id, 1);
+    ASSERT_EQ(timeline->slots[5].task_id, 1);
+    ASSERT_EQ(timeline->slots[4].energy_level, 9);
+    
+    /* A clone owns its own slots */
+    Timeline* copy = timeline_clone(timeline);
+    ASSERT_NE(copy, NULL);
+    ASSERT_TRUE(copy->slots != timeline->slots);
+    ASSERT_EQ(copy->slots[4].task_id, 1);
+    copy->slots[4].task_id = -1;
+    ASSERT_EQ(timeline->slots[4].task_id, 1);
+    timeline_free(copy);
+    timeline_free(timeline);
+    
+    /* Four weeks of hour slots with the first three taken */
+    options.num_days = 28;
+    options.slot_minutes = 60;
+    options.start_slot_of_day = 0;
+    int num_fixed = 21 * 24;
+    TimeSlot* fixed_slots = timeslot_array_create(num_fixed);
+    ASSERT_NE(fixed_slots, NULL);
+    for (int i = 0; i < num_fixed; i++) {
+        fixed_slots[i].slot_index = i;
+        fixed_slots[i].is_fixed = true;
+    }
+    task.duration_slots = 3;
+    task.deadline_slot = 600;
+    timeline = optimize_schedule_ex(&task, 1, fixed_slots, num_fixed, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_TRUE(timeline->success);
+    ASSERT_EQ(timeline->num_slots, 28 * 24);
+    ASSERT_EQ(timeline->slots[num_fixed + 8].task_id, 1);
+    ASSERT_EQ(timeline->slots[num_fixed + 10].task_id, 1);
+    timeline_free(timeline);
+    timeslot_array_free(fixed_slots);
+    
+    /* An invalid horizon is reported, not clamped */
+    options.slot_minutes = 45;
+    timeline = optimize_schedule_ex(&task, 1, NULL, 0, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_EQ(strncmp(timeline->error_message, "Invalid horizon", 15), 0);
+    timeline_free(timeline);
+    
+    ASSERT_EQ(parse_solver_options("{\"num_days\": 28, \"slot_minutes\": 15, "
+                                   "\"start_slot_of_day\": 95}", &options), 0);
+    ASSERT_EQ(options.num_days, 28);
+    ASSERT_EQ(options.slot_minutes, 15);
+    ASSERT_EQ(options.start_slot_of_day, 95);
+    ASSERT_EQ(parse_solver_options("{\"slot_minutes\": 45}", &options), -1);
+    ASSERT_EQ(parse_solver_options("{\"start_slot_of_day\": 48}", &options), -1);
+    ASSERT_EQ(parse_solver_options("{\"num_days\": 0}", &options), -1);
+}
+
+/* Stack of the thread solving test_deep_search_small_stack */
+#define SMALL_STACK_SIZE (128 * 1024)
+
+typedef struct {
+    Task* tasks;
+    int num_tasks;
+    const SolverOptions* options;
+    Timeline* result;
+} SolveJob;
+
+static void* solve_job_main(void* arg) {
+    SolveJob* job = (SolveJob*)arg;
+    job->result = optimize_schedule_ex(job->tasks, job->num_tasks, NULL, 0, job->options);
+    return NULL;
+}
+
+TEST(test_deep_search_small_stack) {
+    /* A search 500 levels deep keeps its frames off the thread stack */
+    int num_tasks = 500;
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].duration_slots = 1;
+        tasks[i].priority = i % 100;
+    }
+    SolverOptions options;
+    solver_options_init(&options);
+    options.engine = ENGINE_BACKTRACK;
+    options.backjumping = true;
+    options.num_days = 14;
+    
+    SolveJob job = { tasks, num_tasks, &options, NULL };
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    ASSERT_EQ(pthread_attr_setstacksize(&attr, SMALL_STACK_SIZE), 0);
+    pthread_t thread;
+    ASSERT_EQ(pthread_create(&thread, &attr, solve_job_main, &job), 0);
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+    
+    ASSERT_NE(job.result, NULL);
+    ASSERT_TRUE(job.result->success);
+    int placed = 0;
+    for (int i = 0; i < job.result->num_slots; i++) {
+        if (job.result->slots[i].task_id > 0) placed++;
+    }
+    ASSERT_EQ(placed, num_tasks);
+    timeline_free(job.result);
+    task_array_free(tasks);
+}
+
+TEST(test_thousands_of_tasks) {
+    /* Term planning: more short revision sessions than a month of
+     * quarter-hour slots holds */
+    int num_tasks = 5000;
+    ASSERT_TRUE(solver_task_capacity() >= num_tasks);
+    Task* tasks = task_array_create(num_tasks);
+    ASSERT_NE(tasks, NULL);
+    seed_random(11);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i].id = i + 1;
+        tasks[i].type = TASK_REVISION;
+        tasks[i].duration_slots = random_int(1, 2);
+        tasks[i].priority = random_int(0, 100);
+    }
+    SolverOptions options;
+    solver_options_init(&options);
+    options.engine = ENGINE_GREEDY;
+    options.num_days = MAX_DAYS;
+    options.slot_minutes = 15;
+    
+    Timeline* timeline = optimize_schedule_ex(tasks, num_tasks, NULL, 0, &options);
+    ASSERT_NE(timeline, NULL);
+    ASSERT_FALSE(timeline->success);
+    ASSERT_TRUE(timeline->num_unplaced > 0);
+    
+    /* Every placed task keeps one run; the rest are reported unplaced */
+    int used = 0;
+    for (int i = 0; i < timeline->num_slots; i++) {
+        if (timeline->slots[i].task_id > 0) used++;
+    }
+    int placed_slots = 0;
+    int placed = 0;
+    for (int t = 0; t < num_tasks; t++) {
+        bool unplaced = false;
+        for (int k = 0; k < timeline->num_unplaced; k++) {
+            if (timeline->unplaced_task_ids[k] == tasks[t].id) unplaced = true;
+        }
+        if (!unplaced) {
+            placed++;
+            placed_slots += tasks[t].duration_slots;
+        }
+    }
+    ASSERT_EQ(placed + timeline->num_unplaced, num_tasks);
+    ASSERT_EQ(used, placed_slots);
+    timeline_free(timeline);
+    task_array_free(tasks);
+}
+
 TEST(test_empty_schedule) {
     Timeline* timeline = optimize_schedule(NULL, 0, NULL, 0);
     ASSERT_NE(timeline, NULL);
@@ -235,7 +2157,7 @@ TEST(property_fixed_slot_preservation) {
             int idx;
             bool unique;
             do {
-                idx = random_int(0, MAX_SLOTS - 1);
+                idx = random_int(0, WEEK_SLOTS - 1);
                 unique = true;
                 for (int j = 0; j < i; j++) {
                     if (used_indices[j] == idx) {
@@ -314,7 +2236,7 @@ TEST(property_deadline_compliance) {
                 /* Deadline must be far enough to fit the task */
                 tasks[i].deadline_slot = random_int(
                     tasks[i].duration_slots + 10, 
-                    MAX_SLOTS - 1
+                    WEEK_SLOTS - 1
                 );
             } else {
                 tasks[i].deadline_slot = -1;
@@ -546,6 +2468,33 @@ int main(int argc, char* argv[]) {
     RUN_TEST(test_timeline_create_free);
     RUN_TEST(test_task_type_strings);
     RUN_TEST(test_energy_levels);
+    RUN_TEST(test_energy_table_default);
+    RUN_TEST(test_custom_energy_curve);
+    RUN_TEST(test_occupancy_free_starts);
+    RUN_TEST(test_free_index);
+    RUN_TEST(test_runtime_horizon);
+    RUN_TEST(test_search_budget_partial_result);
+    RUN_TEST(test_parse_input_scoping);
+    RUN_TEST(test_json_output_formats);
+    RUN_TEST(test_wire_round_trip);
+    RUN_TEST(test_library_api);
+    RUN_TEST(test_incremental_repair);
+    RUN_TEST(test_result_cache);
+    RUN_TEST(test_fixed_templates);
+    RUN_TEST(test_request_variants);
+    RUN_TEST(test_solver_stats);
+    RUN_TEST(test_request_arena);
+    RUN_TEST(test_forward_checking_mrv);
+    RUN_TEST(test_backjumping_proves_infeasible);
+    RUN_TEST(test_capacity_precheck);
+    RUN_TEST(test_component_decomposition);
+    RUN_TEST(test_symmetry_breaking);
+    RUN_TEST(test_branch_and_bound);
+    RUN_TEST(test_greedy_engine);
+    RUN_TEST(test_portfolio_solver);
+    RUN_TEST(test_parallel_search);
+    RUN_TEST(test_deep_search_small_stack);
+    RUN_TEST(test_thousands_of_tasks);
     RUN_TEST(test_empty_schedule);
     RUN_TEST(test_single_task);
     